@@ -0,0 +1,295 @@
+// BatchCompare.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "BatchCompare.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SYMBOLS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SYMBOLS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SYMBOLS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SYMBOLS_TARGET_AVX2
+#endif
+
+namespace Symbols {
+
+    void ChangeMasks::reset(size_t count)
+    {
+        const size_t words = (count + 63) / 64;
+        m_changed.assign(words, 0);
+        m_increased.assign(words, 0);
+        m_decreased.assign(words, 0);
+        m_count = count;
+    }
+
+    size_t ChangeMasks::changedCount() const noexcept
+    {
+        size_t count = 0;
+        for (uint64_t word : m_changed)
+        {
+            for (; word; word &= word - 1)
+                count++;
+        }
+        return count;
+    }
+
+    namespace {
+        SimdLevel detectSimdLevel() noexcept
+        {
+            SimdLevel level = SimdLevel::sl_Scalar;
+#if defined(SYMBOLS_X86)
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            if (info[3] & (1 << 26))
+                level = SimdLevel::sl_SSE2;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            __cpuidex(info, 7, 0);
+            //AVX2 needs the OS to save the ymm registers
+            if (osxsave && (info[1] & (1 << 5)) && (_xgetbv(0) & 0x6) == 0x6)
+                level = SimdLevel::sl_AVX2;
+#else
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("sse2"))
+                level = SimdLevel::sl_SSE2;
+            if (__builtin_cpu_supports("avx2"))
+                level = SimdLevel::sl_AVX2;
+#endif
+#endif
+            if (const char* limit = std::getenv("SYMBOLS_SIMD"))
+            {
+                if (std::strcmp(limit, "scalar") == 0)
+                    level = SimdLevel::sl_Scalar;
+                else if (std::strcmp(limit, "sse2") == 0 && level > SimdLevel::sl_SSE2)
+                    level = SimdLevel::sl_SSE2;
+            }
+            return level;
+        }
+
+        inline void setBits(uint64_t* mask, size_t index, unsigned bits) noexcept
+        {
+            //kernels step by 2, 4 or 8 slots, so a group never crosses a word
+            mask[index / 64] |= static_cast<uint64_t>(bits) << (index % 64);
+        }
+
+        template<typename T>
+        void changesScalar(const T* current, const T* values, size_t first, size_t count,
+            uint64_t* changed, uint64_t* increased, uint64_t* decreased) noexcept
+        {
+            for (size_t i = first; i < count; i++)
+            {
+                const bool up = values[i] > current[i];
+                const bool down = values[i] < current[i];
+                bool change = up || down;
+                if constexpr (std::is_floating_point_v<T>)
+                    change = change || (std::isnan(values[i]) != std::isnan(current[i]));
+
+                const uint64_t bit = uint64_t{ 1 } << (i % 64);
+                if (change)
+                    changed[i / 64] |= bit;
+                if (up)
+                    increased[i / 64] |= bit;
+                if (down)
+                    decreased[i / 64] |= bit;
+            }
+        }
+
+#if defined(SYMBOLS_X86)
+        //----------------------------------------------------------------------------- SSE2
+        size_t changesSse2(const float* current, const float* values, size_t count,
+            uint64_t* changed, uint64_t* increased, uint64_t* decreased) noexcept
+        {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 c = _mm_loadu_ps(current + i);
+                const __m128 v = _mm_loadu_ps(values + i);
+                const unsigned up = static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(v, c)));
+                const unsigned down = static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(v, c)));
+                const unsigned nan = static_cast<unsigned>(_mm_movemask_ps(_mm_cmpunord_ps(c, c)) ^
+                    _mm_movemask_ps(_mm_cmpunord_ps(v, v)));
+                setBits(changed, i, up | down | nan);
+                setBits(increased, i, up);
+                setBits(decreased, i, down);
+            }
+            return i;
+        }
+
+        size_t changesSse2(const double* current, const double* values, size_t count,
+            uint64_t* changed, uint64_t* increased, uint64_t* decreased) noexcept
+        {
+            size_t i = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const __m128d c = _mm_loadu_pd(current + i);
+                const __m128d v = _mm_loadu_pd(values + i);
+                const unsigned up = static_cast<unsigned>(_mm_movemask_pd(_mm_cmpgt_pd(v, c)));
+                const unsigned down = static_cast<unsigned>(_mm_movemask_pd(_mm_cmplt_pd(v, c)));
+                const unsigned nan = static_cast<unsigned>(_mm_movemask_pd(_mm_cmpunord_pd(c, c)) ^
+                    _mm_movemask_pd(_mm_cmpunord_pd(v, v)));
+                setBits(changed, i, up | down | nan);
+                setBits(increased, i, up);
+                setBits(decreased, i, down);
+            }
+            return i;
+        }
+
+        template<bool isUnsigned>
+        size_t changesSse2Int32(const void* current, const void* values, size_t count,
+            uint64_t* changed, uint64_t* increased, uint64_t* decreased) noexcept
+        {
+            //unsigned values are biased into the signed range, pcmpgtd only compares signed
+            const __m128i bias = _mm_set1_epi32(isUnsigned ? INT32_MIN : 0);
+            const auto* c32 = static_cast<const uint32_t*>(current);
+            const auto* v32 = static_cast<const uint32_t*>(values);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128i c = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(c32 + i)), bias);
+                const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v32 + i)), bias);
+                const unsigned up = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, c))));
+                const unsigned down = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(c, v))));
+                setBits(changed, i, up | down);
+                setBits(increased, i, up);
+                setBits(decreased, i, down);
+            }
+            return i;
+        }
+
+        //----------------------------------------------------------------------------- AVX2
+        SYMBOLS_TARGET_AVX2 size_t changesAvx2(const float* current, const float* values, size_t count,
+            uint64_t* changed, uint64_t* increased, uint64_t* decreased) noexcept
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256 c = _mm256_loadu_ps(current + i);
+                const __m256 v = _mm256_loadu_ps(values + i);
+                const unsigned up = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(v, c, _CMP_GT_OQ)));
+                const unsigned down = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(v, c, _CMP_LT_OQ)));
+                const unsigned nan = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(c, c, _CMP_UNORD_Q)) ^
+                    _mm256_movemask_ps(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+                setBits(changed, i, up | down | nan);
+                setBits(increased, i, up);
+                setBits(decreased, i, down);
+            }
+            return i;
+        }
+
+        SYMBOLS_TARGET_AVX2 size_t changesAvx2(const double* current, const double* values, size_t count,
+            uint64_t* changed, uint64_t* increased, uint64_t* decreased) noexcept
+        {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m256d c = _mm256_loadu_pd(current + i);
+                const __m256d v = _mm256_loadu_pd(values + i);
+                const unsigned up = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(v, c, _CMP_GT_OQ)));
+                const unsigned down = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(v, c, _CMP_LT_OQ)));
+                const unsigned nan = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(c, c, _CMP_UNORD_Q)) ^
+                    _mm256_movemask_pd(_mm256_cmp_pd(v, v, _CMP_UNORD_Q)));
+                setBits(changed, i, up | down | nan);
+                setBits(increased, i, up);
+                setBits(decreased, i, down);
+            }
+            return i;
+        }
+
+        template<bool isUnsigned>
+        SYMBOLS_TARGET_AVX2 size_t changesAvx2Int32(const void* current, const void* values, size_t count,
+            uint64_t* changed, uint64_t* increased, uint64_t* decreased) noexcept
+        {
+            const __m256i bias = _mm256_set1_epi32(isUnsigned ? INT32_MIN : 0);
+            const auto* c32 = static_cast<const uint32_t*>(current);
+            const auto* v32 = static_cast<const uint32_t*>(values);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256i c = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(c32 + i)), bias);
+                const __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v32 + i)), bias);
+                const unsigned up = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, c))));
+                const unsigned down = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(c, v))));
+                setBits(changed, i, up | down);
+                setBits(increased, i, up);
+                setBits(decreased, i, down);
+            }
+            return i;
+        }
+#endif
+
+        /*
+        *   runs the widest kernel available for T and returns the number of slots it handled,
+        *   the remaining tail is left to the scalar loop.
+        */
+        template<typename T>
+        size_t changesSimd([[maybe_unused]] const T* current, [[maybe_unused]] const T* values,
+            [[maybe_unused]] size_t count, [[maybe_unused]] uint64_t* changed,
+            [[maybe_unused]] uint64_t* increased, [[maybe_unused]] uint64_t* decreased) noexcept
+        {
+#if defined(SYMBOLS_X86)
+            const SimdLevel level = GetSimdLevel();
+            if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+            {
+                if (level == SimdLevel::sl_AVX2)
+                    return changesAvx2(current, values, count, changed, increased, decreased);
+                if (level == SimdLevel::sl_SSE2)
+                    return changesSse2(current, values, count, changed, increased, decreased);
+            }
+            else if constexpr (std::is_integral_v<T> && sizeof(T) == 4 && !std::is_same_v<T, bool>)
+            {
+                if (level == SimdLevel::sl_AVX2)
+                    return changesAvx2Int32<std::is_unsigned_v<T>>(current, values, count, changed, increased, decreased);
+                if (level == SimdLevel::sl_SSE2)
+                    return changesSse2Int32<std::is_unsigned_v<T>>(current, values, count, changed, increased, decreased);
+            }
+#endif
+            return 0;
+        }
+    }
+
+    SimdLevel GetSimdLevel() noexcept
+    {
+        static const SimdLevel level = detectSimdLevel();
+        return level;
+    }
+
+    template<typename T>
+    void DetectChanges(const T* current, const T* values, size_t count, ChangeMasks& masks)
+    {
+        masks.reset(count);
+        uint64_t* changed = masks.m_changed.data();
+        uint64_t* increased = masks.m_increased.data();
+        uint64_t* decreased = masks.m_decreased.data();
+
+        const size_t done = changesSimd(current, values, count, changed, increased, decreased);
+        changesScalar(current, values, done, count, changed, increased, decreased);
+    }
+
+    template void DetectChanges<bool>(const bool*, const bool*, size_t, ChangeMasks&);
+    template void DetectChanges<signed char>(const signed char*, const signed char*, size_t, ChangeMasks&);
+    template void DetectChanges<unsigned char>(const unsigned char*, const unsigned char*, size_t, ChangeMasks&);
+    template void DetectChanges<short>(const short*, const short*, size_t, ChangeMasks&);
+    template void DetectChanges<unsigned short>(const unsigned short*, const unsigned short*, size_t, ChangeMasks&);
+    template void DetectChanges<int>(const int*, const int*, size_t, ChangeMasks&);
+    template void DetectChanges<unsigned int>(const unsigned int*, const unsigned int*, size_t, ChangeMasks&);
+    template void DetectChanges<long long>(const long long*, const long long*, size_t, ChangeMasks&);
+    template void DetectChanges<unsigned long long>(const unsigned long long*, const unsigned long long*, size_t, ChangeMasks&);
+    template void DetectChanges<float>(const float*, const float*, size_t, ChangeMasks&);
+    template void DetectChanges<double>(const double*, const double*, size_t, ChangeMasks&);
+}
@@ -0,0 +1,79 @@
+// BatchCompare.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Batch change detection over contiguous value columns with SSE2/AVX2 kernels.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Symbols {
+
+    /*
+    *   bit masks produced by DetectChanges(), bit i of word i / 64 belongs to slot i.
+    */
+    struct ChangeMasks {
+        std::vector<uint64_t> m_changed;
+        std::vector<uint64_t> m_increased;
+        std::vector<uint64_t> m_decreased;
+        size_t m_count{};
+
+        /*
+        *   resize the masks for count slots and clear them.
+        *   returns nothing.
+        */
+        void reset(size_t count);
+
+        bool isChanged(size_t index) const noexcept {
+            return (m_changed[index / 64] >> (index % 64)) & 1;
+        }
+
+        bool isIncreased(size_t index) const noexcept {
+            return (m_increased[index / 64] >> (index % 64)) & 1;
+        }
+
+        bool isDecreased(size_t index) const noexcept {
+            return (m_decreased[index / 64] >> (index % 64)) & 1;
+        }
+
+        /*
+        *   get the number of changed slots.
+        */
+        size_t changedCount() const noexcept;
+    };
+
+    enum class SimdLevel {
+        sl_Scalar = 0,
+        sl_SSE2,
+        sl_AVX2
+    };
+
+    /*
+    *   get the instruction set the kernels use on this CPU, detected once at first use.
+    *   the environment variable SYMBOLS_SIMD=scalar|sse2 limits it, e.g. to compare results.
+    */
+    SimdLevel GetSimdLevel() noexcept;
+
+    /*
+    *   compare values[i] against current[i] for i in [0, count) like Symbol::compare does.
+    *   Params:
+    *   current: the values the symbols hold now.
+    *   values: the new values.
+    *   count: number of slots.
+    *   masks: receives changed, increased and decreased bits, reset to count slots.
+    *   Returns: nothing.
+    *   float, double, int and unsigned int use SSE2/AVX2 kernels selected at runtime,
+    *   the other arithmetic types are compared by a scalar loop.
+    */
+    template<typename T>
+    void DetectChanges(const T* current, const T* values, size_t count, ChangeMasks& masks);
+}
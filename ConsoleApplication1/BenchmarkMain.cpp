@@ -0,0 +1,214 @@
+// BenchmarkMain.cpp : benchmark executable
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include "Benchmarks.h"
+#include "StressHarness.h"
+
+namespace {
+    //allocations of the calling thread, counted by the operator new below for AllocationBenchmark
+    thread_local Benchmarks::AllocationCount t_allocations;
+
+    Benchmarks::AllocationCount allocations() noexcept
+    {
+        return t_allocations;
+    }
+
+    void* allocate(std::size_t size)
+    {
+        t_allocations.m_allocations++;
+        t_allocations.m_bytes += size;
+        if (void* p = std::malloc(size ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    //parse a comma separated list of numbers, e.g. "1000,100000"
+    template<typename T>
+    bool parseList(const std::string& text, std::vector<T>& values)
+    {
+        values.clear();
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            char* end = nullptr;
+            const unsigned long long value = std::strtoull(item.c_str(), &end, 10);
+            if (item.empty() || *end != '\0' || value == 0)
+                return false;
+            values.push_back(static_cast<T>(value));
+        }
+        return !values.empty();
+    }
+
+    void usage(const char* program)
+    {
+        std::cerr << "usage: " << program << " [options] [benchmark]\n"
+            << "  benchmark           core (default), stress, lookup, allocations, typed, arrays, structs, computed, expressions, alarms, watches, archive, compare, batch, shm, fanout, replication\n"
+            << "options for core, stress and lookup (--format, --symbols, --threads, --seconds):\n"
+            << "  --format json|csv   output format, default json (one object per line)\n"
+            << "  --symbols N[,N...]  table sizes, default 1000,100000,1000000, stress uses the first, default 100000\n"
+            << "  --threads N[,N...]  thread counts, default 1,2,4,8,16,32,64, stress 1,4,16,64\n"
+            << "  --operations N      core: lookups and updates per run, default 200000\n"
+            << "                      stress: operations per thread, default 0 (run for --seconds)\n"
+            << "  --seconds S         time budget per run, default 2\n"
+            << "options for core:\n"
+            << "  --serialize-limit N largest table SerializeXML runs on, default 100000\n"
+            << "  --quick             small matrix for a smoke run\n"
+            << "options for stress:\n"
+            << "  --workload W        hmi, acquisition, churn, storm or a mix like getid=80,set=20, repeatable\n"
+            << "  --theta T           zipfian skew of the keys, default 0.99, 0 is uniform\n"
+            << "  --seed N            seed of the workload generators, default 1\n"
+            << "  --stats             enable the table statistics during the runs\n";
+    }
+}
+
+//every allocation of the benchmark executable is counted, it costs two thread local increments
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(int argc, char* argv[])
+{
+    Benchmarks::CoreOptions options;
+    Benchmarks::StressOptions stress;
+    std::vector<std::string> workloads;
+    std::string name = "core";
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        bool bRet = true;
+
+        if (arg == "--format" && hasValue)
+        {
+            const std::string format = argv[++i];
+            options.m_format = format == "csv" ? Benchmarks::OutputFormat::of_Csv : Benchmarks::OutputFormat::of_Json;
+            stress.m_format = options.m_format;
+            bRet = format == "csv" || format == "json";
+        }
+        else if (arg == "--symbols" && hasValue)
+        {
+            bRet = parseList(argv[++i], options.m_symbols);
+            if (bRet)
+                stress.m_symbols = options.m_symbols.front();
+        }
+        else if (arg == "--threads" && hasValue)
+            bRet = parseList(argv[++i], options.m_threads) && parseList(argv[i], stress.m_threads);
+        else if (arg == "--operations" && hasValue)
+            options.m_operations = stress.m_operations = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seconds" && hasValue)
+            bRet = (options.m_seconds = stress.m_seconds = std::strtod(argv[++i], nullptr)) > 0;
+        else if (arg == "--serialize-limit" && hasValue)
+            options.m_serializeLimit = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--workload" && hasValue)
+        {
+            Benchmarks::WorkloadMix mix;
+            workloads.push_back(argv[++i]);
+            bRet = Benchmarks::WorkloadMix::parse(workloads.back(), mix);
+        }
+        else if (arg == "--theta" && hasValue)
+            stress.m_theta = std::strtod(argv[++i], nullptr);
+        else if (arg == "--seed" && hasValue)
+            stress.m_seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--stats")
+            stress.m_stats = true;
+        else if (arg == "--quick")
+        {
+            options.m_symbols = { 1000 };
+            options.m_threads = { 1, 2 };
+            options.m_operations = 10000;
+            options.m_seconds = 0.5;
+        }
+        else if (arg.rfind("--", 0) != 0)
+            name = arg;
+        else
+            bRet = false;
+
+        if (!bRet)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (name == "core")
+    {
+        Benchmarks::CoreBenchmark(std::cout, options);
+        return 0;
+    }
+    if (name == "lookup")
+    {
+        Benchmarks::LookupBenchmark(std::cout, options);
+        return 0;
+    }
+    if (name == "allocations")
+    {
+        Benchmarks::AllocationBenchmark(std::cout, options, allocations);
+        return 0;
+    }
+    if (name == "arrays")
+    {
+        Benchmarks::ArrayBenchmark(std::cout, allocations);
+        return 0;
+    }
+    if (name == "structs")
+    {
+        Benchmarks::StructBenchmark(std::cout, allocations);
+        return 0;
+    }
+    if (name == "expressions")
+    {
+        Benchmarks::ExpressionBenchmark(std::cout, allocations);
+        return 0;
+    }
+    if (name == "watches")
+    {
+        Benchmarks::WatchBenchmark(std::cout, allocations);
+        return 0;
+    }
+    if (name == "stress")
+    {
+        if (!workloads.empty())
+            stress.m_workloads = workloads;
+        Benchmarks::StressBenchmark(std::cout, stress);
+        return 0;
+    }
+    return Benchmarks::Run(name, std::cout) ? 0 : 1;
+}
@@ -0,0 +1,1832 @@
+// Benchmarks.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "Benchmarks.h"
+#include "Symbols.h"
+#include "SymbolExpression.h"
+#include "SymbolAwait.h"
+#include "SubscriptionServer.h"
+#include "SymbolReplication.h"
+#include "StressHarness.h"
+#include "ConcurrentHashMap.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Benchmarks {
+
+    namespace {
+        using clock_type = std::chrono::steady_clock;
+
+        double secondsSince(clock_type::time_point start)
+        {
+            return std::chrono::duration<double>(clock_type::now() - start).count();
+        }
+
+        uint64_t floatBits(float f)
+        {
+            uint32_t u;
+            std::memcpy(&u, &f, sizeof(u));
+            return u;
+        }
+
+        uint64_t doubleBits(double d)
+        {
+            uint64_t u;
+            std::memcpy(&u, &d, sizeof(u));
+            return u;
+        }
+
+        template<Symbols::SymbolType symbolType>
+        void compareType(std::ostream& out, const char* name,
+            Symbols::symbol_type_t<symbolType> a, Symbols::symbol_type_t<symbolType> b)
+        {
+            constexpr size_t ITERATIONS = 10000000;
+            const Symbols::Symbol symbol(1, name, "", symbolType, std::any(a));
+            const std::any values[2] = { std::any(a), std::any(b) };
+
+            size_t changes = 0;
+            const auto start = clock_type::now();
+            for (size_t i = 0; i < ITERATIONS; i++)
+            {
+                if (symbol.compare(values[i & 1]) != Symbols::SymbolEvent::EventFireType::eft_None)
+                    changes++;
+            }
+            const double seconds = secondsSince(start);
+
+            out << std::left << std::setw(16) << name
+                << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+                << seconds * 1e9 / ITERATIONS
+                << std::setw(12) << changes << "\n";
+        }
+
+        template<typename T>
+        void batchType(std::ostream& out, const char* name, Symbols::SymbolType symbolType)
+        {
+            constexpr size_t SYMBOLS = 4096;
+            constexpr size_t ROUNDS = 2000;
+            std::mt19937 rng(7);
+
+            //a PLC block read where about 1 of 16 values changed
+            std::vector<T> current(SYMBOLS), values(SYMBOLS);
+            std::vector<Symbols::Symbol> symbols;
+            symbols.reserve(SYMBOLS);
+            for (size_t i = 0; i < SYMBOLS; i++)
+            {
+                current[i] = static_cast<T>(rng() % 1000);
+                values[i] = rng() % 16 == 0 ? static_cast<T>(current[i] + 1) : current[i];
+                symbols.emplace_back(static_cast<uint32_t>(i), name, "", symbolType, std::any(current[i]));
+            }
+
+            // 1: one Symbol::compare per value
+            size_t perSymbolChanges = 0;
+            auto start = clock_type::now();
+            for (size_t round = 0; round < ROUNDS; round++)
+            {
+                for (size_t i = 0; i < SYMBOLS; i++)
+                {
+                    if (symbols[i].compare(std::any(values[i])) != Symbols::SymbolEvent::EventFireType::eft_None)
+                        perSymbolChanges++;
+                }
+            }
+            const double perSymbolSeconds = secondsSince(start);
+
+            // 2: one kernel call per block
+            Symbols::ChangeMasks masks;
+            size_t batchChanges = 0;
+            start = clock_type::now();
+            for (size_t round = 0; round < ROUNDS; round++)
+            {
+                Symbols::DetectChanges(current.data(), values.data(), SYMBOLS, masks);
+                batchChanges += masks.changedCount();
+            }
+            const double batchSeconds = secondsSince(start);
+
+            out << std::left << std::setw(10) << name
+                << std::right << std::setw(16) << std::fixed << std::setprecision(2)
+                << perSymbolSeconds * 1e9 / (ROUNDS * SYMBOLS)
+                << std::setw(16) << batchSeconds * 1e9 / (ROUNDS * SYMBOLS)
+                << std::setw(12) << perSymbolSeconds / batchSeconds
+                << (perSymbolChanges == batchChanges ? "" : "  (change count mismatch!)") << "\n";
+        }
+
+        struct Signal {
+            const char* m_name;
+            Symbols::SymbolArchive::Encoding m_encoding;
+            std::function<uint64_t(size_t, std::mt19937&)> m_generate;
+        };
+    }
+
+    bool Run(const std::string& name, std::ostream& out)
+    {
+        if (name == "archive")
+            ArchiveBenchmark(out);
+        else if (name == "compare")
+            CompareBenchmark(out);
+        else if (name == "batch")
+            BatchBenchmark(out);
+        else if (name == "shm")
+            SharedMemoryBenchmark(out);
+        else if (name == "fanout")
+            FanoutBenchmark(out);
+        else if (name == "replication")
+            ReplicationBenchmark(out);
+        else if (name == "core")
+            CoreBenchmark(out, CoreOptions{});
+        else if (name == "stress")
+            StressBenchmark(out, StressOptions{});
+        else if (name == "lookup")
+            LookupBenchmark(out, CoreOptions{});
+        else if (name == "allocations")
+            AllocationBenchmark(out, CoreOptions{}, nullptr);
+        else if (name == "typed")
+            TypedBenchmark(out);
+        else if (name == "arrays")
+            ArrayBenchmark(out, nullptr);
+        else if (name == "structs")
+            StructBenchmark(out, nullptr);
+        else if (name == "computed")
+            ComputedBenchmark(out);
+        else if (name == "expressions")
+            ExpressionBenchmark(out, nullptr);
+        else if (name == "alarms")
+            AlarmBenchmark(out);
+        else if (name == "watches")
+            WatchBenchmark(out, nullptr);
+        else
+        {
+            out << "unknown benchmark '" << name << "', available: archive, compare, batch, shm, fanout, replication, core, stress, lookup, allocations, typed, arrays, structs, computed, expressions, alarms, watches" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void ArchiveBenchmark(std::ostream& out)
+    {
+        using Encoding = Symbols::SymbolArchive::Encoding;
+        constexpr size_t SAMPLES = 1000000;
+        constexpr int64_t PERIOD = 100000000;  //10 Hz in nanoseconds
+
+        const std::vector<Signal> signals = {
+            // 12 bit ADC reading of a slow sine with noise
+            { "analog float (12 bit adc)", Encoding::enc_XorFloat, [](size_t i, std::mt19937& rng) {
+                const float raw = std::round(2048.0f + 1500.0f * std::sin(i * 0.001f) + (rng() % 5) - 2.0f);
+                return floatBits(raw * 0.05f);
+            } },
+            // process value in engineering units, full precision noise
+            { "analog double (noisy)", Encoding::enc_XorDouble, [](size_t i, std::mt19937& rng) {
+                return doubleBits(20.0 + 5.0 * std::sin(i * 0.0005) + std::uniform_real_distribution<double>(-0.01, 0.01)(rng));
+            } },
+            // set point which changes a few times a day
+            { "setpoint double", Encoding::enc_XorDouble, [](size_t i, std::mt19937&) {
+                return doubleBits(50.0 + 10.0 * static_cast<double>(i / 100000));
+            } },
+            // production counter
+            { "counter int32", Encoding::enc_VarintDelta, [](size_t i, std::mt19937& rng) {
+                return static_cast<uint64_t>(static_cast<int64_t>(i / 3 + rng() % 2));
+            } },
+            // motor running status
+            { "status boolean", Encoding::enc_VarintDelta, [](size_t i, std::mt19937&) {
+                return static_cast<uint64_t>((i / 5000) % 2);
+            } },
+        };
+
+        out << "SymbolArchive: " << SAMPLES << " samples per signal at 10 Hz with +/-2 ms jitter" << "\n";
+        out << std::left << std::setw(28) << "signal"
+            << std::right << std::setw(14) << "bytes"
+            << std::setw(14) << "bytes/sample"
+            << std::setw(16) << "encode Ms/s"
+            << std::setw(16) << "decode Ms/s" << "\n";
+
+        for (const auto& signal : signals)
+        {
+            std::mt19937 rng(42);
+            std::vector<Symbols::SymbolHistory::RawSample> input(SAMPLES);
+            int64_t timestamp = 1600000000LL * 1000000000LL;
+            for (size_t i = 0; i < SAMPLES; i++)
+            {
+                timestamp += PERIOD + (static_cast<int64_t>(rng() % 5) - 2) * 1000000;
+                input[i] = { timestamp, signal.m_generate(i, rng) };
+            }
+
+            Symbols::SymbolArchive archive(signal.m_encoding);
+            auto start = clock_type::now();
+            for (const auto& sample : input)
+                archive.append(sample.m_timestamp, sample.m_bits);
+            const double encodeSeconds = secondsSince(start);
+
+            std::vector<Symbols::SymbolHistory::RawSample> output;
+            output.reserve(SAMPLES);
+            start = clock_type::now();
+            archive.query(input.front().m_timestamp, input.back().m_timestamp, output);
+            const double decodeSeconds = secondsSince(start);
+
+            const size_t bytes = archive.memoryUsage();
+            out << std::left << std::setw(28) << signal.m_name
+                << std::right << std::setw(14) << bytes
+                << std::setw(14) << std::fixed << std::setprecision(3) << static_cast<double>(bytes) / SAMPLES
+                << std::setw(16) << std::setprecision(2) << SAMPLES / encodeSeconds / 1e6
+                << std::setw(16) << output.size() / decodeSeconds / 1e6
+                << (output.size() == SAMPLES ? "" : "  (sample count mismatch!)") << "\n";
+        }
+        out << std::endl;
+    }
+
+    void CompareBenchmark(std::ostream& out)
+    {
+        using Symbols::SymbolType;
+
+        out << "Symbol::compare: 10000000 calls per type, every other value differs" << "\n";
+        out << std::left << std::setw(16) << "type"
+            << std::right << std::setw(12) << "ns/call"
+            << std::setw(12) << "changes" << "\n";
+
+        compareType<SymbolType::st_Boolean>(out, "Boolean", false, true);
+        compareType<SymbolType::st_SByte>(out, "SByte", -5, 7);
+        compareType<SymbolType::st_Byte>(out, "Byte", 5, 200);
+        compareType<SymbolType::st_Int16>(out, "Int16", -300, 300);
+        compareType<SymbolType::st_UInt16>(out, "UInt16", 300, 60000);
+        compareType<SymbolType::st_Int32>(out, "Int32", -70000, 70000);
+        compareType<SymbolType::st_UInt32>(out, "UInt32", 70000, 4000000000u);
+        compareType<SymbolType::st_Int64>(out, "Int64", -(1LL << 40), 1LL << 40);
+        compareType<SymbolType::st_UInt64>(out, "UInt64", 1ULL << 40, 1ULL << 63);
+        compareType<SymbolType::st_Float>(out, "Float", 1.5f, 2.5f);
+        compareType<SymbolType::st_Double>(out, "Double", 1.5, 2.5);
+        compareType<SymbolType::st_String>(out, "String", "folder1.folder1a.value_a", "folder1.folder1a.value_b");
+        compareType<SymbolType::st_DateTime>(out, "DateTime", 132537600000000000ULL, 132537600010000000ULL);
+        compareType<SymbolType::st_Guid>(out, "Guid",
+            Symbols::Guid{ 0x12345678, 0x1234, 0x5678, { 1, 2, 3, 4, 5, 6, 7, 8 } },
+            Symbols::Guid{ 0x12345678, 0x1234, 0x5678, { 1, 2, 3, 4, 5, 6, 7, 9 } });
+        compareType<SymbolType::st_WideString>(out, "WideString", "a", "b");
+        compareType<SymbolType::st_Number>(out, "Number", 1.0f, -1.0f);
+        compareType<SymbolType::st_Integer>(out, "Integer", 1, 2);
+        compareType<SymbolType::st_UInteger>(out, "UInteger", 1u, 2u);
+        out << std::endl;
+    }
+
+    void BatchBenchmark(std::ostream& out)
+    {
+        using Symbols::SymbolType;
+        static const char* LEVELS[] = { "scalar", "sse2", "avx2" };
+
+        out << "DetectChanges: 4096 symbols per block, 2000 blocks, kernels: "
+            << LEVELS[static_cast<int>(Symbols::GetSimdLevel())] << "\n";
+        out << std::left << std::setw(10) << "type"
+            << std::right << std::setw(16) << "compare ns/val"
+            << std::setw(16) << "batch ns/val"
+            << std::setw(12) << "speedup" << "\n";
+
+        batchType<float>(out, "Float", SymbolType::st_Float);
+        batchType<double>(out, "Double", SymbolType::st_Double);
+        batchType<int>(out, "Int32", SymbolType::st_Int32);
+        batchType<unsigned int>(out, "UInt32", SymbolType::st_UInt32);
+        batchType<short>(out, "Int16", SymbolType::st_Int16);
+        batchType<long long>(out, "Int64", SymbolType::st_Int64);
+        out << std::endl;
+    }
+
+    void SharedMemoryBenchmark(std::ostream& out)
+    {
+#if defined(_WIN32)
+        out << "shared memory benchmark needs fork(), not available on this platform" << std::endl;
+#else
+        constexpr uint32_t SYMBOLS = 1024;
+        constexpr int READERS = 4;
+        constexpr double SECONDS = 2.0;
+        const std::string segment = "/symbols_benchmark_" + std::to_string(getpid());
+
+        Symbols::SymbolTable table;
+        for (uint32_t id = 1; id <= SYMBOLS; id++)
+            table.InsertValue(id, "plc.block.value" + std::to_string(id), "", Symbols::SymbolType::st_Double, 0.0);
+
+        if (!table.EnableSharedMemory(segment, SYMBOLS))
+        {
+            out << "could not create shared memory segment " << segment << std::endl;
+            return;
+        }
+
+        // 1: reader processes, every one reports reads and failed reads through a pipe
+        struct ReaderResult {
+            uint64_t m_reads;
+            uint64_t m_failed;
+            uint64_t m_torn;
+            double m_seconds;
+        };
+
+        int fds[2];
+        if (pipe(fds) != 0)
+            return;
+
+        std::vector<pid_t> readers;
+        for (int reader = 0; reader < READERS; reader++)
+        {
+            const pid_t pid = fork();
+            if (pid != 0)
+            {
+                if (pid > 0)
+                    readers.push_back(pid);
+                continue;
+            }
+
+            ReaderResult result{};
+            Symbols::SharedSymbolReader shared;
+            if (shared.open(segment))
+            {
+                std::vector<uint32_t> slots;
+                for (uint32_t id = 1; id <= SYMBOLS; id++)
+                    slots.push_back(shared.find("plc.block.value" + std::to_string(id)));
+
+                std::vector<double> last(SYMBOLS, 0.0);
+                const auto start = clock_type::now();
+                while (secondsSince(start) < SECONDS)
+                {
+                    for (uint32_t i = 0; i < SYMBOLS; i++)
+                    {
+                        uint64_t bits;
+                        int64_t timestamp;
+                        if (!shared.readRaw(slots[i], bits, timestamp))
+                        {
+                            result.m_failed++;
+                            continue;
+                        }
+
+                        //the writer only counts up, a smaller value would be a torn read
+                        double value;
+                        std::memcpy(&value, &bits, sizeof(value));
+                        if (value < last[i])
+                            result.m_torn++;
+                        last[i] = value;
+                    }
+                    result.m_reads += SYMBOLS;
+                }
+                result.m_seconds = secondsSince(start);
+            }
+            const ssize_t written = write(fds[1], &result, sizeof(result));
+            _exit(written == sizeof(result) ? 0 : 1);
+        }
+        close(fds[1]);
+
+        // 2: the writer updates the table through the normal SetValue path
+        uint64_t writes = 0;
+        const auto start = clock_type::now();
+        double seconds = 0;
+        while ((seconds = secondsSince(start)) < SECONDS)
+        {
+            for (uint32_t id = 1; id <= SYMBOLS; id++)
+                table.SetValue(id, static_cast<double>(writes));
+            writes++;
+        }
+
+        out << "shared memory segment: " << SYMBOLS << " double symbols, " << readers.size()
+            << " reader processes, " << SECONDS << " s" << "\n";
+        out << "writer: " << std::fixed << std::setprecision(2)
+            << writes * SYMBOLS / seconds / 1e6 << " M SetValue/s" << "\n";
+        out << std::left << std::setw(10) << "reader"
+            << std::right << std::setw(14) << "M reads/s"
+            << std::setw(12) << "ns/read"
+            << std::setw(12) << "failed"
+            << std::setw(12) << "torn" << "\n";
+
+        for (size_t reader = 0; reader < readers.size(); reader++)
+        {
+            ReaderResult result{};
+            if (read(fds[0], &result, sizeof(result)) != sizeof(result) || result.m_seconds <= 0)
+            {
+                out << std::left << std::setw(10) << reader << "could not open the segment" << "\n";
+                continue;
+            }
+            out << std::left << std::setw(10) << reader
+                << std::right << std::setw(14) << std::setprecision(2) << result.m_reads / result.m_seconds / 1e6
+                << std::setw(12) << result.m_seconds * 1e9 / std::max<uint64_t>(result.m_reads, 1)
+                << std::setw(12) << result.m_failed
+                << std::setw(12) << result.m_torn << "\n";
+        }
+        close(fds[0]);
+
+        for (const pid_t pid : readers)
+            waitpid(pid, nullptr, 0);
+        out << std::endl;
+#endif
+    }
+
+    void FanoutBenchmark(std::ostream& out)
+    {
+        constexpr uint32_t SYMBOLS = 1000;
+        constexpr int WRITERS = 2;
+        constexpr double SECONDS = 2.0;
+        constexpr double DELIVERIES = 1e6;  //offered load per second, 0 in the table means unpaced
+
+        Symbols::SymbolTable table;
+        for (uint32_t id = 1; id <= SYMBOLS; id++)
+            table.InsertValue(id, "plc.block.value" + std::to_string(id), "", Symbols::SymbolType::st_Double, 0.0);
+
+        const std::string path = "/tmp/symbols_fanout_" + std::to_string(
+            std::chrono::steady_clock::now().time_since_epoch().count()) + ".sock";
+
+        out << "subscription fan-out: " << SYMBOLS << " double symbols, " << WRITERS << " writer threads, "
+            << SECONDS << " s per run, " << std::thread::hardware_concurrency() << " cores" << "\n";
+        out << std::left << std::setw(10) << "clients"
+            << std::right << std::setw(12) << "offered"
+            << std::setw(14) << "M changes/s"
+            << std::setw(16) << "M deliveries/s"
+            << std::setw(12) << "frames/s"
+            << std::setw(12) << "server cpu"
+            << std::setw(12) << "received"
+            << std::setw(8) << "slow" << "\n";
+
+        const std::pair<int, double> runs[] = { { 1, 0.0 }, { 1, DELIVERIES }, { 4, DELIVERIES }, { 8, DELIVERIES } };
+        for (const auto& [clients, offered] : runs)
+        {
+            Symbols::SubscriptionServer server(table);
+            if (!server.start(path))
+            {
+                out << "could not listen on " << path << std::endl;
+                return;
+            }
+
+            // 1: every client subscribes to all symbols and counts what it gets
+            std::atomic<bool> running{ true };
+            std::atomic<uint64_t> received{ 0 };
+            std::atomic<int> ready{ 0 };
+            std::vector<std::thread> readers;
+            for (int client = 0; client < clients; client++)
+            {
+                readers.emplace_back([&]() {
+                    Symbols::SubscriptionClient subscriber;
+                    const bool connected = subscriber.connect(path) && subscriber.subscribe("plc.", true);
+                    std::vector<Symbols::SymbolCodec::Change> changes;
+                    while (connected && changes.size() < SYMBOLS)
+                    {
+                        if (subscriber.poll(changes, 100) < 0)
+                            break;
+                    }
+                    ready++;
+
+                    uint64_t count = 0;
+                    while (connected && running)
+                    {
+                        changes.clear();
+                        const int got = subscriber.poll(changes, 10);
+                        if (got < 0)
+                            break;
+                        count += static_cast<uint64_t>(got);
+                    }
+                    received += count;
+                });
+            }
+            while (ready < clients)
+                std::this_thread::yield();
+
+            // 2: writers change the symbols on disjoint halves of the table, paced to the offered load
+            const double changesPerWriter = offered / clients / WRITERS;
+            const auto before = server.stats();
+            const auto start = clock_type::now();
+            std::vector<std::thread> writers;
+            for (int writer = 0; writer < WRITERS; writer++)
+            {
+                writers.emplace_back([&, writer]() {
+                    double value = 0;
+                    uint64_t written = 0;
+                    double elapsed = 0;
+                    while ((elapsed = secondsSince(start)) < SECONDS)
+                    {
+                        if (changesPerWriter > 0 && written > elapsed * changesPerWriter)
+                        {
+                            std::this_thread::sleep_for(std::chrono::microseconds(100));
+                            continue;
+                        }
+                        value += 1;
+                        for (uint32_t id = 1 + writer; id <= SYMBOLS; id += WRITERS)
+                            table.SetValue(id, value);
+                        written += SYMBOLS / WRITERS;
+                    }
+                });
+            }
+            for (auto& writer : writers)
+                writer.join();
+            const double seconds = secondsSince(start);
+
+            //give the clients a moment to take what is still queued
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            const auto after = server.stats();
+            running = false;
+            for (auto& reader : readers)
+                reader.join();
+            server.stop();
+
+            out << std::left << std::setw(10) << clients
+                << std::right << std::setw(12) << (offered > 0 ? std::to_string(static_cast<int>(offered / 1e3)) + "k" : "max")
+                << std::setw(14) << std::fixed << std::setprecision(2)
+                << (after.m_changes - before.m_changes) / seconds / 1e6
+                << std::setw(16) << (after.m_deliveries - before.m_deliveries) / seconds / 1e6
+                << std::setw(12) << std::setprecision(0) << (after.m_frames - before.m_frames) / seconds
+                << std::setw(11) << std::setprecision(1) << (after.m_cpuTime - before.m_cpuTime) / seconds / 1e7 << "%"
+                << std::setw(12) << received.load()
+                << std::setw(8) << after.m_slowConsumers << "\n";
+        }
+        out << std::endl;
+    }
+
+    void ReplicationBenchmark(std::ostream& out)
+    {
+#if defined(_WIN32)
+        out << "replication benchmark needs fork(), not available on this platform" << std::endl;
+#else
+        constexpr uint32_t SYMBOLS = 1000;
+        constexpr double SECONDS = 2.0;
+
+        //every value is the system_clock time it was written at, so the replica sees the lag of each change
+        const auto now = []() {
+            return static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        };
+
+        Symbols::SymbolTable table;
+        for (uint32_t id = 1; id <= SYMBOLS; id++)
+            table.InsertValue(id, "plc.block.value" + std::to_string(id), "", Symbols::SymbolType::st_Int64, now());
+
+        const std::string path = "/tmp/symbols_replication_" + std::to_string(getpid()) + ".sock";
+        Symbols::ReplicationPrimary primary(table);
+        if (!primary.listen(path))
+        {
+            out << "could not listen on " << path << std::endl;
+            return;
+        }
+
+        struct ReplicaResult {
+            uint64_t m_applied{};   //sequence, the primary counts changes of all runs
+            uint64_t m_batches{};
+            uint64_t m_connects{};
+            uint64_t m_snapshots{};
+            double m_averageLag{};  //microseconds
+            double m_p50Lag{};
+            double m_p99Lag{};
+            double m_maxLag{};
+        };
+
+        out << "replication: " << SYMBOLS << " int64 symbols, replica in another process, "
+            << SECONDS << " s per run, the replica reconnects once halfway" << "\n";
+        out << std::left << std::setw(10) << "offered"
+            << std::right << std::setw(14) << "M changes/s"
+            << std::setw(12) << "applied"
+            << std::setw(10) << "batches"
+            << std::setw(10) << "connects"
+            << std::setw(11) << "snapshots"
+            << std::setw(12) << "avg lag us"
+            << std::setw(12) << "p50 lag us"
+            << std::setw(12) << "p99 lag us"
+            << std::setw(12) << "max lag us" << "\n";
+
+        const double runs[] = { 1e4, 1e5, 0.0 };
+        for (const double offered : runs)
+        {
+            int fds[2];
+            if (pipe(fds) != 0)
+                return;
+
+            // 1: the replica process applies the changes to its own table and measures the lag in a table event
+            const pid_t pid = fork();
+            if (pid == 0)
+            {
+                close(fds[0]);
+                Symbols::SymbolTable replicated;
+                std::vector<int64_t> lags;
+                lags.reserve(4 * 1024 * 1024);
+                std::atomic<bool> done{ false };
+                replicated.AddTableEvent([&](const Symbols::TableChange& change) {
+                    if (change.m_change == Symbols::SymbolCodec::ChangeType::ct_Set)
+                        lags.push_back(now() - std::any_cast<long long>(change.m_symbol->get()));
+                    else if (change.m_change == Symbols::SymbolCodec::ChangeType::ct_Insert && change.m_symbol->getId() == 0)
+                        done = true;
+                });
+
+                Symbols::ReplicationReplica replica(replicated);
+                replica.connect(path);
+                const auto start = clock_type::now();
+                bool dropped = false;
+                while (!done && secondsSince(start) < 10 * SECONDS)
+                {
+                    if (!dropped && secondsSince(start) > SECONDS / 2)
+                    {
+                        replica.disconnect();
+                        dropped = true;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                replica.stop();
+
+                const auto stats = replica.stats();
+                ReplicaResult result;
+                result.m_applied = stats.m_appliedSequence;
+                result.m_batches = stats.m_batches;
+                result.m_connects = stats.m_connects;
+                result.m_snapshots = stats.m_snapshots;
+                if (!lags.empty())
+                {
+                    double sum = 0;
+                    for (const int64_t lag : lags)
+                        sum += static_cast<double>(lag);
+                    std::sort(lags.begin(), lags.end());
+                    result.m_averageLag = sum / lags.size() / 1e3;
+                    result.m_p50Lag = lags[lags.size() / 2] / 1e3;
+                    result.m_p99Lag = lags[lags.size() * 99 / 100] / 1e3;
+                    result.m_maxLag = lags.back() / 1e3;
+                }
+                const ssize_t written = write(fds[1], &result, sizeof(result));
+                _exit(written == sizeof(result) ? 0 : 1);
+            }
+            close(fds[1]);
+            if (pid < 0)
+            {
+                close(fds[0]);
+                return;
+            }
+
+            //wait for the snapshot to be acknowledged
+            for (int wait = 0; wait < 500; wait++)
+            {
+                const auto stats = primary.stats();
+                if (stats.m_replicas > 0 && stats.m_ackedSequence >= stats.m_sequence)
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            // 2: change the symbols paced to the offered load, then tell the replica to finish
+            const auto before = primary.stats();
+            const auto start = clock_type::now();
+            uint64_t written = 0;
+            double seconds = 0;
+            while ((seconds = secondsSince(start)) < SECONDS)
+            {
+                if (offered > 0 && written > seconds * offered)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    continue;
+                }
+                for (uint32_t id = 1; id <= SYMBOLS; id += 10)
+                    table.SetValue(id, now());
+                written += SYMBOLS / 10;
+            }
+            const auto after = primary.stats();
+            table.InsertValue(0, "benchmark.done", "", Symbols::SymbolType::st_Boolean, true);
+
+            ReplicaResult result{};
+            const bool reported = read(fds[0], &result, sizeof(result)) == sizeof(result);
+            close(fds[0]);
+            waitpid(pid, nullptr, 0);
+            table.DeleteValue(0u);
+
+            out << std::left << std::setw(10) << (offered > 0 ? std::to_string(static_cast<int>(offered / 1e3)) + "k" : "max");
+            if (!reported)
+            {
+                out << "replica did not report" << "\n";
+                continue;
+            }
+            out << std::right << std::setw(14) << std::fixed << std::setprecision(2)
+                << (after.m_sequence - before.m_sequence) / seconds / 1e6
+                << std::setw(12) << result.m_applied - before.m_sequence
+                << std::setw(10) << result.m_batches
+                << std::setw(10) << result.m_connects
+                << std::setw(11) << result.m_snapshots
+                << std::setw(12) << std::setprecision(1) << result.m_averageLag
+                << std::setw(12) << result.m_p50Lag
+                << std::setw(12) << result.m_p99Lag
+                << std::setw(12) << result.m_maxLag << "\n";
+        }
+        primary.stop();
+        out << std::endl;
+#endif
+    }
+
+    namespace {
+        thread_local uint64_t t_eventCalls = 0;    //counted by the callback of the event dispatch run
+
+        struct CoreResult {
+            const char* m_operation;
+            size_t m_symbols;
+            unsigned m_threads;
+            size_t m_operations;
+            double m_seconds;
+            int64_t m_p50;      //nanoseconds per call
+            int64_t m_p90;
+            int64_t m_p99;
+            int64_t m_p999;
+            int64_t m_max;
+        };
+
+        /*
+        *   call body(thread, index) for the indices [0, count), every thread takes one contiguous block.
+        *   Every call is timed, a thread stops early once it used up the time budget.
+        */
+        template<typename Body>
+        CoreResult timeOperation(const char* operation, size_t symbols, unsigned threads, size_t count,
+            double budget, Body&& body)
+        {
+            std::vector<std::vector<int64_t>> samples(threads);
+            std::atomic<unsigned> ready{ 0 };
+            std::atomic<bool> go{ false };
+            std::vector<std::thread> workers;
+            for (unsigned thread = 0; thread < threads; thread++)
+            {
+                workers.emplace_back([&, thread]() {
+                    const size_t first = count * thread / threads;
+                    const size_t last = count * (thread + 1) / threads;
+                    auto& latencies = samples[thread];
+                    latencies.reserve(last - first);
+
+                    ready++;
+                    while (!go)
+                        std::this_thread::yield();
+
+                    const auto start = clock_type::now();
+                    for (size_t index = first; index < last; index++)
+                    {
+                        const auto before = clock_type::now();
+                        body(thread, index);
+                        const auto after = clock_type::now();
+                        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+                        if (std::chrono::duration<double>(after - start).count() > budget)
+                            break;
+                    }
+                });
+            }
+            while (ready < threads)
+                std::this_thread::yield();
+
+            const auto start = clock_type::now();
+            go = true;
+            for (auto& worker : workers)
+                worker.join();
+            const double seconds = secondsSince(start);
+
+            std::vector<int64_t> all;
+            for (const auto& latencies : samples)
+                all.insert(all.end(), latencies.begin(), latencies.end());
+            std::sort(all.begin(), all.end());
+            const auto percentile = [&all](double p) {
+                return all.empty() ? 0 : all[std::min(all.size() - 1, static_cast<size_t>(all.size() * p))];
+            };
+            return { operation, symbols, threads, all.size(), seconds,
+                percentile(0.5), percentile(0.9), percentile(0.99), percentile(0.999), all.empty() ? 0 : all.back() };
+        }
+
+        void writeResult(std::ostream& out, OutputFormat format, const CoreResult& result)
+        {
+            const double opsPerSecond = result.m_seconds > 0 ? result.m_operations / result.m_seconds : 0.0;
+            if (format == OutputFormat::of_Csv)
+            {
+                out << result.m_operation << ',' << result.m_symbols << ',' << result.m_threads << ','
+                    << result.m_operations << ',' << std::fixed << std::setprecision(6) << result.m_seconds << ','
+                    << std::setprecision(0) << opsPerSecond << ',' << result.m_p50 << ',' << result.m_p90 << ','
+                    << result.m_p99 << ',' << result.m_p999 << ',' << result.m_max << '\n';
+                return;
+            }
+            out << "{\"operation\":\"" << result.m_operation << "\",\"symbols\":" << result.m_symbols
+                << ",\"threads\":" << result.m_threads << ",\"operations\":" << result.m_operations
+                << ",\"seconds\":" << std::fixed << std::setprecision(6) << result.m_seconds
+                << ",\"ops_per_sec\":" << std::setprecision(0) << opsPerSecond
+                << ",\"p50_ns\":" << result.m_p50 << ",\"p90_ns\":" << result.m_p90 << ",\"p99_ns\":" << result.m_p99
+                << ",\"p999_ns\":" << result.m_p999 << ",\"max_ns\":" << result.m_max << "}\n";
+        }
+    }
+
+    void CoreBenchmark(std::ostream& out, const CoreOptions& options)
+    {
+        using Symbols::SymbolType;
+        constexpr double UNLIMITED = 1e30;  //inserts and deletes always run to the end, later runs need the table
+
+        if (options.m_format == OutputFormat::of_Csv)
+            out << "operation,symbols,threads,operations,seconds,ops_per_sec,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+
+        for (const size_t symbols : options.m_symbols)
+        {
+            std::vector<std::string> names(symbols);
+            for (size_t i = 0; i < symbols; i++)
+                names[i] = "plc.block" + std::to_string(i % 100) + ".value" + std::to_string(i + 1);
+
+            //ids are spread over the table, so lookups do not walk it in order
+            const auto scatter = [symbols](size_t index) {
+                return static_cast<uint32_t>(1 + index * 2654435761ull % symbols);
+            };
+
+            for (const unsigned threads : options.m_threads)
+            {
+                if (threads == 0)
+                    continue;
+
+                //writers change the symbols of their own block, no two threads change the same symbol
+                const auto ownSymbol = [symbols, threads](unsigned thread, size_t index) {
+                    const size_t first = symbols * thread / threads;
+                    const size_t length = std::max<size_t>(symbols * (thread + 1) / threads - first, 1);
+                    return static_cast<uint32_t>(1 + first + index * 7919 % length);
+                };
+
+                auto table = std::make_unique<Symbols::SymbolTable>();
+                writeResult(out, options.m_format, timeOperation("InsertValue", symbols, threads, symbols, UNLIMITED,
+                    [&](unsigned, size_t index) {
+                        table->InsertValue(static_cast<uint32_t>(index + 1), names[index], "", SymbolType::st_Double, 0.0);
+                    }));
+
+                writeResult(out, options.m_format, timeOperation("GetValueById", symbols, threads, options.m_operations,
+                    options.m_seconds, [&](unsigned, size_t index) {
+                        [[maybe_unused]] const Symbols::Symbol symbol = table->GetValue(scatter(index));
+                    }));
+
+                writeResult(out, options.m_format, timeOperation("GetValueByName", symbols, threads, options.m_operations,
+                    options.m_seconds, [&](unsigned, size_t index) {
+                        [[maybe_unused]] const Symbols::Symbol symbol = table->GetValue(names[scatter(index) - 1]);
+                    }));
+
+                writeResult(out, options.m_format, timeOperation("SetValue", symbols, threads, options.m_operations,
+                    options.m_seconds, [&](unsigned thread, size_t index) {
+                        table->SetValue(ownSymbol(thread, index), static_cast<double>(index + 1));
+                    }));
+
+                for (uint32_t id = 1; id <= symbols; id++)
+                {
+                    table->AddEvent(id, Symbols::SymbolEvent(1, Symbols::SymbolEvent::EventType::et_OpcServer,
+                        Symbols::SymbolEvent::EventFireType::eft_AnyChange,
+                        [](Symbols::SymbolEvent::BaseArgs*) { t_eventCalls++; }));
+                }
+                writeResult(out, options.m_format, timeOperation("EventDispatch", symbols, threads, options.m_operations,
+                    options.m_seconds, [&](unsigned thread, size_t index) {
+                        table->SetValue(ownSymbol(thread, index), -static_cast<double>(index + 1));
+                    }));
+
+                //a whole table per call, one thread is enough
+                if (threads == options.m_threads.front() && symbols <= options.m_serializeLimit)
+                {
+                    const size_t iterations = std::clamp<size_t>(100000 / symbols, 1, 20);
+                    writeResult(out, options.m_format, timeOperation("SerializeXML", symbols, 1, iterations,
+                        options.m_seconds, [&](unsigned, size_t) {
+                            [[maybe_unused]] const auto xml = table->SerializeXML();
+                        }));
+                }
+
+                writeResult(out, options.m_format, timeOperation("DeleteValue", symbols, threads, symbols, UNLIMITED,
+                    [&](unsigned, size_t index) {
+                        table->DeleteValue(static_cast<uint32_t>(index + 1));
+                    }));
+                out.flush();
+            }
+        }
+    }
+
+    namespace {
+        /*
+        *   readers look random keys up for the time budget while an optional writer inserts and erases
+        *   keys above the table. Returns the lookups per second of all readers.
+        */
+        template<typename Find, typename Write>
+        std::pair<uint64_t, double> timeLookups(size_t symbols, unsigned threads, bool writer, double budget,
+            Find&& find, Write&& write)
+        {
+            std::atomic<bool> go{ false }, stop{ false };
+            std::atomic<uint64_t> lookups{ 0 }, checksum{ 0 };
+            std::vector<std::thread> workers;
+            for (unsigned thread = 0; thread < threads; thread++)
+            {
+                workers.emplace_back([&, thread]() {
+                    std::mt19937 rng(thread + 1);
+                    uint64_t done = 0, sum = 0;
+                    while (!go)
+                        std::this_thread::yield();
+                    while (!stop.load(std::memory_order_relaxed))
+                    {
+                        for (int i = 0; i < 256; i++)
+                            sum += find(static_cast<uint32_t>(1 + rng() % symbols));
+                        done += 256;
+                    }
+                    lookups += done;
+                    checksum += sum;    //keeps the lookups from being optimised out
+                });
+            }
+            std::thread churn;
+            if (writer)
+            {
+                churn = std::thread([&]() {
+                    uint32_t next = 0;
+                    while (!go)
+                        std::this_thread::yield();
+                    while (!stop.load(std::memory_order_relaxed))
+                    {
+                        const uint32_t id = static_cast<uint32_t>(symbols + 1 + next++ % 1024);
+                        write(id, next % 2 == 1);
+                    }
+                });
+            }
+
+            const auto start = clock_type::now();
+            go = true;
+            std::this_thread::sleep_for(std::chrono::duration<double>(budget));
+            stop = true;
+            for (auto& worker : workers)
+                worker.join();
+            const double seconds = secondsSince(start);
+            if (churn.joinable())
+                churn.join();
+            return { lookups.load(), seconds };
+        }
+    }
+
+    void LookupBenchmark(std::ostream& out, const CoreOptions& options)
+    {
+        if (options.m_format == OutputFormat::of_Csv)
+            out << "map,symbols,threads,writer,lookups,seconds,lookups_per_sec,ns_per_lookup\n";
+
+        for (const size_t symbols : options.m_symbols)
+        {
+            aricanli::container::ThreadSafeMap<uint32_t, uint64_t> tree;
+            aricanli::container::ConcurrentHashMap<uint32_t, uint64_t> hash(symbols);
+            for (uint32_t id = 1; id <= symbols; id++)
+            {
+                tree.emplace(id, id);
+                hash.insert(id, id);
+            }
+
+            const auto findTree = [&tree](uint32_t id) -> uint64_t {
+                auto it = tree.find(id);
+                return it != tree.cend() ? it->second : 0;
+            };
+            const auto writeTree = [&tree](uint32_t id, bool add) {
+                if (add)
+                    tree.emplace(id, id);
+                else
+                    tree.erase(id);
+            };
+            const auto findHash = [&hash](uint32_t id) -> uint64_t {
+                uint64_t value = 0;
+                hash.find(id, value);
+                return value;
+            };
+            const auto writeHash = [&hash](uint32_t id, bool add) {
+                if (add)
+                    hash.insert(id, id);
+                else
+                    hash.erase(id);
+            };
+
+            for (const bool writer : { false, true })
+            {
+                for (const unsigned threads : options.m_threads)
+                {
+                    for (const char* map : { "ThreadSafeMap", "ConcurrentHashMap" })
+                    {
+                        const bool isTree = map[0] == 'T';
+                        const auto result = isTree ?
+                            timeLookups(symbols, threads, writer, options.m_seconds, findTree, writeTree) :
+                            timeLookups(symbols, threads, writer, options.m_seconds, findHash, writeHash);
+                        const double perSecond = result.second > 0 ? result.first / result.second : 0.0;
+                        const double nsPerLookup = perSecond > 0 ? threads * 1e9 / perSecond : 0.0;
+
+                        if (options.m_format == OutputFormat::of_Csv)
+                        {
+                            out << map << ',' << symbols << ',' << threads << ',' << (writer ? 1 : 0) << ','
+                                << result.first << ',' << std::fixed << std::setprecision(6) << result.second << ','
+                                << std::setprecision(0) << perSecond << ',' << std::setprecision(1) << nsPerLookup << '\n';
+                        }
+                        else
+                        {
+                            out << "{\"map\":\"" << map << "\",\"symbols\":" << symbols << ",\"threads\":" << threads
+                                << ",\"writer\":" << (writer ? "true" : "false") << ",\"lookups\":" << result.first
+                                << ",\"seconds\":" << std::fixed << std::setprecision(6) << result.second
+                                << ",\"lookups_per_sec\":" << std::setprecision(0) << perSecond
+                                << ",\"ns_per_lookup\":" << std::setprecision(1) << nsPerLookup << "}\n";
+                        }
+                        out << std::defaultfloat << std::setprecision(6);
+                        out.flush();
+                    }
+                }
+            }
+        }
+    }
+
+    void AllocationBenchmark(std::ostream& out, const CoreOptions& options, allocation_counter_t counter)
+    {
+        using Symbols::SymbolType;
+        using Symbols::SymbolEvent;
+
+        if (!counter)
+        {
+            out << "allocation benchmark needs an executable counting operator new, run SymbolBenchmarks allocations" << std::endl;
+            return;
+        }
+
+        constexpr uint32_t CALLS = 10000;
+        const std::string desc = "temperature of the line in degrees celsius";
+        const std::string text = "a string value longer than the small string buffer";
+        std::vector<std::string> names(CALLS);
+        for (uint32_t i = 0; i < CALLS; i++)
+            names[i] = "plant.area" + std::to_string(i % 10) + ".line.temperature" + std::to_string(i);
+
+        //adds the allocations made by fn to total
+        const auto count = [counter](AllocationCount& total, const auto& fn) {
+            const AllocationCount before = counter();
+            fn();
+            const AllocationCount after = counter();
+            total.m_allocations += after.m_allocations - before.m_allocations;
+            total.m_bytes += after.m_bytes - before.m_bytes;
+        };
+
+        const auto report = [&out, &options](const char* operation, const AllocationCount& total) {
+            const double allocations = static_cast<double>(total.m_allocations) / CALLS;
+            const double bytes = static_cast<double>(total.m_bytes) / CALLS;
+            if (options.m_format == OutputFormat::of_Csv)
+            {
+                out << operation << ',' << CALLS << ',' << std::fixed << std::setprecision(2)
+                    << allocations << ',' << std::setprecision(1) << bytes << '\n';
+            }
+            else
+            {
+                out << "{\"operation\":\"" << operation << "\",\"calls\":" << CALLS
+                    << ",\"allocations_per_call\":" << std::fixed << std::setprecision(2) << allocations
+                    << ",\"bytes_per_call\":" << std::setprecision(1) << bytes << "}\n";
+            }
+            out << std::defaultfloat << std::setprecision(6);
+            out.flush();
+        };
+
+        if (options.m_format == OutputFormat::of_Csv)
+            out << "operation,calls,allocations_per_call,bytes_per_call\n";
+
+        // ids 1..CALLS hold integers, CALLS+1..2*CALLS strings
+        Symbols::SymbolTable table;
+        AllocationCount total{};
+        for (uint32_t i = 0; i < CALLS; i++)
+        {
+            std::string name = names[i], description = desc;
+            std::any value(static_cast<int>(i));
+            count(total, [&] {
+                table.InsertValue(i + 1, std::move(name), std::move(description), SymbolType::st_Int32, std::move(value));
+            });
+        }
+        report("InsertValue", total);
+
+        total = {};
+        for (uint32_t i = 0; i < CALLS; i++)
+        {
+            std::string name = names[i] + ".text", description = desc, value = text;
+            count(total, [&] {
+                table.InsertFromStringValue(CALLS + i + 1, std::move(name), std::move(description),
+                    SymbolType::st_String, std::move(value));
+            });
+        }
+        report("InsertFromStringValue", total);
+
+        total = {};
+        for (uint32_t i = 0; i < CALLS; i++)
+        {
+            std::any value(static_cast<int>(i) + 1);
+            count(total, [&] { table.SetValue(i + 1, std::move(value)); });
+        }
+        report("SetValueById", total);
+
+        total = {};
+        for (uint32_t i = 0; i < CALLS; i++)
+        {
+            std::any value(text + std::to_string(i));
+            count(total, [&] { table.SetValue(CALLS + i + 1, std::move(value)); });
+        }
+        report("SetValueByIdString", total);
+
+        total = {};
+        for (uint32_t i = 0; i < CALLS; i++)
+        {
+            std::string name = names[i];
+            std::any value(static_cast<int>(i) + 2);
+            count(total, [&] { table.SetValue(std::move(name), std::move(value)); });
+        }
+        report("SetValueByName", total);
+
+        total = {};
+        for (uint32_t i = 0; i < CALLS; i++)
+        {
+            SymbolEvent symbolEvent(1, SymbolEvent::EventType::et_OpcServer, SymbolEvent::EventFireType::eft_AnyChange,
+                [](SymbolEvent::BaseArgs*) {});
+            count(total, [&] { table.AddEvent(i + 1, std::move(symbolEvent)); });
+        }
+        report("AddEvent", total);
+
+        //the event arguments carry the symbol name, one copy per fired event
+        total = {};
+        for (uint32_t i = 0; i < CALLS; i++)
+        {
+            std::any value(static_cast<int>(i) + 3);
+            count(total, [&] { table.SetValue(i + 1, std::move(value)); });
+        }
+        report("SetValueWithEvent", total);
+
+        total = {};
+        for (uint32_t i = 0; i < CALLS; i++)
+            count(total, [&] { table.DeleteValue(i + 1); });
+        report("DeleteValue", total);
+    }
+
+    void TypedBenchmark(std::ostream& out)
+    {
+        using Symbols::SymbolType;
+        constexpr uint32_t SYMBOLS = 1000;
+        constexpr size_t ROUNDS = 1000;
+
+        Symbols::SymbolTable table;
+        std::vector<Symbols::TypedSymbol<SymbolType::st_Double>> handles;
+        std::vector<Symbols::SymbolHandle> resolved;
+        for (uint32_t id = 1; id <= SYMBOLS; id++)
+        {
+            table.InsertValue(id, "plc.analog" + std::to_string(id), "", SymbolType::st_Double, std::any(0.0));
+            handles.push_back(table.Typed<SymbolType::st_Double>(id));
+            resolved.push_back(table.Resolve(id));
+        }
+
+        out << "TypedSymbol: " << SYMBOLS * ROUNDS << " calls per operation on " << SYMBOLS << " st_Double symbols" << "\n";
+        out << std::left << std::setw(28) << "operation" << std::right << std::setw(12) << "ns/call" << "\n";
+        const auto row = [&out](const char* operation, double seconds) {
+            out << std::left << std::setw(28) << operation << std::right << std::setw(12)
+                << std::fixed << std::setprecision(1) << seconds * 1e9 / (SYMBOLS * ROUNDS) << "\n";
+            out << std::defaultfloat << std::setprecision(6);
+        };
+
+        double sum = 0.0;   //printed, so the reads are not optimised away
+        auto start = clock_type::now();
+        for (size_t round = 0; round < ROUNDS; round++)
+        {
+            for (uint32_t id = 1; id <= SYMBOLS; id++)
+            {
+                const Symbols::Symbol symbol = table.GetValue(id);
+                if (const double* value = symbol.get<double>())
+                    sum += *value;
+            }
+        }
+        row("GetValue + get<double>", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t round = 0; round < ROUNDS; round++)
+        {
+            for (uint32_t id = 1; id <= SYMBOLS; id++)
+            {
+                auto it = table.find(id);
+                if (const double* value = it != table.end() ? it->second.get<double>() : nullptr)
+                    sum += *value;
+            }
+        }
+        row("find + get<double>", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t round = 0; round < ROUNDS; round++)
+        {
+            for (const auto& handle : resolved)
+            {
+                if (const double* value = handle.get<double>())
+                    sum += *value;
+            }
+        }
+        row("SymbolHandle::get<double>", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t round = 0; round < ROUNDS; round++)
+        {
+            for (const auto& handle : handles)
+                sum += handle.get();
+        }
+        row("TypedSymbol::get", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t round = 0; round < ROUNDS; round++)
+        {
+            for (uint32_t id = 1; id <= SYMBOLS; id++)
+                table.SetValue(id, std::any(static_cast<double>(round)));
+        }
+        row("SetValue", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t round = 0; round < ROUNDS; round++)
+        {
+            for (const auto& handle : resolved)
+                table.SetValue(handle, std::any(static_cast<double>(round) + 0.25));
+        }
+        row("SetValue(SymbolHandle)", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t round = 0; round < ROUNDS; round++)
+        {
+            for (auto& handle : handles)
+                handle.set(static_cast<double>(round) + 0.5);
+        }
+        row("TypedSymbol::set", secondsSince(start));
+        out << "checksum " << sum << std::endl;
+    }
+
+    void ArrayBenchmark(std::ostream& out, allocation_counter_t counter)
+    {
+        using Symbols::SymbolType;
+        constexpr uint32_t ELEMENTS = 1000;     //REAL[1000]
+        constexpr size_t CYCLES = 2000;
+        constexpr uint32_t ARRAY_ID = 1000000;
+
+        //a sine which moves by one sample per cycle, so every element changes every cycle
+        std::vector<float> wave(ELEMENTS + CYCLES);
+        for (size_t i = 0; i < wave.size(); i++)
+            wave[i] = static_cast<float>(std::sin(static_cast<double>(i) * 0.01));
+
+        const auto allocated = [counter] { return counter ? counter().m_bytes : 0; };
+
+        // the waveform exploded into one st_Float tag per element, ids 1..ELEMENTS
+        Symbols::SymbolTable scalars;
+        uint64_t before = allocated();
+        for (uint32_t i = 0; i < ELEMENTS; i++)
+            scalars.InsertValue(i + 1, "plc.db10.wave[" + std::to_string(i) + "]", "", SymbolType::st_Float, std::any(0.0f));
+        const uint64_t scalarBytes = allocated() - before;
+
+        Symbols::SymbolTable arrays;
+        before = allocated();
+        arrays.InsertValue(ARRAY_ID, "plc.db10.wave", "", SymbolType::st_FloatArray, std::any(std::vector<float>(ELEMENTS)));
+        const uint64_t arrayBytes = allocated() - before;
+
+        out << "Arrays: REAL[" << ELEMENTS << "] updated " << CYCLES << " times, every element changes" << "\n";
+        out << std::left << std::setw(36) << "operation" << std::right << std::setw(14) << "us/cycle" << "\n";
+        const auto row = [&out](const std::string& operation, double seconds) {
+            out << std::left << std::setw(36) << operation << std::right << std::setw(14)
+                << std::fixed << std::setprecision(2) << seconds * 1e6 / CYCLES << "\n";
+            out << std::defaultfloat << std::setprecision(6);
+        };
+
+        auto start = clock_type::now();
+        for (size_t cycle = 0; cycle < CYCLES; cycle++)
+        {
+            for (uint32_t i = 0; i < ELEMENTS; i++)
+                scalars.SetValue(i + 1, std::any(wave[cycle + i]));
+        }
+        row("SetValue per st_Float tag", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t cycle = 0; cycle < CYCLES; cycle++)
+            scalars.SetValues(1, wave.data() + cycle, ELEMENTS);
+        row("SetValues over st_Float tags", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t cycle = 0; cycle < CYCLES; cycle++)
+            arrays.SetValue(ARRAY_ID, std::any(std::vector<float>(wave.begin() + cycle, wave.begin() + cycle + ELEMENTS)));
+        row("SetValue st_FloatArray", secondsSince(start));
+
+        Symbols::ChangeMasks changes;
+        size_t changed = 0;
+        start = clock_type::now();
+        for (size_t cycle = 0; cycle < CYCLES; cycle++)
+        {
+            arrays.SetSlice(ARRAY_ID, 0, wave.data() + cycle, ELEMENTS, &changes);
+            changed += changes.changedCount();
+        }
+        row("SetSlice st_FloatArray", secondsSince(start));
+
+        start = clock_type::now();
+        for (size_t cycle = 0; cycle < CYCLES; cycle++)
+            arrays.SetSlice(ARRAY_ID, 0, wave.data() + CYCLES - 1, ELEMENTS, &changes);
+        row("SetSlice st_FloatArray, unchanged", secondsSince(start));
+
+        if (counter)
+        {
+            out << "bytes allocated by the inserts: " << scalarBytes << " for " << ELEMENTS << " st_Float tags, "
+                << arrayBytes << " for one st_FloatArray" << "\n";
+        }
+        else
+            out << "run SymbolBenchmarks arrays to count the memory of the symbols" << "\n";
+        out << "changed elements " << changed << std::endl;
+    }
+
+    void StructBenchmark(std::ostream& out, allocation_counter_t counter)
+    {
+        using Symbols::SymbolType;
+        constexpr uint32_t MOTORS = 100;
+        constexpr size_t CYCLES = 2000;
+        constexpr uint32_t FIELDS = 20;
+
+        //a motor UDT: 12 REAL, 4 DINT and 4 BOOL fields, speed and current change every cycle
+        std::vector<Symbols::StructField> fields;
+        for (uint32_t i = 0; i < FIELDS; i++)
+        {
+            const SymbolType type = i < 12 ? SymbolType::st_Float : (i < 16 ? SymbolType::st_Int32 : SymbolType::st_Boolean);
+            fields.push_back({ "field" + std::to_string(i), type });
+        }
+        const auto layout = Symbols::StructLayout::registerType("BenchmarkMotor", fields);
+        const auto allocated = [counter] { return counter ? counter().m_bytes : 0; };
+
+        // the struct flattened into a tag per field, motor m field f has id m * FIELDS + f + 1
+        Symbols::SymbolTable flat;
+        uint64_t before = allocated();
+        for (uint32_t m = 0; m < MOTORS; m++)
+        {
+            for (uint32_t f = 0; f < FIELDS; f++)
+            {
+                const SymbolType type = layout->field(f).m_type;
+                flat.InsertValue(m * FIELDS + f + 1, "plc.motor" + std::to_string(m) + "." + layout->field(f).m_name, "", type,
+                    type == SymbolType::st_Float ? std::any(0.0f) : (type == SymbolType::st_Int32 ? std::any(0) : std::any(false)));
+            }
+        }
+        const uint64_t flatBytes = allocated() - before;
+
+        Symbols::SymbolTable structs;
+        before = allocated();
+        for (uint32_t m = 0; m < MOTORS; m++)
+            structs.InsertValue(m + 1, "plc.motor" + std::to_string(m), "", SymbolType::st_Struct, std::any(Symbols::StructValue(layout)));
+        const uint64_t structBytes = allocated() - before;
+
+        //the blocks a PLC read delivers, built before the runs
+        std::vector<Symbols::StructValue> blocks(MOTORS * 2, Symbols::StructValue(layout));
+        for (size_t b = 0; b < blocks.size(); b++)
+        {
+            blocks[b].set(0, static_cast<float>(b));
+            blocks[b].set(1, static_cast<float>(b) * 0.5f);
+        }
+
+        out << "Structs: " << MOTORS << " motors of " << FIELDS << " fields updated " << CYCLES << " times, 2 fields change" << "\n";
+        out << std::left << std::setw(36) << "operation" << std::right << std::setw(14) << "us/cycle" << "\n";
+        const auto row = [&out](const std::string& operation, double seconds) {
+            out << std::left << std::setw(36) << operation << std::right << std::setw(14)
+                << std::fixed << std::setprecision(2) << seconds * 1e6 / CYCLES << "\n";
+            out << std::defaultfloat << std::setprecision(6);
+        };
+
+        auto start = clock_type::now();
+        for (size_t cycle = 0; cycle < CYCLES; cycle++)
+        {
+            for (uint32_t m = 0; m < MOTORS; m++)
+            {
+                const Symbols::StructValue& block = blocks[(cycle & 1) * MOTORS + m];
+                for (uint32_t f = 0; f < FIELDS; f++)
+                {
+                    const uint32_t id = m * FIELDS + f + 1;
+                    float real;
+                    int dint;
+                    bool flag;
+                    if (block.get(f, real))
+                        flat.SetValue(id, std::any(real));
+                    else if (block.get(f, dint))
+                        flat.SetValue(id, std::any(dint));
+                    else if (block.get(f, flag))
+                        flat.SetValue(id, std::any(flag));
+                }
+            }
+        }
+        row("SetValue per field tag", secondsSince(start));
+
+        uint64_t changed = 0;
+        start = clock_type::now();
+        for (size_t cycle = 0; cycle < CYCLES; cycle++)
+        {
+            for (uint32_t m = 0; m < MOTORS; m++)
+            {
+                const Symbols::StructValue& block = blocks[(cycle & 1) * MOTORS + m];
+                uint64_t fieldMask = 0;
+                structs.SetStruct(m + 1, block.data(), block.size(), &fieldMask);
+                changed |= fieldMask;
+            }
+        }
+        row("SetStruct per motor", secondsSince(start));
+
+        if (counter)
+        {
+            out << "bytes allocated by the inserts: " << flatBytes << " for " << MOTORS * FIELDS << " field tags, "
+                << structBytes << " for " << MOTORS << " structs" << "\n";
+        }
+        else
+            out << "run SymbolBenchmarks structs to count the memory of the symbols" << "\n";
+        out << "map size " << flat.size() << " against " << structs.size() << ", changed field mask " << changed << std::endl;
+    }
+
+    void ComputedBenchmark(std::ostream& out)
+    {
+        using Symbols::SymbolType;
+        constexpr uint32_t TAGS = 10000;
+        constexpr uint32_t GROUP = 10;      //tags per sum, sums per total
+        constexpr uint32_t SUMS = TAGS / GROUP;
+        constexpr uint32_t TOTALS = SUMS / GROUP;
+        constexpr uint32_t CHANGES = TAGS / 100;
+        constexpr size_t CYCLES = 1000;
+
+        //tags 1..TAGS, sums TAGS+1..TAGS+SUMS, totals after them
+        const auto build = [&](Symbols::SymbolTable& table) {
+            for (uint32_t i = 1; i <= TAGS + SUMS + TOTALS; i++)
+                table.InsertValue(i, "plant.value" + std::to_string(i), "", SymbolType::st_Double, std::any(0.0));
+        };
+        const auto sum = [](const std::vector<const Symbols::Symbol*>& inputs) {
+            double total = 0.0;
+            for (const Symbols::Symbol* input : inputs)
+            {
+                if (const double* value = input ? input->get<double>() : nullptr)
+                    total += *value;
+            }
+            return std::any(total);
+        };
+        const auto inputsOf = [](uint32_t first) {
+            std::vector<uint32_t> inputs(GROUP);
+            for (uint32_t i = 0; i < GROUP; i++)
+                inputs[i] = first + i;
+            return inputs;
+        };
+
+        //the tags changing per cycle, drawn before the runs. a block read changes runs of neighbouring tags
+        std::mt19937 rng(42);
+        std::vector<uint32_t> changed(CYCLES * CHANGES);
+        for (size_t i = 0; i < changed.size(); i += GROUP)
+        {
+            const uint32_t first = rng() % (TAGS - GROUP + 1) + 1;
+            for (uint32_t j = 0; j < GROUP; j++)
+                changed[i + j] = first + j;
+        }
+
+        out << "Computed: " << SUMS << " sums of " << GROUP << " tags and " << TOTALS << " totals of " << GROUP
+            << " sums, " << CHANGES << " of " << TAGS << " tags change per cycle in runs of " << GROUP << ", "
+            << CYCLES << " cycles" << "\n";
+        out << std::left << std::setw(36) << "operation" << std::right << std::setw(14) << "us/cycle"
+            << std::setw(16) << "total" << "\n";
+        const auto row = [&out](const std::string& operation, double seconds, const Symbols::SymbolTable& table) {
+            const Symbols::Symbol result = table.GetValue(TAGS + SUMS + 1);
+            out << std::left << std::setw(36) << operation << std::right << std::setw(14)
+                << std::fixed << std::setprecision(2) << seconds * 1e6 / CYCLES
+                << std::setw(16) << *result.get<double>() << "\n";
+            out << std::defaultfloat << std::setprecision(6);
+        };
+
+        // 1: the sums computed outside, every cycle polls all inputs
+        {
+            Symbols::SymbolTable table;
+            build(table);
+            auto start = clock_type::now();
+            for (size_t cycle = 0; cycle < CYCLES; cycle++)
+            {
+                for (uint32_t c = 0; c < CHANGES; c++)
+                    table.SetValue(changed[cycle * CHANGES + c], std::any(static_cast<double>(cycle)));
+                for (uint32_t s = 0; s < SUMS + TOTALS; s++)
+                {
+                    const uint32_t first = s < SUMS ? s * GROUP + 1 : TAGS + (s - SUMS) * GROUP + 1;
+                    double total = 0.0;
+                    for (uint32_t i = 0; i < GROUP; i++)
+                        total += *table.GetValue(first + i).get<double>();
+                    table.SetValue(TAGS + s + 1, std::any(total));
+                }
+            }
+            row("poll and recompute every sum", secondsSince(start), table);
+        }
+
+        // 2: computed symbols, recomputed after every write or once per batch
+        for (const bool batched : { false, true })
+        {
+            Symbols::SymbolTable table;
+            build(table);
+            for (uint32_t s = 0; s < SUMS + TOTALS; s++)
+            {
+                const uint32_t first = s < SUMS ? s * GROUP + 1 : TAGS + (s - SUMS) * GROUP + 1;
+                table.AddComputed(TAGS + s + 1, inputsOf(first), sum);
+            }
+            auto start = clock_type::now();
+            for (size_t cycle = 0; cycle < CYCLES; cycle++)
+            {
+                std::optional<Symbols::SymbolBatch> batch;
+                if (batched)
+                    batch.emplace(table);
+                for (uint32_t c = 0; c < CHANGES; c++)
+                    table.SetValue(changed[cycle * CHANGES + c], std::any(static_cast<double>(cycle)));
+            }
+            row(batched ? "computed, SymbolBatch per cycle" : "computed, recomputed per write", secondsSince(start), table);
+        }
+        out << std::endl;
+    }
+
+    void ExpressionBenchmark(std::ostream& out, allocation_counter_t counter)
+    {
+        using Symbols::SymbolType;
+        constexpr size_t CALLS = 5000000;
+
+        Symbols::SymbolTable table;
+        table.InsertValue(1, "tank.level", "", SymbolType::st_Double, std::any(87.5));
+        table.InsertValue(2, "tank.high", "", SymbolType::st_Double, std::any(90.0));
+        table.InsertValue(3, "pump.running", "", SymbolType::st_Boolean, std::any(false));
+        table.InsertValue(4, "motor.current", "", SymbolType::st_Double, std::any(11.2));
+        table.InsertValue(5, "motor.limit", "", SymbolType::st_Double, std::any(10.0));
+        table.InsertValue(6, "line.count", "", SymbolType::st_Int32, std::any(1234));
+        table.InsertValue(7, "line.pressure", "", SymbolType::st_Float, std::any(61.5f));
+        const Symbols::SymbolHandle level = table.Resolve(1), high = table.Resolve(2), running = table.Resolve(3),
+            current = table.Resolve(4), limit = table.Resolve(5), count = table.Resolve(6), pressure = table.Resolve(7);
+
+        //the hand written versions read through handles as well, they check the types like the bytecode does
+        struct Case {
+            const char* m_text;
+            std::function<double()> m_native;
+        };
+        const std::vector<Case> cases = {
+            { "tank.level > 90.0", [&] {
+                const double* l = level.get<double>();
+                return l && *l > 90.0 ? 1.0 : 0.0;
+            } },
+            { "tank.level > tank.high && !pump.running", [&] {
+                const double* l = level.get<double>();
+                const double* h = high.get<double>();
+                const bool* r = running.get<bool>();
+                return l && h && r && *l > *h && !*r ? 1.0 : 0.0;
+            } },
+            { "abs(motor.current - motor.limit) > 2.5 || line.count % 100 == 0", [&] {
+                const double* c = current.get<double>();
+                const double* m = limit.get<double>();
+                const int* n = count.get<int>();
+                return c && m && n && (std::fabs(*c - *m) > 2.5 || *n % 100 == 0) ? 1.0 : 0.0;
+            } },
+            { "line.pressure * 1.5 + 2 > 100 ? tank.level : tank.high", [&] {
+                const float* p = pressure.get<float>();
+                const double* l = level.get<double>();
+                const double* h = high.get<double>();
+                return p && l && h ? (*p * 1.5 + 2 > 100 ? *l : *h) : 0.0;
+            } },
+        };
+
+        out << "SymbolExpression: " << CALLS << " evaluations per expression" << "\n";
+        out << std::left << std::setw(64) << "expression" << std::right << std::setw(12) << "C++ ns"
+            << std::setw(12) << "compiled ns" << std::setw(14) << "allocs/call" << "\n";
+
+        double sum = 0.0;   //printed, so the evaluations are not optimised away
+        for (const auto& test : cases)
+        {
+            std::string error;
+            const auto expression = Symbols::SymbolExpression::compile(table, test.m_text, &error);
+            if (!expression)
+            {
+                out << test.m_text << ": " << error << "\n";
+                continue;
+            }
+
+            auto start = clock_type::now();
+            for (size_t i = 0; i < CALLS; i++)
+                sum += test.m_native();
+            const double native = secondsSince(start);
+
+            Symbols::SymbolExpression::Value result;
+            const uint64_t before = counter ? counter().m_allocations : 0;
+            start = clock_type::now();
+            for (size_t i = 0; i < CALLS; i++)
+            {
+                if (expression->evaluate(result))
+                    sum += result.toDouble();
+            }
+            const double compiled = secondsSince(start);
+            const uint64_t allocations = counter ? counter().m_allocations - before : 0;
+
+            out << std::left << std::setw(64) << test.m_text << std::right << std::fixed << std::setprecision(1)
+                << std::setw(12) << native * 1e9 / CALLS << std::setw(12) << compiled * 1e9 / CALLS;
+            if (counter)
+                out << std::setw(14) << std::setprecision(3) << static_cast<double>(allocations) / CALLS;
+            else
+                out << std::setw(14) << "-";
+            out << "\n" << std::defaultfloat << std::setprecision(6);
+        }
+        out << "checksum " << sum << std::endl;
+    }
+
+    void AlarmBenchmark(std::ostream& out)
+    {
+        using Symbols::AlarmLevel;
+        constexpr uint32_t POINTS = 100000;
+        constexpr size_t CYCLES = 50;
+
+        Symbols::AlarmLimits limits;
+        limits.m_hihi = 90.0;
+        limits.m_hi = 80.0;
+        limits.m_lo = 20.0;
+        limits.m_lolo = 10.0;
+        limits.m_deadband = 1.0;
+
+        //every point is a slow sine over 5..95 with a phase of its own, so each cycle some cross a limit
+        std::vector<std::vector<double>> cycles(CYCLES, std::vector<double>(POINTS));
+        for (size_t cycle = 0; cycle < CYCLES; cycle++)
+        {
+            for (uint32_t i = 0; i < POINTS; i++)
+                cycles[cycle][i] = 50.0 + 45.0 * std::sin(cycle * 0.05 + i * 0.37);
+        }
+        const auto build = [&](Symbols::SymbolTable& table) {
+            for (uint32_t id = 1; id <= POINTS; id++)
+                table.InsertValue(id, "plant.point" + std::to_string(id), "", Symbols::SymbolType::st_Double, std::any(cycles[0][id - 1]));
+        };
+
+        out << "Alarms: " << POINTS << " points with HI/HIHI/LO/LOLO limits and deadband, all written per cycle "
+            << "by SetValues(), " << CYCLES << " cycles" << "\n";
+        out << std::left << std::setw(36) << "operation" << std::right << std::setw(14) << "ns/write"
+            << std::setw(16) << "transitions" << "\n";
+        const auto row = [&out](const std::string& operation, double seconds, size_t transitions) {
+            out << std::left << std::setw(36) << operation << std::right << std::setw(14)
+                << std::fixed << std::setprecision(2) << seconds * 1e9 / (static_cast<double>(POINTS) * CYCLES)
+                << std::setw(16) << transitions << "\n";
+            out << std::defaultfloat << std::setprecision(6);
+        };
+        const auto run = [&](Symbols::SymbolTable& table) {
+            const auto start = clock_type::now();
+            for (size_t cycle = 1; cycle < CYCLES; cycle++)
+                table.SetValues(1, cycles[cycle].data(), POINTS);
+            table.SetValues(1, cycles[0].data(), POINTS);
+            return secondsSince(start);
+        };
+
+        // 1: the write path without alarms
+        {
+            Symbols::SymbolTable table;
+            build(table);
+            row("no alarms", run(table), 0);
+        }
+
+        // 2: an event per point which classifies the new value, the state kept outside
+        {
+            Symbols::SymbolTable table;
+            build(table);
+            const auto classify = [&limits](double value, AlarmLevel level) {
+                const double hihi = level == AlarmLevel::al_HiHi ? limits.m_hihi - limits.m_deadband : limits.m_hihi;
+                const double hi = level == AlarmLevel::al_Hi || level == AlarmLevel::al_HiHi ? limits.m_hi - limits.m_deadband : limits.m_hi;
+                const double lolo = level == AlarmLevel::al_LoLo ? limits.m_lolo + limits.m_deadband : limits.m_lolo;
+                const double lo = level == AlarmLevel::al_Lo || level == AlarmLevel::al_LoLo ? limits.m_lo + limits.m_deadband : limits.m_lo;
+                return value >= hihi ? AlarmLevel::al_HiHi : value >= hi ? AlarmLevel::al_Hi :
+                    value <= lolo ? AlarmLevel::al_LoLo : value <= lo ? AlarmLevel::al_Lo : AlarmLevel::al_Normal;
+            };
+            std::vector<AlarmLevel> levels(POINTS);
+            size_t transitions = 0;
+            for (uint32_t id = 1; id <= POINTS; id++)
+            {
+                levels[id - 1] = classify(cycles[0][id - 1], AlarmLevel::al_Normal);
+                transitions += levels[id - 1] != AlarmLevel::al_Normal ? 1 : 0;
+                table.AddEvent(id, Symbols::SymbolEvent(1, Symbols::SymbolEvent::EventType::et_OpcServer,
+                    Symbols::SymbolEvent::EventFireType::eft_AnyChange,
+                    [&, id](Symbols::SymbolEvent::BaseArgs* args) {
+                        AlarmLevel& level = levels[id - 1];
+                        const AlarmLevel next = classify(std::any_cast<double>(*args->m_newVal), level);
+                        if (next != level)
+                        {
+                            level = next;
+                            transitions++;
+                        }
+                    }));
+            }
+            const double seconds = run(table);
+            row("SymbolEvent per point", seconds, transitions);
+        }
+
+        // 3: alarm points of the table, one alarm event for all of them
+        {
+            Symbols::SymbolTable table;
+            build(table);
+            size_t transitions = 0;
+            table.AddAlarmEvent([&transitions](const Symbols::AlarmTransition&) { transitions++; });
+            for (uint32_t id = 1; id <= POINTS; id++)
+                table.EnableAlarm(id, limits);
+            const double seconds = run(table);
+            row("EnableAlarm", seconds, transitions);
+        }
+        out << std::endl;
+    }
+
+    namespace {
+#if SYMBOLS_COROUTINES
+        //a coroutine which runs on whoever resumes it, its frame goes when it returns
+        struct DetachedWatch {
+            struct promise_type {
+                DetachedWatch get_return_object() noexcept { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { std::terminate(); }
+            };
+        };
+
+        //counts the changes of a symbol until it is deleted
+        DetachedWatch watchSymbol(Symbols::SymbolTable& table, uint32_t id, size_t& wakes)
+        {
+            for (;;)
+            {
+                const std::any value = co_await table.NextChange(id);
+                if (!value.has_value())
+                    break;
+                wakes++;
+            }
+        }
+#endif
+    }
+
+    void WatchBenchmark(std::ostream& out, allocation_counter_t counter)
+    {
+#if SYMBOLS_COROUTINES
+        using Symbols::SymbolType;
+        constexpr uint32_t WATCHERS = 10000;
+        constexpr uint32_t THREADS = 100;
+        constexpr size_t CYCLES = 100;
+
+        std::vector<double> values(WATCHERS);
+        const auto build = [](Symbols::SymbolTable& table, uint32_t count) {
+            for (uint32_t id = 1; id <= count; id++)
+                table.InsertValue(id, "plant.watch" + std::to_string(id), "", SymbolType::st_Double, std::any(0.0));
+        };
+        const auto write = [&values](Symbols::SymbolTable& table, uint32_t count) {
+            for (size_t cycle = 1; cycle <= CYCLES; cycle++)
+            {
+                std::fill(values.begin(), values.begin() + count, static_cast<double>(cycle));
+                table.SetValues(1, values.data(), count);
+            }
+        };
+
+        out << "Watches: every watcher waits for the changes of its own symbol, all written per cycle by SetValues(), "
+            << CYCLES << " cycles" << "\n";
+        out << std::left << std::setw(28) << "watcher" << std::right << std::setw(10) << "watchers"
+            << std::setw(14) << "ns/change" << std::setw(16) << "heap/watcher" << std::setw(12) << "wakes" << "\n";
+        const auto row = [&out, counter](const std::string& watcher, uint32_t watchers, double seconds,
+            uint64_t bytes, size_t wakes) {
+            out << std::left << std::setw(28) << watcher << std::right << std::setw(10) << watchers
+                << std::setw(14) << std::fixed << std::setprecision(1) << seconds * 1e9 / (static_cast<double>(watchers) * CYCLES);
+            if (counter)
+                out << std::setw(16) << bytes / watchers;
+            else
+                out << std::setw(16) << "-";
+            out << std::setw(12) << wakes << "\n" << std::defaultfloat << std::setprecision(6);
+        };
+
+        // 1: a coroutine per watcher, resumed on the writing thread
+        {
+            Symbols::SymbolTable table;
+            build(table, WATCHERS);
+            size_t wakes = 0;
+            const uint64_t before = counter ? counter().m_bytes : 0;
+            for (uint32_t id = 1; id <= WATCHERS; id++)
+                watchSymbol(table, id, wakes);
+            const uint64_t bytes = counter ? counter().m_bytes - before : 0;
+            const auto start = clock_type::now();
+            write(table, WATCHERS);
+            row("coroutine NextChange()", WATCHERS, secondsSince(start), bytes, wakes);
+
+            //a deleted symbol ends its coroutine
+            for (uint32_t id = 1; id <= WATCHERS; id++)
+                table.DeleteValue(id);
+        }
+
+        // 2: a thread per watcher blocked on a condition variable which a SymbolEvent signals, stacks not counted
+        {
+            struct Watcher {
+                std::mutex m_mutex;
+                std::condition_variable m_changed;
+                size_t m_changes{};
+            };
+            Symbols::SymbolTable table;
+            build(table, THREADS);
+            std::unique_ptr<Watcher[]> watchers(new Watcher[THREADS]);
+            std::atomic<size_t> wakes{ 0 };
+            std::vector<std::thread> threads;
+            const uint64_t before = counter ? counter().m_bytes : 0;
+            for (uint32_t i = 0; i < THREADS; i++)
+            {
+                Watcher& watcher = watchers[i];
+                table.AddEvent(i + 1, Symbols::SymbolEvent(1, Symbols::SymbolEvent::EventType::et_OpcServer,
+                    Symbols::SymbolEvent::EventFireType::eft_AnyChange, [&watcher](Symbols::SymbolEvent::BaseArgs*) {
+                        {
+                            std::lock_guard<std::mutex> lock(watcher.m_mutex);
+                            watcher.m_changes++;
+                        }
+                        watcher.m_changed.notify_one();
+                    }));
+                threads.emplace_back([&watcher, &wakes] {
+                    size_t seen = 0;
+                    std::unique_lock<std::mutex> lock(watcher.m_mutex);
+                    while (seen < CYCLES)
+                    {
+                        watcher.m_changed.wait(lock, [&] { return watcher.m_changes != seen; });
+                        seen = watcher.m_changes;
+                        wakes++;
+                    }
+                });
+            }
+            const uint64_t bytes = counter ? counter().m_bytes - before : 0;
+
+            //until every thread saw the last change
+            const auto start = clock_type::now();
+            write(table, THREADS);
+            for (auto& thread : threads)
+                thread.join();
+            row("thread + SymbolEvent", THREADS, secondsSince(start), bytes, wakes);
+        }
+        out << std::endl;
+#else
+        (void)counter;
+        out << "Watches: needs C++20 coroutines, configure with -DSYMBOLS_CXX20=ON" << std::endl;
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+// Benchmarks.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Compressed archive benchmark.
+//  *Added Symbol::compare micro benchmark per SymbolType.
+//  *Added DetectChanges batch benchmark.
+//  *Added multi process shared memory benchmark.
+//  *Added subscription server fan-out benchmark.
+//  *Added primary/replica replication lag benchmark.
+//  *Added core operation suite with percentile latencies and machine readable output (CoreBenchmark).
+//  *Added id lookup scaling of ThreadSafeMap and ConcurrentHashMap (LookupBenchmark).
+//  *Added heap allocations per call of the write path (AllocationBenchmark).
+//  *Added TypedSymbol against lookups by id (TypedBenchmark).
+//  *TypedBenchmark measures SymbolHandle reads and writes as well.
+//  *Added a waveform as scalar tags against one array symbol (ArrayBenchmark).
+//  *Added a UDT flattened into tags against st_Struct symbols (StructBenchmark).
+//  *Added polled sums against computed symbols (ComputedBenchmark).
+//  *Added compiled alarm expressions against hand written C++ (ExpressionBenchmark).
+//  *Added alarm points against an event per point (AlarmBenchmark).
+//  *Added coroutine watches against a thread per watcher (WatchBenchmark).
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Benchmarks {
+
+    enum class OutputFormat {
+        of_Json = 0,    //one JSON object per line
+        of_Csv          //a header line, then one row per result
+    };
+
+    /*
+    *   settings of CoreBenchmark, the defaults run the full matrix.
+    */
+    struct CoreOptions {
+        std::vector<size_t> m_symbols{ 1000, 100000, 1000000 };     //table sizes
+        std::vector<unsigned> m_threads{ 1, 2, 4, 8, 16, 32, 64 };  //threads sharing the table
+        size_t m_operations{ 200000 };  //lookups and updates per run, inserts and deletes touch every symbol
+        double m_seconds{ 2.0 };        //time budget per run, slow operations stop early
+        size_t m_serializeLimit{ 100000 };  //largest table SerializeXML runs on, a call on a million symbols takes seconds
+        OutputFormat m_format{ OutputFormat::of_Json };
+    };
+
+    /*
+    *   heap allocations of a thread, counted by an executable which replaces operator new.
+    */
+    struct AllocationCount {
+        uint64_t m_allocations{};
+        uint64_t m_bytes{};
+    };
+
+    //returns the allocations of the calling thread so far
+    using allocation_counter_t = AllocationCount(*)() noexcept;
+
+    /*
+    *   Run a benchmark by name.
+    *   Params:
+    *   name: benchmark name, see the list printed for an unknown name.
+    *   out: stream the results are written to.
+    *   Returns: returns true if the benchmark exists, otherwise false.
+    */
+    bool Run(const std::string& name, std::ostream& out);
+
+    /*
+    *   Encode synthetic PLC like signals into a SymbolArchive and report
+    *   bytes per sample, encode and decode throughput.
+    */
+    void ArchiveBenchmark(std::ostream& out);
+
+    /*
+    *   Measure Symbol::compare for every SymbolType which holds a value.
+    */
+    void CompareBenchmark(std::ostream& out);
+
+    /*
+    *   Compare DetectChanges over a value column against one Symbol::compare per value.
+    *   Run with SYMBOLS_SIMD=scalar|sse2 to measure the narrower kernels.
+    */
+    void BatchBenchmark(std::ostream& out);
+
+    /*
+    *   Update a shared symbol table while reader processes read it through SharedSymbolReader,
+    *   report reads per second and failed or torn reads per reader.
+    */
+    void SharedMemoryBenchmark(std::ostream& out);
+
+    /*
+    *   Change symbols from writer threads while SubscriptionClients receive them through a
+    *   SubscriptionServer, report changes and deliveries per second of the server thread.
+    */
+    void FanoutBenchmark(std::ostream& out);
+
+    /*
+    *   Change symbols while a replica in another process follows the table through
+    *   ReplicationPrimary and ReplicationReplica, report the replication lag per change.
+    */
+    void ReplicationBenchmark(std::ostream& out);
+
+    /*
+    *   Measure the core SymbolTable operations for every table size and thread count:
+    *   InsertValue, GetValue by id and by name, SetValue, event dispatch (SetValue on symbols
+    *   with a callback), DeleteValue and SerializeXML (single threaded, up to m_serializeLimit symbols). Every result reports
+    *   throughput and the p50/p90/p99/p99.9/max latency of a single call, in the given format
+    *   so that results of releases can be compared by tools.
+    */
+    void CoreBenchmark(std::ostream& out, const CoreOptions& options);
+
+    /*
+    *   Compare id lookups of a ThreadSafeMap with a ConcurrentHashMap for every table size and thread
+    *   count, alone and with a writer inserting and erasing keys meanwhile. Every run lasts m_seconds and
+    *   reports the lookups per second of all threads, so the rows of a map form its scaling curve.
+    */
+    void LookupBenchmark(std::ostream& out, const CoreOptions& options);
+
+    /*
+    *   Count the heap allocations and bytes of one call on the write path: InsertValue,
+    *   InsertFromStringValue, SetValue by id and by name, SetValue firing an event, AddEvent and
+    *   DeleteValue. Names, descriptions and string values are longer than the small string buffer,
+    *   so every copy of them shows up. The arguments are built before the count starts.
+    *   counter: provided by an executable which replaces operator new (SymbolBenchmarks),
+    *   nothing is measured without one.
+    */
+    void AllocationBenchmark(std::ostream& out, const CoreOptions& options, allocation_counter_t counter);
+
+    /*
+    *   Compare reading and writing st_Double symbols by id with SymbolHandle and TypedSymbol handles
+    *   resolved once.
+    */
+    void TypedBenchmark(std::ostream& out);
+
+    /*
+    *   Compare a REAL[1000] waveform stored as one st_Float tag per element with one st_FloatArray symbol:
+    *   update time per cycle through SetValue, SetValues and SetSlice, and with a counter the bytes
+    *   allocated to insert the symbols.
+    */
+    void ArrayBenchmark(std::ostream& out, allocation_counter_t counter);
+
+    /*
+    *   Compare motors of a 20 field UDT flattened into a tag per field with one st_Struct symbol per motor:
+    *   update time per cycle through SetValue per field and SetStruct per motor, and with a counter the
+    *   bytes allocated to insert the symbols.
+    */
+    void StructBenchmark(std::ostream& out, allocation_counter_t counter);
+
+    /*
+    *   Compare two levels of sums over 10000 tags polled and recomputed every cycle with computed symbols,
+    *   recomputed per write and per SymbolBatch, when 1% of the tags change per cycle in runs of neighbours.
+    */
+    void ComputedBenchmark(std::ostream& out);
+
+    /*
+    *   Compare typical alarm expressions compiled by SymbolExpression with the same expressions written in
+    *   C++ over SymbolHandle reads, and with a counter the heap allocations per evaluation.
+    */
+    void ExpressionBenchmark(std::ostream& out, allocation_counter_t counter);
+
+    /*
+    *   Compare the write time of 100000 points without alarms, with an event per point classifying the value
+    *   and with alarm points of the table, when every point is written each cycle.
+    */
+    void AlarmBenchmark(std::ostream& out);
+
+    /*
+    *   Compare 10000 coroutines waiting in SymbolTable::NextChange() with 100 threads blocked on a condition
+    *   variable signalled by a SymbolEvent, time per change and with a counter the heap bytes per watcher.
+    *   Needs a C++20 build (SYMBOLS_CXX20), see SymbolAwait.h.
+    */
+    void WatchBenchmark(std::ostream& out, allocation_counter_t counter);
+}
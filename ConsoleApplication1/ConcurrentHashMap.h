@@ -0,0 +1,365 @@
+// ConcurrentHashMap.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Open addressing hash map whose lookups take no lock.
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace aricanli::container {
+
+    /*
+    *   ConcurrentHashMap is an open addressing (linear probing) hash map for integral keys and trivially
+    *   copyable values, e.g. symbol ids to slots or indexes. A lookup takes no lock and writes no shared
+    *   memory, it only reads version counters, so readers scale with the cores and never delay a writer.
+    *   Writers are serialised by a mutex.
+    *   Every slot is a seqlock: a writer makes its version odd while it changes the slot, a reader copies
+    *   the slot and retries if the version changed meanwhile. Erasing shifts the following entries back
+    *   and growing replaces the table, both bump m_structure and a reader which saw it change starts over.
+    *   Replaced tables are kept until the map is destroyed, a reader may still walk them. The map only
+    *   grows by doubling, so they never take more memory than the current table.
+    */
+    template<typename Key, typename T>
+    class ConcurrentHashMap
+    {
+        static_assert(std::is_integral_v<Key>, "ConcurrentHashMap keys are integral, e.g. symbol ids");
+        static_assert(std::is_trivially_copyable_v<T>, "ConcurrentHashMap values are copied word by word");
+
+        static inline constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        struct Slot {
+            std::atomic<uint64_t> m_version{ 0 };   //odd while a writer changes the slot
+            std::atomic<bool> m_used{ false };
+            std::atomic<Key> m_key{};
+            std::atomic<uint64_t> m_words[WORDS]{};
+        };
+
+        struct Table {
+            explicit Table(size_t capacity) :
+                m_mask{ capacity - 1 },
+                m_slots{ std::make_unique<Slot[]>(capacity) } {}
+
+            size_t m_mask;      //capacity - 1, the capacity is a power of two
+            std::unique_ptr<Slot[]> m_slots;
+        };
+
+    public:
+        explicit ConcurrentHashMap(size_t capacity = 64)
+        {
+            size_t slots = 16;
+            while (slots < capacity * 2)
+                slots *= 2;
+            m_tables.push_back(std::make_unique<Table>(slots));
+            m_table.store(m_tables.back().get(), std::memory_order_release);
+        }
+
+        ConcurrentHashMap(const ConcurrentHashMap& r) = delete;
+        ConcurrentHashMap& operator=(const ConcurrentHashMap& r) = delete;
+
+        /*
+        *   look a key up without locking.
+        *   Params:
+        *   key: the key.
+        *   value: receives the value if the key exists.
+        *   Returns: returns true if the key exists, otherwise false.
+        */
+        bool find(Key key, T& value) const noexcept
+        {
+            uint64_t words[WORDS]{};
+            for (;;)
+            {
+                const uint64_t structure = m_structure.load(std::memory_order_acquire);
+                if (structure & 1)
+                {
+                    std::this_thread::yield();  //entries are moving
+                    continue;
+                }
+
+                const Table* table = m_table.load(std::memory_order_acquire);
+                bool found = false;
+                size_t index = hashOf(key) & table->m_mask;
+                for (size_t probes = 0; probes <= table->m_mask; probes++, index = (index + 1) & table->m_mask)
+                {
+                    bool used;
+                    if (readSlot(table->m_slots[index], key, used, words))
+                    {
+                        found = true;
+                        break;
+                    }
+                    if (!used)
+                        break;
+                }
+
+                //a found entry may be stale and a missing one may have moved if the structure changed
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_structure.load(std::memory_order_relaxed) != structure)
+                    continue;
+
+                if (found)
+                    std::memcpy(&value, words, sizeof(T));
+                return found;
+            }
+        }
+
+        bool contains(Key key) const noexcept
+        {
+            T value;
+            return find(key, value);
+        }
+
+        /*
+        *   insert a key if it does not exist yet.
+        *   returns true if inserted, false if the key exists.
+        */
+        bool insert(Key key, const T& value)
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            Slot* slot = locate(key);
+            if (slot->m_used.load(std::memory_order_relaxed))
+                return false;
+
+            slot = reserve(key);
+            writeSlot(*slot, true, key, value);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /*
+        *   insert a key or replace its value.
+        *   returns true if inserted, false if the value was replaced.
+        */
+        bool insert_or_assign(Key key, const T& value)
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            Slot* slot = locate(key);
+            if (slot->m_used.load(std::memory_order_relaxed))
+            {
+                writeSlot(*slot, true, key, value);
+                return false;
+            }
+
+            slot = reserve(key);
+            writeSlot(*slot, true, key, value);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /*
+        *   erase a key, the entries probed after it are shifted back so no tombstones are left.
+        *   returns true if the key existed.
+        */
+        bool erase(Key key)
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            Table* table = m_table.load(std::memory_order_relaxed);
+            Slot* slot = locate(key);
+            if (!slot->m_used.load(std::memory_order_relaxed))
+                return false;
+
+            beginStructure();
+            size_t hole = static_cast<size_t>(slot - table->m_slots.get());
+            for (size_t next = (hole + 1) & table->m_mask; ; next = (next + 1) & table->m_mask)
+            {
+                Slot& candidate = table->m_slots[next];
+                if (!candidate.m_used.load(std::memory_order_relaxed))
+                    break;
+
+                //an entry whose home lies cyclically in (hole, next] is still reachable, leave it
+                const Key candidateKey = candidate.m_key.load(std::memory_order_relaxed);
+                const size_t home = hashOf(candidateKey) & table->m_mask;
+                const bool reachable = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+                if (reachable)
+                    continue;
+
+                copySlot(table->m_slots[hole], candidate);
+                hole = next;
+            }
+            clearSlot(table->m_slots[hole]);
+            endStructure();
+
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /*
+        *   erase every key, the capacity is kept.
+        *   returns nothing.
+        */
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            Table* table = m_table.load(std::memory_order_relaxed);
+            beginStructure();
+            for (size_t i = 0; i <= table->m_mask; i++)
+            {
+                if (table->m_slots[i].m_used.load(std::memory_order_relaxed))
+                    clearSlot(table->m_slots[i]);
+            }
+            endStructure();
+            m_size.store(0, std::memory_order_relaxed);
+        }
+
+        size_t size() const noexcept
+        {
+            return m_size.load(std::memory_order_relaxed);
+        }
+
+        size_t capacity() const noexcept
+        {
+            return m_table.load(std::memory_order_acquire)->m_mask + 1;
+        }
+
+    private:
+        static size_t hashOf(Key key) noexcept
+        {
+            //ids are mostly consecutive, mix them so neighbours do not probe the same run
+            uint64_t x = static_cast<uint64_t>(key);
+            x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdULL;
+            x ^= x >> 33;
+            return static_cast<size_t>(x);
+        }
+
+        /*
+        *   copy a slot if it holds key, retrying while a writer changes it.
+        *   returns true if the slot holds key, used tells whether the slot holds any key.
+        */
+        static bool readSlot(const Slot& slot, Key key, bool& used, uint64_t* words) noexcept
+        {
+            for (;;)
+            {
+                const uint64_t version = slot.m_version.load(std::memory_order_acquire);
+                if (version & 1)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                used = slot.m_used.load(std::memory_order_relaxed);
+                const bool match = used && slot.m_key.load(std::memory_order_relaxed) == key;
+                if (match)
+                {
+                    for (size_t i = 0; i < WORDS; i++)
+                        words[i] = slot.m_words[i].load(std::memory_order_relaxed);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.m_version.load(std::memory_order_relaxed) == version)
+                    return match;
+            }
+        }
+
+        static void beginWrite(Slot& slot) noexcept
+        {
+            slot.m_version.store(slot.m_version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        static void endWrite(Slot& slot) noexcept
+        {
+            slot.m_version.store(slot.m_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        static void writeSlot(Slot& slot, bool used, Key key, const T& value) noexcept
+        {
+            uint64_t words[WORDS]{};
+            std::memcpy(words, &value, sizeof(T));
+
+            beginWrite(slot);
+            slot.m_key.store(key, std::memory_order_relaxed);
+            for (size_t i = 0; i < WORDS; i++)
+                slot.m_words[i].store(words[i], std::memory_order_relaxed);
+            slot.m_used.store(used, std::memory_order_relaxed);
+            endWrite(slot);
+        }
+
+        static void copySlot(Slot& target, const Slot& source) noexcept
+        {
+            beginWrite(target);
+            target.m_key.store(source.m_key.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            for (size_t i = 0; i < WORDS; i++)
+                target.m_words[i].store(source.m_words[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            target.m_used.store(true, std::memory_order_relaxed);
+            endWrite(target);
+        }
+
+        static void clearSlot(Slot& slot) noexcept
+        {
+            beginWrite(slot);
+            slot.m_used.store(false, std::memory_order_relaxed);
+            endWrite(slot);
+        }
+
+        void beginStructure() noexcept
+        {
+            m_structure.store(m_structure.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        void endStructure() noexcept
+        {
+            m_structure.store(m_structure.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        //the slot holding key or the empty slot ending its probe run, m_writeMutex is held
+        Slot* locate(Key key) const noexcept
+        {
+            Table* table = m_table.load(std::memory_order_relaxed);
+            size_t index = hashOf(key) & table->m_mask;
+            for (;;)
+            {
+                Slot& slot = table->m_slots[index];
+                if (!slot.m_used.load(std::memory_order_relaxed) || slot.m_key.load(std::memory_order_relaxed) == key)
+                    return &slot;
+                index = (index + 1) & table->m_mask;
+            }
+        }
+
+        //the empty slot a new key goes to, grows the table beyond half full. m_writeMutex is held
+        Slot* reserve(Key key)
+        {
+            Table* table = m_table.load(std::memory_order_relaxed);
+            if ((m_size.load(std::memory_order_relaxed) + 1) * 2 > table->m_mask + 1)
+            {
+                auto grown = std::make_unique<Table>((table->m_mask + 1) * 2);
+                for (size_t i = 0; i <= table->m_mask; i++)
+                {
+                    const Slot& source = table->m_slots[i];
+                    if (!source.m_used.load(std::memory_order_relaxed))
+                        continue;
+
+                    size_t index = hashOf(source.m_key.load(std::memory_order_relaxed)) & grown->m_mask;
+                    while (grown->m_slots[index].m_used.load(std::memory_order_relaxed))
+                        index = (index + 1) & grown->m_mask;
+                    copySlot(grown->m_slots[index], source);
+                }
+
+                beginStructure();
+                m_table.store(grown.get(), std::memory_order_release);
+                endStructure();
+                m_tables.push_back(std::move(grown));   //the old table stays, readers may still walk it
+            }
+            return locate(key);
+        }
+
+        std::atomic<Table*> m_table{ nullptr };
+        std::vector<std::unique_ptr<Table>> m_tables;   //current and replaced tables
+        std::atomic<uint64_t> m_structure{ 0 };         //odd while entries move or the table is replaced
+        std::atomic<size_t> m_size{ 0 };
+        std::mutex m_writeMutex;
+    };
+}
@@ -0,0 +1,138 @@
+// HandleTable.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Slots with generation counters for handles which outlive their objects.
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace aricanli::container {
+
+    /*
+    *   HandleTable hands out slots which point to objects stored elsewhere, e.g. symbols in the nodes of
+    *   a map. A handle keeps the slot index and the generation of the slot when it was handed out.
+    *   Releasing a slot bumps its generation, so a handle taken before tells that its object is gone
+    *   instead of pointing into freed memory, even after the slot was reused for another object.
+    *   Slots live in chunks which never move and are kept until the table is destroyed, get() takes no
+    *   lock and only reads the slot. acquire() and release() must be serialised by the caller.
+    *   A generation wraps after 2^32 releases of the same slot.
+    */
+    template<typename T>
+    class HandleTable
+    {
+        static inline constexpr uint32_t CHUNK_BITS = 12;
+        static inline constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;    //slots per chunk
+        static inline constexpr uint32_t MAX_CHUNKS = 1024;
+
+        struct Slot {
+            std::atomic<T*> m_object{ nullptr };
+            std::atomic<uint32_t> m_generation{ 0 };
+        };
+
+    public:
+        static inline constexpr uint32_t NO_SLOT = UINT32_MAX;
+        static inline constexpr uint32_t MAX_SLOTS = CHUNK_SIZE * MAX_CHUNKS;
+
+        HandleTable() = default;
+        HandleTable(const HandleTable& r) = delete;
+        HandleTable& operator=(const HandleTable& r) = delete;
+
+        /*
+        *   get the object of a slot without locking.
+        *   Params:
+        *   slot: slot index returned by acquire().
+        *   generation: generation of the slot returned by acquire().
+        *   Returns: returns the object, nullptr if the slot was released since.
+        */
+        T* get(uint32_t slot, uint32_t generation) const noexcept
+        {
+            if (slot == NO_SLOT)
+                return nullptr;
+            const Slot& entry = m_chunks[slot >> CHUNK_BITS].load(std::memory_order_acquire)[slot & (CHUNK_SIZE - 1)];
+            //release() bumps the generation before a reused slot gets its new object
+            T* object = entry.m_object.load(std::memory_order_acquire);
+            return entry.m_generation.load(std::memory_order_relaxed) == generation ? object : nullptr;
+        }
+
+        /*
+        *   get the current generation of a slot.
+        */
+        uint32_t generation(uint32_t slot) const noexcept
+        {
+            return at(slot).m_generation.load(std::memory_order_relaxed);
+        }
+
+        /*
+        *   point a free slot to an object, released slots are reused first.
+        *   Returns: returns the slot, NO_SLOT if all MAX_SLOTS slots are taken.
+        */
+        uint32_t acquire(T* object)
+        {
+            uint32_t slot;
+            if (!m_free.empty())
+            {
+                slot = m_free.back();
+                m_free.pop_back();
+            }
+            else
+            {
+                if (m_next == MAX_SLOTS)
+                    return NO_SLOT;
+                slot = m_next++;
+                if ((slot & (CHUNK_SIZE - 1)) == 0)
+                {
+                    m_owned.push_back(std::make_unique<Slot[]>(CHUNK_SIZE));
+                    m_chunks[slot >> CHUNK_BITS].store(m_owned.back().get(), std::memory_order_release);
+                }
+            }
+            at(slot).m_object.store(object, std::memory_order_release);
+            m_used.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+
+        /*
+        *   release a slot, handles to it become invalid.
+        *   returns nothing.
+        */
+        void release(uint32_t slot)
+        {
+            if (slot == NO_SLOT)
+                return;
+            Slot& entry = at(slot);
+            entry.m_generation.fetch_add(1, std::memory_order_relaxed);
+            entry.m_object.store(nullptr, std::memory_order_release);
+            m_free.push_back(slot);
+            m_used.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        //slots pointing to an object
+        size_t size() const noexcept
+        {
+            return m_used.load(std::memory_order_relaxed);
+        }
+
+    private:
+        Slot& at(uint32_t slot) const noexcept
+        {
+            return m_chunks[slot >> CHUNK_BITS].load(std::memory_order_acquire)[slot & (CHUNK_SIZE - 1)];
+        }
+
+        std::array<std::atomic<Slot*>, MAX_CHUNKS> m_chunks{};  //read by get(), owned by m_owned
+        std::vector<std::unique_ptr<Slot[]>> m_owned;
+        std::vector<uint32_t> m_free;   //released slots
+        uint32_t m_next{ 0 };           //slots ever handed out
+        std::atomic<size_t> m_used{ 0 };
+    };
+}
@@ -0,0 +1,477 @@
+// SharedSymbols.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SharedSymbols.h"
+#include "Symbols.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <thread>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Symbols {
+
+    namespace {
+        uint32_t hashName(const char* name, size_t length) noexcept
+        {
+            //FNV-1a, the reader has to compute the same hash
+            uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < length; i++)
+            {
+                hash ^= static_cast<unsigned char>(name[i]);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        size_t alignUp(size_t value, size_t alignment) noexcept
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        uint32_t indexSizeFor(uint32_t capacity) noexcept
+        {
+            //at most half full, keeps the probe sequences short
+            uint32_t size = 16;
+            while (size < capacity * 2ull)
+                size *= 2;
+            return size;
+        }
+
+        size_t indexOffset() noexcept
+        {
+            return alignUp(sizeof(SharedSymbolSegment::Header), alignof(std::atomic<uint32_t>));
+        }
+
+        size_t slotOffset(uint32_t capacity) noexcept
+        {
+            return alignUp(indexOffset() + indexSizeFor(capacity) * sizeof(std::atomic<uint32_t>),
+                alignof(SharedSymbolSegment::Slot));
+        }
+
+#if defined(_WIN32)
+        std::string mappingName(const std::string& name)
+        {
+            //POSIX style names start with a slash, Windows object names must not contain one
+            return "Local\\" + (name.size() && name[0] == '/' ? name.substr(1) : name);
+        }
+#endif
+    }
+
+    SharedMapping::~SharedMapping()
+    {
+        close();
+    }
+
+    bool SharedMapping::create(const std::string& name, size_t size)
+    {
+        close();
+#if defined(_WIN32)
+        const auto high = static_cast<DWORD>(static_cast<uint64_t>(size) >> 32);
+        const auto low = static_cast<DWORD>(size & 0xFFFFFFFF);
+        HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, high, low,
+            mappingName(name).c_str());
+        if (!handle)
+            return false;
+
+        void* data = MapViewOfFile(handle, FILE_MAP_WRITE, 0, 0, size);
+        if (!data)
+        {
+            CloseHandle(handle);
+            return false;
+        }
+        m_handle = handle;
+#else
+        //a stale segment of a crashed writer is replaced
+        shm_unlink(name.c_str());
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            return false;
+
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            ::close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            shm_unlink(name.c_str());
+            return false;
+        }
+#endif
+        m_name = name;
+        m_data = data;
+        m_size = size;
+        m_owner = true;
+        return true;
+    }
+
+    bool SharedMapping::open(const std::string& name)
+    {
+        close();
+#if defined(_WIN32)
+        HANDLE handle = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName(name).c_str());
+        if (!handle)
+            return false;
+
+        void* data = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+        MEMORY_BASIC_INFORMATION info{};
+        if (!data || !VirtualQuery(data, &info, sizeof(info)))
+        {
+            if (data)
+                UnmapViewOfFile(data);
+            CloseHandle(handle);
+            return false;
+        }
+        m_handle = handle;
+        const size_t size = info.RegionSize;
+#else
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        const auto size = static_cast<size_t>(info.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+            return false;
+#endif
+        m_name = name;
+        m_data = data;
+        m_size = size;
+        m_owner = false;
+        return true;
+    }
+
+    void SharedMapping::close() noexcept
+    {
+        if (!m_data)
+            return;
+#if defined(_WIN32)
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_handle);
+        m_handle = nullptr;
+#else
+        munmap(m_data, m_size);
+        if (m_owner)
+            shm_unlink(m_name.c_str());
+#endif
+        m_data = nullptr;
+        m_size = 0;
+        m_owner = false;
+        m_name.clear();
+    }
+
+    size_t SharedSymbolSegment::segmentSize(uint32_t capacity) noexcept
+    {
+        return slotOffset(capacity) + static_cast<size_t>(capacity) * sizeof(Slot);
+    }
+
+    bool SharedSymbolSegment::create(const std::string& name, uint32_t capacity)
+    {
+        capacity = std::max<uint32_t>(capacity, 1);
+        const size_t size = segmentSize(capacity);
+        if (!m_mapping.create(name, size))
+            return false;
+
+        //the mapping is zero filled, which is a valid empty index and free slots
+        auto* base = static_cast<uint8_t*>(m_mapping.data());
+        m_index = reinterpret_cast<std::atomic<uint32_t>*>(base + indexOffset());
+        m_slots = reinterpret_cast<Slot*>(base + slotOffset(capacity));
+        m_header = new (base) Header{};
+        m_header->m_capacity = capacity;
+        m_header->m_indexSize = indexSizeFor(capacity);
+        m_header->m_slotOffset = slotOffset(capacity);
+        m_header->m_size = size;
+        m_header->m_version = VERSION;
+        m_name = name;
+
+        //the magic goes last, a reader which maps a half initialized segment rejects it
+        m_header->m_magic.store(MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t SharedSymbolSegment::publish(uint32_t id, const std::string& name, SymbolType type)
+    {
+        if (!m_header)
+            return NO_SLOT;
+
+        const uint32_t slot = m_header->m_used.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= m_header->m_capacity)
+        {
+            m_header->m_used.store(m_header->m_capacity, std::memory_order_relaxed);
+            return NO_SLOT;
+        }
+
+        // 1: fill in the constant part while the slot is still free
+        Slot& entry = m_slots[slot];
+        const size_t length = std::min(name.size(), NAME_LENGTH - 1);
+        entry.m_id = id;
+        entry.m_type = static_cast<uint32_t>(type);
+        if (type == SymbolType::st_String || type == SymbolType::st_WideString)
+            entry.m_bits.store(NO_TEXT, std::memory_order_relaxed);
+        std::memcpy(entry.m_name, name.data(), length);
+        entry.m_name[length] = '\0';
+        entry.m_state.store(static_cast<uint32_t>(SlotState::ss_Live), std::memory_order_release);
+
+        // 2: add the name to the index, the entries hold slot + 1 so zero means empty
+        const uint32_t mask = m_header->m_indexSize - 1;
+        for (uint32_t i = hashName(entry.m_name, length) & mask;; i = (i + 1) & mask)
+        {
+            uint32_t expected = 0;
+            if (m_index[i].compare_exchange_strong(expected, slot + 1, std::memory_order_release))
+                break;
+        }
+        return slot;
+    }
+
+    SharedSymbolSegment::Slot* SharedSymbolSegment::beginWrite(uint32_t slot) noexcept
+    {
+        if (!m_header || slot >= m_header->m_capacity)
+            return nullptr;
+
+        //writers of the same slot exclude each other through the odd sequence
+        Slot* entry = &m_slots[slot];
+        uint64_t seq = entry->m_seq.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (seq & 1)
+            {
+                std::this_thread::yield();
+                seq = entry->m_seq.load(std::memory_order_relaxed);
+            }
+            else if (entry->m_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire))
+                break;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        return entry;
+    }
+
+    void SharedSymbolSegment::endWrite(Slot* slot) noexcept
+    {
+        slot->m_seq.fetch_add(1, std::memory_order_release);
+    }
+
+    void SharedSymbolSegment::write(uint32_t slot, int64_t timestamp, uint64_t bits) noexcept
+    {
+        if (Slot* entry = beginWrite(slot))
+        {
+            entry->m_timestamp.store(timestamp, std::memory_order_relaxed);
+            entry->m_bits.store(bits, std::memory_order_relaxed);
+            endWrite(entry);
+        }
+    }
+
+    void SharedSymbolSegment::writeText(uint32_t slot, int64_t timestamp, const std::string& text) noexcept
+    {
+        if (Slot* entry = beginWrite(slot))
+        {
+            const size_t length = std::min(text.size(), TEXT_LENGTH);
+            for (size_t word = 0; word < TEXT_WORDS; word++)
+            {
+                uint64_t chunk = 0;
+                const size_t offset = word * sizeof(uint64_t);
+                if (offset < length)
+                    std::memcpy(&chunk, text.data() + offset, std::min(sizeof(uint64_t), length - offset));
+                entry->m_text[word].store(chunk, std::memory_order_relaxed);
+            }
+            entry->m_timestamp.store(timestamp, std::memory_order_relaxed);
+            entry->m_bits.store(length, std::memory_order_relaxed);
+            endWrite(entry);
+        }
+    }
+
+    void SharedSymbolSegment::clearText(uint32_t slot, int64_t timestamp) noexcept
+    {
+        if (Slot* entry = beginWrite(slot))
+        {
+            entry->m_timestamp.store(timestamp, std::memory_order_relaxed);
+            entry->m_bits.store(NO_TEXT, std::memory_order_relaxed);
+            endWrite(entry);
+        }
+    }
+
+    void SharedSymbolSegment::remove(uint32_t slot) noexcept
+    {
+        if (Slot* entry = beginWrite(slot))
+        {
+            //the index entry stays, readers skip dead slots
+            entry->m_state.store(static_cast<uint32_t>(SlotState::ss_Deleted), std::memory_order_relaxed);
+            endWrite(entry);
+        }
+    }
+
+    bool SharedSymbolReader::open(const std::string& name)
+    {
+        m_header = nullptr;
+        if (!m_mapping.open(name) || m_mapping.size() < sizeof(SharedSymbolSegment::Header))
+            return false;
+
+        const auto* base = static_cast<const uint8_t*>(m_mapping.data());
+        const auto* header = reinterpret_cast<const SharedSymbolSegment::Header*>(base);
+        const uint32_t magic = header->m_magic.load(std::memory_order_acquire);
+
+        //the layout is only trusted if it matches what this build would have created
+        if (magic != SharedSymbolSegment::MAGIC || header->m_version != SharedSymbolSegment::VERSION ||
+            header->m_indexSize != indexSizeFor(header->m_capacity) ||
+            header->m_slotOffset != slotOffset(header->m_capacity) ||
+            header->m_size != SharedSymbolSegment::segmentSize(header->m_capacity) ||
+            header->m_size > m_mapping.size())
+        {
+            m_mapping.close();
+            return false;
+        }
+
+        m_header = header;
+        m_index = reinterpret_cast<const std::atomic<uint32_t>*>(base + indexOffset());
+        m_slots = reinterpret_cast<const SharedSymbolSegment::Slot*>(base + header->m_slotOffset);
+        return true;
+    }
+
+    uint32_t SharedSymbolReader::size() const noexcept
+    {
+        if (!m_header)
+            return 0;
+        return std::min(m_header->m_used.load(std::memory_order_acquire), m_header->m_capacity);
+    }
+
+    const SharedSymbolSegment::Slot* SharedSymbolReader::liveSlot(uint32_t slot) const noexcept
+    {
+        if (!m_header || slot >= m_header->m_capacity)
+            return nullptr;
+
+        const auto* entry = &m_slots[slot];
+        if (entry->m_state.load(std::memory_order_acquire) !=
+            static_cast<uint32_t>(SharedSymbolSegment::SlotState::ss_Live))
+            return nullptr;
+        return entry;
+    }
+
+    uint32_t SharedSymbolReader::find(const std::string& name) const noexcept
+    {
+        if (!m_header || name.size() >= SharedSymbolSegment::NAME_LENGTH)
+            return SharedSymbolSegment::NO_SLOT;
+
+        const uint32_t mask = m_header->m_indexSize - 1;
+        for (uint32_t i = hashName(name.data(), name.size()) & mask;; i = (i + 1) & mask)
+        {
+            const uint32_t entry = m_index[i].load(std::memory_order_acquire);
+            if (entry == 0)
+                return SharedSymbolSegment::NO_SLOT;    //end of the probe sequence
+
+            const auto* slot = liveSlot(entry - 1);
+            if (slot && std::strncmp(slot->m_name, name.c_str(), SharedSymbolSegment::NAME_LENGTH) == 0)
+                return entry - 1;
+        }
+    }
+
+    bool SharedSymbolReader::describe(uint32_t slot, uint32_t& id, SymbolType& type) const noexcept
+    {
+        const auto* entry = liveSlot(slot);
+        if (!entry)
+            return false;
+
+        id = entry->m_id;
+        type = static_cast<SymbolType>(entry->m_type);
+        return true;
+    }
+
+    bool SharedSymbolReader::readRaw(uint32_t slot, uint64_t& bits, int64_t& timestamp) const noexcept
+    {
+        const auto* entry = liveSlot(slot);
+        if (!entry)
+            return false;
+
+        for (int retry = 0; retry < READ_RETRIES; retry++)
+        {
+            const uint64_t seq = entry->m_seq.load(std::memory_order_acquire);
+            if (seq & 1)
+                continue;   //a writer is active
+
+            bits = entry->m_bits.load(std::memory_order_relaxed);
+            timestamp = entry->m_timestamp.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry->m_seq.load(std::memory_order_relaxed) == seq)
+                return true;
+        }
+        return false;
+    }
+
+    bool SharedSymbolReader::readText(uint32_t slot, std::string& text, int64_t& timestamp) const
+    {
+        const auto* entry = liveSlot(slot);
+        if (!entry)
+            return false;
+
+        uint64_t words[SharedSymbolSegment::TEXT_WORDS];
+        for (int retry = 0; retry < READ_RETRIES; retry++)
+        {
+            const uint64_t seq = entry->m_seq.load(std::memory_order_acquire);
+            if (seq & 1)
+                continue;
+
+            const uint64_t length = entry->m_bits.load(std::memory_order_relaxed);
+            timestamp = entry->m_timestamp.load(std::memory_order_relaxed);
+            for (size_t word = 0; word < SharedSymbolSegment::TEXT_WORDS; word++)
+                words[word] = entry->m_text[word].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry->m_seq.load(std::memory_order_relaxed) == seq)
+            {
+                if (length == SharedSymbolSegment::NO_TEXT)
+                    return false;
+                text.assign(reinterpret_cast<const char*>(words),
+                    static_cast<size_t>(std::min<uint64_t>(length, SharedSymbolSegment::TEXT_LENGTH)));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::any SharedSymbolReader::read(uint32_t slot) const
+    {
+        uint32_t id;
+        SymbolType type;
+        int64_t timestamp;
+        if (!describe(slot, id, type))
+            return {};
+
+        if (type == SymbolType::st_String || type == SymbolType::st_WideString)
+        {
+            std::string text;
+            if (readText(slot, text, timestamp))
+                return text;
+            return {};
+        }
+
+        uint64_t bits;
+        if (!Symbol::isScalar(type) || !readRaw(slot, bits, timestamp))
+            return {};
+        return Symbol::fromRaw(type, bits);
+    }
+}
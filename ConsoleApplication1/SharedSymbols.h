@@ -0,0 +1,264 @@
+// SharedSymbols.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Symbol values in a shared memory segment, read by other local processes
+//   without syscalls or copies through the table.
+//  Version 1.1:
+//  *A string slot without a value the segment can hold, e.g. a std::wstring, is marked with NO_TEXT and
+//   SharedSymbolReader::readText() fails instead of returning an empty string. Segment VERSION 2.
+
+#pragma once
+#include <any>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "SymbolTraits.h"
+
+namespace Symbols {
+
+    /*
+    *   SharedMapping owns one named shared memory mapping.
+    *   POSIX shm_open/mmap, on Windows a paging file backed file mapping in the Local\ namespace.
+    */
+    class SharedMapping
+    {
+    public:
+        SharedMapping() = default;
+        virtual ~SharedMapping();   //destructor, unmaps and removes the name if we created it
+
+        SharedMapping(const SharedMapping& r) = delete;
+        SharedMapping& operator=(const SharedMapping& r) = delete;
+
+        /*
+        *   create a new mapping of the given size, an existing one with the same name is replaced.
+        *   returns true if successful, otherwise false.
+        */
+        bool create(const std::string& name, size_t size);
+
+        /*
+        *   map an existing mapping read-only.
+        *   returns true if successful, otherwise false.
+        */
+        bool open(const std::string& name);
+
+        /*
+        *   unmap, the name is removed if the mapping was created by us.
+        *   returns nothing.
+        */
+        void close() noexcept;
+
+        void* data() const noexcept {
+            return m_data;
+        }
+
+        size_t size() const noexcept {
+            return m_size;
+        }
+
+    private:
+        std::string m_name;
+        void* m_data{};
+        size_t m_size{};
+        bool m_owner{};
+#if defined(_WIN32)
+        void* m_handle{};
+#endif
+    };
+
+    /*
+    *   SharedSymbolSegment is the writer side of a shared symbol table.
+    *   The segment has a fixed layout: a header, an open addressing name index and an array of slots.
+    *   Every slot is guarded by its own sequence number (seqlock), so readers in other processes copy
+    *   values without any lock and retry if a writer was active. Slots are handed out once and never
+    *   reused, a deleted symbol leaves a dead slot behind.
+    *   Scalar values are stored in their raw 64 bit representation (see Symbol::getRaw()),
+    *   string values up to TEXT_LENGTH bytes inline. A string slot holds NO_TEXT as its length until
+    *   a value is written, and when the value is not a std::string.
+    */
+    class SharedSymbolSegment
+    {
+    public:
+        static inline constexpr uint32_t MAGIC = 0x544D5953;     //"SYMT"
+        static inline constexpr uint32_t VERSION = 2;
+        static inline constexpr size_t NAME_LENGTH = 96;        //bytes including the terminating zero
+        static inline constexpr size_t TEXT_WORDS = 8;
+        static inline constexpr size_t TEXT_LENGTH = TEXT_WORDS * sizeof(uint64_t);
+        static inline constexpr uint32_t NO_SLOT = UINT32_MAX;
+        static inline constexpr uint64_t NO_TEXT = UINT64_MAX;    //length of a string slot without a value
+
+        enum class SlotState : uint32_t {
+            ss_Free = 0,
+            ss_Live,
+            ss_Deleted
+        };
+
+        struct Header {
+            std::atomic<uint32_t> m_magic;  //set last, when the rest of the header is valid
+            uint32_t m_version;
+            uint32_t m_capacity;            //number of slots
+            uint32_t m_indexSize;           //number of index entries, a power of two
+            uint64_t m_slotOffset;          //offset of the first slot from the header
+            uint64_t m_size;                //total size of the segment
+            std::atomic<uint32_t> m_used;   //slots handed out so far
+        };
+
+        struct alignas(64) Slot {
+            std::atomic<uint64_t> m_seq;        //odd while a writer is active
+            std::atomic<uint32_t> m_state;      //SlotState
+            uint32_t m_id;                      //written once before the slot gets live
+            uint32_t m_type;                    //SymbolType, written once
+            std::atomic<int64_t> m_timestamp;   //nanoseconds since system_clock epoch
+            std::atomic<uint64_t> m_bits;       //raw value, or the length of a string value
+            std::atomic<uint64_t> m_text[TEXT_WORDS];
+            char m_name[NAME_LENGTH];           //written once
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared slots need lock-free 64 bit atomics");
+
+        SharedSymbolSegment() = default;
+        virtual ~SharedSymbolSegment() = default;  //destructor
+
+        SharedSymbolSegment(const SharedSymbolSegment& r) = delete;
+        SharedSymbolSegment& operator=(const SharedSymbolSegment& r) = delete;
+
+        /*
+        *   create the segment.
+        *   Params:
+        *   name: segment name, e.g. "/plc_symbols".
+        *   capacity: maximum number of symbols ever published.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool create(const std::string& name, uint32_t capacity);
+
+        /*
+        *   get the memory a segment of the given capacity occupies.
+        *   returns the size in bytes.
+        */
+        static size_t segmentSize(uint32_t capacity) noexcept;
+
+        /*
+        *   hand out a slot for a symbol and add its name to the index.
+        *   returns the slot, NO_SLOT if the segment is full.
+        */
+        uint32_t publish(uint32_t id, const std::string& name, SymbolType type);
+
+        /*
+        *   store a raw scalar value.
+        *   returns nothing.
+        */
+        void write(uint32_t slot, int64_t timestamp, uint64_t bits) noexcept;
+
+        /*
+        *   store a string value, longer strings are cut at TEXT_LENGTH bytes.
+        *   returns nothing.
+        */
+        void writeText(uint32_t slot, int64_t timestamp, const std::string& text) noexcept;
+
+        /*
+        *   mark a string slot as holding no value, readers fail until the next writeText().
+        *   returns nothing.
+        */
+        void clearText(uint32_t slot, int64_t timestamp) noexcept;
+
+        /*
+        *   mark a slot as deleted, readers do not find it anymore.
+        *   returns nothing.
+        */
+        void remove(uint32_t slot) noexcept;
+
+        const std::string& name() const noexcept {
+            return m_name;
+        }
+
+    private:
+        Slot* beginWrite(uint32_t slot) noexcept;
+        static void endWrite(Slot* slot) noexcept;
+
+        std::string m_name;
+        SharedMapping m_mapping;
+        Header* m_header{};
+        std::atomic<uint32_t>* m_index{};
+        Slot* m_slots{};
+    };
+
+    /*
+    *   SharedSymbolReader maps a segment created by SharedSymbolSegment read-only.
+    *   Lookups by name go through the index in the segment, reads copy the slot under its
+    *   seqlock, neither needs a syscall or touches the writer process.
+    */
+    class SharedSymbolReader
+    {
+    public:
+        static inline constexpr int READ_RETRIES = 64;
+
+        SharedSymbolReader() = default;
+        virtual ~SharedSymbolReader() = default;    //destructor
+
+        SharedSymbolReader(const SharedSymbolReader& r) = delete;
+        SharedSymbolReader& operator=(const SharedSymbolReader& r) = delete;
+
+        /*
+        *   map the segment read-only.
+        *   Params:
+        *   name: segment name given to SharedSymbolSegment::create().
+        *   Returns: returns true if successful, otherwise false (missing segment or layout mismatch).
+        */
+        bool open(const std::string& name);
+
+        /*
+        *   get the slot of a symbol by name.
+        *   returns the slot, SharedSymbolSegment::NO_SLOT if there is no live symbol with that name.
+        */
+        uint32_t find(const std::string& name) const noexcept;
+
+        /*
+        *   get the number of slots handed out so far, slots are numbered from 0.
+        */
+        uint32_t size() const noexcept;
+
+        /*
+        *   get id and type of a slot.
+        *   returns false if the slot is not live.
+        */
+        bool describe(uint32_t slot, uint32_t& id, SymbolType& type) const noexcept;
+
+        /*
+        *   read the raw value of a scalar symbol.
+        *   Params:
+        *   slot: slot returned by find().
+        *   bits: receives the raw value, see Symbol::fromRaw().
+        *   timestamp: receives the time of the last update in nanoseconds since system_clock epoch.
+        *   Returns: returns true if successful, false if the slot is not live or a writer kept
+        *   it busy for READ_RETRIES attempts.
+        */
+        bool readRaw(uint32_t slot, uint64_t& bits, int64_t& timestamp) const noexcept;
+
+        /*
+        *   read a string value.
+        *   returns true if successful, otherwise false (also if the slot holds no value, see NO_TEXT).
+        */
+        bool readText(uint32_t slot, std::string& text, int64_t& timestamp) const;
+
+        /*
+        *   read the value of a slot converted back to its symbol type.
+        *   returns the value, empty if the slot could not be read.
+        */
+        std::any read(uint32_t slot) const;
+
+    private:
+        const SharedSymbolSegment::Slot* liveSlot(uint32_t slot) const noexcept;
+
+        SharedMapping m_mapping;
+        const SharedSymbolSegment::Header* m_header{};
+        const std::atomic<uint32_t>* m_index{};
+        const SharedSymbolSegment::Slot* m_slots{};
+    };
+}
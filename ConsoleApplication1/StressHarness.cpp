@@ -0,0 +1,385 @@
+// StressHarness.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "StressHarness.h"
+#include "Symbols.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace Benchmarks {
+
+    namespace {
+        using clock_type = std::chrono::steady_clock;
+        constexpr size_t OPERATION_COUNT = static_cast<size_t>(StressOperation::so_Count);
+        constexpr uint32_t CHURN_RANGE = 1000000;  //ids every thread inserts and deletes, above the table
+
+        const char* const OPERATION_NAMES[OPERATION_COUNT] = {
+            "getid", "getname", "set", "insert", "delete", "subscribe", "unsubscribe"
+        };
+
+        thread_local uint64_t t_eventCalls = 0;    //counted by the callback of the subscriptions
+
+        //spread the ranks over the keys, so the hot symbols are not neighbours in the map
+        uint64_t scramble(uint64_t rank, uint64_t items) noexcept
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (int i = 0; i < 8; i++)
+            {
+                hash ^= (rank >> (i * 8)) & 0xFF;
+                hash *= 1099511628211ull;
+            }
+            return hash % items;
+        }
+
+        struct Samples {
+            std::vector<int64_t> m_latency;     //nanoseconds per call
+            std::vector<int64_t> m_wait;        //nanoseconds waited for the map lock per call
+            uint64_t m_lockWaits{};             //acquisitions which had to wait
+        };
+
+        struct ThreadResult {
+            Samples m_samples[OPERATION_COUNT];
+        };
+
+        int64_t percentile(const std::vector<int64_t>& sorted, double p) noexcept
+        {
+            return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * p))];
+        }
+
+        /*
+        *   one thread of a run, draws its operations until the count or the time is reached.
+        */
+        void runThread(Symbols::SymbolTable& table, const WorkloadMix& mix, const StressOptions& options,
+            unsigned thread, unsigned threads,
+            const std::vector<std::string>& names, const std::atomic<bool>& go, ThreadResult& result)
+        {
+            std::seed_seq seed{ static_cast<uint32_t>(options.m_seed), static_cast<uint32_t>(options.m_seed >> 32), thread };
+            std::mt19937_64 rng(seed);
+            const auto uniform = [&rng]() {
+                return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+            };
+
+            //the symbols this thread reads and writes
+            const size_t symbols = names.size();
+            const size_t first = symbols * thread / threads;
+            const size_t length = std::max<size_t>(symbols * (thread + 1) / threads - first, 1);
+            const ZipfianGenerator ownKeys(length, options.m_theta);
+            const auto ownKey = [&]() {
+                return static_cast<uint32_t>(1 + first + scramble(ownKeys.next(uniform()), length));
+            };
+
+            const uint32_t churnBase = static_cast<uint32_t>(symbols + 1 + static_cast<size_t>(thread) * CHURN_RANGE);
+            uint64_t inserted = 0, deleted = 0;
+            std::deque<std::pair<uint32_t, int>> subscriptions;
+            int nextEventId = 1;
+
+            unsigned cumulative[OPERATION_COUNT];
+            unsigned sum = 0;
+            for (size_t i = 0; i < OPERATION_COUNT; i++)
+                cumulative[i] = sum += mix.m_percent[i];
+
+            while (!go)
+                std::this_thread::yield();
+
+            const auto start = clock_type::now();
+            auto& lockWait = aricanli::container::lockWaitCounters();
+            for (size_t done = 0; options.m_operations == 0 || done < options.m_operations; done++)
+            {
+                // 1: draw the operation and its key before the clock starts
+                const unsigned pick = static_cast<unsigned>(rng() % 100);
+                auto operation = static_cast<StressOperation>(
+                    std::upper_bound(cumulative, cumulative + OPERATION_COUNT, pick) - cumulative);
+                if (operation == StressOperation::so_Delete && inserted == deleted)
+                    operation = StressOperation::so_Insert;
+                if (operation == StressOperation::so_Unsubscribe && subscriptions.empty())
+                    operation = StressOperation::so_Subscribe;
+
+                uint32_t id = 0;
+                std::string name;
+                const double value = uniform();
+                switch (operation)
+                {
+                case StressOperation::so_GetById:
+                case StressOperation::so_GetByName:
+                case StressOperation::so_SetValue:
+                case StressOperation::so_Subscribe:
+                    id = ownKey();
+                    break;
+                case StressOperation::so_Insert:
+                    id = churnBase + static_cast<uint32_t>(inserted % CHURN_RANGE);
+                    name = "churn.tag" + std::to_string(id);
+                    break;
+                case StressOperation::so_Delete:
+                    id = churnBase + static_cast<uint32_t>(deleted % CHURN_RANGE);
+                    break;
+                default:
+                    break;
+                }
+
+                // 2: run it
+                const uint64_t waitsBefore = lockWait.m_sharedWaits + lockWait.m_exclusiveWaits;
+                const uint64_t waitBefore = lockWait.waitNs();
+                const auto before = clock_type::now();
+                switch (operation)
+                {
+                case StressOperation::so_GetById:
+                {
+                    [[maybe_unused]] const Symbols::Symbol symbol = table.GetValue(id);
+                    break;
+                }
+                case StressOperation::so_GetByName:
+                {
+                    [[maybe_unused]] const Symbols::Symbol symbol = table.GetValue(names[id - 1]);
+                    break;
+                }
+                case StressOperation::so_SetValue:
+                    table.SetValue(id, value);
+                    break;
+                case StressOperation::so_Insert:
+                    table.InsertValue(id, std::move(name), "", Symbols::SymbolType::st_Double, 0.0);
+                    inserted++;
+                    break;
+                case StressOperation::so_Delete:
+                    table.DeleteValue(id);
+                    deleted++;
+                    break;
+                case StressOperation::so_Subscribe:
+                    table.AddEvent(id, Symbols::SymbolEvent(nextEventId, Symbols::SymbolEvent::EventType::et_OpcServer,
+                        Symbols::SymbolEvent::EventFireType::eft_AnyChange,
+                        [](Symbols::SymbolEvent::BaseArgs*) { t_eventCalls++; }));
+                    subscriptions.emplace_back(id, nextEventId++);
+                    break;
+                case StressOperation::so_Unsubscribe:
+                    table.RemoveEvent(subscriptions.front().first, subscriptions.front().second);
+                    subscriptions.pop_front();
+                    break;
+                default:
+                    break;
+                }
+                const auto after = clock_type::now();
+
+                auto& samples = result.m_samples[static_cast<size_t>(operation)];
+                samples.m_latency.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+                samples.m_wait.push_back(static_cast<int64_t>(lockWait.waitNs() - waitBefore));
+                samples.m_lockWaits += lockWait.m_sharedWaits + lockWait.m_exclusiveWaits - waitsBefore;
+
+                if (options.m_operations == 0 && std::chrono::duration<double>(after - start).count() > options.m_seconds)
+                    break;
+            }
+        }
+
+        void writeRow(std::ostream& out, const StressOptions& options, const WorkloadMix& mix, unsigned threads,
+            const char* operation, Samples& samples, double seconds)
+        {
+            std::sort(samples.m_latency.begin(), samples.m_latency.end());
+            int64_t totalWait = 0;
+            for (const int64_t wait : samples.m_wait)
+                totalWait += wait;
+            std::sort(samples.m_wait.begin(), samples.m_wait.end());
+
+            const size_t operations = samples.m_latency.size();
+            const double opsPerSecond = seconds > 0 ? operations / seconds : 0.0;
+            const double averageWait = operations > 0 ? static_cast<double>(totalWait) / operations : 0.0;
+            const int64_t maxLatency = operations > 0 ? samples.m_latency.back() : 0;
+            const int64_t maxWait = operations > 0 ? samples.m_wait.back() : 0;
+
+            if (options.m_format == OutputFormat::of_Csv)
+            {
+                //a mix given as shares has commas in its name
+                out << '"' << mix.m_name << '"' << ',' << threads << ',' << options.m_symbols << ',' << options.m_theta << ','
+                    << options.m_seed << ',' << operation << ',' << operations << ','
+                    << std::fixed << std::setprecision(0) << opsPerSecond << ','
+                    << percentile(samples.m_latency, 0.5) << ',' << percentile(samples.m_latency, 0.99) << ','
+                    << percentile(samples.m_latency, 0.999) << ',' << maxLatency << ','
+                    << samples.m_lockWaits << ',' << std::setprecision(1) << averageWait << ','
+                    << percentile(samples.m_wait, 0.99) << ',' << maxWait << '\n';
+                out << std::defaultfloat << std::setprecision(6);
+                return;
+            }
+            out << "{\"workload\":\"" << mix.m_name << "\",\"threads\":" << threads
+                << ",\"symbols\":" << options.m_symbols << ",\"theta\":" << options.m_theta
+                << ",\"seed\":" << options.m_seed << ",\"operation\":\"" << operation << "\""
+                << ",\"operations\":" << operations
+                << ",\"ops_per_sec\":" << std::fixed << std::setprecision(0) << opsPerSecond
+                << ",\"p50_ns\":" << percentile(samples.m_latency, 0.5)
+                << ",\"p99_ns\":" << percentile(samples.m_latency, 0.99)
+                << ",\"p999_ns\":" << percentile(samples.m_latency, 0.999)
+                << ",\"max_ns\":" << maxLatency
+                << ",\"lock_waits\":" << samples.m_lockWaits
+                << ",\"lock_wait_avg_ns\":" << std::setprecision(1) << averageWait
+                << ",\"lock_wait_p99_ns\":" << percentile(samples.m_wait, 0.99)
+                << ",\"lock_wait_max_ns\":" << maxWait << "}\n";
+            out << std::defaultfloat << std::setprecision(6);
+        }
+    }
+
+    ZipfianGenerator::ZipfianGenerator(uint64_t items, double theta) :
+        m_items{ std::max<uint64_t>(items, 1) },
+        m_theta{ std::clamp(theta, 0.0, 0.9999) }  //the closed form needs theta below 1
+    {
+        m_zetaN = 0;
+        for (uint64_t i = 1; i <= m_items; i++)
+            m_zetaN += 1.0 / std::pow(static_cast<double>(i), m_theta);
+
+        const double zeta2 = 1.0 + 1.0 / std::pow(2.0, m_theta);
+        m_alpha = 1.0 / (1.0 - m_theta);
+        m_eta = m_items > 2 ? (1.0 - std::pow(2.0 / m_items, 1.0 - m_theta)) / (1.0 - zeta2 / m_zetaN) : 1.0;
+        m_secondRank = zeta2;
+    }
+
+    uint64_t ZipfianGenerator::next(double uniform) const noexcept
+    {
+        const double uz = uniform * m_zetaN;
+        if (uz < 1.0)
+            return 0;
+        if (uz < m_secondRank)
+            return std::min<uint64_t>(1, m_items - 1);
+        const auto rank = static_cast<uint64_t>(m_items * std::pow(m_eta * uniform - m_eta + 1.0, m_alpha));
+        return std::min(rank, m_items - 1);
+    }
+
+    bool WorkloadMix::parse(const std::string& text, WorkloadMix& mix)
+    {
+        mix = WorkloadMix{};
+        mix.m_name = text;
+        auto& percent = mix.m_percent;
+        const auto index = [](StressOperation operation) { return static_cast<size_t>(operation); };
+
+        if (text == "hmi")
+        {
+            percent[index(StressOperation::so_GetById)] = 90;
+            percent[index(StressOperation::so_GetByName)] = 1;
+            percent[index(StressOperation::so_SetValue)] = 9;
+            return true;
+        }
+        if (text == "acquisition")
+        {
+            percent[index(StressOperation::so_GetById)] = 5;
+            percent[index(StressOperation::so_SetValue)] = 95;
+            return true;
+        }
+        if (text == "churn")
+        {
+            percent[index(StressOperation::so_GetById)] = 40;
+            percent[index(StressOperation::so_SetValue)] = 10;
+            percent[index(StressOperation::so_Insert)] = 25;
+            percent[index(StressOperation::so_Delete)] = 25;
+            return true;
+        }
+        if (text == "storm")
+        {
+            percent[index(StressOperation::so_GetById)] = 10;
+            percent[index(StressOperation::so_SetValue)] = 50;
+            percent[index(StressOperation::so_Subscribe)] = 20;
+            percent[index(StressOperation::so_Unsubscribe)] = 20;
+            return true;
+        }
+
+        //a list of operation=percent
+        std::stringstream stream(text);
+        std::string item;
+        unsigned sum = 0;
+        while (std::getline(stream, item, ','))
+        {
+            const size_t equals = item.find('=');
+            if (equals == std::string::npos)
+                return false;
+            const auto name = std::find(std::begin(OPERATION_NAMES), std::end(OPERATION_NAMES), item.substr(0, equals));
+            if (name == std::end(OPERATION_NAMES))
+                return false;
+            const unsigned share = static_cast<unsigned>(std::strtoul(item.c_str() + equals + 1, nullptr, 10));
+            percent[name - std::begin(OPERATION_NAMES)] += share;
+            sum += share;
+        }
+        return sum == 100;
+    }
+
+    void StressBenchmark(std::ostream& out, const StressOptions& options)
+    {
+        if (options.m_format == OutputFormat::of_Csv)
+        {
+            out << "workload,threads,symbols,theta,seed,operation,operations,ops_per_sec,p50_ns,p99_ns,p999_ns,max_ns,"
+                "lock_waits,lock_wait_avg_ns,lock_wait_p99_ns,lock_wait_max_ns\n";
+        }
+
+        const size_t symbols = std::max<size_t>(options.m_symbols, 1);
+        std::vector<std::string> names(symbols);
+        for (size_t i = 0; i < symbols; i++)
+            names[i] = "plc.area" + std::to_string(i % 100) + ".tag" + std::to_string(i + 1);
+
+        for (const auto& workload : options.m_workloads)
+        {
+            WorkloadMix mix;
+            if (!WorkloadMix::parse(workload, mix))
+            {
+                out << "unknown workload '" << workload << "', use hmi, acquisition, churn, storm or a list like getid=80,set=20" << std::endl;
+                continue;
+            }
+
+            for (const unsigned threads : options.m_threads)
+            {
+                if (threads == 0 || threads > symbols)  //every thread needs a key range of its own
+                    continue;
+
+                auto table = std::make_unique<Symbols::SymbolTable>();
+                for (size_t i = 0; i < symbols; i++)
+                    table->InsertValue(static_cast<uint32_t>(i + 1), names[i], "", Symbols::SymbolType::st_Double, 0.0);
+                if (options.m_stats)
+                    table->EnableStats();
+
+                std::vector<ThreadResult> results(threads);
+                std::atomic<bool> go{ false };
+                std::vector<std::thread> workers;
+                for (unsigned thread = 0; thread < threads; thread++)
+                {
+                    workers.emplace_back(runThread, std::ref(*table), std::cref(mix), std::cref(options),
+                        thread, threads, std::cref(names), std::cref(go), std::ref(results[thread]));
+                }
+
+                const auto start = clock_type::now();
+                go = true;
+                for (auto& worker : workers)
+                    worker.join();
+                const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+                // every operation of the mix, then all of them together
+                Samples all;
+                for (size_t operation = 0; operation < OPERATION_COUNT; operation++)
+                {
+                    Samples merged;
+                    for (auto& result : results)
+                    {
+                        auto& samples = result.m_samples[operation];
+                        merged.m_latency.insert(merged.m_latency.end(), samples.m_latency.begin(), samples.m_latency.end());
+                        merged.m_wait.insert(merged.m_wait.end(), samples.m_wait.begin(), samples.m_wait.end());
+                        merged.m_lockWaits += samples.m_lockWaits;
+                    }
+                    if (merged.m_latency.empty())
+                        continue;
+
+                    all.m_latency.insert(all.m_latency.end(), merged.m_latency.begin(), merged.m_latency.end());
+                    all.m_wait.insert(all.m_wait.end(), merged.m_wait.begin(), merged.m_wait.end());
+                    all.m_lockWaits += merged.m_lockWaits;
+                    writeRow(out, options, mix, threads, OPERATION_NAMES[operation], merged, seconds);
+                }
+                writeRow(out, options, mix, threads, "all", all, seconds);
+                out.flush();
+            }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+// StressHarness.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Reproducible multi-threaded workloads against SymbolTable with lock wait accounting.
+
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Benchmarks.h"
+
+namespace Benchmarks {
+
+    /*
+    *   ZipfianGenerator draws ranks 0..items-1, rank k with a probability proportional to
+    *   1 / (k + 1)^theta (the generator of Gray et al. which YCSB uses as well).
+    *   theta 0 is uniform, 0.99 gives the usual skew of a few hot tags.
+    */
+    class ZipfianGenerator
+    {
+    public:
+        ZipfianGenerator(uint64_t items, double theta);
+
+        /*
+        *   draw a rank, rank 0 is the hottest.
+        *   Params:
+        *   uniform: a uniformly distributed number in [0, 1).
+        *   Returns: returns the rank.
+        */
+        uint64_t next(double uniform) const noexcept;
+
+        uint64_t items() const noexcept {
+            return m_items;
+        }
+
+    private:
+        uint64_t m_items;
+        double m_theta;
+        double m_zetaN;
+        double m_alpha;
+        double m_eta;
+        double m_secondRank;    //probability bound of rank 1, 1 + 0.5^theta
+    };
+
+    enum class StressOperation {
+        so_GetById = 0,
+        so_GetByName,
+        so_SetValue,
+        so_Insert,
+        so_Delete,
+        so_Subscribe,       //AddEvent on a symbol
+        so_Unsubscribe,     //RemoveEvent of the oldest subscription of the thread
+        so_Count
+    };
+
+    /*
+    *   a workload, the share of every operation in percent.
+    */
+    struct WorkloadMix {
+        std::string m_name;
+        unsigned m_percent[static_cast<size_t>(StressOperation::so_Count)]{};
+
+        /*
+        *   get a workload by preset name or from a list of shares.
+        *   Presets: hmi (read-heavy polling), acquisition (write-heavy), churn (inserts and deletes),
+        *   storm (subscriptions coming and going while values change).
+        *   A list names the operations with their share, e.g. "getid=70,set=25,subscribe=5",
+        *   operations: getid, getname, set, insert, delete, subscribe, unsubscribe.
+        *   Returns: returns false if the name is unknown or the shares do not add up to 100.
+        */
+        static bool parse(const std::string& text, WorkloadMix& mix);
+    };
+
+    /*
+    *   settings of StressBenchmark, the defaults run every preset.
+    */
+    struct StressOptions {
+        std::vector<std::string> m_workloads{ "hmi", "acquisition", "churn", "storm" };
+        size_t m_symbols{ 100000 };
+        std::vector<unsigned> m_threads{ 1, 4, 16, 64 };
+        double m_theta{ 0.99 };         //skew of the keys, see ZipfianGenerator
+        uint64_t m_seed{ 1 };           //same seed, same operations per thread
+        size_t m_operations{ 0 };       //per thread, 0 runs for m_seconds instead
+        double m_seconds{ 2.0 };
+        bool m_stats{ false };          //run with SymbolTable::EnableStats(), shows what the counters cost
+        OutputFormat m_format{ OutputFormat::of_Json };
+    };
+
+    /*
+    *   Run workloads against a SymbolTable from several threads and report per operation
+    *   throughput, p50/p99/p99.9/max latency and the time spent waiting for the map lock.
+    *   Every thread draws its operations and keys from its own generator seeded with the seed and
+    *   its index, so a run with a fixed operation count replays the same operations.
+    *   A SymbolTable locks its map but not the symbols in it, a GetValue copies the value and the
+    *   events of a symbol while SetValue or AddEvent may change them. So every thread reads, writes,
+    *   subscribes and churns in its own key range, the threads still share the lock of the map.
+    *   GetValue by name walks the table without the lock, combine it with inserts or deletes only
+    *   to reproduce that race.
+    */
+    void StressBenchmark(std::ostream& out, const StressOptions& options);
+}
@@ -0,0 +1,715 @@
+// SubscriptionServer.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SubscriptionServer.h"
+#include "Symbols.h"
+#include <algorithm>
+#include <chrono>
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Symbols {
+
+#if defined(__linux__)
+    namespace {
+        int64_t nowNanoseconds() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        bool socketAddress(const std::string& path, sockaddr_un& address) noexcept
+        {
+            address = {};
+            address.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(address.sun_path))
+                return false;
+            std::copy(path.begin(), path.end(), address.sun_path);
+            return true;
+        }
+
+        /*
+        *   calls handler for every complete frame in buffer and removes them.
+        *   returns false if a frame is malformed or the handler rejects it.
+        */
+        template<typename Handler>
+        bool takeFrames(std::vector<uint8_t>& buffer, Handler&& handler)
+        {
+            size_t offset = 0;
+            bool bRet = true;
+            while (buffer.size() - offset >= SubscriptionProtocol::HEADER_SIZE)
+            {
+                uint32_t length;
+                std::memcpy(&length, buffer.data() + offset, sizeof(length));
+                const auto type = static_cast<SubscriptionProtocol::FrameType>(buffer[offset + sizeof(length)]);
+                if (length > SubscriptionProtocol::MAX_FRAME)
+                {
+                    bRet = false;
+                    break;
+                }
+                if (buffer.size() - offset - SubscriptionProtocol::HEADER_SIZE < length)
+                    break;  //wait for the rest
+
+                ByteReader payload(buffer.data() + offset + SubscriptionProtocol::HEADER_SIZE, length);
+                offset += SubscriptionProtocol::HEADER_SIZE + length;
+                if (!handler(type, payload))
+                {
+                    bRet = false;
+                    break;
+                }
+            }
+            buffer.erase(buffer.begin(), buffer.begin() + offset);
+            return bRet;
+        }
+    }
+#endif
+
+    SubscriptionServer::SubscriptionServer(SymbolTable& table, size_t maxQueueBytes) :
+        m_table{ table },
+        m_maxQueueBytes{ maxQueueBytes }
+    {
+
+    }
+
+    SubscriptionServer::~SubscriptionServer()
+    {
+        stop();
+    }
+
+    SubscriptionStats SubscriptionServer::stats() const noexcept
+    {
+        SubscriptionStats stats;
+        stats.m_clients = m_clientCount.load(std::memory_order_relaxed);
+        stats.m_changes = m_changes.load(std::memory_order_relaxed);
+        stats.m_deliveries = m_deliveries.load(std::memory_order_relaxed);
+        stats.m_frames = m_frames.load(std::memory_order_relaxed);
+        stats.m_bytes = m_bytes.load(std::memory_order_relaxed);
+        stats.m_slowConsumers = m_slowConsumers.load(std::memory_order_relaxed);
+        stats.m_cpuTime = m_cpuTime.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    bool SubscriptionServer::matches(const Subscription& subscription, const std::string& name) noexcept
+    {
+        if (subscription.m_prefix)
+            return name.compare(0, subscription.m_name.size(), subscription.m_name) == 0;
+        return name == subscription.m_name;
+    }
+
+#if defined(__linux__)
+    bool SubscriptionServer::start(const std::string& path)
+    {
+        if (m_running)
+            return false;
+
+        sockaddr_un address;
+        if (!socketAddress(path, address))
+            return false;
+
+        // 1: listening socket, a socket file left by a previous run is replaced
+        m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0)
+            return false;
+
+        unlink(path.c_str());
+        if (bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(m_listenFd, SOMAXCONN) != 0)
+        {
+            close(m_listenFd);
+            m_listenFd = -1;
+            return false;
+        }
+        m_path = path;
+
+        // 2: epoll set with the listening socket and the wake up event of the table event
+        m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event listenEvent{};
+        listenEvent.events = EPOLLIN;
+        listenEvent.data.fd = m_listenFd;
+        epoll_event wakeEvent{};
+        wakeEvent.events = EPOLLIN;
+        wakeEvent.data.fd = m_wakeFd;
+        if (m_epollFd < 0 || m_wakeFd < 0 ||
+            epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &listenEvent) != 0 ||
+            epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &wakeEvent) != 0)
+        {
+            m_running = true;   //let stop() release what was created
+            stop();
+            return false;
+        }
+
+        // 3: hook into the table and run
+        m_running = true;
+        m_tableEvent = m_table.AddTableEvent([this](const TableChange& change) {
+            //subscribers see what the symbol events see, changes inside the deadband are not sent
+            if (change.m_fireType != SymbolEvent::EventFireType::eft_Filtered)
+                onTableChange(change.m_change, *change.m_symbol);
+        });
+        m_thread = std::thread(&SubscriptionServer::run, this);
+        return true;
+    }
+
+    void SubscriptionServer::stop()
+    {
+        if (!m_running.exchange(false))
+            return;
+
+        if (m_tableEvent)
+        {
+            m_table.RemoveTableEvent(m_tableEvent);
+            m_tableEvent = 0;
+        }
+
+        if (m_thread.joinable())
+        {
+            const uint64_t one = 1;
+            [[maybe_unused]] const ssize_t written = write(m_wakeFd, &one, sizeof(one));
+            m_thread.join();
+        }
+
+        while (!m_clients.empty())
+            closeClient(m_clients.begin()->first);
+        m_routes.clear();
+        m_dropped.clear();
+
+        for (int* fd : { &m_listenFd, &m_epollFd, &m_wakeFd })
+        {
+            if (*fd >= 0)
+                close(*fd);
+            *fd = -1;
+        }
+        if (!m_path.empty())
+            unlink(m_path.c_str());
+        m_path.clear();
+
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_pending.clear();
+        m_pendingBytes.clear();
+    }
+
+    void SubscriptionServer::onTableChange(SymbolCodec::ChangeType change, const Symbol& symbol)
+    {
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            wake = m_pending.empty();
+
+            const size_t offset = m_pendingBytes.size();
+            ByteWriter writer(m_pendingBytes);
+            SymbolCodec::encodeChange(writer, change, symbol, nowNanoseconds());
+            m_pending.push_back({ change, symbol.getId(), static_cast<uint32_t>(offset),
+                static_cast<uint32_t>(m_pendingBytes.size() - offset),
+                change == SymbolCodec::ChangeType::ct_Insert ? symbol.getName() : std::string{} });
+        }
+
+        //only the first change of a batch wakes the server, the others ride along
+        if (wake)
+        {
+            const uint64_t one = 1;
+            [[maybe_unused]] const ssize_t written = write(m_wakeFd, &one, sizeof(one));
+        }
+    }
+
+    void SubscriptionServer::run()
+    {
+        epoll_event events[64];
+        while (m_running.load(std::memory_order_relaxed))
+        {
+            const int count = epoll_wait(m_epollFd, events, 64, 100);
+            for (int i = 0; i < count; i++)
+            {
+                const int fd = events[i].data.fd;
+                if (fd == m_listenFd)
+                    accept();
+                else if (fd == m_wakeFd)
+                {
+                    uint64_t value;
+                    [[maybe_unused]] const ssize_t got = read(m_wakeFd, &value, sizeof(value));
+                    drainPending();
+                }
+                else
+                {
+                    auto it = m_clients.find(fd);
+                    if (it == m_clients.end())
+                        continue;   //closed earlier in this round
+
+                    bool alive = true;
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                        alive = readClient(it->second);
+                    if (alive && (events[i].events & EPOLLOUT))
+                        alive = writeClient(it->second);
+                    if (!alive)
+                        closeClient(fd);
+                }
+
+                //clients dropped by drainPending() while a frame of one of them was handled
+                for (const int dropped : m_dropped)
+                    closeClient(dropped);
+                m_dropped.clear();
+            }
+
+            timespec cpu{};
+            if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == 0)
+                m_cpuTime.store(static_cast<uint64_t>(cpu.tv_sec) * 1000000000u + cpu.tv_nsec, std::memory_order_relaxed);
+        }
+    }
+
+    void SubscriptionServer::accept()
+    {
+        for (;;)
+        {
+            const int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+            {
+                close(fd);
+                continue;
+            }
+
+            Client& client = m_clients[fd];
+            client.m_fd = fd;
+            m_clientCount++;
+        }
+    }
+
+    void SubscriptionServer::drainPending()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            std::swap(m_pendingBytes, m_drainBytes);
+            std::swap(m_pending, m_drain);
+        }
+
+        for (const Pending& pending : m_drain)
+        {
+            // 1: a new symbol may match existing prefix subscriptions
+            if (pending.m_change == SymbolCodec::ChangeType::ct_Insert)
+            {
+                for (auto& item : m_clients)
+                {
+                    Client& client = item.second;
+                    const bool wanted = std::any_of(client.m_subscriptions.cbegin(), client.m_subscriptions.cend(),
+                        [&pending](const Subscription& subscription) { return matches(subscription, pending.m_name); });
+                    if (wanted && client.m_ids.emplace(pending.m_id, pending.m_name).second)
+                        m_routes[pending.m_id].push_back(client.m_fd);
+                }
+            }
+
+            // 2: append the record to the frame of every subscriber
+            auto route = m_routes.find(pending.m_id);
+            if (route == m_routes.end())
+                continue;
+
+            for (const int fd : route->second)
+                queueRecord(m_clients[fd], m_drainBytes.data() + pending.m_offset, pending.m_length);
+
+            if (pending.m_change == SymbolCodec::ChangeType::ct_Delete)
+            {
+                for (const int fd : route->second)
+                    m_clients[fd].m_ids.erase(pending.m_id);
+                m_routes.erase(route);
+            }
+        }
+        m_changes += m_drain.size();
+        m_drain.clear();
+        m_drainBytes.clear();
+
+        // 3: one frame per client for the whole batch. A failed client is closed by run(), subscribe()
+        //    gets here while it handles a frame of a client which may be one of them
+        for (auto& item : m_clients)
+        {
+            if (item.second.m_batchCount && !flushBatch(item.second))
+                m_dropped.push_back(item.first);
+        }
+    }
+
+    bool SubscriptionServer::readClient(Client& client)
+    {
+        uint8_t chunk[16 * 1024];
+        for (;;)
+        {
+            const ssize_t got = recv(client.m_fd, chunk, sizeof(chunk), 0);
+            if (got > 0)
+            {
+                client.m_in.insert(client.m_in.end(), chunk, chunk + got);
+                continue;
+            }
+            if (got == 0)
+                return false;   //closed by the client
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            if (errno != EINTR)
+                return false;
+        }
+
+        const bool bRet = takeFrames(client.m_in, [this, &client](SubscriptionProtocol::FrameType type, ByteReader& payload) {
+            return handleFrame(client, type, payload);
+        });
+        return bRet && (!client.m_batchCount || flushBatch(client));
+    }
+
+    bool SubscriptionServer::handleFrame(Client& client, SubscriptionProtocol::FrameType type, ByteReader& payload)
+    {
+        uint8_t prefix;
+        Subscription subscription;
+        if (!payload.get(prefix) || !payload.getString(subscription.m_name))
+            return false;
+        subscription.m_prefix = prefix != 0;
+
+        switch (type)
+        {
+        case SubscriptionProtocol::FrameType::ft_Subscribe:
+            subscribe(client, subscription);
+            return true;
+
+        case SubscriptionProtocol::FrameType::ft_Unsubscribe:
+            unsubscribe(client, subscription);
+            return true;
+
+        default:
+            return false;   //clients do not send anything else
+        }
+    }
+
+    void SubscriptionServer::subscribe(Client& client, const Subscription& subscription)
+    {
+        //changes encoded before the snapshot go out first, so the snapshot is never followed by an older value
+        drainPending();
+
+        client.m_subscriptions.push_back(subscription);
+
+        std::vector<uint8_t> record;
+        const int64_t now = nowNanoseconds();
+        m_table.ForEach([&](const auto& item)
+        {
+            const Symbol& symbol = item.second;
+            const std::string name = symbol.getName();
+            if (!matches(subscription, name) || !client.m_ids.emplace(symbol.getId(), name).second)
+                return;
+
+            m_routes[symbol.getId()].push_back(client.m_fd);
+
+            record.clear();
+            ByteWriter writer(record);
+            SymbolCodec::encodeChange(writer, SymbolCodec::ChangeType::ct_Insert, symbol, now);
+            queueRecord(client, record.data(), record.size());
+        });
+    }
+
+    void SubscriptionServer::unsubscribe(Client& client, const Subscription& subscription)
+    {
+        auto& subscriptions = client.m_subscriptions;
+        subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+            [&subscription](const Subscription& item) {
+                return item.m_prefix == subscription.m_prefix && item.m_name == subscription.m_name;
+            }), subscriptions.end());
+
+        //keep the symbols another subscription of the client still matches
+        for (auto it = client.m_ids.begin(); it != client.m_ids.end(); )
+        {
+            const std::string& name = it->second;
+            const bool wanted = std::any_of(subscriptions.cbegin(), subscriptions.cend(),
+                [&name](const Subscription& item) { return matches(item, name); });
+            if (wanted)
+            {
+                ++it;
+                continue;
+            }
+
+            auto route = m_routes.find(it->first);
+            if (route != m_routes.end())
+            {
+                auto& fds = route->second;
+                fds.erase(std::remove(fds.begin(), fds.end(), client.m_fd), fds.end());
+                if (fds.empty())
+                    m_routes.erase(route);
+            }
+            it = client.m_ids.erase(it);
+        }
+    }
+
+    void SubscriptionServer::queueRecord(Client& client, const uint8_t* record, size_t length)
+    {
+        if (client.m_batch.empty())
+        {
+            SymbolCodec::beginFrame(client.m_batch, static_cast<uint8_t>(SubscriptionProtocol::FrameType::ft_Changes));
+            ByteWriter(client.m_batch).put(uint32_t{ 0 });  //record count, patched by flushBatch()
+        }
+        client.m_batch.insert(client.m_batch.end(), record, record + length);
+        client.m_batchCount++;
+        m_deliveries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool SubscriptionServer::flushBatch(Client& client)
+    {
+        SymbolCodec::endFrame(client.m_batch, 0);
+        std::memcpy(client.m_batch.data() + SubscriptionProtocol::HEADER_SIZE, &client.m_batchCount,
+            sizeof(client.m_batchCount));
+
+        if (client.m_outOffset == client.m_out.size())
+        {
+            client.m_out.clear();
+            client.m_outOffset = 0;
+        }
+        client.m_out.insert(client.m_out.end(), client.m_batch.begin(), client.m_batch.end());
+        client.m_batch.clear();
+        client.m_batchCount = 0;
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+
+        //slow consumer: the client does not keep up with the changes it subscribed to
+        if (client.m_out.size() - client.m_outOffset > m_maxQueueBytes)
+        {
+            m_slowConsumers.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return !client.m_writable || writeClient(client);
+    }
+
+    bool SubscriptionServer::writeClient(Client& client)
+    {
+        while (client.m_outOffset < client.m_out.size())
+        {
+            const ssize_t sent = send(client.m_fd, client.m_out.data() + client.m_outOffset,
+                client.m_out.size() - client.m_outOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (sent > 0)
+            {
+                client.m_outOffset += static_cast<size_t>(sent);
+                m_bytes.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+                continue;
+            }
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                //socket buffer full, continue when epoll reports it writable
+                if (client.m_writable)
+                {
+                    client.m_writable = false;
+                    updateEvents(client, true);
+                }
+                if (client.m_outOffset > client.m_out.size() / 2)
+                {
+                    client.m_out.erase(client.m_out.begin(), client.m_out.begin() + client.m_outOffset);
+                    client.m_outOffset = 0;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        client.m_out.clear();
+        client.m_outOffset = 0;
+        if (!client.m_writable)
+        {
+            client.m_writable = true;
+            updateEvents(client, false);
+        }
+        return true;
+    }
+
+    void SubscriptionServer::updateEvents(Client& client, bool wantWrite)
+    {
+        epoll_event event{};
+        event.events = wantWrite ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.fd = client.m_fd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_MOD, client.m_fd, &event);
+    }
+
+    void SubscriptionServer::closeClient(int fd)
+    {
+        auto it = m_clients.find(fd);
+        if (it == m_clients.end())
+            return;
+
+        for (const auto& id : it->second.m_ids)
+        {
+            auto route = m_routes.find(id.first);
+            if (route == m_routes.end())
+                continue;
+            auto& fds = route->second;
+            fds.erase(std::remove(fds.begin(), fds.end(), fd), fds.end());
+            if (fds.empty())
+                m_routes.erase(route);
+        }
+
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        m_clients.erase(it);
+        m_clientCount--;
+    }
+
+    SubscriptionClient::~SubscriptionClient()
+    {
+        disconnect();
+    }
+
+    bool SubscriptionClient::connect(const std::string& path)
+    {
+        disconnect();
+
+        sockaddr_un address;
+        if (!socketAddress(path, address))
+            return false;
+
+        m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_fd < 0)
+            return false;
+
+        if (::connect(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void SubscriptionClient::disconnect() noexcept
+    {
+        if (m_fd >= 0)
+            close(m_fd);
+        m_fd = -1;
+        m_in.clear();
+    }
+
+    bool SubscriptionClient::subscribe(const std::string& name, bool prefix)
+    {
+        return sendFrame(SubscriptionProtocol::FrameType::ft_Subscribe, name, prefix);
+    }
+
+    bool SubscriptionClient::unsubscribe(const std::string& name, bool prefix)
+    {
+        return sendFrame(SubscriptionProtocol::FrameType::ft_Unsubscribe, name, prefix);
+    }
+
+    bool SubscriptionClient::sendFrame(SubscriptionProtocol::FrameType type, const std::string& name, bool prefix)
+    {
+        if (m_fd < 0)
+            return false;
+
+        std::vector<uint8_t> frame;
+        SymbolCodec::beginFrame(frame, static_cast<uint8_t>(type));
+        ByteWriter writer(frame);
+        writer.put(static_cast<uint8_t>(prefix ? 1 : 0));
+        writer.putString(name);
+        SymbolCodec::endFrame(frame, 0);
+
+        for (size_t offset = 0; offset < frame.size(); )
+        {
+            const ssize_t sent = send(m_fd, frame.data() + offset, frame.size() - offset, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent <= 0)
+                return false;
+            offset += static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    int SubscriptionClient::poll(std::vector<SymbolCodec::Change>& changes, int timeoutMs)
+    {
+        if (m_fd < 0)
+            return -1;
+
+        // 1: wait for data, then take everything the socket has
+        pollfd descriptor{ m_fd, POLLIN, 0 };
+        if (::poll(&descriptor, 1, timeoutMs) > 0)
+        {
+            uint8_t chunk[64 * 1024];
+            for (;;)
+            {
+                const ssize_t got = recv(m_fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+                if (got > 0)
+                {
+                    m_in.insert(m_in.end(), chunk, chunk + got);
+                    continue;
+                }
+                if (got == 0)
+                    return -1;
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                return -1;
+            }
+        }
+
+        // 2: decode the complete frames
+        const size_t before = changes.size();
+        const bool bRet = takeFrames(m_in, [&changes](SubscriptionProtocol::FrameType type, ByteReader& payload) {
+            uint32_t count;
+            if (type != SubscriptionProtocol::FrameType::ft_Changes || !payload.get(count))
+                return false;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                changes.emplace_back();
+                if (!SymbolCodec::decodeChange(payload, changes.back()))
+                    return false;
+            }
+            return true;
+        });
+        if (!bRet)
+            return -1;
+        return static_cast<int>(changes.size() - before);
+    }
+#else
+    bool SubscriptionServer::start(const std::string&)
+    {
+        return false;   //epoll and Unix domain sockets are Linux only
+    }
+
+    void SubscriptionServer::stop()
+    {
+
+    }
+
+    SubscriptionClient::~SubscriptionClient()
+    {
+
+    }
+
+    bool SubscriptionClient::connect(const std::string&)
+    {
+        return false;
+    }
+
+    void SubscriptionClient::disconnect() noexcept
+    {
+
+    }
+
+    bool SubscriptionClient::subscribe(const std::string&, bool)
+    {
+        return false;
+    }
+
+    bool SubscriptionClient::unsubscribe(const std::string&, bool)
+    {
+        return false;
+    }
+
+    int SubscriptionClient::poll(std::vector<SymbolCodec::Change>&, int)
+    {
+        return -1;
+    }
+#endif
+}
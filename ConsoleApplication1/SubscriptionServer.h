@@ -0,0 +1,222 @@
+// SubscriptionServer.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Unix domain socket server which fans out symbol changes to local subscribers.
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "SymbolCodec.h"
+
+namespace Symbols {
+
+    class SymbolTable;  //incomplete type declaration
+
+    /*
+    *   Wire format shared by SubscriptionServer and SubscriptionClient.
+    *   Every frame is: u32 payload length, u8 FrameType, payload.
+    *   ft_Subscribe / ft_Unsubscribe (client to server): u8 1 for a prefix, 0 for an exact name, name.
+    *   ft_Changes (server to client): u32 count, then count change records (see SymbolCodec).
+    *   A subscription is answered by ct_Insert records holding the current values of the matching symbols.
+    */
+    struct SubscriptionProtocol {
+        enum class FrameType : uint8_t {
+            ft_Subscribe = 1,
+            ft_Unsubscribe,
+            ft_Changes
+        };
+
+        static inline constexpr size_t HEADER_SIZE = SymbolCodec::FRAME_HEADER_SIZE;
+        static inline constexpr uint32_t MAX_FRAME = 16 * 1024 * 1024;
+    };
+
+    /*
+    *   counters of a SubscriptionServer, read with SubscriptionServer::stats().
+    */
+    struct SubscriptionStats {
+        uint64_t m_clients{};           //connected clients
+        uint64_t m_changes{};           //table changes taken from the table
+        uint64_t m_deliveries{};        //change records queued to clients
+        uint64_t m_frames{};            //frames queued to clients
+        uint64_t m_bytes{};             //bytes written to sockets
+        uint64_t m_slowConsumers{};     //clients dropped because their send queue was full
+        uint64_t m_cpuTime{};           //nanoseconds of CPU time used by the server thread
+    };
+
+    /*
+    *   SubscriptionServer publishes the changes of a SymbolTable on a Unix domain socket.
+    *   Clients subscribe by name or prefix and receive batched binary change frames.
+    *   The table event only encodes the change into a pending buffer, one server thread running an
+    *   epoll loop with non-blocking sockets routes the changes, so the writers of the table are
+    *   never blocked by a client. Every client has its own send queue, a client whose queue grows
+    *   beyond maxQueueBytes is a slow consumer and gets disconnected.
+    *   Linux only, start() fails on other platforms.
+    */
+    class SubscriptionServer
+    {
+    public:
+        static inline constexpr size_t DEFAULT_MAX_QUEUE = 8 * 1024 * 1024;    //bytes per client
+
+        explicit SubscriptionServer(SymbolTable& table, size_t maxQueueBytes = DEFAULT_MAX_QUEUE);
+        virtual ~SubscriptionServer();  //destructor, stops the server
+
+        SubscriptionServer(const SubscriptionServer& r) = delete;
+        SubscriptionServer& operator=(const SubscriptionServer& r) = delete;
+
+        /*
+        *   listen on a socket path and start the server thread.
+        *   Params:
+        *   path: socket path, an existing socket file is replaced.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool start(const std::string& path);
+
+        /*
+        *   disconnect all clients, stop the server thread and remove the socket file.
+        *   returns nothing.
+        */
+        void stop();
+
+        /*
+        *   get a copy of the counters.
+        */
+        SubscriptionStats stats() const noexcept;
+
+    private:
+        struct Subscription {
+            std::string m_name;
+            bool m_prefix{};
+        };
+
+        struct Client {
+            int m_fd{ -1 };
+            std::vector<Subscription> m_subscriptions;
+            std::unordered_map<uint32_t, std::string> m_ids;   //symbols the client receives, id to name
+            std::vector<uint8_t> m_in;              //partial frames read so far
+            std::vector<uint8_t> m_out;             //send queue
+            size_t m_outOffset{};                   //bytes of m_out already sent
+            std::vector<uint8_t> m_batch;           //change frame being built
+            uint32_t m_batchCount{};
+            bool m_writable{ true };
+        };
+
+        struct Pending {
+            SymbolCodec::ChangeType m_change;
+            uint32_t m_id;
+            uint32_t m_offset;      //record in the pending buffer
+            uint32_t m_length;
+            std::string m_name;     //only for inserts, used for routing
+        };
+
+        void onTableChange(SymbolCodec::ChangeType change, const Symbol& symbol);
+        void run();
+        void accept();
+        void drainPending();
+        bool readClient(Client& client);
+        bool handleFrame(Client& client, SubscriptionProtocol::FrameType type, ByteReader& payload);
+        void subscribe(Client& client, const Subscription& subscription);
+        void unsubscribe(Client& client, const Subscription& subscription);
+        void queueRecord(Client& client, const uint8_t* record, size_t length);
+        bool flushBatch(Client& client);
+        bool writeClient(Client& client);
+        void updateEvents(Client& client, bool wantWrite);
+        void closeClient(int fd);
+        static bool matches(const Subscription& subscription, const std::string& name) noexcept;
+
+        SymbolTable& m_table;
+        size_t m_maxQueueBytes;
+        std::string m_path;
+        int m_tableEvent{};
+        int m_listenFd{ -1 };
+        int m_epollFd{ -1 };
+        int m_wakeFd{ -1 };
+        std::thread m_thread;
+        std::atomic<bool> m_running{ false };
+
+        //filled by the table event on the writer threads
+        std::mutex m_pendingMutex;
+        std::vector<uint8_t> m_pendingBytes;
+        std::vector<Pending> m_pending;
+
+        //owned by the server thread
+        std::vector<uint8_t> m_drainBytes;
+        std::vector<Pending> m_drain;
+        std::unordered_map<int, Client> m_clients;
+        std::unordered_map<uint32_t, std::vector<int>> m_routes;   //symbol id to client sockets
+        std::vector<int> m_dropped;     //clients whose frame failed, closed by run() after the current event
+
+        std::atomic<uint64_t> m_clientCount{ 0 };
+        std::atomic<uint64_t> m_changes{ 0 };
+        std::atomic<uint64_t> m_deliveries{ 0 };
+        std::atomic<uint64_t> m_frames{ 0 };
+        std::atomic<uint64_t> m_bytes{ 0 };
+        std::atomic<uint64_t> m_slowConsumers{ 0 };
+        std::atomic<uint64_t> m_cpuTime{ 0 };
+    };
+
+    /*
+    *   SubscriptionClient is a small blocking client for SubscriptionServer,
+    *   used by tests, benchmarks and local tools.
+    */
+    class SubscriptionClient
+    {
+    public:
+        SubscriptionClient() = default;
+        virtual ~SubscriptionClient();  //destructor, disconnects
+
+        SubscriptionClient(const SubscriptionClient& r) = delete;
+        SubscriptionClient& operator=(const SubscriptionClient& r) = delete;
+
+        /*
+        *   connect to the server socket.
+        *   returns true if successful, otherwise false.
+        */
+        bool connect(const std::string& path);
+
+        /*
+        *   close the connection.
+        *   returns nothing.
+        */
+        void disconnect() noexcept;
+
+        /*
+        *   subscribe to a symbol name, or to every symbol whose name starts with it if prefix is set.
+        *   returns true if the request was sent.
+        */
+        bool subscribe(const std::string& name, bool prefix = false);
+
+        /*
+        *   remove a subscription made with the same parameters.
+        *   returns true if the request was sent.
+        */
+        bool unsubscribe(const std::string& name, bool prefix = false);
+
+        /*
+        *   wait for change frames and decode them.
+        *   Params:
+        *   changes: receives the decoded changes, appended.
+        *   timeoutMs: how long to wait for the first frame, 0 only takes what already arrived.
+        *   Returns: returns the number of changes appended, -1 if the connection was closed.
+        */
+        int poll(std::vector<SymbolCodec::Change>& changes, int timeoutMs);
+
+    private:
+        bool sendFrame(SubscriptionProtocol::FrameType type, const std::string& name, bool prefix);
+
+        int m_fd{ -1 };
+        std::vector<uint8_t> m_in;
+    };
+}
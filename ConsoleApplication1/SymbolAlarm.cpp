@@ -0,0 +1,154 @@
+// SymbolAlarm.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolAlarm.h"
+#include <algorithm>
+
+namespace Symbols {
+
+    namespace {
+        int64_t nowNanoseconds() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    SymbolAlarm::SymbolAlarm(const AlarmLimits& limits) noexcept
+        : m_enterLow(std::max(limits.m_lo, limits.m_lolo)),
+        m_enterHigh(std::min(limits.m_hi, limits.m_hihi)),
+        m_leaveHiHi(limits.m_hihi - std::max(limits.m_deadband, 0.0)),
+        m_leaveHi(limits.m_hi - std::max(limits.m_deadband, 0.0)),
+        m_leaveLo(limits.m_lo + std::max(limits.m_deadband, 0.0)),
+        m_leaveLoLo(limits.m_lolo + std::max(limits.m_deadband, 0.0)),
+        m_limits(limits)
+    {
+    }
+
+    AlarmLevel SymbolAlarm::classify(double value, AlarmLevel current) const noexcept
+    {
+        //a level is kept until the value is back by more than the deadband, NaN is normal
+        if (value >= (current == AlarmLevel::al_HiHi ? m_leaveHiHi : m_limits.m_hihi))
+            return AlarmLevel::al_HiHi;
+        if (value >= (current == AlarmLevel::al_Hi || current == AlarmLevel::al_HiHi ? m_leaveHi : m_limits.m_hi))
+            return AlarmLevel::al_Hi;
+        if (value <= (current == AlarmLevel::al_LoLo ? m_leaveLoLo : m_limits.m_lolo))
+            return AlarmLevel::al_LoLo;
+        if (value <= (current == AlarmLevel::al_Lo || current == AlarmLevel::al_LoLo ? m_leaveLo : m_limits.m_lo))
+            return AlarmLevel::al_Lo;
+        return AlarmLevel::al_Normal;
+    }
+
+    int64_t SymbolAlarm::delayOf(AlarmLevel from, AlarmLevel to) const noexcept
+    {
+        const auto delay = severity(to) < severity(from) ? m_limits.m_offDelay : m_limits.m_onDelay;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+    }
+
+    uint32_t SymbolAlarm::enter(uint32_t state, AlarmLevel level) noexcept
+    {
+        //a new or a more severe alarm has to be acknowledged again
+        const AlarmLevel from = levelOf(state);
+        bool acked = (state & ACKED) != 0;
+        if (level != AlarmLevel::al_Normal && (from == AlarmLevel::al_Normal || severity(level) > severity(from)))
+            acked = false;
+        return static_cast<uint32_t>(level) | (acked ? ACKED : 0);
+    }
+
+    bool SymbolAlarm::update(double value, AlarmTransition& transition, bool& delayed) noexcept
+    {
+        delayed = false;
+        uint32_t state = m_state.load(std::memory_order_acquire);
+        //the common case, a normal value of a normal point
+        if (static_cast<AlarmLevel>(state & 0xF) == AlarmLevel::al_Normal && !(state & PENDING) &&
+            value > m_enterLow && value < m_enterHigh)
+            return false;
+
+        m_lastValue.store(value, std::memory_order_relaxed);
+        int64_t now = 0;
+        for (;;)
+        {
+            const AlarmLevel from = levelOf(state);
+            const AlarmLevel to = classify(value, from);
+            uint32_t next;
+            if (to == from)
+            {
+                if (!(state & PENDING))
+                    return false;
+                next = state & ~(PENDING | 0xF00u);     //back before the delay passed
+            }
+            else
+            {
+                const int64_t delay = delayOf(from, to);
+                if (delay > 0 && now == 0)
+                    now = nowNanoseconds();
+                if (delay <= 0 || ((state & PENDING) && pendingOf(state) == to &&
+                    now - m_pendingSince.load(std::memory_order_relaxed) >= delay))
+                    next = enter(state, to);
+                else if ((state & PENDING) && pendingOf(state) == to)
+                    return false;                       //still waiting
+                else
+                {
+                    m_pendingSince.store(now, std::memory_order_relaxed);
+                    next = (state & (ACKED | 0xF)) | PENDING | (static_cast<uint32_t>(to) << 8);
+                }
+            }
+            if (!m_state.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_acquire))
+                continue;
+            if (next & PENDING)
+            {
+                delayed = true;
+                return false;
+            }
+            if (levelOf(next) == from)
+                return false;
+            transition.m_from = from;
+            transition.m_to = levelOf(next);
+            transition.m_acknowledged = (next & ACKED) != 0;
+            transition.m_value = value;
+            transition.m_timestamp = now != 0 ? now : nowNanoseconds();
+            return true;
+        }
+    }
+
+    bool SymbolAlarm::expire(int64_t now, AlarmTransition& transition) noexcept
+    {
+        uint32_t state = m_state.load(std::memory_order_acquire);
+        for (;;)
+        {
+            if (!(state & PENDING))
+                return false;
+            const AlarmLevel from = levelOf(state);
+            const AlarmLevel to = pendingOf(state);
+            if (now - m_pendingSince.load(std::memory_order_relaxed) < delayOf(from, to))
+                return false;
+            const uint32_t next = enter(state, to);
+            if (!m_state.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_acquire))
+                continue;
+            transition.m_from = from;
+            transition.m_to = to;
+            transition.m_acknowledged = (next & ACKED) != 0;
+            transition.m_value = m_lastValue.load(std::memory_order_relaxed);
+            transition.m_timestamp = now;
+            return true;
+        }
+    }
+
+    bool SymbolAlarm::acknowledge(AlarmTransition& transition) noexcept
+    {
+        const uint32_t state = m_state.fetch_or(ACKED, std::memory_order_acq_rel);
+        if (state & ACKED)
+            return false;
+        transition.m_from = transition.m_to = levelOf(state);
+        transition.m_acknowledged = true;
+        transition.m_value = m_lastValue.load(std::memory_order_relaxed);
+        transition.m_timestamp = nowNanoseconds();
+        return true;
+    }
+}
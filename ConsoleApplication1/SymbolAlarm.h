@@ -0,0 +1,159 @@
+// SymbolAlarm.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. HI/HIHI/LO/LOLO alarms with deadband, on and off delays and acknowledgement.
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace Symbols {
+
+    enum class AlarmLevel : uint8_t {
+        al_Normal = 0,
+        al_Lo,
+        al_LoLo,
+        al_Hi,
+        al_HiHi
+    };
+
+    /*
+    *   the limits of an alarm point, see SymbolTable::EnableAlarm(). A limit left infinite is not checked.
+    *   A level is entered when the value reaches its limit and left when the value is back by more than
+    *   m_deadband. A more severe level, or one on the other side, is entered after the value stayed there
+    *   for m_onDelay, a less severe one or normal after m_offDelay.
+    */
+    struct AlarmLimits {
+        double m_hihi{ std::numeric_limits<double>::infinity() };
+        double m_hi{ std::numeric_limits<double>::infinity() };
+        double m_lo{ -std::numeric_limits<double>::infinity() };
+        double m_lolo{ -std::numeric_limits<double>::infinity() };
+        double m_deadband{};
+        std::chrono::milliseconds m_onDelay{};
+        std::chrono::milliseconds m_offDelay{};
+    };
+
+    /*
+    *   a change of the state of an alarm point, passed to the alarm events.
+    *   An acknowledgement reports m_from == m_to with m_acknowledged set.
+    */
+    struct AlarmTransition {
+        uint32_t m_id{};
+        AlarmLevel m_from{ AlarmLevel::al_Normal };
+        AlarmLevel m_to{ AlarmLevel::al_Normal };
+        bool m_acknowledged{};
+        double m_value{};
+        int64_t m_timestamp{};  //nanoseconds since the epoch
+    };
+
+    /*
+    *   the state of an alarm point, returned by SymbolTable::ActiveAlarms().
+    */
+    struct AlarmStatus {
+        uint32_t m_id{};
+        AlarmLevel m_level{ AlarmLevel::al_Normal };
+        bool m_acknowledged{};
+    };
+
+    /*
+    *   SymbolAlarm is the state machine of one alarm point. The thresholds with the deadband applied are
+    *   computed once from the limits, so a value inside the normal band costs two comparisons.
+    *   The level, the acknowledgement and a pending delayed level share one atomic word, so an
+    *   acknowledgement from another thread does not race with the writer of the symbol.
+    *   Entering a level from normal, or a more severe one, clears the acknowledgement.
+    */
+    class SymbolAlarm
+    {
+    public:
+        explicit SymbolAlarm(const AlarmLimits& limits) noexcept;
+
+        SymbolAlarm(const SymbolAlarm& r) = delete;
+        SymbolAlarm& operator=(const SymbolAlarm& r) = delete;
+
+        const AlarmLimits& getLimits() const noexcept {
+            return m_limits;
+        }
+
+        /*
+        *   evaluate a new value of the symbol.
+        *   Params:
+        *   value: the new value.
+        *   transition: receives the transition, m_id is left to the caller.
+        *   delayed: set to true when the value starts a delay, the caller has to call expire() later.
+        *   Returns: true if the level changed.
+        */
+        bool update(double value, AlarmTransition& transition, bool& delayed) noexcept;
+
+        /*
+        *   complete a pending delayed level whose delay has passed.
+        *   Params:
+        *   now: nanoseconds since the epoch.
+        *   transition: receives the transition.
+        *   Returns: true if the level changed.
+        */
+        bool expire(int64_t now, AlarmTransition& transition) noexcept;
+
+        /*
+        *   acknowledge the alarm.
+        *   returns true if it was not acknowledged, transition receives the acknowledgement.
+        */
+        bool acknowledge(AlarmTransition& transition) noexcept;
+
+        AlarmLevel level() const noexcept {
+            return levelOf(m_state.load(std::memory_order_acquire));
+        }
+
+        bool acknowledged() const noexcept {
+            return (m_state.load(std::memory_order_acquire) & ACKED) != 0;
+        }
+
+        //a level waits for its delay
+        bool pending() const noexcept {
+            return (m_state.load(std::memory_order_acquire) & PENDING) != 0;
+        }
+
+        //0 for normal, 1 for HI and LO, 2 for HIHI and LOLO
+        static int severity(AlarmLevel level) noexcept {
+            return level == AlarmLevel::al_Normal ? 0 : (level == AlarmLevel::al_Hi || level == AlarmLevel::al_Lo ? 1 : 2);
+        }
+
+    private:
+        //the state word: the level in bits 0-3, the pending level in bits 8-11
+        static inline constexpr uint32_t ACKED = 1u << 4;
+        static inline constexpr uint32_t PENDING = 1u << 5;
+
+        static AlarmLevel levelOf(uint32_t state) noexcept {
+            return static_cast<AlarmLevel>(state & 0xF);
+        }
+
+        static AlarmLevel pendingOf(uint32_t state) noexcept {
+            return static_cast<AlarmLevel>((state >> 8) & 0xF);
+        }
+
+        AlarmLevel classify(double value, AlarmLevel current) const noexcept;
+        int64_t delayOf(AlarmLevel from, AlarmLevel to) const noexcept;
+        static uint32_t enter(uint32_t state, AlarmLevel level) noexcept;
+
+        //read by every update(), kept together at the start of the object
+        std::atomic<uint32_t> m_state{ ACKED };
+        double m_enterLow;      //a normal value stays normal inside (m_enterLow, m_enterHigh)
+        double m_enterHigh;
+        double m_leaveHiHi;     //limits with the deadband applied, for leaving a level
+        double m_leaveHi;
+        double m_leaveLo;
+        double m_leaveLoLo;
+        std::atomic<int64_t> m_pendingSince{ 0 };
+        std::atomic<double> m_lastValue{ 0.0 };
+        AlarmLimits m_limits;
+    };
+}
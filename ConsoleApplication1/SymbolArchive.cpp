@@ -0,0 +1,373 @@
+// SymbolArchive.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolArchive.h"
+#include <algorithm>
+#include <mutex>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Symbols {
+
+    namespace {
+        /*
+        *   appends the n low bits of value to buffer, most significant bit first.
+        */
+        void writeBits(std::vector<uint8_t>& buffer, uint32_t& bitCount, uint64_t value, int n)
+        {
+            while (n > 0)
+            {
+                if (bitCount % 8 == 0)
+                    buffer.push_back(0);
+
+                const int free = 8 - static_cast<int>(bitCount % 8);
+                const int take = std::min(free, n);
+                const auto chunk = static_cast<uint8_t>((value >> (n - take)) & ((1u << take) - 1));
+                buffer.back() |= static_cast<uint8_t>(chunk << (free - take));
+                bitCount += take;
+                n -= take;
+            }
+        }
+
+        class BitReader
+        {
+        public:
+            explicit BitReader(const std::vector<uint8_t>& buffer) noexcept :
+                m_data(buffer.data()), m_size(buffer.size()) {}
+
+            uint64_t read(int n) noexcept
+            {
+                if (n > 56)
+                {
+                    const uint64_t high = read(n - 32);
+                    return (high << 32) | read(32);
+                }
+
+                const size_t byte = m_pos / 8;
+                const int offset = static_cast<int>(m_pos % 8);
+                m_pos += n;
+                if (n == 0)
+                    return 0;
+
+                //fast path: take the bits out of a big endian 64 bit window
+                uint64_t window = 0;
+                if (byte + 8 <= m_size)
+                {
+                    for (int i = 0; i < 8; i++)
+                        window = (window << 8) | m_data[byte + i];
+                }
+                else
+                {
+                    for (int i = 0; i < 8; i++)
+                        window = (window << 8) | (byte + i < m_size ? m_data[byte + i] : 0);
+                }
+                return (window << offset) >> (64 - n);
+            }
+
+            bool bit() noexcept {
+                return read(1) != 0;
+            }
+
+        private:
+            const uint8_t* m_data;
+            size_t m_size;
+            size_t m_pos{};
+        };
+
+        int64_t signExtend(uint64_t value, int n) noexcept
+        {
+            const uint64_t sign = uint64_t{ 1 } << (n - 1);
+            return static_cast<int64_t>((value ^ sign) - sign);
+        }
+
+        uint64_t zigzag(int64_t value) noexcept
+        {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        int64_t unzigzag(uint64_t value) noexcept
+        {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        int leadingZeros(uint64_t value) noexcept
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            return _BitScanReverse64(&index, value) ? 63 - static_cast<int>(index) : 64;
+#else
+            return value ? __builtin_clzll(value) : 64;
+#endif
+        }
+
+        int trailingZeros(uint64_t value) noexcept
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            return _BitScanForward64(&index, value) ? static_cast<int>(index) : 64;
+#else
+            return value ? __builtin_ctzll(value) : 64;
+#endif
+        }
+
+        int valueWidth(SymbolArchive::Encoding encoding) noexcept
+        {
+            return encoding == SymbolArchive::Encoding::enc_XorFloat ? 32 : 64;
+        }
+    }
+
+    SymbolArchive::SymbolArchive(Encoding encoding, int64_t resolution, uint32_t blockSamples, size_t maxBytes) :
+        m_encoding{ encoding },
+        m_resolution{ std::max<int64_t>(resolution, 1) },
+        m_blockSamples{ std::max<uint32_t>(blockSamples, 2) },
+        m_maxBytes{ maxBytes }
+    {
+
+    }
+
+    void SymbolArchive::append(int64_t timestamp, uint64_t bits)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        encode(timestamp / m_resolution, bits);
+        if (m_open.m_count >= m_blockSamples)
+            seal();
+    }
+
+    void SymbolArchive::encode(int64_t timestamp, uint64_t bits)
+    {
+        auto& buffer = m_open.m_data;
+        const int width = valueWidth(m_encoding);
+
+        if (m_open.m_count == 0)
+        {
+            //the first sample of a block is stored verbatim
+            writeBits(buffer, m_bitCount, static_cast<uint64_t>(timestamp), 64);
+            writeBits(buffer, m_bitCount, bits, width);
+            m_open.m_first = m_open.m_last = timestamp;
+            m_open.m_count = 1;
+            m_prevTimestamp = timestamp;
+            m_prevDelta = 0;
+            m_prevBits = bits;
+            m_prevLeading = -1;
+            return;
+        }
+
+        // 1: timestamp as delta-of-delta
+        const int64_t delta = timestamp - m_prevTimestamp;
+        const int64_t dod = delta - m_prevDelta;
+        if (dod == 0)
+            writeBits(buffer, m_bitCount, 0b0, 1);
+        else if (dod >= -64 && dod <= 63)
+        {
+            writeBits(buffer, m_bitCount, 0b10, 2);
+            writeBits(buffer, m_bitCount, static_cast<uint64_t>(dod), 7);
+        }
+        else if (dod >= -256 && dod <= 255)
+        {
+            writeBits(buffer, m_bitCount, 0b110, 3);
+            writeBits(buffer, m_bitCount, static_cast<uint64_t>(dod), 9);
+        }
+        else if (dod >= -2048 && dod <= 2047)
+        {
+            writeBits(buffer, m_bitCount, 0b1110, 4);
+            writeBits(buffer, m_bitCount, static_cast<uint64_t>(dod), 12);
+        }
+        else
+        {
+            writeBits(buffer, m_bitCount, 0b1111, 4);
+            writeBits(buffer, m_bitCount, static_cast<uint64_t>(dod), 64);
+        }
+
+        // 2: value
+        if (m_encoding == Encoding::enc_VarintDelta)
+        {
+            const uint64_t zz = zigzag(static_cast<int64_t>(bits - m_prevBits));
+            if (zz == 0)
+                writeBits(buffer, m_bitCount, 0b0, 1);
+            else
+            {
+                writeBits(buffer, m_bitCount, 0b1, 1);
+                uint64_t rest = zz;
+                do
+                {
+                    const uint64_t group = rest & 0x7F;
+                    rest >>= 7;
+                    writeBits(buffer, m_bitCount, group | (rest ? 0x80 : 0), 8);
+                } while (rest);
+            }
+        }
+        else
+        {
+            const uint64_t x = bits ^ m_prevBits;
+            if (x == 0)
+                writeBits(buffer, m_bitCount, 0b0, 1);
+            else
+            {
+                const int leading = leadingZeros(x) - (64 - width);
+                const int trailing = trailingZeros(x);
+                if (m_prevLeading >= 0 && leading >= m_prevLeading && trailing >= m_prevTrailing)
+                {
+                    //meaningful bits fit into the previous window
+                    writeBits(buffer, m_bitCount, 0b10, 2);
+                    writeBits(buffer, m_bitCount, x >> m_prevTrailing, width - m_prevLeading - m_prevTrailing);
+                }
+                else
+                {
+                    const int length = width - leading - trailing;
+                    writeBits(buffer, m_bitCount, 0b11, 2);
+                    writeBits(buffer, m_bitCount, static_cast<uint64_t>(leading), 6);
+                    writeBits(buffer, m_bitCount, static_cast<uint64_t>(length & 0x3F), 6);  //64 is stored as 0
+                    writeBits(buffer, m_bitCount, x >> trailing, length);
+                    m_prevLeading = leading;
+                    m_prevTrailing = trailing;
+                }
+            }
+        }
+
+        m_open.m_last = timestamp;
+        m_open.m_count++;
+        m_prevTimestamp = timestamp;
+        m_prevDelta = delta;
+        m_prevBits = bits;
+    }
+
+    void SymbolArchive::seal()
+    {
+        m_open.m_data.shrink_to_fit();
+        m_sealed.push_back(std::move(m_open));
+        m_open = Block{};
+        m_bitCount = 0;
+
+        if (m_maxBytes == 0)
+            return;
+
+        //retention: drop the oldest blocks beyond the memory limit
+        while (!m_sealed.empty() && memoryUsageLocked() > m_maxBytes)
+            m_sealed.pop_front();
+    }
+
+    void SymbolArchive::decode(const Block& block, int64_t from, int64_t to,
+        std::vector<SymbolHistory::RawSample>& out) const
+    {
+        if (block.m_count == 0)
+            return;
+
+        BitReader reader(block.m_data);
+        const int width = valueWidth(m_encoding);
+
+        int64_t timestamp = static_cast<int64_t>(reader.read(64));
+        uint64_t bits = reader.read(width);
+        int64_t delta = 0;
+        int leading = 0, trailing = 0;
+
+        for (uint32_t i = 0;; )
+        {
+            if (timestamp > to)
+                break;      //samples are stored in time order
+            if (timestamp >= from)
+                out.push_back({ timestamp * m_resolution, bits });
+
+            if (++i == block.m_count)
+                break;
+
+            // 1: timestamp
+            int64_t dod = 0;
+            if (!reader.bit())
+                dod = 0;
+            else if (!reader.bit())
+                dod = signExtend(reader.read(7), 7);
+            else if (!reader.bit())
+                dod = signExtend(reader.read(9), 9);
+            else if (!reader.bit())
+                dod = signExtend(reader.read(12), 12);
+            else
+                dod = static_cast<int64_t>(reader.read(64));
+            delta += dod;
+            timestamp += delta;
+
+            // 2: value
+            if (!reader.bit())
+                continue;   //unchanged
+
+            if (m_encoding == Encoding::enc_VarintDelta)
+            {
+                uint64_t zz = 0;
+                for (int shift = 0;; shift += 7)
+                {
+                    const uint64_t group = reader.read(8);
+                    zz |= (group & 0x7F) << shift;
+                    if (!(group & 0x80))
+                        break;
+                }
+                bits += static_cast<uint64_t>(unzigzag(zz));
+            }
+            else
+            {
+                if (reader.bit())
+                {
+                    leading = static_cast<int>(reader.read(6));
+                    const int length = static_cast<int>(reader.read(6));
+                    trailing = width - leading - (length == 0 ? 64 : length);
+                }
+                bits ^= reader.read(width - leading - trailing) << trailing;
+            }
+        }
+    }
+
+    size_t SymbolArchive::query(int64_t from, int64_t to, std::vector<SymbolHistory::RawSample>& out) const
+    {
+        const size_t before = out.size();
+        const int64_t first = from / m_resolution;
+        const int64_t last = to / m_resolution;
+
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        //block index: skip every sealed block which ends before the range
+        auto it = std::partition_point(m_sealed.cbegin(), m_sealed.cend(),
+            [first](const Block& block) { return block.m_last < first; });
+
+        for (; it != m_sealed.cend() && it->m_first <= last; ++it)
+            decode(*it, first, last, out);
+
+        if (m_open.m_count && m_open.m_last >= first && m_open.m_first <= last)
+            decode(m_open, first, last, out);
+
+        return out.size() - before;
+    }
+
+    size_t SymbolArchive::sampleCount() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        size_t count = m_open.m_count;
+        for (const auto& block : m_sealed)
+            count += block.m_count;
+        return count;
+    }
+
+    size_t SymbolArchive::blockCount() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_sealed.size() + (m_open.m_count ? 1 : 0);
+    }
+
+    size_t SymbolArchive::memoryUsage() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return memoryUsageLocked();
+    }
+
+    size_t SymbolArchive::memoryUsageLocked() const noexcept
+    {
+        size_t bytes = sizeof(SymbolArchive) + m_open.m_data.capacity();
+        for (const auto& block : m_sealed)
+            bytes += sizeof(Block) + block.m_data.capacity();
+        return bytes;
+    }
+}
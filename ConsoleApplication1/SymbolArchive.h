@@ -0,0 +1,119 @@
+// SymbolArchive.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Compressed long term history of (timestamp, value) samples per symbol.
+
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <vector>
+#include "SymbolHistory.h"
+
+namespace Symbols {
+
+    /*
+    *   SymbolArchive keeps the history of one symbol compressed in blocks.
+    *   Timestamps are stored as delta-of-delta, floating point values are XOR'ed with the previous
+    *   value (Gorilla style) and integer values are stored as zigzag varint deltas.
+    *   Every block records its first and last timestamp, so a range query only decodes the blocks
+    *   it touches. Timestamps are quantized to the resolution given at construction.
+    */
+    class SymbolArchive
+    {
+    public:
+        enum class Encoding {
+            enc_VarintDelta = 0,    //booleans, integers and date time values
+            enc_XorFloat,           //32 bit IEEE 754
+            enc_XorDouble           //64 bit IEEE 754
+        };
+
+        static inline constexpr int64_t DEFAULT_RESOLUTION = 1000000;    //nanoseconds, 1 ms
+        static inline constexpr uint32_t DEFAULT_BLOCK_SAMPLES = 1024;
+
+        /*
+        *   encoding: how the raw values are compressed.
+        *   resolution: timestamp resolution in nanoseconds.
+        *   blockSamples: number of samples per block before it is sealed.
+        *   maxBytes: memory limit, the oldest blocks are dropped beyond it. 0 means unlimited.
+        */
+        explicit SymbolArchive(Encoding encoding, int64_t resolution = DEFAULT_RESOLUTION,
+            uint32_t blockSamples = DEFAULT_BLOCK_SAMPLES, size_t maxBytes = 0);
+        virtual ~SymbolArchive() = default;  //destructor
+
+        SymbolArchive(const SymbolArchive& r) = delete;
+        SymbolArchive& operator=(const SymbolArchive& r) = delete;
+
+        /*
+        *   append a sample. Timestamps are expected in ascending order.
+        *   returns nothing.
+        */
+        void append(int64_t timestamp, uint64_t bits);
+
+        /*
+        *   decode the samples whose timestamp lies in [from, to] into out, oldest first.
+        *   returns the number of samples appended to out.
+        */
+        size_t query(int64_t from, int64_t to, std::vector<SymbolHistory::RawSample>& out) const;
+
+        /*
+        *   get the number of samples currently held.
+        */
+        size_t sampleCount() const;
+
+        /*
+        *   get the number of blocks including the open one.
+        */
+        size_t blockCount() const;
+
+        /*
+        *   get the memory occupied by the compressed blocks.
+        *   returns the size in bytes.
+        */
+        size_t memoryUsage() const;
+
+        Encoding getEncoding() const noexcept {
+            return m_encoding;
+        }
+
+    private:
+        struct Block {
+            int64_t m_first{};      //first timestamp in resolution units
+            int64_t m_last{};       //last timestamp in resolution units
+            uint32_t m_count{};     //number of samples
+            std::vector<uint8_t> m_data;
+        };
+
+        void encode(int64_t timestamp, uint64_t bits);
+        void seal();
+        void decode(const Block& block, int64_t from, int64_t to,
+            std::vector<SymbolHistory::RawSample>& out) const;
+        size_t memoryUsageLocked() const noexcept;
+
+        Encoding m_encoding;
+        int64_t m_resolution;
+        uint32_t m_blockSamples;
+        size_t m_maxBytes;
+
+        std::deque<Block> m_sealed;
+        Block m_open;
+
+        //encoder state of the open block
+        uint32_t m_bitCount{};
+        int64_t m_prevTimestamp{};
+        int64_t m_prevDelta{};
+        uint64_t m_prevBits{};
+        int m_prevLeading{ -1 };
+        int m_prevTrailing{};
+
+        mutable std::shared_mutex m_mutex;
+    };
+}
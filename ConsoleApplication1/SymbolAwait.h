@@ -0,0 +1,250 @@
+// SymbolAwait.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. C++20 coroutine watches: SymbolTable::NextChange(), WaitUntil() and Changes().
+
+#pragma once
+#include "Symbols.h"
+
+//the watches need the coroutine support of C++20, a C++17 build compiles them out
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define SYMBOLS_COROUTINES 1
+#else
+#define SYMBOLS_COROUTINES 0
+#endif
+
+#if SYMBOLS_COROUTINES
+#include <coroutine>
+#include <deque>
+#include <mutex>
+
+namespace Symbols {
+
+    namespace detail {
+        inline void resumeCoroutine(void* address)
+        {
+            std::coroutine_handle<>::from_address(address).resume();
+        }
+    }
+
+    /*
+    *   the awaitable of SymbolTable::NextChange(). The coroutine is resumed with the new value by the next
+    *   reported change of the symbol, on the executor of the table. A waiting coroutine must not be
+    *   destroyed and the table has to outlive it.
+    */
+    class ChangeAwaiter : private ChangeWaiter
+    {
+    public:
+        ChangeAwaiter(SymbolTable& table, uint32_t id) noexcept : m_table(table)
+        {
+            m_id = id;
+            m_notify = &ChangeAwaiter::notify;
+            m_resume = &detail::resumeCoroutine;
+        }
+
+        ChangeAwaiter(const ChangeAwaiter& r) = delete;
+        ChangeAwaiter& operator=(const ChangeAwaiter& r) = delete;
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        //returns false to go on right away if the symbol does not exist
+        bool await_suspend(std::coroutine_handle<> coroutine) {
+            m_context = coroutine.address();
+            return m_table.addWaiter(*this);
+        }
+
+        std::any await_resume() noexcept {
+            return std::move(m_value);
+        }
+
+    private:
+        static bool notify(ChangeWaiter& waiter, SymbolCodec::ChangeType change, const Symbol& symbol) {
+            if (change != SymbolCodec::ChangeType::ct_Delete)
+                static_cast<ChangeAwaiter&>(waiter).m_value = symbol.get();
+            return true;
+        }
+
+        SymbolTable& m_table;
+        std::any m_value;
+    };
+
+    /*
+    *   the awaitable of SymbolTable::WaitUntil(). A value which satisfies the predicate already does not suspend,
+    *   otherwise the coroutine is resumed by the first reported change which does, on the executor of the table.
+    *   A waiting coroutine must not be destroyed and the table has to outlive it.
+    */
+    class ConditionAwaiter : private ChangeWaiter
+    {
+    public:
+        ConditionAwaiter(SymbolTable& table, uint32_t id, std::function<bool(const Symbol&)> predicate) :
+            m_table(table), m_predicate(std::move(predicate))
+        {
+            m_id = id;
+            m_notify = &ConditionAwaiter::notify;
+            m_resume = &detail::resumeCoroutine;
+        }
+
+        ConditionAwaiter(const ConditionAwaiter& r) = delete;
+        ConditionAwaiter& operator=(const ConditionAwaiter& r) = delete;
+
+        bool await_ready() {
+            return test();
+        }
+
+        //a change between await_ready() and the registration is not notified, so it tests once more
+        bool await_suspend(std::coroutine_handle<> coroutine) {
+            m_context = coroutine.address();
+            return m_table.addWaiter(*this, true);
+        }
+
+        std::any await_resume() noexcept {
+            return std::move(m_value);
+        }
+
+    private:
+        //true if the symbol does not exist or its current value satisfies the predicate
+        bool test() {
+            const Symbol symbol = m_table.GetValue(m_id);
+            if (symbol.getId() == m_id && !m_predicate(symbol))
+                return false;
+            m_value = symbol.get();
+            return true;
+        }
+
+        static bool notify(ChangeWaiter& waiter, SymbolCodec::ChangeType change, const Symbol& symbol) {
+            auto& awaiter = static_cast<ConditionAwaiter&>(waiter);
+            if (change == SymbolCodec::ChangeType::ct_Delete)
+                return true;
+            if (!awaiter.m_predicate(symbol))
+                return false;
+            awaiter.m_value = symbol.get();
+            return true;
+        }
+
+        SymbolTable& m_table;
+        std::function<bool(const Symbol&)> m_predicate;
+        std::any m_value;
+    };
+
+    //a change delivered by a ChangeStream
+    struct SymbolChange {
+        uint32_t m_id{};
+        SymbolCodec::ChangeType m_change{ SymbolCodec::ChangeType::ct_Set };
+        std::any m_value;   //empty for ct_Delete
+    };
+
+    /*
+    *   the changes of the symbols under a name prefix, see SymbolTable::Changes(). The changes are queued from
+    *   the construction on, a coroutine takes them one by one with co_await next():
+    *       auto changes = table.Changes("plant.line1.");
+    *       for (;;) {
+    *           SymbolChange change = co_await changes.next();
+    *           ...
+    *       }
+    *   Only one coroutine may wait in next() at a time. The queue grows while the coroutine falls behind.
+    *   The table has to outlive the stream.
+    */
+    class ChangeStream : private ChangeWaiter
+    {
+    public:
+        ChangeStream(SymbolTable& table, std::string prefix) : m_table(table)
+        {
+            m_prefix = std::move(prefix);
+            m_byPrefix = true;
+            m_persistent = true;
+            m_notify = &ChangeStream::notify;
+            m_resume = &detail::resumeCoroutine;
+            m_table.addWaiter(*this);
+        }
+
+        ~ChangeStream()
+        {
+            m_table.removeWaiter(*this);
+        }
+
+        ChangeStream(const ChangeStream& r) = delete;
+        ChangeStream& operator=(const ChangeStream& r) = delete;
+
+        class NextAwaiter
+        {
+        public:
+            explicit NextAwaiter(ChangeStream& stream) noexcept : m_stream(stream) {}
+
+            bool await_ready() {
+                std::lock_guard<std::mutex> lock(m_stream.m_queueMutex);
+                return !m_stream.m_queue.empty();
+            }
+
+            bool await_suspend(std::coroutine_handle<> coroutine) {
+                std::lock_guard<std::mutex> lock(m_stream.m_queueMutex);
+                if (!m_stream.m_queue.empty())
+                    return false;
+                m_stream.m_context = coroutine.address();
+                m_stream.m_waiting = true;
+                return true;
+            }
+
+            SymbolChange await_resume() {
+                std::lock_guard<std::mutex> lock(m_stream.m_queueMutex);
+                SymbolChange change = std::move(m_stream.m_queue.front());
+                m_stream.m_queue.pop_front();
+                return change;
+            }
+
+        private:
+            ChangeStream& m_stream;
+        };
+
+        //co_await the next change
+        NextAwaiter next() noexcept {
+            return NextAwaiter(*this);
+        }
+
+        //number of changes queued
+        size_t pending() const {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            return m_queue.size();
+        }
+
+    private:
+        static bool notify(ChangeWaiter& waiter, SymbolCodec::ChangeType change, const Symbol& symbol) {
+            auto& stream = static_cast<ChangeStream&>(waiter);
+            std::lock_guard<std::mutex> lock(stream.m_queueMutex);
+            stream.m_queue.push_back({ symbol.getId(), change,
+                change == SymbolCodec::ChangeType::ct_Delete ? std::any() : symbol.get() });
+            //resume the coroutine once, the changes until it runs are queued
+            return std::exchange(stream.m_waiting, false);
+        }
+
+        SymbolTable& m_table;
+        std::deque<SymbolChange> m_queue;
+        mutable std::mutex m_queueMutex;
+        bool m_waiting{};   //a coroutine waits in next()
+    };
+
+    inline ChangeAwaiter SymbolTable::NextChange(uint32_t id)
+    {
+        return ChangeAwaiter(*this, id);
+    }
+
+    inline ConditionAwaiter SymbolTable::WaitUntil(uint32_t id, std::function<bool(const Symbol&)> predicate)
+    {
+        return ConditionAwaiter(*this, id, std::move(predicate));
+    }
+
+    inline ChangeStream SymbolTable::Changes(std::string prefix)
+    {
+        return ChangeStream(*this, std::move(prefix));
+    }
+}
+#endif
@@ -0,0 +1,201 @@
+// SymbolCodec.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolCodec.h"
+#include "Symbols.h"
+
+namespace Symbols {
+
+    size_t SymbolCodec::beginFrame(std::vector<uint8_t>& buffer, uint8_t frameType)
+    {
+        const size_t frameStart = buffer.size();
+        ByteWriter writer(buffer);
+        writer.put(uint32_t{ 0 });
+        writer.put(frameType);
+        return frameStart;
+    }
+
+    void SymbolCodec::endFrame(std::vector<uint8_t>& buffer, size_t frameStart) noexcept
+    {
+        const auto length = static_cast<uint32_t>(buffer.size() - frameStart - FRAME_HEADER_SIZE);
+        std::memcpy(buffer.data() + frameStart, &length, sizeof(length));
+    }
+
+    bool SymbolCodec::encodeValue(ByteWriter& writer, SymbolType type, const std::any& value)
+    {
+        uint64_t bits;
+        if (Symbol::toRaw(type, value, bits))
+        {
+            writer.put(bits);
+            return true;
+        }
+
+        const void* data;
+        size_t count;
+        if (Symbol::arrayData(type, value, data, count))
+        {
+            writer.put(static_cast<uint32_t>(count));
+            writer.putBytes(data, count * Symbol::elementSize(type));
+            return true;
+        }
+
+        switch (type)
+        {
+        case SymbolType::st_String:
+        case SymbolType::st_WideString:
+        {
+            const auto* text = std::any_cast<std::string>(&value);
+            if (!text)
+                return false;
+            writer.put(static_cast<uint32_t>(text->size()));
+            writer.putBytes(text->data(), text->size());
+            return true;
+        }
+
+        case SymbolType::st_Struct:
+        {
+            //the type name, the receiver looks the layout up in its own registry
+            const auto* structValue = std::any_cast<StructValue>(&value);
+            if (!structValue || !structValue->getLayout())
+                return false;
+            writer.putString(structValue->getLayout()->getName());
+            writer.put(static_cast<uint32_t>(structValue->size()));
+            writer.putBytes(structValue->data(), structValue->size());
+            return true;
+        }
+
+        case SymbolType::st_Guid:
+        {
+            const auto* guid = std::any_cast<Guid>(&value);
+            if (!guid)
+                return false;
+            writer.put(*guid);
+            return true;
+        }
+
+        default:
+            //no payload, but only if the symbol does not hold anything either
+            return !value.has_value();
+        }
+    }
+
+    bool SymbolCodec::decodeValue(ByteReader& reader, SymbolType type, std::any& value)
+    {
+        if (Symbol::isScalar(type))
+        {
+            uint64_t bits;
+            if (!reader.get(bits))
+                return false;
+            value = Symbol::fromRaw(type, bits);
+            return true;
+        }
+
+        if (Symbol::isArray(type))
+        {
+            uint32_t count;
+            const uint8_t* data;
+            const size_t elementSize = Symbol::elementSize(type);
+            if (!reader.get(count) || reader.remaining() / elementSize < count ||
+                !reader.getView(data, count * elementSize))
+                return false;
+            value = Symbol::arrayFromBytes(type, data, count);
+            return true;
+        }
+
+        switch (type)
+        {
+        case SymbolType::st_String:
+        case SymbolType::st_WideString:
+        {
+            uint32_t length;
+            if (!reader.get(length) || reader.remaining() < length)
+                return false;
+            std::string text(length, '\0');
+            reader.getBytes(text.data(), length);
+            value = std::move(text);
+            return true;
+        }
+
+        case SymbolType::st_Struct:
+        {
+            std::string typeName;
+            uint32_t size;
+            const uint8_t* data;
+            if (!reader.getString(typeName) || !reader.get(size) || !reader.getView(data, size))
+                return false;
+            //a type which is not registered here or has another size cannot be decoded
+            auto layout = StructLayout::find(typeName);
+            if (!layout || layout->size() != size)
+                return false;
+            StructValue structValue(std::move(layout));
+            structValue.write(0, data, size);
+            value = std::move(structValue);
+            return true;
+        }
+
+        case SymbolType::st_Guid:
+        {
+            Guid guid;
+            if (!reader.get(guid))
+                return false;
+            value = guid;
+            return true;
+        }
+
+        default:
+            value.reset();
+            return true;
+        }
+    }
+
+    void SymbolCodec::encodeChange(ByteWriter& writer, ChangeType change, const Symbol& symbol, int64_t timestamp)
+    {
+        writer.put(static_cast<uint8_t>(change));
+        writer.put(symbol.getId());
+        writer.put(static_cast<uint16_t>(symbol.getType()));
+        writer.put(timestamp);
+        if (change == ChangeType::ct_Insert)
+            writer.putString(symbol.getName());
+        if (change == ChangeType::ct_Delete)
+            return;
+
+        //the flag is patched if the value does not match the type
+        const size_t flag = writer.size();
+        writer.put(uint8_t{ 1 });
+        if (!encodeValue(writer, symbol.getType(), symbol.get()))
+            writer.buffer()[flag] = 0;
+    }
+
+    bool SymbolCodec::decodeChange(ByteReader& reader, Change& change)
+    {
+        uint8_t changeType;
+        uint16_t symbolType;
+        if (!reader.get(changeType) || !reader.get(change.m_id) ||
+            !reader.get(symbolType) || !reader.get(change.m_timestamp))
+            return false;
+
+        if (changeType > static_cast<uint8_t>(ChangeType::ct_Set) || symbolType >= SYMBOL_TYPE_COUNT)
+            return false;
+
+        change.m_change = static_cast<ChangeType>(changeType);
+        change.m_type = static_cast<SymbolType>(symbolType);
+        change.m_name.clear();
+        change.m_value.reset();
+
+        if (change.m_change == ChangeType::ct_Insert && !reader.getString(change.m_name))
+            return false;
+        if (change.m_change == ChangeType::ct_Delete)
+            return true;
+
+        uint8_t hasValue;
+        if (!reader.get(hasValue))
+            return false;
+        return !hasValue || decodeValue(reader, change.m_type, change.m_value);
+    }
+}
@@ -0,0 +1,211 @@
+// SymbolCodec.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Binary encoding of symbol values and table changes for the wire.
+//  *Added frame helpers shared by the subscription server and replication.
+//  *Array types and ByteString are written as 32 bit element count and the elements.
+//  *A struct is written as its type name, 32 bit size and the block.
+
+#pragma once
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "SymbolTraits.h"
+
+namespace Symbols {
+
+    class Symbol;   //incomplete type declaration
+
+    /*
+    *   ByteWriter appends little endian values to a byte buffer.
+    */
+    class ByteWriter
+    {
+    public:
+        explicit ByteWriter(std::vector<uint8_t>& buffer) noexcept : m_buffer(buffer) {}
+
+        template<typename T>
+        void put(T value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "only plain values can be written");
+            const size_t offset = m_buffer.size();
+            m_buffer.resize(offset + sizeof(T));
+            std::memcpy(m_buffer.data() + offset, &value, sizeof(T));
+        }
+
+        void putBytes(const void* data, size_t size)
+        {
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+        }
+
+        /*
+        *   write a string prefixed by its 16 bit length, longer strings are cut.
+        */
+        void putString(const std::string& text)
+        {
+            const auto length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+            put(length);
+            putBytes(text.data(), length);
+        }
+
+        size_t size() const noexcept {
+            return m_buffer.size();
+        }
+
+        std::vector<uint8_t>& buffer() noexcept {
+            return m_buffer;
+        }
+
+    private:
+        std::vector<uint8_t>& m_buffer;
+    };
+
+    /*
+    *   ByteReader reads little endian values written by ByteWriter.
+    *   Reading past the end sets the reader to failed, every further read fails as well.
+    */
+    class ByteReader
+    {
+    public:
+        ByteReader(const uint8_t* data, size_t size) noexcept : m_pos(data), m_end(data + size) {}
+
+        template<typename T>
+        bool get(T& value) noexcept
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "only plain values can be read");
+            if (!m_ok || static_cast<size_t>(m_end - m_pos) < sizeof(T))
+                return m_ok = false;
+            std::memcpy(&value, m_pos, sizeof(T));
+            m_pos += sizeof(T);
+            return true;
+        }
+
+        bool getBytes(void* data, size_t size) noexcept
+        {
+            if (!m_ok || static_cast<size_t>(m_end - m_pos) < size)
+                return m_ok = false;
+            std::memcpy(data, m_pos, size);
+            m_pos += size;
+            return true;
+        }
+
+        /*
+        *   point to the next size bytes instead of copying them.
+        */
+        bool getView(const uint8_t*& data, size_t size) noexcept
+        {
+            if (!m_ok || static_cast<size_t>(m_end - m_pos) < size)
+                return m_ok = false;
+            data = m_pos;
+            m_pos += size;
+            return true;
+        }
+
+        bool getString(std::string& text)
+        {
+            uint16_t length;
+            if (!get(length) || static_cast<size_t>(m_end - m_pos) < length)
+                return m_ok = false;
+            text.assign(reinterpret_cast<const char*>(m_pos), length);
+            m_pos += length;
+            return true;
+        }
+
+        bool ok() const noexcept {
+            return m_ok;
+        }
+
+        size_t remaining() const noexcept {
+            return static_cast<size_t>(m_end - m_pos);
+        }
+
+    private:
+        const uint8_t* m_pos;
+        const uint8_t* m_end;
+        bool m_ok{ true };
+    };
+
+    /*
+    *   SymbolCodec writes symbol values and table changes in a compact binary form.
+    *   Values: scalar types as their raw 64 bit representation (see Symbol::getRaw()),
+    *   strings as 32 bit length and bytes, Guid as 16 bytes, arrays and ByteString as 32 bit
+    *   element count and the elements in host (little endian) order, a struct as its type name
+    *   (16 bit length), 32 bit size and the block. Other types have no payload.
+    *   A change record is: u8 ChangeType, u32 id, u16 SymbolType, i64 timestamp (ns since
+    *   system_clock epoch), the name for inserts, then unless the symbol was deleted a u8 flag
+    *   and the value if the flag is 1. The flag is 0 if the value does not match the symbol type.
+    */
+    class SymbolCodec
+    {
+    public:
+        enum class ChangeType : uint8_t {
+            ct_Insert = 0,
+            ct_Delete,
+            ct_Set
+        };
+
+        /*
+        *   a decoded change record.
+        */
+        struct Change {
+            ChangeType m_change{ ChangeType::ct_Set };
+            uint32_t m_id{};
+            SymbolType m_type{ SymbolType::st_Null };
+            int64_t m_timestamp{};
+            std::string m_name;     //only set for ct_Insert
+            std::any m_value;       //empty for ct_Delete
+        };
+
+        //every frame on the wire: u32 payload length, u8 frame type, payload
+        static inline constexpr size_t FRAME_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+
+        /*
+        *   append a frame header with the length left open.
+        *   returns the offset of the frame, to pass to endFrame() once the payload is written.
+        */
+        static size_t beginFrame(std::vector<uint8_t>& buffer, uint8_t frameType);
+
+        /*
+        *   fill in the payload length of the frame started at frameStart.
+        *   returns nothing.
+        */
+        static void endFrame(std::vector<uint8_t>& buffer, size_t frameStart) noexcept;
+
+        /*
+        *   append the value of the given type.
+        *   returns false if the value does not hold the C++ type of the symbol type, nothing is written then.
+        */
+        static bool encodeValue(ByteWriter& writer, SymbolType type, const std::any& value);
+
+        /*
+        *   read a value of the given type.
+        *   returns true if successful, otherwise false.
+        */
+        static bool decodeValue(ByteReader& reader, SymbolType type, std::any& value);
+
+        /*
+        *   append a change record of a symbol.
+        *   returns nothing.
+        */
+        static void encodeChange(ByteWriter& writer, ChangeType change, const Symbol& symbol, int64_t timestamp);
+
+        /*
+        *   read a change record.
+        *   returns true if successful, otherwise false.
+        */
+        static bool decodeChange(ByteReader& reader, Change& change);
+    };
+}
@@ -0,0 +1,710 @@
+// SymbolExpression.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolExpression.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace Symbols {
+
+    namespace {
+        //the type an operand of a number computes in, booleans count as the integers 0 and 1
+        SymbolExpression::ValueType numeric(SymbolExpression::ValueType a, SymbolExpression::ValueType b) noexcept
+        {
+            using ValueType = SymbolExpression::ValueType;
+            return a == ValueType::vt_Double || b == ValueType::vt_Double ? ValueType::vt_Double : ValueType::vt_Int;
+        }
+
+        template<typename T>
+        bool fitsInteger(int64_t value) noexcept
+        {
+            if constexpr (std::is_same_v<T, int64_t> || std::is_same_v<T, long long>)
+                return true;
+            else if constexpr (std::is_signed_v<T>)
+                return value >= std::numeric_limits<T>::min() && value <= std::numeric_limits<T>::max();
+            else
+                return value >= 0 && static_cast<uint64_t>(value) <= std::numeric_limits<T>::max();
+        }
+    }
+
+    template<typename T>
+    bool SymbolExpression::loadSymbol(const Symbol& symbol, Slot& slot) noexcept
+    {
+        const T* value = symbol.get<T>();
+        if (!value)
+            return false;
+        if constexpr (std::is_floating_point_v<T>)
+            slot.m_double = static_cast<double>(*value);
+        else
+            slot.m_int = static_cast<int64_t>(*value);
+        return true;
+    }
+
+    /*
+    *   recursive descent over the text into a small tree, typed while it is built, which is then
+    *   emitted as bytecode. The tree only lives during compile().
+    */
+    struct SymbolExpression::Parser {
+        enum class Kind {
+            nk_Constant = 0,
+            nk_Symbol,
+            nk_Unary,
+            nk_Binary,
+            nk_Ternary,
+            nk_Call
+        };
+
+        struct Node {
+            Kind m_kind{ Kind::nk_Constant };
+            std::string m_op;   //operator or function name
+            ValueType m_type{ ValueType::vt_Bool };
+            Slot m_constant{};
+            uint32_t m_slot{};
+            load_t m_load{};
+            std::vector<std::unique_ptr<Node>> m_children;
+        };
+        using node_t = std::unique_ptr<Node>;
+
+        SymbolTable& m_table;
+        const std::string& m_text;
+        SymbolExpression& m_expression;
+        size_t m_pos{ 0 };
+        std::string m_error;
+        size_t m_depth{ 0 };
+        size_t m_maxDepth{ 0 };
+
+        Parser(SymbolTable& table, const std::string& text, SymbolExpression& expression) :
+            m_table{ table },
+            m_text{ text },
+            m_expression{ expression }
+        {
+
+        }
+
+        node_t fail(const std::string& message)
+        {
+            if (m_error.empty())
+                m_error = message + " at " + std::to_string(m_pos);
+            return nullptr;
+        }
+
+        void skipSpaces() noexcept
+        {
+            while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+                m_pos++;
+        }
+
+        //consume a token if the text continues with it
+        bool match(const char* token) noexcept
+        {
+            skipSpaces();
+            const size_t length = std::char_traits<char>::length(token);
+            if (m_text.compare(m_pos, length, token) != 0)
+                return false;
+            m_pos += length;
+            return true;
+        }
+
+        bool peek(char c) noexcept
+        {
+            skipSpaces();
+            return m_pos < m_text.size() && m_text[m_pos] == c;
+        }
+
+        static bool isNameChar(char c) noexcept
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+        }
+
+        node_t make(Kind kind, std::string op, ValueType type, node_t a = nullptr, node_t b = nullptr, node_t c = nullptr)
+        {
+            auto node = std::make_unique<Node>();
+            node->m_kind = kind;
+            node->m_op = std::move(op);
+            node->m_type = type;
+            for (node_t* child : { &a, &b, &c })
+            {
+                if (*child)
+                    node->m_children.push_back(std::move(*child));
+            }
+            return node;
+        }
+
+        node_t binary(const char* op, node_t left, node_t right)
+        {
+            if (!left || !right)
+                return nullptr;
+            const std::string name = op;
+            ValueType type = numeric(left->m_type, right->m_type);
+            if (name == "/")
+                type = ValueType::vt_Double;
+            else if (name != "+" && name != "-" && name != "*" && name != "%")
+                type = ValueType::vt_Bool;
+            return make(Kind::nk_Binary, name, type, std::move(left), std::move(right));
+        }
+
+        node_t parseTernary()
+        {
+            node_t condition = parseOr();
+            if (!condition || !match("?"))
+                return condition;
+            node_t a = parseTernary();
+            if (!a)
+                return nullptr;
+            if (!match(":"))
+                return fail("expected ':'");
+            node_t b = parseTernary();
+            if (!b)
+                return nullptr;
+            const ValueType type = a->m_type == ValueType::vt_Bool && b->m_type == ValueType::vt_Bool ?
+                ValueType::vt_Bool : numeric(a->m_type, b->m_type);
+            return make(Kind::nk_Ternary, "?", type, std::move(condition), std::move(a), std::move(b));
+        }
+
+        node_t parseOr()
+        {
+            node_t left = parseAnd();
+            while (left && match("||"))
+                left = binary("||", std::move(left), parseAnd());
+            return left;
+        }
+
+        node_t parseAnd()
+        {
+            node_t left = parseEquality();
+            while (left && match("&&"))
+                left = binary("&&", std::move(left), parseEquality());
+            return left;
+        }
+
+        node_t parseEquality()
+        {
+            node_t left = parseRelational();
+            while (left)
+            {
+                if (match("=="))
+                    left = binary("==", std::move(left), parseRelational());
+                else if (match("!="))
+                    left = binary("!=", std::move(left), parseRelational());
+                else
+                    break;
+            }
+            return left;
+        }
+
+        node_t parseRelational()
+        {
+            node_t left = parseAdditive();
+            while (left)
+            {
+                if (match("<="))
+                    left = binary("<=", std::move(left), parseAdditive());
+                else if (match(">="))
+                    left = binary(">=", std::move(left), parseAdditive());
+                else if (match("<"))
+                    left = binary("<", std::move(left), parseAdditive());
+                else if (match(">"))
+                    left = binary(">", std::move(left), parseAdditive());
+                else
+                    break;
+            }
+            return left;
+        }
+
+        node_t parseAdditive()
+        {
+            node_t left = parseMultiplicative();
+            while (left)
+            {
+                if (match("+"))
+                    left = binary("+", std::move(left), parseMultiplicative());
+                else if (match("-"))
+                    left = binary("-", std::move(left), parseMultiplicative());
+                else
+                    break;
+            }
+            return left;
+        }
+
+        node_t parseMultiplicative()
+        {
+            node_t left = parseUnary();
+            while (left)
+            {
+                if (match("*"))
+                    left = binary("*", std::move(left), parseUnary());
+                else if (match("/"))
+                    left = binary("/", std::move(left), parseUnary());
+                else if (match("%"))
+                    left = binary("%", std::move(left), parseUnary());
+                else
+                    break;
+            }
+            return left;
+        }
+
+        node_t parseUnary()
+        {
+            if (match("-"))
+            {
+                node_t operand = parseUnary();
+                if (!operand)
+                    return nullptr;
+                const ValueType type = operand->m_type == ValueType::vt_Double ? ValueType::vt_Double : ValueType::vt_Int;
+                return make(Kind::nk_Unary, "-", type, std::move(operand));
+            }
+            if (peek('!') && m_text.compare(m_pos, 2, "!=") != 0)
+            {
+                m_pos++;
+                node_t operand = parseUnary();
+                return operand ? make(Kind::nk_Unary, "!", ValueType::vt_Bool, std::move(operand)) : nullptr;
+            }
+            return parsePrimary();
+        }
+
+        node_t parsePrimary()
+        {
+            skipSpaces();
+            if (m_pos >= m_text.size())
+                return fail("unexpected end");
+
+            const char c = m_text[m_pos];
+            if (c == '(')
+            {
+                m_pos++;
+                node_t inner = parseTernary();
+                if (inner && !match(")"))
+                    return fail("expected ')'");
+                return inner;
+            }
+            if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && m_pos + 1 < m_text.size() &&
+                std::isdigit(static_cast<unsigned char>(m_text[m_pos + 1]))))
+                return parseNumber();
+            if (isNameChar(c))
+                return parseName();
+            return fail(std::string("unexpected '") + c + "'");
+        }
+
+        node_t parseNumber()
+        {
+            const char* begin = m_text.c_str() + m_pos;
+            char* end = nullptr;
+            auto node = make(Kind::nk_Constant, "", ValueType::vt_Int);
+            //an integer unless it has a fraction or an exponent
+            const size_t digits = std::strspn(begin, "0123456789");
+            if (begin[digits] != '.' && begin[digits] != 'e' && begin[digits] != 'E')
+            {
+                errno = 0;
+                node->m_constant.m_int = std::strtoll(begin, &end, 10);
+                if (errno == ERANGE)
+                    return fail("integer out of range");
+            }
+            else
+            {
+                node->m_type = ValueType::vt_Double;
+                node->m_constant.m_double = std::strtod(begin, &end);
+            }
+            m_pos += static_cast<size_t>(end - begin);
+            if (m_pos < m_text.size() && isNameChar(m_text[m_pos]))
+                return fail("bad number");
+            return node;
+        }
+
+        node_t parseName()
+        {
+            const size_t start = m_pos;
+            while (m_pos < m_text.size() && isNameChar(m_text[m_pos]))
+                m_pos++;
+            const std::string name = m_text.substr(start, m_pos - start);
+
+            if (name == "true" || name == "false")
+            {
+                auto node = make(Kind::nk_Constant, "", ValueType::vt_Bool);
+                node->m_constant.m_int = name == "true" ? 1 : 0;
+                return node;
+            }
+            if (peek('('))
+                return parseCall(name);
+            return parseSymbol(name, start);
+        }
+
+        node_t parseCall(const std::string& name)
+        {
+            const size_t arguments = name == "abs" ? 1 : (name == "min" || name == "max" ? 2 : 0);
+            if (arguments == 0)
+                return fail("unknown function '" + name + "'");
+            match("(");
+            node_t a = parseTernary();
+            node_t b;
+            if (a && arguments == 2)
+            {
+                if (!match(","))
+                    return fail("expected ','");
+                b = parseTernary();
+            }
+            if (!a || (arguments == 2 && !b))
+                return nullptr;
+            if (!match(")"))
+                return fail("expected ')'");
+            const ValueType type = b ? numeric(a->m_type, b->m_type) : numeric(a->m_type, ValueType::vt_Int);
+            return make(Kind::nk_Call, name, type, std::move(a), std::move(b));
+        }
+
+        node_t parseSymbol(const std::string& name, size_t start)
+        {
+            SymbolHandle handle = m_table.Resolve(name);
+            const Symbol* symbol = handle.get();
+            if (!symbol)
+            {
+                m_pos = start;
+                return fail("unknown symbol '" + name + "'");
+            }
+
+            // 1: the load of the type the symbol stores, picked once
+            auto node = make(Kind::nk_Symbol, name, ValueType::vt_Bool);
+            visitSymbolType(symbol->getType(), [&node, symbol](auto symbolType) {
+                using T = symbol_type_t<decltype(symbolType)::value>;
+                if constexpr (std::is_arithmetic_v<T>)
+                {
+                    if (!symbol->get<T>())
+                        return;
+                    node->m_load = &loadSymbol<T>;
+                    node->m_type = std::is_same_v<T, bool> ? ValueType::vt_Bool :
+                        (std::is_floating_point_v<T> ? ValueType::vt_Double : ValueType::vt_Int);
+                }
+            });
+            if (!node->m_load)
+            {
+                m_pos = start;
+                return fail("symbol '" + name + "' is not boolean or numeric");
+            }
+
+            // 2: one slot per symbol, however often it is named
+            auto& inputs = m_expression.m_inputs;
+            const auto it = std::find(inputs.begin(), inputs.end(), handle.getId());
+            node->m_slot = static_cast<uint32_t>(it - inputs.begin());
+            if (it == inputs.end())
+            {
+                inputs.push_back(handle.getId());
+                m_expression.m_symbols.push_back(std::move(handle));
+            }
+            return node;
+        }
+
+        void emit(OpCode op, uint32_t arg = 0, Slot constant = {}, load_t load = nullptr)
+        {
+            m_expression.m_code.push_back({ op, arg, constant, load });
+        }
+
+        void push() noexcept
+        {
+            m_maxDepth = std::max(m_maxDepth, ++m_depth);
+        }
+
+        //convert the top of the stack, booleans need no conversion to integers
+        void convert(ValueType from, ValueType to)
+        {
+            if (to == ValueType::vt_Double && from != ValueType::vt_Double)
+                emit(OpCode::oc_IntToDouble);
+            else if (to == ValueType::vt_Bool && from == ValueType::vt_Int)
+                emit(OpCode::oc_IntToBool);
+            else if (to == ValueType::vt_Bool && from == ValueType::vt_Double)
+                emit(OpCode::oc_DoubleToBool);
+        }
+
+        void emitOperand(const Node& node, ValueType type)
+        {
+            emitNode(node);
+            convert(node.m_type, type);
+        }
+
+        uint32_t here() const noexcept
+        {
+            return static_cast<uint32_t>(m_expression.m_code.size());
+        }
+
+        static OpCode binaryOp(const std::string& op, bool isDouble) noexcept
+        {
+            static const struct { const char* m_op; OpCode m_int; OpCode m_double; } OPS[] = {
+                { "+", OpCode::oc_AddInt, OpCode::oc_AddDouble },
+                { "-", OpCode::oc_SubInt, OpCode::oc_SubDouble },
+                { "*", OpCode::oc_MulInt, OpCode::oc_MulDouble },
+                { "/", OpCode::oc_DivDouble, OpCode::oc_DivDouble },
+                { "%", OpCode::oc_ModInt, OpCode::oc_ModDouble },
+                { "<", OpCode::oc_LessInt, OpCode::oc_LessDouble },
+                { "<=", OpCode::oc_LessEqualInt, OpCode::oc_LessEqualDouble },
+                { ">", OpCode::oc_GreaterInt, OpCode::oc_GreaterDouble },
+                { ">=", OpCode::oc_GreaterEqualInt, OpCode::oc_GreaterEqualDouble },
+                { "==", OpCode::oc_EqualInt, OpCode::oc_EqualDouble },
+                { "!=", OpCode::oc_NotEqualInt, OpCode::oc_NotEqualDouble },
+                { "min", OpCode::oc_MinInt, OpCode::oc_MinDouble },
+                { "max", OpCode::oc_MaxInt, OpCode::oc_MaxDouble },
+            };
+            for (const auto& entry : OPS)
+            {
+                if (op == entry.m_op)
+                    return isDouble ? entry.m_double : entry.m_int;
+            }
+            return OpCode::oc_AddInt;
+        }
+
+        void emitNode(const Node& node)
+        {
+            switch (node.m_kind)
+            {
+            case Kind::nk_Constant:
+                emit(OpCode::oc_Constant, 0, node.m_constant);
+                push();
+                break;
+
+            case Kind::nk_Symbol:
+                emit(OpCode::oc_Load, node.m_slot, {}, node.m_load);
+                push();
+                break;
+
+            case Kind::nk_Unary:
+                if (node.m_op == "!")
+                {
+                    emitOperand(*node.m_children[0], ValueType::vt_Bool);
+                    emit(OpCode::oc_Not);
+                }
+                else
+                {
+                    emitOperand(*node.m_children[0], node.m_type);
+                    emit(node.m_type == ValueType::vt_Double ? OpCode::oc_NegDouble : OpCode::oc_NegInt);
+                }
+                break;
+
+            case Kind::nk_Binary:
+            case Kind::nk_Call:
+                if (node.m_op == "&&" || node.m_op == "||")
+                {
+                    //the left result stays if it decides, otherwise the right one replaces it
+                    emitOperand(*node.m_children[0], ValueType::vt_Bool);
+                    const uint32_t jump = here();
+                    emit(node.m_op == "&&" ? OpCode::oc_JumpFalseOrPop : OpCode::oc_JumpTrueOrPop);
+                    m_depth--;
+                    emitOperand(*node.m_children[1], ValueType::vt_Bool);
+                    m_expression.m_code[jump].m_arg = here();
+                }
+                else if (node.m_op == "abs")
+                {
+                    emitOperand(*node.m_children[0], node.m_type);
+                    emit(node.m_type == ValueType::vt_Double ? OpCode::oc_AbsDouble : OpCode::oc_AbsInt);
+                }
+                else
+                {
+                    //comparisons compute in the type of their operands, arithmetic in its own
+                    const ValueType type = node.m_type == ValueType::vt_Bool ?
+                        numeric(node.m_children[0]->m_type, node.m_children[1]->m_type) : node.m_type;
+                    emitOperand(*node.m_children[0], type);
+                    emitOperand(*node.m_children[1], type);
+                    emit(binaryOp(node.m_op, type == ValueType::vt_Double));
+                    m_depth--;
+                }
+                break;
+
+            case Kind::nk_Ternary:
+            {
+                emitOperand(*node.m_children[0], ValueType::vt_Bool);
+                const uint32_t toElse = here();
+                emit(OpCode::oc_JumpIfFalse);
+                m_depth--;
+                emitOperand(*node.m_children[1], node.m_type);
+                const uint32_t toEnd = here();
+                emit(OpCode::oc_Jump);
+                m_depth--;
+                m_expression.m_code[toElse].m_arg = here();
+                emitOperand(*node.m_children[2], node.m_type);
+                m_expression.m_code[toEnd].m_arg = here();
+            }
+            break;
+            }
+        }
+    };
+
+    std::shared_ptr<const SymbolExpression> SymbolExpression::compile(SymbolTable& table, const std::string& text,
+        std::string* error)
+    {
+        std::shared_ptr<SymbolExpression> expression(new SymbolExpression());
+        expression->m_text = text;
+        Parser parser(table, text, *expression);
+
+        // 1: parse into a typed tree, the symbols are resolved on the way
+        Parser::node_t root = parser.parseTernary();
+        parser.skipSpaces();
+        if (root && parser.m_pos != text.size())
+            root = parser.fail("unexpected '" + text.substr(parser.m_pos, 1) + "'");
+
+        // 2: emit the bytecode, the stack of evaluate() has a fixed size
+        if (root)
+        {
+            parser.emitNode(*root);
+            expression->m_type = root->m_type;
+            if (parser.m_maxDepth > MAX_STACK)
+            {
+                parser.m_pos = 0;
+                root = parser.fail("expression nests too deep");
+            }
+        }
+        if (!root)
+        {
+            if (error)
+                *error = parser.m_error;
+            return nullptr;
+        }
+        expression->m_code.shrink_to_fit();
+        return expression;
+    }
+
+    std::any SymbolExpression::toAny(const Value& value, SymbolType type)
+    {
+        return visitSymbolType(type, [&value](auto symbolType) -> std::any {
+            using T = symbol_type_t<decltype(symbolType)::value>;
+            if constexpr (std::is_same_v<T, bool>)
+                return value.toBool();
+            else if constexpr (std::is_floating_point_v<T>)
+                return static_cast<T>(value.toDouble());
+            else if constexpr (std::is_integral_v<T>)
+            {
+                //a double is truncated like a C cast, a value out of the range of T gives nothing
+                if (value.m_type != ValueType::vt_Double)
+                    return fitsInteger<T>(value.m_int) ? std::any(static_cast<T>(value.m_int)) : std::any();
+                const double d = value.m_double;
+                if (!(d > static_cast<double>(std::numeric_limits<T>::min()) - 1.0 &&
+                    d < static_cast<double>(std::numeric_limits<T>::max()) + 1.0))
+                    return {};
+                return static_cast<T>(d);
+            }
+            else
+                return {};
+        });
+    }
+
+    template<typename Source>
+    bool SymbolExpression::run(const Source& source, Value& result) const noexcept
+    {
+        //the integer operations wrap instead of overflowing
+        const auto wrap = [](int64_t a, int64_t b, auto op) {
+            return static_cast<int64_t>(op(static_cast<uint64_t>(a), static_cast<uint64_t>(b)));
+        };
+        //the first push goes to stack[2], top - 1 stays inside the array for the first instruction as well
+        std::array<Slot, MAX_STACK + 2> stack;
+        Slot* top = stack.data() + 1;   //the operands of a binary operation are top[-1] and top[0]
+        const Instruction* code = m_code.data();
+        const Instruction* const last = code + m_code.size();
+
+        for (const Instruction* pc = code; pc != last;)
+        {
+            const Instruction& instruction = *pc++;
+            Slot& b = *top;
+            Slot* const a = top - 1;
+            switch (instruction.m_op)
+            {
+            case OpCode::oc_Constant:
+                *++top = instruction.m_constant;
+                break;
+            case OpCode::oc_Load:
+            {
+                const Symbol* symbol = source(instruction.m_arg);
+                if (!symbol || !instruction.m_load(*symbol, *++top))
+                    return false;
+            }
+            break;
+            case OpCode::oc_IntToDouble: b.m_double = static_cast<double>(b.m_int); break;
+            case OpCode::oc_IntToBool: b.m_int = b.m_int != 0; break;
+            case OpCode::oc_DoubleToBool: b.m_int = b.m_double != 0.0; break;
+            case OpCode::oc_Not: b.m_int = b.m_int == 0; break;
+            case OpCode::oc_NegInt: b.m_int = wrap(0, b.m_int, std::minus<>()); break;
+            case OpCode::oc_NegDouble: b.m_double = -b.m_double; break;
+            case OpCode::oc_AbsInt: b.m_int = b.m_int < 0 ? wrap(0, b.m_int, std::minus<>()) : b.m_int; break;
+            case OpCode::oc_AbsDouble: b.m_double = std::fabs(b.m_double); break;
+
+            case OpCode::oc_AddInt: a->m_int = wrap(a->m_int, b.m_int, std::plus<>()); top--; break;
+            case OpCode::oc_SubInt: a->m_int = wrap(a->m_int, b.m_int, std::minus<>()); top--; break;
+            case OpCode::oc_MulInt: a->m_int = wrap(a->m_int, b.m_int, std::multiplies<>()); top--; break;
+            case OpCode::oc_ModInt:
+                if (b.m_int == 0)
+                    return false;
+                a->m_int = b.m_int == -1 ? 0 : a->m_int % b.m_int;
+                top--;
+                break;
+            case OpCode::oc_AddDouble: a->m_double += b.m_double; top--; break;
+            case OpCode::oc_SubDouble: a->m_double -= b.m_double; top--; break;
+            case OpCode::oc_MulDouble: a->m_double *= b.m_double; top--; break;
+            case OpCode::oc_DivDouble: a->m_double /= b.m_double; top--; break;
+            case OpCode::oc_ModDouble: a->m_double = std::fmod(a->m_double, b.m_double); top--; break;
+            case OpCode::oc_MinInt: a->m_int = b.m_int < a->m_int ? b.m_int : a->m_int; top--; break;
+            case OpCode::oc_MaxInt: a->m_int = a->m_int < b.m_int ? b.m_int : a->m_int; top--; break;
+            case OpCode::oc_MinDouble: a->m_double = b.m_double < a->m_double ? b.m_double : a->m_double; top--; break;
+            case OpCode::oc_MaxDouble: a->m_double = a->m_double < b.m_double ? b.m_double : a->m_double; top--; break;
+
+            case OpCode::oc_LessInt: a->m_int = a->m_int < b.m_int; top--; break;
+            case OpCode::oc_LessEqualInt: a->m_int = a->m_int <= b.m_int; top--; break;
+            case OpCode::oc_GreaterInt: a->m_int = a->m_int > b.m_int; top--; break;
+            case OpCode::oc_GreaterEqualInt: a->m_int = a->m_int >= b.m_int; top--; break;
+            case OpCode::oc_EqualInt: a->m_int = a->m_int == b.m_int; top--; break;
+            case OpCode::oc_NotEqualInt: a->m_int = a->m_int != b.m_int; top--; break;
+            case OpCode::oc_LessDouble: a->m_int = a->m_double < b.m_double; top--; break;
+            case OpCode::oc_LessEqualDouble: a->m_int = a->m_double <= b.m_double; top--; break;
+            case OpCode::oc_GreaterDouble: a->m_int = a->m_double > b.m_double; top--; break;
+            case OpCode::oc_GreaterEqualDouble: a->m_int = a->m_double >= b.m_double; top--; break;
+            case OpCode::oc_EqualDouble: a->m_int = a->m_double == b.m_double; top--; break;
+            case OpCode::oc_NotEqualDouble: a->m_int = a->m_double != b.m_double; top--; break;
+
+            case OpCode::oc_Jump:
+                pc = code + instruction.m_arg;
+                break;
+            case OpCode::oc_JumpIfFalse:
+                top--;
+                if (b.m_int == 0)
+                    pc = code + instruction.m_arg;
+                break;
+            case OpCode::oc_JumpFalseOrPop:
+                if (b.m_int == 0)
+                    pc = code + instruction.m_arg;
+                else
+                    top--;
+                break;
+            case OpCode::oc_JumpTrueOrPop:
+                if (b.m_int != 0)
+                    pc = code + instruction.m_arg;
+                else
+                    top--;
+                break;
+            }
+        }
+
+        result.m_type = m_type;
+        if (m_type == ValueType::vt_Double)
+            result.m_double = top->m_double;
+        else
+            result.m_int = top->m_int;
+        return true;
+    }
+
+    bool SymbolExpression::evaluate(Value& result) const noexcept
+    {
+        return run([this](uint32_t slot) { return m_symbols[slot].get(); }, result);
+    }
+
+    bool SymbolExpression::evaluate(const std::vector<const Symbol*>& inputs, Value& result) const noexcept
+    {
+        if (inputs.size() < m_inputs.size())
+            return false;
+        return run([&inputs](uint32_t slot) { return inputs[slot]; }, result);
+    }
+}
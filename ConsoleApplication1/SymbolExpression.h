@@ -0,0 +1,168 @@
+// SymbolExpression.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Expressions over symbols compiled once into typed bytecode, for computed symbols
+//   and event conditions.
+
+#pragma once
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Symbols.h"
+
+namespace Symbols {
+
+    /*
+    *   SymbolExpression is a formula over symbols, e.g. "tank1.level > tank1.high && !pump1.running",
+    *   compiled once into bytecode for a small stack machine. Symbol names are resolved into handles and
+    *   every operation gets its type at compile time, evaluate() does no lookup, no parsing and no allocation.
+    *   The language:
+    *     literals      42, 1.5, 2e3, true, false
+    *     symbols       names of boolean and numeric symbols: letters, digits, '_' and '.'
+    *     operators     by precedence: ?:, ||, &&, == !=, < <= > >=, + -, * / %, unary - and !
+    *     functions     abs(x), min(a, b), max(a, b)
+    *   Values are booleans, 64 bit integers or doubles. Integers stay integers for + - * % and unary -,
+    *   '/' and mixed operands compute in double. && and || short-circuit, a number is true if it is not 0.
+    */
+    class SymbolExpression
+    {
+    public:
+        static inline constexpr size_t MAX_STACK = 32;  //deepest nesting an expression compiles with
+
+        enum class ValueType {
+            vt_Bool = 0,
+            vt_Int,
+            vt_Double
+        };
+
+        //a result of evaluate(), m_int holds booleans and integers
+        struct Value {
+            ValueType m_type{ ValueType::vt_Bool };
+            int64_t m_int{};
+            double m_double{};
+
+            double toDouble() const noexcept {
+                return m_type == ValueType::vt_Double ? m_double : static_cast<double>(m_int);
+            }
+
+            bool toBool() const noexcept {
+                return m_type == ValueType::vt_Double ? m_double != 0.0 : m_int != 0;
+            }
+        };
+
+        /*
+        *   compile an expression against the symbols of a table.
+        *   Params:
+        *   table: the table the symbol names are resolved in.
+        *   text: the expression.
+        *   error: optional, receives what is wrong with the expression and where.
+        *   Returns: the expression, nullptr if it does not parse, names a symbol which does not exist
+        *   or is not boolean or numeric, or nests deeper than MAX_STACK.
+        */
+        static std::shared_ptr<const SymbolExpression> compile(SymbolTable& table, const std::string& text,
+            std::string* error = nullptr);
+
+        /*
+        *   convert a result into the value a symbol of the given type stores.
+        *   returns an empty std::any if the type is not boolean or numeric, or the result does not fit.
+        */
+        static std::any toAny(const Value& value, SymbolType type);
+
+        const std::string& getText() const noexcept {
+            return m_text;
+        }
+
+        ValueType getType() const noexcept {
+            return m_type;
+        }
+
+        //ids of the symbols the expression reads, in the order evaluate(inputs) expects them
+        const std::vector<uint32_t>& getInputs() const noexcept {
+            return m_inputs;
+        }
+
+        /*
+        *   evaluate with the current values of the symbols, read through their handles.
+        *   returns false if a symbol was deleted or holds another type since, or an integer % by 0.
+        */
+        bool evaluate(Value& result) const noexcept;
+
+        /*
+        *   evaluate with the symbols given in the order of getInputs(), e.g. the inputs of a computed symbol.
+        *   returns false if an input is missing or nullptr, see evaluate(Value&).
+        */
+        bool evaluate(const std::vector<const Symbol*>& inputs, Value& result) const noexcept;
+
+        /*
+        *   evaluate as a condition.
+        *   returns true if the expression evaluates and its result is not 0.
+        */
+        bool test() const noexcept {
+            Value result;
+            return evaluate(result) && result.toBool();
+        }
+
+    private:
+        //a value on the stack, the instructions know its type
+        union Slot {
+            int64_t m_int;
+            double m_double;
+        };
+
+        using load_t = bool (*)(const Symbol& symbol, Slot& slot) noexcept;
+
+        enum class OpCode : uint8_t {
+            oc_Constant = 0,    //push m_constant
+            oc_Load,            //push symbol m_arg through m_load
+            oc_IntToDouble,     //convert the top, booleans are integers 0 and 1
+            oc_IntToBool,
+            oc_DoubleToBool,
+            oc_Not,
+            oc_NegInt, oc_NegDouble,
+            oc_AbsInt, oc_AbsDouble,
+            oc_AddInt, oc_SubInt, oc_MulInt, oc_ModInt,
+            oc_AddDouble, oc_SubDouble, oc_MulDouble, oc_DivDouble, oc_ModDouble,
+            oc_MinInt, oc_MaxInt, oc_MinDouble, oc_MaxDouble,
+            oc_LessInt, oc_LessEqualInt, oc_GreaterInt, oc_GreaterEqualInt, oc_EqualInt, oc_NotEqualInt,
+            oc_LessDouble, oc_LessEqualDouble, oc_GreaterDouble, oc_GreaterEqualDouble, oc_EqualDouble, oc_NotEqualDouble,
+            oc_Jump,            //continue at m_arg
+            oc_JumpIfFalse,     //pop, continue at m_arg if it was false
+            oc_JumpFalseOrPop,  //&&: keep a false top and continue at m_arg, pop a true one
+            oc_JumpTrueOrPop    //||: keep a true top and continue at m_arg, pop a false one
+        };
+
+        struct Instruction {
+            OpCode m_op;
+            uint32_t m_arg;
+            Slot m_constant;
+            load_t m_load;
+        };
+
+        struct Parser;
+        friend struct Parser;
+
+        SymbolExpression() = default;
+
+        template<typename T>
+        static bool loadSymbol(const Symbol& symbol, Slot& slot) noexcept;
+
+        template<typename Source>
+        bool run(const Source& source, Value& result) const noexcept;
+
+        std::string m_text;
+        ValueType m_type{ ValueType::vt_Bool };
+        std::vector<Instruction> m_code;
+        std::vector<SymbolHandle> m_symbols;
+        std::vector<uint32_t> m_inputs;
+    };
+}
@@ -0,0 +1,74 @@
+// SymbolHistory.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolHistory.h"
+#include <algorithm>
+
+namespace Symbols {
+
+    SymbolHistory::SymbolHistory(size_t capacity) :
+        m_capacity{ std::max<size_t>(capacity, 1) },
+        m_slots{ std::make_unique<Slot[]>(m_capacity) }
+    {
+
+    }
+
+    size_t SymbolHistory::size() const noexcept
+    {
+        return static_cast<size_t>(std::min<uint64_t>(m_head.load(std::memory_order_acquire), m_capacity));
+    }
+
+    size_t SymbolHistory::memoryUsage(size_t capacity) noexcept
+    {
+        return sizeof(SymbolHistory) + std::max<size_t>(capacity, 1) * sizeof(Slot);
+    }
+
+    void SymbolHistory::append(int64_t timestamp, uint64_t bits) noexcept
+    {
+        const uint64_t index = m_head.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[index % m_capacity];
+
+        // odd sequence tells readers the slot is being rewritten
+        slot.m_seq.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.m_timestamp.store(timestamp, std::memory_order_relaxed);
+        slot.m_bits.store(bits, std::memory_order_relaxed);
+        slot.m_seq.store(index * 2 + 2, std::memory_order_release);
+
+        m_head.store(index + 1, std::memory_order_release);
+    }
+
+    size_t SymbolHistory::query(int64_t from, int64_t to, std::vector<RawSample>& out) const
+    {
+        const size_t before = out.size();
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        const uint64_t first = head > m_capacity ? head - m_capacity : 0;
+
+        for (uint64_t index = first; index < head; index++)
+        {
+            const Slot& slot = m_slots[index % m_capacity];
+            const uint64_t seq = slot.m_seq.load(std::memory_order_acquire);
+            if (seq != index * 2 + 2)
+                continue;   //overwritten by a newer sample or still being written
+
+            RawSample sample{ slot.m_timestamp.load(std::memory_order_relaxed),
+                slot.m_bits.load(std::memory_order_relaxed) };
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.m_seq.load(std::memory_order_relaxed) != seq)
+                continue;   //the writer wrapped around while we were copying
+
+            if (sample.m_timestamp < from || sample.m_timestamp > to)
+                continue;
+
+            out.push_back(sample);
+        }
+        return out.size() - before;
+    }
+}
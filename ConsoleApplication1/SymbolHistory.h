@@ -0,0 +1,96 @@
+// SymbolHistory.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Fixed capacity in-memory history of (timestamp, value) samples per symbol.
+
+#pragma once
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Symbols {
+
+    /*
+    *   a single history entry returned by SymbolTable::History().
+    */
+    struct HistorySample {
+        std::chrono::system_clock::time_point m_timestamp;
+        std::any m_value;
+    };
+
+    /*
+    *   SymbolHistory is a fixed capacity ring buffer of (timestamp, raw value) samples.
+    *   Values are kept as their raw 64 bit representation, so only scalar symbol types are recorded.
+    *   Appends are lock-free but expect a single writer per symbol (the thread which acquires the tag),
+    *   any number of readers may query at the same time. Every slot is guarded by its own sequence
+    *   number, so a reader simply drops samples which were overwritten while it was copying them.
+    */
+    class SymbolHistory
+    {
+    public:
+        struct RawSample {
+            int64_t m_timestamp;    //nanoseconds since system_clock epoch
+            uint64_t m_bits;        //raw value, see Symbol::getRaw()
+        };
+
+        explicit SymbolHistory(size_t capacity);
+        virtual ~SymbolHistory() = default;  //destructor
+
+        SymbolHistory(const SymbolHistory& r) = delete;
+        SymbolHistory& operator=(const SymbolHistory& r) = delete;
+
+        /*
+        *   get the number of samples the buffer can hold.
+        *   returns the capacity given at construction.
+        */
+        size_t capacity() const noexcept {
+            return m_capacity;
+        }
+
+        /*
+        *   get the number of samples currently held.
+        *   returns at most capacity().
+        */
+        size_t size() const noexcept;
+
+        /*
+        *   get the memory a buffer of the given capacity occupies.
+        *   returns the size in bytes, used for the per table budget.
+        */
+        static size_t memoryUsage(size_t capacity) noexcept;
+
+        /*
+        *   append a sample, overwriting the oldest one if the buffer is full.
+        *   must only be called from one thread at a time.
+        */
+        void append(int64_t timestamp, uint64_t bits) noexcept;
+
+        /*
+        *   copy the samples whose timestamp lies in [from, to] into out, oldest first.
+        *   returns the number of samples appended to out.
+        */
+        size_t query(int64_t from, int64_t to, std::vector<RawSample>& out) const;
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> m_seq{ 0 };     //2 * index + 2 when written, odd while writing
+            std::atomic<int64_t> m_timestamp{ 0 };
+            std::atomic<uint64_t> m_bits{ 0 };
+        };
+
+        size_t m_capacity{};
+        std::unique_ptr<Slot[]> m_slots;
+        std::atomic<uint64_t> m_head{ 0 };   //total number of appended samples
+    };
+}
@@ -0,0 +1,796 @@
+// SymbolReplication.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolReplication.h"
+#include "Symbols.h"
+#include <algorithm>
+#include <chrono>
+#if !defined(_WIN32)
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Symbols {
+
+    using FrameType = ReplicationProtocol::FrameType;
+
+    namespace {
+        constexpr int POLL_INTERVAL_MS = 100;   //how often blocked I/O checks whether to stop
+
+        int64_t nowNanoseconds() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        uint64_t newEpoch() noexcept
+        {
+            static std::atomic<uint64_t> counter{ 0 };
+            const auto ticks = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            const uint64_t epoch = (ticks * 0x9E3779B97F4A7C15ull) ^ ++counter;
+            return epoch != 0 ? epoch : 1;  //0 means "no epoch" in a hello
+        }
+
+#if !defined(_WIN32)
+        //fill in the record count which follows the header of a frame
+        void putCount(std::vector<uint8_t>& buffer, size_t frameStart, uint32_t count) noexcept
+        {
+            std::memcpy(buffer.data() + frameStart + SymbolCodec::FRAME_HEADER_SIZE, &count, sizeof(count));
+        }
+
+        bool socketAddress(const std::string& path, sockaddr_un& address) noexcept
+        {
+            address = {};
+            address.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(address.sun_path))
+                return false;
+            std::copy(path.begin(), path.end(), address.sun_path);
+            return true;
+        }
+
+        //a replica that went away must not kill the process, writes fail with EPIPE instead
+        void blockSigpipe() noexcept
+        {
+            sigset_t set;
+            sigemptyset(&set);
+            sigaddset(&set, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &set, nullptr);
+        }
+
+        void closePair(int readFd, int writeFd) noexcept
+        {
+            if (readFd >= 0)
+                close(readFd);
+            if (writeFd >= 0 && writeFd != readFd)
+                close(writeFd);
+        }
+
+        /*
+        *   wait until the descriptor is ready, checking keepRunning every POLL_INTERVAL_MS.
+        *   returns false if keepRunning turned false or the descriptor failed.
+        */
+        template<typename Running>
+        bool waitReady(int fd, short events, Running&& keepRunning)
+        {
+            for (;;)
+            {
+                if (!keepRunning())
+                    return false;
+                pollfd descriptor{ fd, events, 0 };
+                const int ready = ::poll(&descriptor, 1, POLL_INTERVAL_MS);
+                if (ready > 0)
+                    return true;
+                if (ready < 0 && errno != EINTR)
+                    return false;
+            }
+        }
+
+        //read and write instead of recv and send, so pipes work as well as sockets
+        template<typename Running>
+        bool readExact(int fd, void* data, size_t size, Running&& keepRunning)
+        {
+            auto* bytes = static_cast<uint8_t*>(data);
+            while (size > 0)
+            {
+                if (!waitReady(fd, POLLIN, keepRunning))
+                    return false;
+                const ssize_t got = read(fd, bytes, size);
+                if (got < 0 && (errno == EINTR || errno == EAGAIN))
+                    continue;
+                if (got <= 0)
+                    return false;
+                bytes += got;
+                size -= static_cast<size_t>(got);
+            }
+            return true;
+        }
+
+        template<typename Running>
+        bool writeAll(int fd, const std::vector<uint8_t>& buffer, Running&& keepRunning)
+        {
+            for (size_t offset = 0; offset < buffer.size(); )
+            {
+                if (!waitReady(fd, POLLOUT, keepRunning))
+                    return false;
+                const ssize_t sent = write(fd, buffer.data() + offset, buffer.size() - offset);
+                if (sent < 0 && (errno == EINTR || errno == EAGAIN))
+                    continue;
+                if (sent <= 0)
+                    return false;
+                offset += static_cast<size_t>(sent);
+            }
+            return true;
+        }
+
+        template<typename Running>
+        bool readFrame(int fd, FrameType& type, std::vector<uint8_t>& payload, Running&& keepRunning)
+        {
+            uint8_t header[SymbolCodec::FRAME_HEADER_SIZE];
+            if (!readExact(fd, header, sizeof(header), keepRunning))
+                return false;
+
+            uint32_t length;
+            std::memcpy(&length, header, sizeof(length));
+            if (length > ReplicationProtocol::MAX_FRAME)
+                return false;
+            type = static_cast<FrameType>(header[sizeof(length)]);
+            payload.resize(length);
+            return readExact(fd, payload.data(), length, keepRunning);
+        }
+
+        //a frame holding a single u64, or two of them
+        std::vector<uint8_t> sequenceFrame(FrameType type, uint64_t first)
+        {
+            std::vector<uint8_t> frame;
+            SymbolCodec::beginFrame(frame, static_cast<uint8_t>(type));
+            ByteWriter(frame).put(first);
+            SymbolCodec::endFrame(frame, 0);
+            return frame;
+        }
+
+        std::vector<uint8_t> sequenceFrame(FrameType type, uint64_t first, uint64_t second)
+        {
+            std::vector<uint8_t> frame;
+            SymbolCodec::beginFrame(frame, static_cast<uint8_t>(type));
+            ByteWriter writer(frame);
+            writer.put(first);
+            writer.put(second);
+            SymbolCodec::endFrame(frame, 0);
+            return frame;
+        }
+#endif
+    }
+
+    ReplicationPrimary::ReplicationPrimary(SymbolTable& table, size_t maxLogBytes) :
+        m_table{ table },
+        m_maxLogBytes{ maxLogBytes },
+        m_epoch{ newEpoch() }
+    {
+
+    }
+
+    ReplicationPrimary::~ReplicationPrimary()
+    {
+        stop();
+    }
+
+    ReplicationPrimaryStats ReplicationPrimary::stats() const
+    {
+        ReplicationPrimaryStats stats;
+        {
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            stats.m_sequence = m_sequence;
+            stats.m_logRecords = m_log.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_sessionMutex);
+            bool first = true;
+            for (const auto& session : m_sessions)
+            {
+                if (session.m_done)
+                    continue;
+                const uint64_t acked = session.m_acked;
+                stats.m_ackedSequence = first ? acked : std::min(stats.m_ackedSequence, acked);
+                stats.m_replicas++;
+                first = false;
+            }
+        }
+        stats.m_snapshots = m_snapshots;
+        return stats;
+    }
+
+    void ReplicationPrimary::start()
+    {
+        if (m_running.exchange(true))
+            return;
+
+        m_tableEvent = m_table.AddTableEvent([this](const TableChange& change) {
+            onTableChange(change.m_change, *change.m_symbol);
+        });
+    }
+
+    void ReplicationPrimary::onTableChange(SymbolCodec::ChangeType change, const Symbol& symbol)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            LogRecord record{ ++m_sequence, {} };
+            ByteWriter writer(record.m_bytes);
+            writer.put(record.m_sequence);
+            SymbolCodec::encodeChange(writer, change, symbol, nowNanoseconds());
+            if (change == SymbolCodec::ChangeType::ct_Insert)
+                writer.putString(symbol.getDescription());
+
+            m_logBytes += record.m_bytes.size();
+            m_log.push_back(std::move(record));
+
+            //the newest change always stays, a replica behind the front of the log gets a snapshot
+            while (m_logBytes > m_maxLogBytes && m_log.size() > 1)
+            {
+                m_logBytes -= m_log.front().m_bytes.size();
+                m_log.pop_front();
+            }
+        }
+        m_logChanged.notify_all();
+    }
+
+#if !defined(_WIN32)
+    bool ReplicationPrimary::listen(const std::string& path)
+    {
+        if (m_listenFd >= 0)
+            return false;
+
+        sockaddr_un address;
+        if (!socketAddress(path, address))
+            return false;
+
+        m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0)
+            return false;
+
+        unlink(path.c_str());
+        if (bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(m_listenFd, SOMAXCONN) != 0)
+        {
+            close(m_listenFd);
+            m_listenFd = -1;
+            return false;
+        }
+        m_path = path;
+
+        start();
+        m_acceptThread = std::thread(&ReplicationPrimary::acceptLoop, this);
+        return true;
+    }
+
+    bool ReplicationPrimary::attach(int readFd, int writeFd)
+    {
+        if (readFd < 0 || writeFd < 0)
+            return false;
+
+        start();
+        std::lock_guard<std::mutex> lock(m_sessionMutex);
+        reapSessions();
+        Session& session = m_sessions.emplace_back();
+        session.m_readFd = readFd;
+        session.m_writeFd = writeFd;
+        session.m_thread = std::thread(&ReplicationPrimary::serve, this, std::ref(session));
+        return true;
+    }
+
+    void ReplicationPrimary::stop()
+    {
+        if (!m_running.exchange(false))
+            return;
+
+        m_table.RemoveTableEvent(m_tableEvent);
+        m_logChanged.notify_all();
+
+        if (m_acceptThread.joinable())
+            m_acceptThread.join();
+        {
+            std::lock_guard<std::mutex> lock(m_sessionMutex);
+            for (auto& session : m_sessions)
+            {
+                if (session.m_thread.joinable())
+                    session.m_thread.join();
+            }
+            m_sessions.clear();
+        }
+
+        if (m_listenFd >= 0)
+        {
+            close(m_listenFd);
+            unlink(m_path.c_str());
+        }
+        m_listenFd = -1;
+    }
+
+    void ReplicationPrimary::acceptLoop()
+    {
+        const auto running = [this] { return m_running.load(); };
+        while (waitReady(m_listenFd, POLLIN, running))
+        {
+            const int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0 && !attach(fd, fd))
+                close(fd);
+        }
+    }
+
+    void ReplicationPrimary::reapSessions()
+    {
+        for (auto it = m_sessions.begin(); it != m_sessions.end(); )
+        {
+            if (!it->m_done)
+            {
+                ++it;
+                continue;
+            }
+            it->m_thread.join();
+            it = m_sessions.erase(it);
+        }
+    }
+
+    void ReplicationPrimary::serve(Session& session)
+    {
+        blockSigpipe();
+        const auto running = [this] { return m_running.load(); };
+
+        // 1: the hello tells where the replica stands
+        FrameType type;
+        std::vector<uint8_t> payload;
+        uint64_t epoch = 0, last = 0, cursor = 0;
+        bool bRet = readFrame(session.m_readFd, type, payload, running) && type == FrameType::ft_Hello;
+        if (bRet)
+        {
+            ByteReader reader(payload.data(), payload.size());
+            bRet = reader.get(epoch) && reader.get(last);
+        }
+
+        // 2: resume if the log still holds every change after its last one, otherwise a snapshot
+        if (bRet)
+        {
+            bool resume;
+            {
+                std::lock_guard<std::mutex> lock(m_logMutex);
+                resume = epoch == m_epoch && last <= m_sequence &&
+                    (last == m_sequence || (!m_log.empty() && last + 1 >= m_log.front().m_sequence));
+            }
+            if (resume)
+            {
+                cursor = last;
+                session.m_acked = last;
+            }
+            else
+                bRet = sendSnapshot(session, cursor);
+        }
+
+        // 3: stream the log in batches, a heartbeat when there is nothing to send
+        std::vector<uint8_t> frame;
+        while (bRet && m_running)
+        {
+            bRet = readRequests(session);
+            if (!bRet)
+                break;
+
+            bool snapshot = false;
+            frame.clear();
+            {
+                std::unique_lock<std::mutex> lock(m_logMutex);
+                m_logChanged.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL_MS),
+                    [this, cursor] { return m_sequence > cursor || !m_running; });
+                if (!m_running)
+                    break;
+
+                if (m_sequence == cursor)
+                    frame = sequenceFrame(FrameType::ft_Heartbeat, m_sequence);
+                else if (m_log.empty() || cursor + 1 < m_log.front().m_sequence)
+                    snapshot = true;    //the replica fell behind the log
+                else
+                {
+                    const size_t frameStart = SymbolCodec::beginFrame(frame, static_cast<uint8_t>(FrameType::ft_Changes));
+                    ByteWriter(frame).put(uint32_t{ 0 });
+
+                    uint32_t count = 0;
+                    for (size_t index = static_cast<size_t>(cursor + 1 - m_log.front().m_sequence);
+                        index < m_log.size() && count < ReplicationProtocol::BATCH_RECORDS; index++, count++)
+                    {
+                        const auto& bytes = m_log[index].m_bytes;
+                        frame.insert(frame.end(), bytes.begin(), bytes.end());
+                    }
+                    putCount(frame, frameStart, count);
+                    SymbolCodec::endFrame(frame, frameStart);
+                    cursor += count;
+                }
+            }
+
+            if (snapshot)
+                bRet = sendSnapshot(session, cursor);
+            else
+                bRet = writeAll(session.m_writeFd, frame, running);
+        }
+
+        closePair(session.m_readFd, session.m_writeFd);
+        session.m_done = true;
+    }
+
+    bool ReplicationPrimary::sendSnapshot(Session& session, uint64_t& cursor)
+    {
+        // 1: encode the table while no change can be logged, so the snapshot matches the sequence
+        std::vector<uint8_t> frames;
+        uint64_t sequence;
+        {
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            sequence = m_sequence;
+            frames = sequenceFrame(FrameType::ft_SnapshotBegin, m_epoch, sequence);
+
+            const int64_t now = nowNanoseconds();
+            size_t frameStart = 0;
+            uint32_t count = 0;
+            m_table.ForEach([&](const auto& item)
+            {
+                if (count == 0)
+                {
+                    frameStart = SymbolCodec::beginFrame(frames, static_cast<uint8_t>(FrameType::ft_Snapshot));
+                    ByteWriter(frames).put(uint32_t{ 0 });
+                }
+                ByteWriter writer(frames);
+                SymbolCodec::encodeChange(writer, SymbolCodec::ChangeType::ct_Insert, item.second, now);
+                writer.putString(item.second.getDescription());
+
+                if (++count == ReplicationProtocol::BATCH_RECORDS)
+                {
+                    putCount(frames, frameStart, count);
+                    SymbolCodec::endFrame(frames, frameStart);
+                    count = 0;
+                }
+            });
+            if (count > 0)
+            {
+                putCount(frames, frameStart, count);
+                SymbolCodec::endFrame(frames, frameStart);
+            }
+            SymbolCodec::endFrame(frames, SymbolCodec::beginFrame(frames, static_cast<uint8_t>(FrameType::ft_SnapshotEnd)));
+        }
+
+        // 2: send it without holding the log
+        if (!writeAll(session.m_writeFd, frames, [this] { return m_running.load(); }))
+            return false;
+
+        cursor = sequence;
+        m_snapshots++;
+        return true;
+    }
+
+    bool ReplicationPrimary::readRequests(Session& session)
+    {
+        //acks are small, take whatever arrived without waiting
+        for (;;)
+        {
+            pollfd descriptor{ session.m_readFd, POLLIN, 0 };
+            const int ready = ::poll(&descriptor, 1, 0);
+            if (ready == 0)
+                return true;
+            if (ready < 0)
+                return errno == EINTR;
+
+            FrameType type;
+            std::vector<uint8_t> payload;
+            if (!readFrame(session.m_readFd, type, payload, [this] { return m_running.load(); }))
+                return false;
+
+            uint64_t acked;
+            ByteReader reader(payload.data(), payload.size());
+            if (type != FrameType::ft_Ack || !reader.get(acked))
+                return false;
+            session.m_acked = acked;
+        }
+    }
+#else
+    bool ReplicationPrimary::listen(const std::string&)
+    {
+        return false;   //the transport uses POSIX descriptors
+    }
+
+    bool ReplicationPrimary::attach(int, int)
+    {
+        return false;
+    }
+
+    void ReplicationPrimary::stop()
+    {
+
+    }
+#endif
+
+    ReplicationReplica::ReplicationReplica(SymbolTable& table) :
+        m_table{ table }
+    {
+
+    }
+
+    ReplicationReplica::~ReplicationReplica()
+    {
+        stop();
+    }
+
+    ReplicationReplicaStats ReplicationReplica::stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        return m_stats;
+    }
+
+    bool ReplicationReplica::waitFor(uint64_t sequence, int timeoutMs) const
+    {
+        std::unique_lock<std::mutex> lock(m_stateMutex);
+        return m_applied.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+            [this, sequence] { return m_stats.m_appliedSequence >= sequence; });
+    }
+
+    void ReplicationReplica::disconnect()
+    {
+        m_drop = true;
+    }
+
+    bool ReplicationReplica::keepRunning() const noexcept
+    {
+        return m_running && !m_drop;
+    }
+
+    void ReplicationReplica::applyRecord(const SymbolCodec::Change& change, const std::string& desc)
+    {
+        switch (change.m_change)
+        {
+        case SymbolCodec::ChangeType::ct_Insert:
+        {
+            //a symbol already known with the same name and type only gets the value, so its events stay
+            auto it = m_table.find(change.m_id);
+            if (it != m_table.end() && it->second.getName() == change.m_name && it->second.getType() == change.m_type)
+            {
+                if (change.m_value.has_value())
+                    m_table.SetValue(change.m_id, change.m_value);
+                break;
+            }
+            if (it != m_table.end())
+                m_table.DeleteValue(change.m_id);
+            m_table.InsertValue(change.m_id, change.m_name, desc, change.m_type, change.m_value);
+            break;
+        }
+        case SymbolCodec::ChangeType::ct_Set:
+            if (change.m_value.has_value())
+                m_table.SetValue(change.m_id, change.m_value);
+            break;
+        case SymbolCodec::ChangeType::ct_Delete:
+            m_table.DeleteValue(change.m_id);
+            break;
+        }
+    }
+
+    bool ReplicationReplica::applySnapshot(ByteReader& payload)
+    {
+        uint32_t count;
+        if (!payload.get(count))
+            return false;
+
+        SymbolCodec::Change change;
+        std::string desc;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (!SymbolCodec::decodeChange(payload, change) || !payload.getString(desc))
+                return false;
+            applyRecord(change, desc);
+            m_snapshotIds.insert(change.m_id);
+        }
+        return true;
+    }
+
+    bool ReplicationReplica::applyChanges(ByteReader& payload)
+    {
+        uint32_t count;
+        if (!payload.get(count))
+            return false;
+
+        uint64_t applied = m_stats.m_appliedSequence;   //only written by this thread
+        int64_t timestamp = 0;
+        SymbolCodec::Change change;
+        std::string desc;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint64_t sequence;
+            desc.clear();
+            if (!payload.get(sequence) || !SymbolCodec::decodeChange(payload, change))
+                return false;
+            if (change.m_change == SymbolCodec::ChangeType::ct_Insert && !payload.getString(desc))
+                return false;
+            if (sequence <= applied)
+                continue;   //already applied before a reconnect
+
+            applyRecord(change, desc);
+            applied = sequence;
+            timestamp = change.m_timestamp;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            m_stats.m_appliedSequence = applied;
+            m_stats.m_primarySequence = std::max(m_stats.m_primarySequence, applied);
+            if (timestamp != 0)
+                m_stats.m_lag = nowNanoseconds() - timestamp;
+            m_stats.m_batches++;
+        }
+        m_applied.notify_all();
+        return true;
+    }
+
+#if !defined(_WIN32)
+    bool ReplicationReplica::connect(const std::string& path)
+    {
+        if (m_running)
+            return false;
+
+        m_path = path;
+        m_drop = false;
+        m_running = true;
+        m_thread = std::thread(&ReplicationReplica::run, this, -1, -1, true);
+        return true;
+    }
+
+    bool ReplicationReplica::attach(int readFd, int writeFd)
+    {
+        if (m_running || readFd < 0 || writeFd < 0)
+            return false;
+
+        m_drop = false;
+        m_running = true;
+        m_thread = std::thread(&ReplicationReplica::run, this, readFd, writeFd, false);
+        return true;
+    }
+
+    void ReplicationReplica::stop()
+    {
+        m_running = false;
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void ReplicationReplica::run(int readFd, int writeFd, bool reconnect)
+    {
+        blockSigpipe();
+        while (m_running)
+        {
+            if (reconnect)
+            {
+                sockaddr_un address;
+                const int fd = socketAddress(m_path, address) ? socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) : -1;
+                if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+                    readFd = writeFd = fd;
+                else if (fd >= 0)
+                    close(fd);
+            }
+
+            if (readFd >= 0)
+            {
+                session(readFd, writeFd);
+                closePair(readFd, writeFd);
+                readFd = writeFd = -1;
+                std::lock_guard<std::mutex> lock(m_stateMutex);
+                m_stats.m_connected = false;
+            }
+            m_drop = false;
+            if (!reconnect)
+                break;
+
+            for (int waited = 0; waited < RECONNECT_DELAY_MS && m_running; waited += 10)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        m_running = false;
+    }
+
+    bool ReplicationReplica::session(int readFd, int writeFd)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            m_stats.m_connects++;
+            m_stats.m_connected = true;
+        }
+
+        const auto running = [this] { return keepRunning(); };
+        if (!writeAll(writeFd, sequenceFrame(FrameType::ft_Hello, m_epoch, m_stats.m_appliedSequence), running))
+            return false;
+
+        FrameType type;
+        std::vector<uint8_t> payload;
+        while (readFrame(readFd, type, payload, running))
+        {
+            ByteReader reader(payload.data(), payload.size());
+            bool bRet = true;
+            switch (type)
+            {
+            case FrameType::ft_SnapshotBegin:
+                m_snapshotIds.clear();
+                bRet = reader.get(m_snapshotEpoch) && reader.get(m_snapshotSequence);
+                break;
+            case FrameType::ft_Snapshot:
+                bRet = applySnapshot(reader);
+                break;
+            case FrameType::ft_SnapshotEnd:
+            {
+                //symbols the primary does not have anymore
+                std::vector<uint32_t> stale;
+                m_table.ForEach([&](const auto& item)
+                {
+                    if (m_snapshotIds.count(item.first) == 0)
+                        stale.push_back(item.first);
+                });
+                for (const uint32_t id : stale)
+                    m_table.DeleteValue(id);
+                m_snapshotIds.clear();
+
+                m_epoch = m_snapshotEpoch;
+                {
+                    std::lock_guard<std::mutex> lock(m_stateMutex);
+                    m_stats.m_appliedSequence = m_snapshotSequence;
+                    m_stats.m_primarySequence = std::max(m_stats.m_primarySequence, m_snapshotSequence);
+                    m_stats.m_lag = 0;
+                    m_stats.m_snapshots++;
+                }
+                m_applied.notify_all();
+                bRet = sendAck(writeFd);
+                break;
+            }
+            case FrameType::ft_Changes:
+                bRet = applyChanges(reader) && sendAck(writeFd);
+                break;
+            case FrameType::ft_Heartbeat:
+            {
+                uint64_t sequence = 0;
+                bRet = reader.get(sequence);
+                if (bRet)
+                {
+                    std::lock_guard<std::mutex> lock(m_stateMutex);
+                    m_stats.m_primarySequence = std::max(m_stats.m_primarySequence, sequence);
+                }
+                break;
+            }
+            default:
+                bRet = false;
+                break;
+            }
+            if (!bRet)
+                return false;
+        }
+        return true;
+    }
+
+    bool ReplicationReplica::sendAck(int writeFd)
+    {
+        return writeAll(writeFd, sequenceFrame(FrameType::ft_Ack, m_stats.m_appliedSequence),
+            [this] { return keepRunning(); });
+    }
+#else
+    bool ReplicationReplica::connect(const std::string&)
+    {
+        return false;   //the transport uses POSIX descriptors
+    }
+
+    bool ReplicationReplica::attach(int, int)
+    {
+        return false;
+    }
+
+    void ReplicationReplica::stop()
+    {
+
+    }
+#endif
+}
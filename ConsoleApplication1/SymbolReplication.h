@@ -0,0 +1,250 @@
+// SymbolReplication.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Primary/replica replication of a SymbolTable over a stream socket or pipe.
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "SymbolCodec.h"
+
+namespace Symbols {
+
+    class SymbolTable;  //incomplete type declaration
+
+    /*
+    *   Wire format between ReplicationPrimary and ReplicationReplica, framed like SymbolCodec::beginFrame().
+    *   ft_Hello (replica): u64 epoch, u64 last applied sequence. Zeros ask for a snapshot.
+    *   ft_SnapshotBegin (primary): u64 epoch, u64 sequence the snapshot was taken at.
+    *   ft_Snapshot (primary): u32 count, change records (ct_Insert) each followed by the description.
+    *   ft_SnapshotEnd (primary): nothing, symbols missing from the snapshot are deleted by the replica.
+    *   ft_Changes (primary): u32 count, then per change u64 sequence, change record, description for inserts.
+    *   ft_Heartbeat (primary): u64 last sequence of the primary, sent when there is nothing to replicate.
+    *   ft_Ack (replica): u64 last applied sequence.
+    */
+    struct ReplicationProtocol {
+        enum class FrameType : uint8_t {
+            ft_Hello = 1,
+            ft_SnapshotBegin,
+            ft_Snapshot,
+            ft_SnapshotEnd,
+            ft_Changes,
+            ft_Heartbeat,
+            ft_Ack
+        };
+
+        static inline constexpr uint32_t MAX_FRAME = 16 * 1024 * 1024;
+        static inline constexpr uint32_t BATCH_RECORDS = 4096;  //change records per frame at most
+    };
+
+    /*
+    *   counters of a ReplicationPrimary.
+    */
+    struct ReplicationPrimaryStats {
+        uint64_t m_sequence{};          //sequence of the last change logged
+        uint64_t m_logRecords{};        //changes kept for replicas which reconnect
+        uint64_t m_replicas{};          //connected replicas
+        uint64_t m_ackedSequence{};     //lowest sequence acknowledged by a connected replica
+        uint64_t m_snapshots{};         //snapshots sent
+    };
+
+    /*
+    *   counters of a ReplicationReplica.
+    */
+    struct ReplicationReplicaStats {
+        uint64_t m_appliedSequence{};   //last change applied to the table
+        uint64_t m_primarySequence{};   //last sequence the primary reported
+        int64_t m_lag{};                //nanoseconds between the last applied change on the primary and here
+        uint64_t m_batches{};           //frames applied
+        uint64_t m_snapshots{};         //snapshots received
+        uint64_t m_connects{};          //sessions started, more than one means it reconnected
+        bool m_connected{};
+    };
+
+    /*
+    *   ReplicationPrimary logs every change of a SymbolTable with a sequence number and streams it to
+    *   replicas. A new replica gets a snapshot first, a replica which reconnects resumes after its last
+    *   applied sequence as long as the change log still holds it, otherwise it gets a new snapshot.
+    *   The table event only appends to the log, every replica is served by its own thread, so a slow
+    *   replica never blocks the writers of the table.
+    */
+    class ReplicationPrimary
+    {
+    public:
+        static inline constexpr size_t DEFAULT_LOG_BYTES = 16 * 1024 * 1024;
+
+        explicit ReplicationPrimary(SymbolTable& table, size_t maxLogBytes = DEFAULT_LOG_BYTES);
+        virtual ~ReplicationPrimary();  //destructor, stops replication
+
+        ReplicationPrimary(const ReplicationPrimary& r) = delete;
+        ReplicationPrimary& operator=(const ReplicationPrimary& r) = delete;
+
+        /*
+        *   accept replicas on a Unix domain socket.
+        *   Params:
+        *   path: socket path, an existing socket file is replaced.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool listen(const std::string& path);
+
+        /*
+        *   serve one replica on an existing connection, e.g. a pair of pipes.
+        *   Params:
+        *   readFd: descriptor the replica requests are read from.
+        *   writeFd: descriptor the changes are written to, may be the same as readFd.
+        *   Returns: returns true if successful. The descriptors are closed when the session ends.
+        */
+        bool attach(int readFd, int writeFd);
+
+        /*
+        *   disconnect all replicas and stop logging changes.
+        *   returns nothing.
+        */
+        void stop();
+
+        /*
+        *   get a copy of the counters.
+        */
+        ReplicationPrimaryStats stats() const;
+
+    private:
+        struct LogRecord {
+            uint64_t m_sequence;
+            std::vector<uint8_t> m_bytes;   //u64 sequence, change record, description for inserts
+        };
+
+        struct Session {
+            int m_readFd{ -1 };
+            int m_writeFd{ -1 };
+            std::thread m_thread;
+            std::atomic<uint64_t> m_acked{ 0 };
+            std::atomic<bool> m_done{ false };
+        };
+
+        void start();
+        void onTableChange(SymbolCodec::ChangeType change, const Symbol& symbol);
+        void acceptLoop();
+        void serve(Session& session);
+        bool sendSnapshot(Session& session, uint64_t& cursor);
+        bool readRequests(Session& session);
+        void reapSessions();
+
+        SymbolTable& m_table;
+        size_t m_maxLogBytes;
+        uint64_t m_epoch;
+        std::string m_path;
+        int m_listenFd{ -1 };
+        int m_tableEvent{};
+        std::atomic<bool> m_running{ false };
+        std::thread m_acceptThread;
+
+        mutable std::mutex m_logMutex;
+        std::condition_variable m_logChanged;
+        std::deque<LogRecord> m_log;
+        size_t m_logBytes{};
+        uint64_t m_sequence{};
+
+        mutable std::mutex m_sessionMutex;
+        std::list<Session> m_sessions;
+        std::atomic<uint64_t> m_snapshots{ 0 };
+    };
+
+    /*
+    *   ReplicationReplica keeps a SymbolTable identical to the one of a ReplicationPrimary.
+    *   Changes arrive in batches and are applied through the normal table methods, so the events of
+    *   the replica fire as well. When connected by path the replica reconnects on its own and resumes
+    *   from the last applied sequence.
+    */
+    class ReplicationReplica
+    {
+    public:
+        static inline constexpr int RECONNECT_DELAY_MS = 100;
+
+        explicit ReplicationReplica(SymbolTable& table);
+        virtual ~ReplicationReplica();  //destructor, stops replication
+
+        ReplicationReplica(const ReplicationReplica& r) = delete;
+        ReplicationReplica& operator=(const ReplicationReplica& r) = delete;
+
+        /*
+        *   replicate from the primary listening on a Unix domain socket, reconnecting when the
+        *   connection drops.
+        *   returns true if the replication thread was started.
+        */
+        bool connect(const std::string& path);
+
+        /*
+        *   replicate over an existing connection, e.g. a pair of pipes. There is no reconnect.
+        *   Params:
+        *   readFd: descriptor the changes are read from.
+        *   writeFd: descriptor the requests are written to, may be the same as readFd.
+        *   Returns: returns true if the replication thread was started.
+        */
+        bool attach(int readFd, int writeFd);
+
+        /*
+        *   close the connection and stop the replication thread.
+        *   returns nothing.
+        */
+        void stop();
+
+        /*
+        *   drop the current connection, a replica connected by path reconnects and resumes.
+        *   returns nothing.
+        */
+        void disconnect();
+
+        /*
+        *   wait until the change with the given sequence is applied.
+        *   returns true if it was applied within the timeout.
+        */
+        bool waitFor(uint64_t sequence, int timeoutMs) const;
+
+        /*
+        *   get a copy of the counters.
+        */
+        ReplicationReplicaStats stats() const;
+
+    private:
+        void run(int readFd, int writeFd, bool reconnect);
+        bool session(int readFd, int writeFd);
+        bool applyChanges(ByteReader& payload);
+        bool applySnapshot(ByteReader& payload);
+        void applyRecord(const SymbolCodec::Change& change, const std::string& desc);
+        bool sendAck(int writeFd);
+        bool keepRunning() const noexcept;
+
+        SymbolTable& m_table;
+        std::string m_path;
+        std::thread m_thread;
+        std::atomic<bool> m_running{ false };
+        std::atomic<bool> m_drop{ false };  //set by disconnect(), ends the current session
+
+        //owned by the replication thread
+        uint64_t m_epoch{};                 //epoch of the primary the table was replicated from
+        uint64_t m_snapshotEpoch{};         //snapshot being received
+        uint64_t m_snapshotSequence{};
+        std::unordered_set<uint32_t> m_snapshotIds;
+
+        mutable std::mutex m_stateMutex;
+        mutable std::condition_variable m_applied;
+        ReplicationReplicaStats m_stats;
+    };
+}
@@ -0,0 +1,117 @@
+// SymbolRollup.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolRollup.h"
+#include <algorithm>
+#include <limits>
+
+namespace Symbols {
+
+    SymbolRollup::SymbolRollup()
+    {
+        for (size_t level = 0; level < RESOLUTIONS.size(); level++)
+            m_levels[level].resize(RESOLUTIONS[level].m_buckets);
+    }
+
+    size_t SymbolRollup::memoryUsage() noexcept
+    {
+        size_t bytes = sizeof(SymbolRollup);
+        for (const auto& resolution : RESOLUTIONS)
+            bytes += resolution.m_buckets * sizeof(Bucket);
+        return bytes;
+    }
+
+    void SymbolRollup::add(int64_t timestamp, double value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latest = std::max(m_latest, timestamp);
+        for (size_t level = 0; level < RESOLUTIONS.size(); level++)
+        {
+            const int64_t index = timestamp / RESOLUTIONS[level].m_width;
+            Bucket& bucket = m_levels[level][static_cast<size_t>(index) % RESOLUTIONS[level].m_buckets];
+            if (index > bucket.m_index)
+            {
+                //a new window starts, the ring forgets the oldest one
+                bucket = Bucket{ index, value, value, value, value, 1 };
+                continue;
+            }
+            //a late sample of a window the ring already forgot must not wipe the newer one
+            if (index < bucket.m_index)
+                continue;
+            bucket.m_min = std::min(bucket.m_min, value);
+            bucket.m_max = std::max(bucket.m_max, value);
+            bucket.m_sum += value;
+            bucket.m_last = value;
+            bucket.m_count++;
+        }
+    }
+
+    size_t SymbolRollup::query(int64_t from, int64_t to, int64_t step, std::vector<RollupAggregate>& out) const
+    {
+        const size_t before = out.size();
+        if (from > to)
+            return 0;
+        step = std::max<int64_t>(step, 1);
+
+        //coarsest resolution which still fits into a window, the finest one otherwise
+        size_t level = 0;
+        for (size_t i = 1; i < RESOLUTIONS.size(); i++)
+        {
+            if (RESOLUTIONS[i].m_width <= step)
+                level = i;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        //a fine resolution has forgotten the start of a long range, go coarser until the range is retained
+        while (level + 1 < RESOLUTIONS.size() && !retains(level, from))
+            level++;
+
+        const int64_t width = RESOLUTIONS[level].m_width;
+        const int64_t firstIndex = from / width;
+        const int64_t lastIndex = to / width;
+        const size_t buckets = RESOLUTIONS[level].m_buckets;
+
+        //never walk more buckets than the ring holds
+        const int64_t start = std::max(firstIndex, lastIndex - static_cast<int64_t>(buckets) + 1);
+        for (int64_t index = start; index <= lastIndex; index++)
+        {
+            const Bucket& bucket = m_levels[level][static_cast<size_t>(index) % buckets];
+            if (bucket.m_index != index)
+                continue;   //no samples in this bucket or already overwritten
+
+            const int64_t window = from + (index * width - from) / step * step;
+            const auto windowStart = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                    std::chrono::nanoseconds(std::max(window, from))));
+
+            if (out.size() == before || out.back().m_start != windowStart)
+            {
+                out.push_back({ windowStart, bucket.m_min, bucket.m_max, bucket.m_sum, bucket.m_last, bucket.m_count });
+                continue;
+            }
+
+            RollupAggregate& aggregate = out.back();
+            aggregate.m_min = std::min(aggregate.m_min, bucket.m_min);
+            aggregate.m_max = std::max(aggregate.m_max, bucket.m_max);
+            aggregate.m_sum += bucket.m_sum;
+            aggregate.m_last = bucket.m_last;
+            aggregate.m_count += bucket.m_count;
+        }
+        return out.size() - before;
+    }
+
+    bool SymbolRollup::retains(size_t level, int64_t timestamp) const noexcept
+    {
+        //the ring holds the buckets up to the one of the latest sample
+        if (m_latest == std::numeric_limits<int64_t>::min())
+            return true;
+        const int64_t width = RESOLUTIONS[level].m_width;
+        return timestamp / width > m_latest / width - static_cast<int64_t>(RESOLUTIONS[level].m_buckets);
+    }
+}
@@ -0,0 +1,107 @@
+// SymbolRollup.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Incremental min/max/avg/count/last aggregates per symbol at 1 s, 1 min and 1 h.
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace Symbols {
+
+    /*
+    *   an aggregated window returned by SymbolTable::Rollup().
+    */
+    struct RollupAggregate {
+        std::chrono::system_clock::time_point m_start;
+        double m_min{};
+        double m_max{};
+        double m_sum{};
+        double m_last{};
+        uint64_t m_count{};
+
+        double average() const noexcept {
+            return m_count ? m_sum / static_cast<double>(m_count) : 0.0;
+        }
+    };
+
+    /*
+    *   SymbolRollup maintains aggregates of a numeric symbol at several resolutions.
+    *   Every resolution is a ring of buckets, a sample updates one bucket per resolution, so the cost
+    *   of an update does not depend on the retention. A query picks the coarsest resolution which is
+    *   still finer than the requested step and merges its buckets into windows of that step. When that
+    *   resolution does not retain the start of the range any more, the finest coarser one which does is
+    *   used instead, so the windows are as wide as its buckets. Data older than the retention of the
+    *   coarsest resolution is gone, those windows are left out.
+    *   The range edges are rounded to the width of the chosen buckets.
+    */
+    class SymbolRollup
+    {
+    public:
+        struct Resolution {
+            int64_t m_width;        //bucket width in nanoseconds
+            size_t m_buckets;       //retention in buckets
+        };
+
+        // 1 s for two minutes, 1 min for a day, 1 h for a week
+        static inline constexpr std::array<Resolution, 3> RESOLUTIONS = { {
+            { 1000000000LL, 120 },
+            { 60 * 1000000000LL, 1440 },
+            { 3600 * 1000000000LL, 168 }
+        } };
+
+        SymbolRollup();
+        virtual ~SymbolRollup() = default;  //destructor
+
+        SymbolRollup(const SymbolRollup& r) = delete;
+        SymbolRollup& operator=(const SymbolRollup& r) = delete;
+
+        /*
+        *   get the memory a rollup occupies.
+        *   returns the size in bytes, used for the per table budget.
+        */
+        static size_t memoryUsage() noexcept;
+
+        /*
+        *   add a sample to every resolution. A resolution whose ring already moved past the
+        *   window of the sample leaves it out.
+        *   returns nothing.
+        */
+        void add(int64_t timestamp, double value);
+
+        /*
+        *   aggregate [from, to] into windows of step nanoseconds, empty windows are left out.
+        *   returns the number of windows appended to out.
+        */
+        size_t query(int64_t from, int64_t to, int64_t step, std::vector<RollupAggregate>& out) const;
+
+    private:
+        struct Bucket {
+            int64_t m_index{ -1 };  //timestamp / width, -1 if unused
+            double m_min{};
+            double m_max{};
+            double m_sum{};
+            double m_last{};
+            uint64_t m_count{};
+        };
+
+        //true if the ring of the resolution still holds the bucket of timestamp
+        bool retains(size_t level, int64_t timestamp) const noexcept;
+
+        std::array<std::vector<Bucket>, RESOLUTIONS.size()> m_levels;
+        int64_t m_latest{ std::numeric_limits<int64_t>::min() };   //timestamp of the latest sample
+        mutable std::mutex m_mutex;
+    };
+}
@@ -0,0 +1,309 @@
+// SymbolStats.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolStats.h"
+#include <algorithm>
+#include <iomanip>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Symbols {
+
+    namespace {
+        constexpr auto RELAXED = std::memory_order_relaxed;
+
+        int highestBit(uint64_t value) noexcept
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            return _BitScanReverse64(&index, value) ? static_cast<int>(index) : -1;
+#else
+            return value ? 63 - __builtin_clzll(value) : -1;
+#endif
+        }
+
+        int64_t steadyNanoseconds() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void writeHistogram(std::ostream& out, const char* prefix, const LatencyHistogram& histogram)
+        {
+            out << ",\"" << prefix << "avg_ns\":" << std::fixed << std::setprecision(1) << histogram.average()
+                << std::defaultfloat << std::setprecision(6)
+                << ",\"" << prefix << "p50_ns\":" << histogram.percentile(0.5)
+                << ",\"" << prefix << "p99_ns\":" << histogram.percentile(0.99)
+                << ",\"" << prefix << "p999_ns\":" << histogram.percentile(0.999)
+                << ",\"" << prefix << "max_ns\":" << histogram.maximum();
+        }
+    }
+
+    const char* statsOperationName(StatsOperation operation) noexcept
+    {
+        switch (operation)
+        {
+        case StatsOperation::op_GetValue: return "GetValue";
+        case StatsOperation::op_SetValue: return "SetValue";
+        case StatsOperation::op_SetValues: return "SetValues";
+        case StatsOperation::op_InsertValue: return "InsertValue";
+        case StatsOperation::op_DeleteValue: return "DeleteValue";
+        case StatsOperation::op_AddEvent: return "AddEvent";
+        case StatsOperation::op_RemoveEvent: return "RemoveEvent";
+        default: return "unknown";
+        }
+    }
+
+    const char* symbolMetricName(SymbolMetric metric) noexcept
+    {
+        switch (metric)
+        {
+        case SymbolMetric::sm_Reads: return "reads";
+        case SymbolMetric::sm_Writes: return "writes";
+        case SymbolMetric::sm_Changes: return "changes";
+        case SymbolMetric::sm_Events: return "events";
+        default: return "unknown";
+        }
+    }
+
+    size_t LatencyHistogram::bucketOf(uint64_t ns) noexcept
+    {
+        if (ns < SUB_BUCKETS)
+            return static_cast<size_t>(ns);
+
+        const unsigned exponent = static_cast<unsigned>(highestBit(ns));
+        if (exponent > MAX_EXPONENT)
+            return BUCKETS - 1;
+
+        const uint64_t sub = (ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + (exponent - SUB_BITS) * SUB_BUCKETS + static_cast<size_t>(sub);
+    }
+
+    uint64_t LatencyHistogram::lowestOf(size_t bucket) noexcept
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+
+        const unsigned exponent = static_cast<unsigned>((bucket - SUB_BUCKETS) / SUB_BUCKETS) + SUB_BITS;
+        const uint64_t sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+        return (uint64_t(1) << exponent) + (sub << (exponent - SUB_BITS));
+    }
+
+    uint64_t LatencyHistogram::percentile(double p) const noexcept
+    {
+        if (m_count == 0)
+            return 0;
+
+        //rank of the value, counted from 1
+        const uint64_t rank = std::max<uint64_t>(1,
+            static_cast<uint64_t>(std::min(p, 1.0) * static_cast<double>(m_count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < BUCKETS; bucket++)
+        {
+            seen += m_buckets[bucket];
+            if (seen >= rank)
+            {
+                const uint64_t width = bucket + 1 < BUCKETS ? lowestOf(bucket + 1) - lowestOf(bucket) : 1;
+                return lowestOf(bucket) + width / 2;
+            }
+        }
+        return lowestOf(BUCKETS - 1);
+    }
+
+    void SymbolStatsSnapshot::writeJson(std::ostream& out) const
+    {
+        const double seconds = std::chrono::duration<double>(m_interval).count();
+        for (size_t i = 0; i < m_operations.size(); i++)
+        {
+            const OperationStats& operation = m_operations[i];
+            out << "{\"operation\":\"" << statsOperationName(static_cast<StatsOperation>(i)) << "\""
+                << ",\"count\":" << operation.m_count << ",\"failed\":" << operation.m_failed
+                << ",\"per_sec\":" << std::fixed << std::setprecision(0)
+                << (seconds > 0 ? static_cast<double>(operation.m_count) / seconds : 0.0)
+                << std::defaultfloat << std::setprecision(6);
+            writeHistogram(out, "", operation.m_latency);
+            out << ",\"lock_waits\":" << operation.m_lockWaits;
+            writeHistogram(out, "lock_wait_", operation.m_lockWait);
+            out << "}\n";
+        }
+
+        const std::pair<const char*, const LatencyHistogram*> locks[] = { { "shared", &m_shared }, { "exclusive", &m_exclusive } };
+        for (const auto& lock : locks)
+        {
+            out << "{\"lock\":\"" << lock.first << "\",\"waits\":" << lock.second->m_count
+                << ",\"wait_ns\":" << lock.second->m_totalNs;
+            writeHistogram(out, "", *lock.second);
+            out << "}\n";
+        }
+    }
+
+    void SymbolStats::AtomicHistogram::record(uint64_t ns) noexcept
+    {
+        m_buckets[LatencyHistogram::bucketOf(ns)].fetch_add(1, RELAXED);
+        m_count.fetch_add(1, RELAXED);
+        m_totalNs.fetch_add(ns, RELAXED);
+    }
+
+    void SymbolStats::AtomicHistogram::mergeInto(LatencyHistogram& histogram) const noexcept
+    {
+        for (size_t i = 0; i < LatencyHistogram::BUCKETS; i++)
+            histogram.m_buckets[i] += m_buckets[i].load(RELAXED);
+        histogram.m_count += m_count.load(RELAXED);
+        histogram.m_totalNs += m_totalNs.load(RELAXED);
+    }
+
+    void SymbolStats::AtomicHistogram::clear() noexcept
+    {
+        for (auto& bucket : m_buckets)
+            bucket.store(0, RELAXED);
+        m_count.store(0, RELAXED);
+        m_totalNs.store(0, RELAXED);
+    }
+
+    SymbolStats::SymbolStats() :
+        m_shards{ std::make_unique<Shard[]>(SHARDS) },
+        m_since{ steadyNanoseconds() }
+    {
+    }
+
+    SymbolStats::~SymbolStats()
+    {
+        stopDump();
+    }
+
+    SymbolStats::Shard& SymbolStats::shard() noexcept
+    {
+        //threads get consecutive indexes, so up to SHARDS threads never share a shard
+        static std::atomic<unsigned> nextThread{ 0 };
+        thread_local const unsigned index = nextThread.fetch_add(1, RELAXED) % SHARDS;
+        return m_shards[index];
+    }
+
+    void SymbolStats::record(StatsOperation operation, uint64_t ns, bool failed,
+        const aricanli::container::LockWaitCounters& before) noexcept
+    {
+        Shard& current = shard();
+        OperationCounters& counters = current.m_operations[static_cast<size_t>(operation)];
+        counters.m_latency.record(ns);
+        if (failed)
+            counters.m_failed.fetch_add(1, RELAXED);
+
+        // the lock waits of this thread since the operation started
+        const auto& after = aricanli::container::lockWaitCounters();
+        uint64_t waitNs = 0;
+        if (after.m_sharedWaits != before.m_sharedWaits)
+        {
+            current.m_shared.record(after.m_sharedWaitNs - before.m_sharedWaitNs);
+            waitNs += after.m_sharedWaitNs - before.m_sharedWaitNs;
+        }
+        if (after.m_exclusiveWaits != before.m_exclusiveWaits)
+        {
+            current.m_exclusive.record(after.m_exclusiveWaitNs - before.m_exclusiveWaitNs);
+            waitNs += after.m_exclusiveWaitNs - before.m_exclusiveWaitNs;
+        }
+        if (waitNs > 0)
+        {
+            counters.m_lockWaits.fetch_add(1, RELAXED);
+            counters.m_lockWait.record(waitNs);
+        }
+    }
+
+    SymbolStatsSnapshot SymbolStats::snapshot() const
+    {
+        SymbolStatsSnapshot bRet;
+        bRet.m_taken = std::chrono::system_clock::now();
+        bRet.m_interval = std::chrono::nanoseconds(steadyNanoseconds() - m_since.load(RELAXED));
+
+        for (size_t s = 0; s < SHARDS; s++)
+        {
+            const Shard& shard = m_shards[s];
+            for (size_t i = 0; i < bRet.m_operations.size(); i++)
+            {
+                const OperationCounters& counters = shard.m_operations[i];
+                OperationStats& operation = bRet.m_operations[i];
+                counters.m_latency.mergeInto(operation.m_latency);
+                counters.m_lockWait.mergeInto(operation.m_lockWait);
+                operation.m_failed += counters.m_failed.load(RELAXED);
+                operation.m_lockWaits += counters.m_lockWaits.load(RELAXED);
+            }
+            shard.m_shared.mergeInto(bRet.m_shared);
+            shard.m_exclusive.mergeInto(bRet.m_exclusive);
+        }
+
+        for (auto& operation : bRet.m_operations)
+            operation.m_count = operation.m_latency.m_count;
+        return bRet;
+    }
+
+    void SymbolStats::reset()
+    {
+        //counts recorded meanwhile may be lost, the counters are statistics only
+        for (size_t s = 0; s < SHARDS; s++)
+        {
+            Shard& shard = m_shards[s];
+            for (auto& counters : shard.m_operations)
+            {
+                counters.m_latency.clear();
+                counters.m_lockWait.clear();
+                counters.m_failed.store(0, RELAXED);
+                counters.m_lockWaits.store(0, RELAXED);
+            }
+            shard.m_shared.clear();
+            shard.m_exclusive.clear();
+        }
+        m_since.store(steadyNanoseconds(), RELAXED);
+    }
+
+    void SymbolStats::startDump(std::chrono::milliseconds interval,
+        std::function<void(const SymbolStatsSnapshot&)> sink, bool resetAfter)
+    {
+        std::lock_guard<std::mutex> control(m_dumpControl);
+        stopThread();
+
+        std::lock_guard<std::mutex> lock(m_dumpMutex);
+        m_dumpStop = false;
+        m_dumpThread = std::thread(&SymbolStats::dumpLoop, this, interval, std::move(sink), resetAfter);
+    }
+
+    void SymbolStats::stopDump()
+    {
+        std::lock_guard<std::mutex> control(m_dumpControl);
+        stopThread();
+    }
+
+    void SymbolStats::stopThread()
+    {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(m_dumpMutex);
+            m_dumpStop = true;
+            thread = std::move(m_dumpThread);
+        }
+        m_dumpWake.notify_all();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    void SymbolStats::dumpLoop(std::chrono::milliseconds interval,
+        std::function<void(const SymbolStatsSnapshot&)> sink, bool resetAfter)
+    {
+        auto next = std::chrono::steady_clock::now() + interval;
+        std::unique_lock<std::mutex> lock(m_dumpMutex);
+        while (!m_dumpWake.wait_until(lock, next, [this] { return m_dumpStop; }))
+        {
+            lock.unlock();
+            sink(snapshot());
+            if (resetAfter)
+                reset();
+            lock.lock();
+            next += interval;
+        }
+    }
+}
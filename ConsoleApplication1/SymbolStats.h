@@ -0,0 +1,330 @@
+// SymbolStats.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Operation counters, latency histograms and lock wait times of a SymbolTable.
+//  Version 1.1:
+//  *Added SymbolCounters, the per symbol read, write, change and event counts behind SymbolTable::TopN().
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include "ThreadSafeMap.h"
+
+//build with SYMBOLS_STATS=0 to compile the instrumentation out, SymbolTable::EnableStats() fails then
+#ifndef SYMBOLS_STATS
+#define SYMBOLS_STATS 1
+#endif
+
+namespace Symbols {
+
+    enum class StatsOperation {
+        op_GetValue = 0,
+        op_SetValue,
+        op_SetValues,       //one call for a run of symbols
+        op_InsertValue,
+        op_DeleteValue,
+        op_AddEvent,
+        op_RemoveEvent,
+        op_Count
+    };
+
+    /*
+    *   get the name of an operation, e.g. "SetValue".
+    */
+    const char* statsOperationName(StatsOperation operation) noexcept;
+
+    enum class SymbolMetric {
+        sm_Reads = 0,       //GetValue calls which found the symbol
+        sm_Writes,          //values written by SetValue or SetValues, changed or not
+        sm_Changes,         //writes which changed the value, including changes inside the deadband
+        sm_Events,          //symbol events fired
+        sm_Count
+    };
+
+    /*
+    *   get the name of a metric, e.g. "writes".
+    */
+    const char* symbolMetricName(SymbolMetric metric) noexcept;
+
+    /*
+    *   the activity counters of a symbol. The table counts with relaxed atomics on the symbol itself,
+    *   so a thread only touches the cache line of the symbol it works on anyway, and only while the
+    *   stats of the table are enabled. A copy of a symbol holds the counts at the time of the copy.
+    */
+    class SymbolCounters
+    {
+    public:
+        SymbolCounters() = default;
+        SymbolCounters(const SymbolCounters& r) noexcept {
+            *this = r;
+        }
+
+        SymbolCounters& operator=(const SymbolCounters& r) noexcept {
+            for (size_t i = 0; i < m_counts.size(); i++)
+                m_counts[i].store(r.m_counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+
+        //const, the reads of a const table are counted as well
+        void add(SymbolMetric metric, uint64_t count = 1) const noexcept {
+            m_counts[static_cast<size_t>(metric)].fetch_add(count, std::memory_order_relaxed);
+        }
+
+        uint64_t get(SymbolMetric metric) const noexcept {
+            return m_counts[static_cast<size_t>(metric)].load(std::memory_order_relaxed);
+        }
+
+        void clear() const noexcept {
+            for (auto& count : m_counts)
+                count.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        mutable std::array<std::atomic<uint64_t>, static_cast<size_t>(SymbolMetric::sm_Count)> m_counts{};
+    };
+
+    /*
+    *   a symbol in the result of SymbolTable::TopN().
+    */
+    struct SymbolActivity {
+        uint32_t m_id{};
+        std::string m_name;
+        uint64_t m_count{};
+        double m_perSecond{};       //count divided by the time since the stats were enabled or reset
+    };
+
+    /*
+    *   a latency histogram with log-linear buckets like HdrHistogram: every power of two is split into
+    *   SUB_BUCKETS buckets, so a recorded value is off by at most 1/SUB_BUCKETS (12.5%).
+    *   Values from 0 to 2^MAX_EXPONENT nanoseconds (about 18 minutes) are kept, larger ones are clamped.
+    */
+    struct LatencyHistogram {
+        static inline constexpr unsigned SUB_BITS = 3;
+        static inline constexpr unsigned SUB_BUCKETS = 1u << SUB_BITS;
+        static inline constexpr unsigned MAX_EXPONENT = 40;
+        static inline constexpr size_t BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - SUB_BITS + 1) * SUB_BUCKETS;
+
+        std::array<uint64_t, BUCKETS> m_buckets{};
+        uint64_t m_count{};
+        uint64_t m_totalNs{};
+
+        static size_t bucketOf(uint64_t ns) noexcept;
+        static uint64_t lowestOf(size_t bucket) noexcept;    //smallest value counted in the bucket
+
+        /*
+        *   get the value below which the given share of the recorded values lies.
+        *   Params:
+        *   p: share between 0 and 1, e.g. 0.99.
+        *   Returns: returns the middle of the bucket holding that value, 0 if nothing was recorded.
+        */
+        uint64_t percentile(double p) const noexcept;
+
+        uint64_t maximum() const noexcept {
+            return percentile(1.0);
+        }
+
+        double average() const noexcept {
+            return m_count ? static_cast<double>(m_totalNs) / static_cast<double>(m_count) : 0.0;
+        }
+    };
+
+    /*
+    *   counters of one operation.
+    */
+    struct OperationStats {
+        uint64_t m_count{};
+        uint64_t m_failed{};        //calls which returned false or found no symbol
+        uint64_t m_lockWaits{};     //calls which had to wait for a lock
+        LatencyHistogram m_latency;
+        LatencyHistogram m_lockWait;    //time the waiting calls spent on the lock
+    };
+
+    /*
+    *   the counters of a table aggregated over all threads, returned by SymbolTable::Stats().
+    *   m_shared and m_exclusive hold the lock waits of the map by lock path, the operations hold
+    *   them by the operation which waited.
+    */
+    struct SymbolStatsSnapshot {
+        std::chrono::system_clock::time_point m_taken;
+        std::chrono::nanoseconds m_interval{};     //since the counters were enabled or reset
+        std::array<OperationStats, static_cast<size_t>(StatsOperation::op_Count)> m_operations{};
+        LatencyHistogram m_shared;
+        LatencyHistogram m_exclusive;
+
+        const OperationStats& operator[](StatsOperation operation) const noexcept {
+            return m_operations[static_cast<size_t>(operation)];
+        }
+
+        /*
+        *   write one JSON object per line, an operation per line followed by the lock paths.
+        */
+        void writeJson(std::ostream& out) const;
+    };
+
+    /*
+    *   SymbolStats collects the counters of a SymbolTable. Every thread records into one of SHARDS
+    *   cache aligned shards picked by its thread index, so threads do not share counters unless there
+    *   are more threads than shards. The shards are merged only when a snapshot is taken.
+    *   Lock waits come from the per thread LockWaitCounters of ThreadSafeMap, the part accrued during
+    *   an operation is charged to it.
+    */
+    class SymbolStats
+    {
+    public:
+        static inline constexpr size_t SHARDS = 16;
+
+        SymbolStats();
+        virtual ~SymbolStats();     //destructor, stops the dump thread
+
+        SymbolStats(const SymbolStats& r) = delete;
+        SymbolStats& operator=(const SymbolStats& r) = delete;
+
+        /*
+        *   measures one operation from construction to destruction, records nothing if stats is null.
+        */
+        class Scope
+        {
+        public:
+            Scope(SymbolStats* stats, StatsOperation operation) noexcept;
+            ~Scope();
+
+            Scope(const Scope& r) = delete;
+            Scope& operator=(const Scope& r) = delete;
+
+            //mark the operation as failed, e.g. the symbol was not found
+            void failed() noexcept {
+                m_failed = true;
+            }
+
+            //true if the stats are enabled, to count the symbol activity as well
+            bool active() const noexcept {
+#if SYMBOLS_STATS
+                return m_stats != nullptr;
+#else
+                return false;
+#endif
+            }
+
+        private:
+            bool m_failed{ false };
+#if SYMBOLS_STATS
+            SymbolStats* m_stats;
+            StatsOperation m_operation;
+            aricanli::container::LockWaitCounters m_before;
+            std::chrono::steady_clock::time_point m_start;
+#endif
+        };
+
+        /*
+        *   merge the shards into a snapshot.
+        *   returns the counters since the last reset.
+        */
+        SymbolStatsSnapshot snapshot() const;
+
+        /*
+        *   clear every counter.
+        *   returns nothing.
+        */
+        void reset();
+
+        /*
+        *   call sink with a snapshot every interval on a thread of its own, replaces a running dump.
+        *   Params:
+        *   interval: time between two snapshots.
+        *   sink: receives the snapshot, e.g. writes it with SymbolStatsSnapshot::writeJson().
+        *   resetAfter: clear the counters after each snapshot, so every snapshot covers one interval.
+        *   Returns: nothing.
+        */
+        void startDump(std::chrono::milliseconds interval, std::function<void(const SymbolStatsSnapshot&)> sink,
+            bool resetAfter);
+
+        /*
+        *   stop the dump thread, once it returns the sink is not running anymore.
+        *   returns nothing.
+        */
+        void stopDump();
+
+    private:
+        struct AtomicHistogram {
+            std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> m_buckets{};
+            std::atomic<uint64_t> m_count{ 0 };
+            std::atomic<uint64_t> m_totalNs{ 0 };
+
+            void record(uint64_t ns) noexcept;
+            void mergeInto(LatencyHistogram& histogram) const noexcept;
+            void clear() noexcept;
+        };
+
+        struct OperationCounters {
+            std::atomic<uint64_t> m_failed{ 0 };
+            std::atomic<uint64_t> m_lockWaits{ 0 };
+            AtomicHistogram m_latency;
+            AtomicHistogram m_lockWait;
+        };
+
+        struct alignas(64) Shard {
+            std::array<OperationCounters, static_cast<size_t>(StatsOperation::op_Count)> m_operations;
+            AtomicHistogram m_shared;
+            AtomicHistogram m_exclusive;
+        };
+
+        Shard& shard() noexcept;
+        void record(StatsOperation operation, uint64_t ns, bool failed,
+            const aricanli::container::LockWaitCounters& before) noexcept;
+        void stopThread();
+        void dumpLoop(std::chrono::milliseconds interval, std::function<void(const SymbolStatsSnapshot&)> sink,
+            bool resetAfter);
+
+        std::unique_ptr<Shard[]> m_shards;
+        std::atomic<int64_t> m_since;   //steady clock ticks of the last reset
+
+        std::mutex m_dumpControl;   //serialises startDump() and stopDump()
+        std::mutex m_dumpMutex;
+        std::condition_variable m_dumpWake;
+        bool m_dumpStop{ false };
+        std::thread m_dumpThread;
+    };
+
+#if SYMBOLS_STATS
+    inline SymbolStats::Scope::Scope(SymbolStats* stats, StatsOperation operation) noexcept :
+        m_stats{ stats }, m_operation{ operation }
+    {
+        //a disabled table passes null, which costs this branch only
+        if (m_stats)
+        {
+            m_before = aricanli::container::lockWaitCounters();
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    inline SymbolStats::Scope::~Scope()
+    {
+        if (m_stats)
+        {
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_start).count();
+            m_stats->record(m_operation, static_cast<uint64_t>(ns), m_failed, m_before);
+        }
+    }
+#else
+    inline SymbolStats::Scope::Scope(SymbolStats*, StatsOperation) noexcept {}
+    inline SymbolStats::Scope::~Scope() {}
+#endif
+}
@@ -0,0 +1,187 @@
+// SymbolStruct.cpp : implementation file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "SymbolStruct.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace Symbols {
+
+    namespace {
+        //the types registered in this process by name
+        struct StructRegistry {
+            std::mutex m_mutex;
+            std::map<std::string, std::shared_ptr<const StructLayout>> m_types;
+        };
+
+        StructRegistry& registry()
+        {
+            static StructRegistry instance;
+            return instance;
+        }
+
+        size_t alignOf(SymbolType type) noexcept
+        {
+            //Guid aligns like its first member, the scalars like themselves
+            return visitSymbolType(type, [](auto symbolType) -> size_t {
+                using T = symbol_type_t<decltype(symbolType)::value>;
+                if constexpr (std::is_arithmetic_v<T> || std::is_same_v<T, Guid>)
+                    return alignof(T);
+                else
+                    return 1;
+            });
+        }
+
+        bool sameFields(const StructLayout& layout, const std::vector<StructField>& fields) noexcept
+        {
+            if (layout.fieldCount() != fields.size())
+                return false;
+            for (size_t i = 0; i < fields.size(); i++)
+            {
+                const StructField& field = layout.field(i);
+                if (field.m_name != fields[i].m_name || field.m_type != fields[i].m_type ||
+                    field.m_offset != fields[i].m_offset)
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    size_t StructLayout::fieldSize(SymbolType type) noexcept
+    {
+        return visitSymbolType(type, [](auto symbolType) -> size_t {
+            using T = symbol_type_t<decltype(symbolType)::value>;
+            if constexpr (std::is_arithmetic_v<T> || std::is_same_v<T, Guid>)
+                return sizeof(T);
+            else
+                return 0;
+        });
+    }
+
+    std::shared_ptr<const StructLayout> StructLayout::registerType(const std::string& name, std::vector<StructField> fields)
+    {
+        if (fields.empty() || fields.size() > MAX_FIELDS)
+            return nullptr;
+
+        // 1: resolve the offsets, AUTO follows the previous field with natural alignment
+        std::vector<size_t> sizes(fields.size());
+        size_t end = 0, alignment = 1;
+        for (size_t i = 0; i < fields.size(); i++)
+        {
+            sizes[i] = fieldSize(fields[i].m_type);
+            if (sizes[i] == 0)
+                return nullptr;
+            for (size_t j = 0; j < i; j++)
+            {
+                if (fields[j].m_name == fields[i].m_name)
+                    return nullptr;
+            }
+
+            const size_t align = alignOf(fields[i].m_type);
+            alignment = std::max(alignment, align);
+            if (fields[i].m_offset == StructField::AUTO)
+                fields[i].m_offset = (end + align - 1) / align * align;
+            end = fields[i].m_offset + sizes[i];
+        }
+
+        // 2: explicit offsets may reorder the fields but not overlap them
+        std::vector<size_t> order(fields.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&fields](size_t a, size_t b) { return fields[a].m_offset < fields[b].m_offset; });
+        size_t size = 0;
+        for (const size_t i : order)
+        {
+            if (fields[i].m_offset < size)
+                return nullptr;
+            size = fields[i].m_offset + sizes[i];
+        }
+        size = (size + alignment - 1) / alignment * alignment;
+
+        // 3: one layout per name
+        StructRegistry& types = registry();
+        std::lock_guard<std::mutex> lock(types.m_mutex);
+        auto it = types.m_types.find(name);
+        if (it != types.m_types.end())
+            return sameFields(*it->second, fields) ? it->second : nullptr;
+
+        std::shared_ptr<StructLayout> layout(new StructLayout());
+        layout->m_name = name;
+        layout->m_fields = std::move(fields);
+        layout->m_sizes = std::move(sizes);
+        layout->m_size = size;
+        types.m_types.emplace(name, layout);
+        return layout;
+    }
+
+    std::shared_ptr<const StructLayout> StructLayout::find(const std::string& name)
+    {
+        StructRegistry& types = registry();
+        std::lock_guard<std::mutex> lock(types.m_mutex);
+        auto it = types.m_types.find(name);
+        return it != types.m_types.end() ? it->second : nullptr;
+    }
+
+    size_t StructLayout::fieldIndex(const std::string& name) const noexcept
+    {
+        for (size_t i = 0; i < m_fields.size(); i++)
+        {
+            if (m_fields[i].m_name == name)
+                return i;
+        }
+        return NO_FIELD;
+    }
+
+    uint64_t StructLayout::fieldsIn(size_t offset, size_t size) const noexcept
+    {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < m_fields.size(); i++)
+        {
+            if (m_fields[i].m_offset < offset + size && offset < m_fields[i].m_offset + m_sizes[i])
+                mask |= uint64_t{ 1 } << i;
+        }
+        return mask;
+    }
+
+    StructValue::StructValue(std::shared_ptr<const StructLayout> layout) :
+        m_layout{ std::move(layout) },
+        m_data(m_layout ? m_layout->size() : 0)
+    {
+
+    }
+
+    uint64_t StructValue::diff(const StructValue& other) const noexcept
+    {
+        if (m_layout != other.m_layout)
+            return m_layout ? m_layout->allFields() : (other.m_layout ? other.m_layout->allFields() : 0);
+        if (!m_layout)
+            return 0;
+        return changedFields(0, other.m_data.data(), m_data.size());
+    }
+
+    uint64_t StructValue::changedFields(size_t offset, const void* bytes, size_t size) const noexcept
+    {
+        //one compare of the whole range first, an unchanged struct is the common case
+        const auto* incoming = static_cast<const unsigned char*>(bytes);
+        if (!m_layout || size == 0 || std::memcmp(m_data.data() + offset, incoming, size) == 0)
+            return 0;
+
+        uint64_t mask = 0;
+        for (size_t i = 0; i < m_layout->fieldCount(); i++)
+        {
+            //the part of the field inside the range
+            const size_t first = std::max(offset, m_layout->field(i).m_offset);
+            const size_t last = std::min(offset + size, m_layout->field(i).m_offset + m_layout->fieldSize(i));
+            if (first < last && std::memcmp(m_data.data() + first, incoming + (first - offset), last - first) != 0)
+                mask |= uint64_t{ 1 } << i;
+        }
+        return mask;
+    }
+}
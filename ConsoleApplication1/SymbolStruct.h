@@ -0,0 +1,210 @@
+// SymbolStruct.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. User defined types (UDT) with a fixed field layout, stored in one contiguous block.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "SymbolTraits.h"
+
+namespace Symbols {
+
+    /*
+    *   a field of a user defined type, see StructLayout::registerType().
+    *   m_offset is the byte offset in the block, AUTO places the field after the previous one
+    *   with the natural alignment of its type.
+    */
+    struct StructField {
+        static inline constexpr size_t AUTO = SIZE_MAX;
+
+        std::string m_name;
+        SymbolType m_type{ SymbolType::st_Null };
+        size_t m_offset{ AUTO };
+    };
+
+    /*
+    *   StructLayout describes a user defined type, e.g. a motor struct of a PLC: the fields with their
+    *   type and precomputed offset. A layout is registered once per process by name and shared by all
+    *   values of the type, a replica decodes a value only if the same type is registered there.
+    *   Fields hold scalar types or Guid, a layout has at most MAX_FIELDS fields so that a change
+    *   fits into a 64 bit field mask.
+    */
+    class StructLayout
+    {
+    public:
+        static inline constexpr size_t MAX_FIELDS = 64;
+        static inline constexpr size_t NO_FIELD = SIZE_MAX;
+
+        /*
+        *   register a user defined type.
+        *   Params:
+        *   name: type name, e.g. "Motor".
+        *   fields: the fields in order, offsets left AUTO are computed.
+        *   Returns: the layout, the registered one if the name exists with the same fields,
+        *   nullptr if it exists with other fields or the fields are not valid (no field, more than
+        *   MAX_FIELDS, a duplicate name, a type without a fixed size or overlapping offsets).
+        */
+        static std::shared_ptr<const StructLayout> registerType(const std::string& name, std::vector<StructField> fields);
+
+        /*
+        *   find a registered type by name.
+        *   returns the layout, nullptr if no type of that name was registered.
+        */
+        static std::shared_ptr<const StructLayout> find(const std::string& name);
+
+        /*
+        *   get the size of a field of the given type.
+        *   returns 0 if the type cannot be a field.
+        */
+        static size_t fieldSize(SymbolType type) noexcept;
+
+        const std::string& getName() const noexcept {
+            return m_name;
+        }
+
+        //bytes of a value of the type
+        size_t size() const noexcept {
+            return m_size;
+        }
+
+        size_t fieldCount() const noexcept {
+            return m_fields.size();
+        }
+
+        //the field with its resolved offset
+        const StructField& field(size_t index) const noexcept {
+            return m_fields[index];
+        }
+
+        size_t fieldSize(size_t index) const noexcept {
+            return m_sizes[index];
+        }
+
+        /*
+        *   get the index of a field by name, look it up once and keep the index.
+        *   returns NO_FIELD if the type has no field of that name.
+        */
+        size_t fieldIndex(const std::string& name) const noexcept;
+
+        /*
+        *   get the mask of the fields which overlap a byte range of the block.
+        */
+        uint64_t fieldsIn(size_t offset, size_t size) const noexcept;
+
+        //a bit for every field
+        uint64_t allFields() const noexcept {
+            return m_fields.size() == 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << m_fields.size()) - 1;
+        }
+
+    private:
+        StructLayout() = default;
+
+        std::string m_name;
+        std::vector<StructField> m_fields;
+        std::vector<size_t> m_sizes;
+        size_t m_size{};
+    };
+
+    /*
+    *   StructValue is the value of a st_Struct symbol: the layout and one contiguous block holding
+    *   all fields. Fields are read and written by index at their precomputed offset, fields are
+    *   compared byte by byte, a changed NaN payload counts as a change.
+    */
+    class StructValue
+    {
+    public:
+        StructValue() = default;
+
+        //a value of the type with every field zero
+        explicit StructValue(std::shared_ptr<const StructLayout> layout);
+
+        const std::shared_ptr<const StructLayout>& getLayout() const noexcept {
+            return m_layout;
+        }
+
+        const unsigned char* data() const noexcept {
+            return m_data.data();
+        }
+
+        size_t size() const noexcept {
+            return m_data.size();
+        }
+
+        /*
+        *   read a field.
+        *   returns false if the field does not exist or its type does not store T.
+        */
+        template<typename T>
+        bool get(size_t field, T& value) const noexcept {
+            if (!holds<T>(field))
+                return false;
+            std::memcpy(&value, m_data.data() + m_layout->field(field).m_offset, sizeof(T));
+            return true;
+        }
+
+        /*
+        *   write a field.
+        *   returns false if the field does not exist or its type does not store T.
+        */
+        template<typename T>
+        bool set(size_t field, const T& value) noexcept {
+            if (!holds<T>(field))
+                return false;
+            std::memcpy(m_data.data() + m_layout->field(field).m_offset, &value, sizeof(T));
+            return true;
+        }
+
+        /*
+        *   get the mask of the fields which differ from another value of the same type.
+        *   returns allFields() of the layout if the types differ.
+        */
+        uint64_t diff(const StructValue& other) const noexcept;
+
+        /*
+        *   get the mask of the fields a write of size bytes at offset would change.
+        *   the range has to lie inside the block.
+        */
+        uint64_t changedFields(size_t offset, const void* bytes, size_t size) const noexcept;
+
+        /*
+        *   write size bytes at offset of the block, the range has to lie inside the block.
+        *   returns nothing.
+        */
+        void write(size_t offset, const void* bytes, size_t size) noexcept {
+            std::memcpy(m_data.data() + offset, bytes, size);
+        }
+
+        bool operator==(const StructValue& other) const noexcept {
+            return m_layout == other.m_layout && m_data == other.m_data;
+        }
+
+        bool operator!=(const StructValue& other) const noexcept {
+            return !(*this == other);
+        }
+
+    private:
+        template<typename T>
+        bool holds(size_t field) const noexcept {
+            static_assert(std::is_trivially_copyable_v<T>, "fields hold plain values");
+            return m_layout && field < m_layout->fieldCount() &&
+                symbolTypeStores<T>(m_layout->field(field).m_type);
+        }
+
+        std::shared_ptr<const StructLayout> m_layout;
+        std::vector<unsigned char> m_data;
+    };
+}
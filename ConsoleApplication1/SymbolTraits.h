@@ -0,0 +1,243 @@
+// SymbolTraits.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. SymbolType moved here from Symbols.h, added SymbolTypeTraits.
+//  Version 1.1:
+//  *Added SymbolTypeOf mapping a C++ type back to its SymbolType, symbolTypeStores() and visitSymbolType().
+//  Version 1.2:
+//  *Added st_ByteString and the numeric array types, stored as a std::vector of their elements.
+//   SymbolTypeTraits tells array types by is_array and element_type.
+//  Version 1.3:
+//  *Added st_Struct for user defined types, the value is a StructValue (SymbolStruct.h).
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Symbols {
+    enum class SymbolType {
+        st_Null = 0,
+        st_Boolean = 1,
+        st_SByte = 2,
+        st_Byte = 3,
+        st_Int16 = 4,
+        st_UInt16 = 5,
+        st_Int32 = 6,
+        st_UInt32 = 7,
+        st_Int64 = 8,
+        st_UInt64 = 9,
+        st_Float = 10,
+        st_Double = 11,
+        st_String = 12,
+        st_DateTime = 13,
+        st_Guid = 14,
+        st_ByteString = 15,
+        //XmlElement = 16,
+        //NodeId = 17,
+        //ExpandedNodeId = 18,
+        //StatusCode = 19,
+        //QualifiedName = 20,
+        //LocalizedText = 21,
+        st_Struct = 22,     //ExtensionObject, a user defined type, see StructLayout
+        //DataValue = 23,
+        //Variant = 24,
+        //DiagnosticInfo = 25,
+        st_WideString = 25,
+        st_Number = 26,
+        st_Integer = 27,
+        st_UInteger = 28,
+        //arrays are stored contiguously, e.g. REAL[1000] of a data block is one st_FloatArray symbol.
+        //a BYTE array is a st_ByteString, there is no BOOL array, use a ByteString or a UInt16Array
+        st_SByteArray = 29,
+        st_Int16Array = 30,
+        st_UInt16Array = 31,
+        st_Int32Array = 32,
+        st_UInt32Array = 33,
+        st_Int64Array = 34,
+        st_UInt64Array = 35,
+        st_FloatArray = 36,
+        st_DoubleArray = 37,
+        //st_FolderType = 61
+    };
+
+    //number of slots a table indexed by SymbolType needs
+    static inline constexpr size_t SYMBOL_TYPE_COUNT = static_cast<size_t>(SymbolType::st_DoubleArray) + 1;
+
+    //the value stored for SymbolType::st_Guid
+    struct Guid {
+        uint32_t Data1;
+        uint16_t Data2;
+        uint16_t Data3;
+        uint8_t Data4[8];
+    };
+
+    class StructValue;  //the value stored for SymbolType::st_Struct, see SymbolStruct.h
+
+    /*
+    *   SymbolTypeTraits maps a SymbolType to the C++ type stored in the std::any of a Symbol.
+    *   type is void for SymbolTypes which have no value (st_Null and the unused OPC UA ids).
+    *   is_scalar tells if the value has a raw 64 bit representation (see Symbol::getRaw()).
+    *   is_array tells if the value is a std::vector of element_type, element_type is void otherwise.
+    */
+    template<SymbolType symbolType>
+    struct SymbolTypeTraits {
+        using type = void;
+        using element_type = void;
+        static constexpr bool is_scalar = false;
+        static constexpr bool is_array = false;
+    };
+
+    template<typename T>
+    struct SymbolArrayOf {
+        using element_type = void;
+        static constexpr bool value = false;
+    };
+
+    template<typename T>
+    struct SymbolArrayOf<std::vector<T>> {
+        using element_type = T;
+        static constexpr bool value = true;
+    };
+
+    template<typename T>
+    struct SymbolTypeTraitsBase {
+        using type = T;
+        using element_type = typename SymbolArrayOf<T>::element_type;
+        static constexpr bool is_scalar = std::is_arithmetic_v<T>;
+        static constexpr bool is_array = SymbolArrayOf<T>::value;
+    };
+
+    template<> struct SymbolTypeTraits<SymbolType::st_Boolean> : SymbolTypeTraitsBase<bool> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_SByte> : SymbolTypeTraitsBase<signed char> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Byte> : SymbolTypeTraitsBase<unsigned char> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Int16> : SymbolTypeTraitsBase<short> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_UInt16> : SymbolTypeTraitsBase<unsigned short> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Int32> : SymbolTypeTraitsBase<int> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_UInt32> : SymbolTypeTraitsBase<unsigned int> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Int64> : SymbolTypeTraitsBase<long long> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_UInt64> : SymbolTypeTraitsBase<unsigned long long> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Float> : SymbolTypeTraitsBase<float> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Double> : SymbolTypeTraitsBase<double> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_String> : SymbolTypeTraitsBase<std::string> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_DateTime> : SymbolTypeTraitsBase<unsigned long long> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Guid> : SymbolTypeTraitsBase<Guid> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_WideString> : SymbolTypeTraitsBase<std::string> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Number> : SymbolTypeTraitsBase<float> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Integer> : SymbolTypeTraitsBase<int> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_UInteger> : SymbolTypeTraitsBase<unsigned int> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Struct> : SymbolTypeTraitsBase<StructValue> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_ByteString> : SymbolTypeTraitsBase<std::vector<unsigned char>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_SByteArray> : SymbolTypeTraitsBase<std::vector<signed char>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Int16Array> : SymbolTypeTraitsBase<std::vector<short>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_UInt16Array> : SymbolTypeTraitsBase<std::vector<unsigned short>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Int32Array> : SymbolTypeTraitsBase<std::vector<int>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_UInt32Array> : SymbolTypeTraitsBase<std::vector<unsigned int>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_Int64Array> : SymbolTypeTraitsBase<std::vector<long long>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_UInt64Array> : SymbolTypeTraitsBase<std::vector<unsigned long long>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_FloatArray> : SymbolTypeTraitsBase<std::vector<float>> {};
+    template<> struct SymbolTypeTraits<SymbolType::st_DoubleArray> : SymbolTypeTraitsBase<std::vector<double>> {};
+
+    template<SymbolType symbolType>
+    using symbol_type_t = typename SymbolTypeTraits<symbolType>::type;
+
+    /*
+    *   SymbolTypeOf maps a C++ type back to the SymbolType which stores it, e.g. double to st_Double.
+    *   A type stored by several SymbolTypes maps to the OPC UA one: int to st_Int32, float to st_Float,
+    *   std::string to st_String and unsigned long long to st_UInt64. Other types map to st_Null.
+    */
+    template<typename T>
+    struct SymbolTypeOf {
+        static constexpr SymbolType value = SymbolType::st_Null;
+    };
+
+    template<> struct SymbolTypeOf<bool> { static constexpr SymbolType value = SymbolType::st_Boolean; };
+    template<> struct SymbolTypeOf<signed char> { static constexpr SymbolType value = SymbolType::st_SByte; };
+    template<> struct SymbolTypeOf<unsigned char> { static constexpr SymbolType value = SymbolType::st_Byte; };
+    template<> struct SymbolTypeOf<short> { static constexpr SymbolType value = SymbolType::st_Int16; };
+    template<> struct SymbolTypeOf<unsigned short> { static constexpr SymbolType value = SymbolType::st_UInt16; };
+    template<> struct SymbolTypeOf<int> { static constexpr SymbolType value = SymbolType::st_Int32; };
+    template<> struct SymbolTypeOf<unsigned int> { static constexpr SymbolType value = SymbolType::st_UInt32; };
+    template<> struct SymbolTypeOf<long long> { static constexpr SymbolType value = SymbolType::st_Int64; };
+    template<> struct SymbolTypeOf<unsigned long long> { static constexpr SymbolType value = SymbolType::st_UInt64; };
+    template<> struct SymbolTypeOf<float> { static constexpr SymbolType value = SymbolType::st_Float; };
+    template<> struct SymbolTypeOf<double> { static constexpr SymbolType value = SymbolType::st_Double; };
+    template<> struct SymbolTypeOf<std::string> { static constexpr SymbolType value = SymbolType::st_String; };
+    template<> struct SymbolTypeOf<Guid> { static constexpr SymbolType value = SymbolType::st_Guid; };
+    template<> struct SymbolTypeOf<StructValue> { static constexpr SymbolType value = SymbolType::st_Struct; };
+    template<> struct SymbolTypeOf<std::vector<unsigned char>> { static constexpr SymbolType value = SymbolType::st_ByteString; };
+    template<> struct SymbolTypeOf<std::vector<signed char>> { static constexpr SymbolType value = SymbolType::st_SByteArray; };
+    template<> struct SymbolTypeOf<std::vector<short>> { static constexpr SymbolType value = SymbolType::st_Int16Array; };
+    template<> struct SymbolTypeOf<std::vector<unsigned short>> { static constexpr SymbolType value = SymbolType::st_UInt16Array; };
+    template<> struct SymbolTypeOf<std::vector<int>> { static constexpr SymbolType value = SymbolType::st_Int32Array; };
+    template<> struct SymbolTypeOf<std::vector<unsigned int>> { static constexpr SymbolType value = SymbolType::st_UInt32Array; };
+    template<> struct SymbolTypeOf<std::vector<long long>> { static constexpr SymbolType value = SymbolType::st_Int64Array; };
+    template<> struct SymbolTypeOf<std::vector<unsigned long long>> { static constexpr SymbolType value = SymbolType::st_UInt64Array; };
+    template<> struct SymbolTypeOf<std::vector<float>> { static constexpr SymbolType value = SymbolType::st_FloatArray; };
+    template<> struct SymbolTypeOf<std::vector<double>> { static constexpr SymbolType value = SymbolType::st_DoubleArray; };
+
+    template<typename T>
+    inline constexpr SymbolType symbol_type_of_v = SymbolTypeOf<std::decay_t<T>>::value;
+
+    static_assert(symbol_type_of_v<symbol_type_t<SymbolType::st_Double>> == SymbolType::st_Double);
+    static_assert(symbol_type_of_v<symbol_type_t<SymbolType::st_Int32>> == SymbolType::st_Int32);
+    static_assert(symbol_type_of_v<symbol_type_t<SymbolType::st_String>> == SymbolType::st_String);
+    static_assert(symbol_type_of_v<symbol_type_t<SymbolType::st_FloatArray>> == SymbolType::st_FloatArray);
+
+    namespace detail {
+        template<typename T, size_t... I>
+        constexpr bool storesAt(size_t index, std::index_sequence<I...>) noexcept
+        {
+            return ((index == I && std::is_same_v<symbol_type_t<static_cast<SymbolType>(I)>, T>) || ...);
+        }
+
+        template<typename Fn, size_t I>
+        auto invokeAt(Fn& fn)
+        {
+            return fn(std::integral_constant<SymbolType, static_cast<SymbolType>(I)>{});
+        }
+
+        template<typename Fn, size_t... I>
+        auto visitAt(size_t index, Fn& fn, std::index_sequence<I...>)
+        {
+            using result_t = decltype(invokeAt<Fn, 0>(fn));
+            static constexpr result_t(*TABLE[])(Fn&) = { &invokeAt<Fn, I>... };
+            return TABLE[index < sizeof...(I) ? index : 0](fn);
+        }
+    }
+
+    /*
+    *   tell if a symbol of the given type stores its value as T, e.g. float for st_Float and st_Number.
+    */
+    template<typename T>
+    constexpr bool symbolTypeStores(SymbolType type) noexcept
+    {
+        return detail::storesAt<T>(static_cast<size_t>(type), std::make_index_sequence<SYMBOL_TYPE_COUNT>{});
+    }
+
+    /*
+    *   call fn with a runtime SymbolType as a compile time constant, one indirect call instead of a
+    *   switch over every type. A type outside the enum is passed as st_Null.
+    *   Params:
+    *   type: the SymbolType.
+    *   fn: called as fn(std::integral_constant<SymbolType, type>{}), use symbol_type_t<decltype(t)::value>
+    *   for the C++ type. Every instantiation has to return the same type.
+    *   Returns: what fn returned.
+    */
+    template<typename Fn>
+    auto visitSymbolType(SymbolType type, Fn&& fn)
+    {
+        return detail::visitAt(static_cast<size_t>(type), fn, std::make_index_sequence<SYMBOL_TYPE_COUNT>{});
+    }
+}
@@ -1,408 +1,2208 @@
-// Symbols.cpp : implementation file
-// 
-// Symbols Interface for PLCiManagementConsole App
-// Version: 1.4
-// Date: February 2021
-// Authors: Kadir ALTINDAG, Suat ARICANLI
-// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
-// Copyright (c) 2021. All Rights Reserved.
-
-#include "Symbols.h"
-#include <sstream>
-
-typedef struct _GUID {
-    unsigned long  Data1;
-    unsigned short Data2;
-    unsigned short Data3;
-    unsigned char  Data4[8];
-} GUID;
-
-namespace Symbols {
-
-    SymbolEvent::EventFireType Symbol::compare(const std::any& value) const {
-        SymbolEvent::EventFireType result{ SymbolEvent::EventFireType::eft_None };
-        switch (m_type)
-        {
-        case SymbolType::st_Null:
-            break;
-
-        case SymbolType::st_Boolean:
-        {
-            const auto& b = *get<bool>();
-            auto comp = std::any_cast<bool>(value);
-            if (comp > b)
-                result = SymbolEvent::EventFireType::eft_Increase;
-            else if (comp < b)
-                result = SymbolEvent::EventFireType::eft_Decrease;
-            else
-                result = SymbolEvent::EventFireType::eft_None;
-        }
-        break;
-
-        case SymbolType::st_Float:
-        {
-            const auto& f = *get<float>();
-            auto comp = std::any_cast<float>(value);
-            if (comp > f)
-                result = SymbolEvent::EventFireType::eft_Increase;
-            else if (comp < f)
-                result = SymbolEvent::EventFireType::eft_Decrease;
-            else
-                result = SymbolEvent::EventFireType::eft_None;
-        }
-        break;
-
-        case SymbolType::st_Double:
-        {
-            const auto& d = *get<double>();
-            auto comp = std::any_cast<double>(value);
-            if (comp > d)
-                result = SymbolEvent::EventFireType::eft_Increase;
-            else if (comp < d)
-                result = SymbolEvent::EventFireType::eft_Decrease;
-            else
-                result = SymbolEvent::EventFireType::eft_None;
-        }
-        break;
-
-        case SymbolType::st_String:  //it's not a raw string
-        {
-            const auto& s = *get<std::string>();
-            auto comp = std::any_cast<std::string>(value);
-            if (comp > s)
-                result = SymbolEvent::EventFireType::eft_Increase;
-            else if (comp < s)
-                result = SymbolEvent::EventFireType::eft_Decrease;
-            else
-                result = SymbolEvent::EventFireType::eft_None;
-        }
-        break;
-
-        case SymbolType::st_Integer:
-        {
-            const auto& i = *get<int>();
-            auto comp = std::any_cast<int>(value);
-            if (comp > i)
-                result = SymbolEvent::EventFireType::eft_Increase;
-            else if (comp < i)
-                result = SymbolEvent::EventFireType::eft_Decrease;
-            else
-                result = SymbolEvent::EventFireType::eft_None;
-        }
-        break;
-
-        }
-        return result;
-    }
-
-    Symbol SymbolTable::GetValue(uint32_t id) const
-    {
-        Symbol bRet;
-        auto it = find(id);
-        if (it != cend())
-            bRet = it->second;
-        return bRet;
-    }
-
-    Symbol SymbolTable::GetValue(std::string name) const
-    {
-        Symbol bRet;
-        int index = getSymbolIdByName(name);
-        if (index > 0)
-        {
-            bRet = GetValue(index);
-        }
-        return bRet;
-    }
-
-    bool SymbolTable::AddEvent(uint32_t id, Symbols::SymbolEvent symbolEvent)
-    {
-        bool bRet = false;
-        auto it = find(id);
-        if (it != end())
-        {
-            bRet = true;
-            it->second.addEvent(symbolEvent.getEventId(), symbolEvent);
-        }
-        return bRet;
-    }
-
-    bool SymbolTable::AddEvent(std::string name, Symbols::SymbolEvent symbolEvent)
-    {
-        int index = getSymbolIdByName(name);
-        if (index > 0)
-        {
-            return AddEvent(index, symbolEvent);
-        }
-        return false;
-    }
-
-    bool SymbolTable::SetValue(uint32_t id, std::any value)
-    {
-        bool bRet = false;
-        auto it = find(id);
-        if (it != end())
-        {
-            // 1: get the current value
-            const std::any& oldVal = it->second.get();
-
-            // 2: determine how the value changed
-            Symbols::SymbolEvent::EventFireType theChange = it->second.compare(value);
-
-            // 3: update with new value
-            it->second.set(value);
-
-            if (theChange != Symbols::SymbolEvent::EventFireType::eft_None)
-            {
-                //for (auto itm = it->second.events.begin(); itm != it->second.events.end(); itm++)
-                //{
-                //    // 4: SATISFY Symbols::SymbolEvent::EventFireType
-                //    if (itm->second.getEventFireType() != Symbols::SymbolEvent::EventFireType::eft_AnyChange &&
-                //        itm->second.getEventFireType() != theChange)
-                //        continue;
-
-                //    // 5: construct arguments for specified event type and fire event
-                //    if (itm->second.getEventType() == Symbols::SymbolEvent::EventType::et_OpcServer)
-                //    {
-                //        Symbols::SymbolEvent::OpcServerArgs arg(name, it->second.getType(), oldVal, value);
-                //        itm->second.m_event(&arg);
-                //    }
-                //    else if (itm->second.getEventType() == Symbols::SymbolEvent::EventType::et_OpcClient)
-                //    {
-                //        Symbols::SymbolEvent::OpcClientArgs arg(name, it->second.getType(), oldVal, value);
-                //        itm->second.m_event(&arg);
-                //    }
-                //    else if (itm->second.getEventType() == Symbols::SymbolEvent::EventType::et_Database)
-                //    {
-                //        Symbols::SymbolEvent::DatabaseArgs arg(name, it->second.getType(), oldVal, value, 1);
-                //        itm->second.m_event(&arg);
-                //    }
-                //    else if (itm->second.getEventType() == Symbols::SymbolEvent::EventType::et_Transaction)
-                //    {
-                //        Symbols::SymbolEvent::TransactionArgs arg(name, it->second.getType(), oldVal, value, 1);
-                //        itm->second.m_event(&arg);
-                //    }
-                //}
-            }
-            bRet = true;
-        }
-        return bRet;
-    }
-
-    bool SymbolTable::SetValue(std::string name, std::any value)
-    {
-        bool bRet = false;
-        int index = getSymbolIdByName(name);
-        if (index > 0)
-        {
-            bRet = SetValue(index, value);
-        }
-        return bRet;
-    }
-
-    bool SymbolTable::InsertFromStringValue(uint32_t id, std::string name, std::string desc,
-        SymbolType type, std::string value)
-    {
-        int is;
-        std::string val;
-        std::any anyVal;
-
-        if (value.length() == 0) val = "0";
-        else val = value;
-
-        switch (type)
-        {
-        case SymbolType::st_Boolean:
-            anyVal = true;
-            if (val.substr(0, 1) == "0") anyVal = false;
-            break;
-        case SymbolType::st_SByte:
-        case SymbolType::st_Byte:
-            anyVal = val[0];
-            break;
-        case SymbolType::st_Int16:
-            is = static_cast<int>(std::strtol(val.c_str(), nullptr, 0));
-            if (is > SHRT_MAX)
-                anyVal = static_cast<short>(SHRT_MAX);
-            else if (is < SHRT_MIN)
-                anyVal = static_cast<short>(SHRT_MIN);
-            else
-                anyVal = static_cast<short>(is);
-            break;
-        case SymbolType::st_UInt16:
-            is = static_cast<int>(std::strtol(val.c_str(), nullptr, 0));
-            if (is > USHRT_MAX)
-                anyVal = static_cast<unsigned short>(USHRT_MAX);
-            else if (is < 0)
-                anyVal = static_cast<unsigned short>(0);
-            else
-                anyVal = static_cast<unsigned short>(is);
-            break;
-        case SymbolType::st_Integer:
-        case SymbolType::st_Int32:
-            anyVal = static_cast<int>(std::strtol(val.c_str(), nullptr, 0));
-            break;
-        case SymbolType::st_UInteger:
-        case SymbolType::st_UInt32:
-            anyVal = static_cast<unsigned int>(std::strtoul(val.c_str(), nullptr, 0));
-            break;
-        case SymbolType::st_Int64:
-            anyVal = static_cast<long long>(std::strtoll(val.c_str(), nullptr, 0));
-            break;
-        case SymbolType::st_UInt64:
-            anyVal = static_cast<unsigned long long>(std::strtoull(val.c_str(), nullptr, 0));
-            break;
-        case SymbolType::st_Number:
-        case SymbolType::st_Float:
-            anyVal = static_cast<float>(std::strtof(val.c_str(), nullptr));
-            break;
-        case SymbolType::st_Double:
-            anyVal = static_cast<float>(std::strtod(val.c_str(), nullptr));
-            break;
-        case SymbolType::st_String:
-            anyVal = val;
-            break;
-        case SymbolType::st_DateTime:
-            anyVal = static_cast<unsigned long long>(std::strtoull(val.c_str(), nullptr, 0));
-            break;
-        case SymbolType::st_Guid:
-            GUID guid;
-            sscanf_s(val.c_str(),
-                "{%8x-%4hx-%4hx-%2hhx%2hhx-%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx}",
-                &guid.Data1, &guid.Data2, &guid.Data3,
-                &guid.Data4[0], &guid.Data4[1], &guid.Data4[2], &guid.Data4[3],
-                &guid.Data4[4], &guid.Data4[5], &guid.Data4[6], &guid.Data4[7]);
-            anyVal = guid;
-            break;
-        case SymbolType::st_WideString:
-            anyVal = val;
-            break;
-        case SymbolType::st_Null:
-        default:
-            anyVal = val;
-            break;
-        }
-
-        return InsertValue(id, name, desc, type, anyVal);
-    }
-
-    bool SymbolTable::InsertValue(uint32_t id, std::string name, std::string desc, SymbolType type, std::any value)
-    {
-        auto result = emplace(id, Symbol{ id, name, desc, type, value });
-        return result.second;
-    }
-
-    bool SymbolTable::DeleteValue(std::string name)
-    {
-        int index = getSymbolIdByName(name);
-        if (index > 0)
-        {
-            return DeleteValue(index);
-        }
-        return false;
-    }
-
-    bool SymbolTable::DeleteValue(uint32_t id)
-    {
-        auto it = find(id);
-        if (it != end())
-        {
-            erase(it);
-            return true;
-        }
-        return false;
-    }
-
-    int SymbolTable::getSymbolIdByName(std::string name) const noexcept
-    {
-        for (const auto& item : *this)
-        {
-            if (item.second.getName() == name)
-                return item.first;
-        }
-        return 0;
-    }
-
-    std::vector<unsigned char> SymbolTable::SerializeXML() const
-    {
-        tinyxml2::XMLElement* root = nullptr, * pElm = nullptr;
-
-        std::vector<unsigned char> charVec;
-
-        std::map<std::string, Symbol> nameMap;
-        std::map<std::string, Symbol>::iterator itn;
-
-        auto pDoc = std::make_unique<tinyxml2::XMLDocument>();
-        tinyxml2::XMLNode* pRoot = pDoc->NewElement(XML_ELEMENT_SYMBOLTABLE);
-        tinyxml2::XMLNode* pTemp, *pSearch;
-        pDoc->InsertFirstChild(pRoot);
-
-        for (const auto& item : *this)
-        {
-            nameMap.emplace(item.second.getName(), item.second);
-        }
-
-        for (auto itn = nameMap.cbegin(); itn != nameMap.cend(); itn++)
-        {
-            bool lastSubs = false;
-            std::istringstream f(itn->first);
-            std::string s;
-
-            if (itn->first.length() == 0)
-                continue;
-
-            pTemp = pRoot;
-
-            // split name into substrings and search
-            while (getline(f, s, '.'))
-            {
-                // is substring same as string or is substring last substring
-                if (itn->first == s || itn->first.rfind('.' + s) == itn->first.length() - s.length() - 1)
-                    lastSubs = true;
-
-                pSearch = pTemp->FirstChildElement(s.c_str());
-
-                // substring not found? create
-                if (!pSearch)
-                {
-                    // if base variable type add variable
-                    if (lastSubs)
-                    {
-                        pElm = pDoc->NewElement(XML_ELEMENT_SYMBOL);
-                        pElm->SetAttribute(XML_ELEMENT_ID, itn->second.getId());
-                        pElm->SetAttribute(XML_ELEMENT_NAME, s.c_str());
-                        pElm->SetAttribute(XML_ELEMENT_DESC, itn->second.getDescription().c_str());
-                        pElm->SetAttribute(XML_ELEMENT_TYPE, static_cast<int>(itn->second.getType()));
-                        pTemp->LinkEndChild(pElm);
-                    }
-                    else // if folder type add folder
-                    {
-                        pElm = pDoc->NewElement(XML_ELEMENT_FOLDER);
-                        pElm->SetAttribute(XML_ELEMENT_NAME, s.c_str());
-                        pTemp->LinkEndChild(pElm);
-                        pTemp = pElm;
-                    }
-                }
-                else // substring found
-                {
-                    if (!lastSubs)
-                    {
-                        pTemp = pSearch;
-                    }
-                }
-            }
-        }
-
-        //print
-        tinyxml2::XMLPrinter printer;
-        pDoc->Accept(&printer);
-
-        const char* chIn = printer.CStr();
-
-        const char* end = chIn + strlen(chIn);
-
-        charVec.insert(charVec.end(), chIn, end);
-
-        return charVec;
-    }
+// Symbols.cpp : implementation file
+// 
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.4
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "Symbols.h"
+#include "SymbolExpression.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <optional>
+#include <sstream>
+#include <unordered_set>
+
+#if defined(_MSC_VER)
+#define SYMBOLS_SSCANF sscanf_s    //the CRT deprecates sscanf
+#else
+#define SYMBOLS_SSCANF std::sscanf
+#endif
+
+namespace Symbols {
+
+    namespace {
+        using compare_t = SymbolEvent::EventFireType(*)(const std::any&, const std::any&) noexcept;
+        using to_raw_t = bool(*)(const std::any&, uint64_t&) noexcept;
+        using from_raw_t = std::any(*)(uint64_t);
+        using raw_to_double_t = double(*)(uint64_t) noexcept;
+        using array_data_t = bool(*)(const std::any&, const void*&, size_t&) noexcept;
+        using array_from_bytes_t = std::any(*)(const void*, size_t);
+
+        SymbolEvent::EventFireType compareNothing(const std::any&, const std::any&) noexcept
+        {
+            return SymbolEvent::EventFireType::eft_None;
+        }
+
+        template<typename T>
+        SymbolEvent::EventFireType compareValues(const std::any& current, const std::any& value) noexcept
+        {
+            const T* cur = std::any_cast<T>(&current);
+            const T* comp = std::any_cast<T>(&value);
+            if (!cur || !comp)
+            {
+                //the value is not of the symbol type, we cannot tell the direction
+                return current.has_value() || value.has_value() ?
+                    SymbolEvent::EventFireType::eft_AnyChange : SymbolEvent::EventFireType::eft_None;
+            }
+
+            int order = 0;
+            if constexpr (std::is_same_v<T, Guid>)
+                order = std::memcmp(comp, cur, sizeof(Guid));
+            else
+            {
+                if constexpr (std::is_floating_point_v<T>)
+                {
+                    if (std::isnan(*cur) != std::isnan(*comp))
+                        return SymbolEvent::EventFireType::eft_AnyChange;
+                }
+                order = *comp > *cur ? 1 : (*comp < *cur ? -1 : 0);
+            }
+
+            if (order > 0)
+                return SymbolEvent::EventFireType::eft_Increase;
+            else if (order < 0)
+                return SymbolEvent::EventFireType::eft_Decrease;
+            return SymbolEvent::EventFireType::eft_None;
+        }
+
+        template<typename T>
+        SymbolEvent::EventFireType compareArrays(const std::any& current, const std::any& value) noexcept
+        {
+            const auto* cur = std::any_cast<std::vector<T>>(&current);
+            const auto* comp = std::any_cast<std::vector<T>>(&value);
+            if (!cur || !comp || cur->size() != comp->size())
+            {
+                return current.has_value() || value.has_value() ?
+                    SymbolEvent::EventFireType::eft_AnyChange : SymbolEvent::EventFireType::eft_None;
+            }
+
+            //the SIMD kernels of SetValues in chunks, the masks stay small and the first change stops it.
+            //an array has no direction, any changed element is eft_AnyChange
+            constexpr size_t CHUNK = 4096;
+            thread_local ChangeMasks masks;
+            for (size_t offset = 0; offset < cur->size(); offset += CHUNK)
+            {
+                const size_t count = std::min(CHUNK, cur->size() - offset);
+                DetectChanges(cur->data() + offset, comp->data() + offset, count, masks);
+                if (masks.changedCount() > 0)
+                    return SymbolEvent::EventFireType::eft_AnyChange;
+            }
+            return SymbolEvent::EventFireType::eft_None;
+        }
+
+        SymbolEvent::EventFireType compareStructs(const std::any& current, const std::any& value) noexcept
+        {
+            const auto* cur = std::any_cast<StructValue>(&current);
+            const auto* comp = std::any_cast<StructValue>(&value);
+            if (cur && comp && cur->diff(*comp) == 0)
+                return SymbolEvent::EventFireType::eft_None;
+            //a struct has no direction either
+            return current.has_value() || value.has_value() ?
+                SymbolEvent::EventFireType::eft_AnyChange : SymbolEvent::EventFireType::eft_None;
+        }
+
+        template<typename T>
+        bool arrayToData(const std::any& value, const void*& data, size_t& count) noexcept
+        {
+            const auto* array = std::any_cast<std::vector<T>>(&value);
+            if (!array)
+                return false;
+            data = array->data();
+            count = array->size();
+            return true;
+        }
+
+        template<typename T>
+        std::any arrayFromData(const void* data, size_t count)
+        {
+            std::vector<T> array(count);
+            if (count > 0)
+                std::memcpy(array.data(), data, count * sizeof(T));
+            return array;
+        }
+
+        template<typename T>
+        std::any parseArray(const std::string& text)
+        {
+            //elements separated by commas or white space, e.g. "1.5, 2, 3"
+            std::vector<T> array;
+            const char* pos = text.c_str();
+            for (;;)
+            {
+                while (*pos == ',' || std::isspace(static_cast<unsigned char>(*pos)))
+                    pos++;
+                if (*pos == '\0')
+                    break;
+
+                char* end = nullptr;
+                if constexpr (std::is_floating_point_v<T>)
+                    array.push_back(static_cast<T>(std::strtod(pos, &end)));
+                else if constexpr (std::is_signed_v<T>)
+                    array.push_back(static_cast<T>(std::strtoll(pos, &end, 0)));
+                else
+                    array.push_back(static_cast<T>(std::strtoull(pos, &end, 0)));
+                if (end == pos)
+                    break;  //not a number, the elements parsed so far are kept
+                pos = end;
+            }
+            return array;
+        }
+
+        std::any parseHex(const std::string& text)
+        {
+            //two hex digits per byte, e.g. "0a1b2c", white space is skipped
+            std::vector<unsigned char> bytes;
+            int high = -1;
+            for (const char ch : text)
+            {
+                int digit;
+                if (ch >= '0' && ch <= '9')
+                    digit = ch - '0';
+                else if (ch >= 'a' && ch <= 'f')
+                    digit = ch - 'a' + 10;
+                else if (ch >= 'A' && ch <= 'F')
+                    digit = ch - 'A' + 10;
+                else
+                    continue;
+
+                if (high < 0)
+                    high = digit;
+                else
+                {
+                    bytes.push_back(static_cast<unsigned char>(high * 16 + digit));
+                    high = -1;
+                }
+            }
+            return bytes;
+        }
+
+        template<typename T>
+        bool anyToRaw(const std::any& value, uint64_t& bits) noexcept
+        {
+            const T* p = std::any_cast<T>(&value);
+            if (!p)
+                return false;
+
+            if constexpr (std::is_same_v<T, float>)
+            {
+                uint32_t u;
+                std::memcpy(&u, p, sizeof(u));
+                bits = u;
+            }
+            else if constexpr (std::is_same_v<T, double>)
+                std::memcpy(&bits, p, sizeof(bits));
+            else if constexpr (std::is_signed_v<T>)
+                bits = static_cast<uint64_t>(static_cast<int64_t>(*p));   //sign extended
+            else
+                bits = static_cast<uint64_t>(*p);
+            return true;
+        }
+
+        template<typename T>
+        std::any anyFromRaw(uint64_t bits)
+        {
+            if constexpr (std::is_same_v<T, float>)
+            {
+                const auto u = static_cast<uint32_t>(bits);
+                float f;
+                std::memcpy(&f, &u, sizeof(f));
+                return f;
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                return d;
+            }
+            else
+                return static_cast<T>(bits);
+        }
+
+        template<typename T>
+        double rawAsDouble(uint64_t bits) noexcept
+        {
+            if constexpr (std::is_same_v<T, float>)
+            {
+                const auto u = static_cast<uint32_t>(bits);
+                float f;
+                std::memcpy(&f, &u, sizeof(f));
+                return f;
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                return d;
+            }
+            else if constexpr (std::is_signed_v<T>)
+                return static_cast<double>(static_cast<int64_t>(bits));
+            else
+                return static_cast<double>(bits);
+        }
+
+        //what a SymbolType can do with its value, nullptr if the type has no raw representation or is no array
+        struct TypeOperations {
+            compare_t m_compare;
+            to_raw_t m_toRaw;
+            from_raw_t m_fromRaw;
+            raw_to_double_t m_toDouble;
+            array_data_t m_arrayData;
+            array_from_bytes_t m_arrayFromBytes;
+            size_t m_elementSize;
+        };
+
+        template<SymbolType symbolType>
+        constexpr TypeOperations makeOperations() noexcept
+        {
+            using T = symbol_type_t<symbolType>;
+            using E = typename SymbolTypeTraits<symbolType>::element_type;
+            if constexpr (std::is_void_v<T>)
+                return { &compareNothing, nullptr, nullptr, nullptr, nullptr, nullptr, 0 };
+            else if constexpr (SymbolTypeTraits<symbolType>::is_scalar)
+                return { &compareValues<T>, &anyToRaw<T>, &anyFromRaw<T>, &rawAsDouble<T>, nullptr, nullptr, 0 };
+            else if constexpr (SymbolTypeTraits<symbolType>::is_array)
+                return { &compareArrays<E>, nullptr, nullptr, nullptr, &arrayToData<E>, &arrayFromData<E>, sizeof(E) };
+            else if constexpr (std::is_same_v<T, StructValue>)
+                return { &compareStructs, nullptr, nullptr, nullptr, nullptr, nullptr, 0 };
+            else
+                return { &compareValues<T>, nullptr, nullptr, nullptr, nullptr, nullptr, 0 };
+        }
+
+        template<size_t... I>
+        constexpr std::array<TypeOperations, sizeof...(I)> makeOperationsTable(std::index_sequence<I...>) noexcept
+        {
+            return { { makeOperations<static_cast<SymbolType>(I)>()... } };
+        }
+
+        //one entry per SymbolType, generated at compile time from SymbolTypeTraits
+        constexpr auto TYPE_OPERATIONS = makeOperationsTable(std::make_index_sequence<SYMBOL_TYPE_COUNT>{});
+
+        const TypeOperations* operationsOf(SymbolType type) noexcept
+        {
+            const auto index = static_cast<size_t>(type);
+            return index < TYPE_OPERATIONS.size() ? &TYPE_OPERATIONS[index] : nullptr;
+        }
+
+        int64_t nowNanoseconds() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        int64_t toNanoseconds(std::chrono::system_clock::time_point tp) noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+        }
+
+        std::vector<HistorySample> toHistorySamples(SymbolType type,
+            const std::vector<SymbolHistory::RawSample>& raw)
+        {
+            std::vector<HistorySample> samples;
+            samples.reserve(raw.size());
+            for (const auto& sample : raw)
+            {
+                samples.push_back({ std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::nanoseconds(sample.m_timestamp))),
+                    Symbol::fromRaw(type, sample.m_bits) });
+            }
+            return samples;
+        }
+
+        bool archiveEncoding(SymbolType type, SymbolArchive::Encoding& encoding) noexcept
+        {
+            switch (type)
+            {
+            case SymbolType::st_Float:
+            case SymbolType::st_Number:
+                encoding = SymbolArchive::Encoding::enc_XorFloat;
+                return true;
+            case SymbolType::st_Double:
+                encoding = SymbolArchive::Encoding::enc_XorDouble;
+                return true;
+            default:
+                //integers are stored as deltas, anything else has no raw representation
+                encoding = SymbolArchive::Encoding::enc_VarintDelta;
+                return Symbol::isScalar(type);
+            }
+        }
+
+        uint64_t hashName(const std::string& name) noexcept
+        {
+            //FNV-1a, 64 bits keep collisions of names rare, colliding names share an entry of m_nameTwins
+            uint64_t hash = 14695981039346656037ull;
+            for (const char ch : name)
+            {
+                hash ^= static_cast<unsigned char>(ch);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    }
+
+    bool Symbol::getRaw(uint64_t& bits) const noexcept
+    {
+        return toRaw(m_type, m_value, bits);
+    }
+
+    bool Symbol::toRaw(SymbolType type, const std::any& value, uint64_t& bits) noexcept
+    {
+        const TypeOperations* operations = operationsOf(type);
+        return operations && operations->m_toRaw && operations->m_toRaw(value, bits);
+    }
+
+    std::any Symbol::fromRaw(SymbolType type, uint64_t bits)
+    {
+        const TypeOperations* operations = operationsOf(type);
+        return operations && operations->m_fromRaw ? operations->m_fromRaw(bits) : std::any{};
+    }
+
+    double Symbol::rawToDouble(SymbolType type, uint64_t bits) noexcept
+    {
+        const TypeOperations* operations = operationsOf(type);
+        return operations && operations->m_toDouble ? operations->m_toDouble(bits) : 0.0;
+    }
+
+    bool Symbol::isScalar(SymbolType type) noexcept
+    {
+        const TypeOperations* operations = operationsOf(type);
+        return operations && operations->m_toRaw;
+    }
+
+    bool Symbol::isArray(SymbolType type) noexcept
+    {
+        const TypeOperations* operations = operationsOf(type);
+        return operations && operations->m_arrayData;
+    }
+
+    size_t Symbol::elementSize(SymbolType type) noexcept
+    {
+        const TypeOperations* operations = operationsOf(type);
+        return operations ? operations->m_elementSize : 0;
+    }
+
+    bool Symbol::arrayData(SymbolType type, const std::any& value, const void*& data, size_t& count) noexcept
+    {
+        const TypeOperations* operations = operationsOf(type);
+        return operations && operations->m_arrayData && operations->m_arrayData(value, data, count);
+    }
+
+    std::any Symbol::arrayFromBytes(SymbolType type, const void* data, size_t count)
+    {
+        const TypeOperations* operations = operationsOf(type);
+        return operations && operations->m_arrayFromBytes ? operations->m_arrayFromBytes(data, count) : std::any{};
+    }
+
+    size_t Symbol::getArrayLength() const noexcept
+    {
+        const void* data;
+        size_t count;
+        return arrayData(m_type, m_value, data, count) ? count : 0;
+    }
+
+    SymbolEvent::EventFireType Symbol::compare(const std::any& value) const
+    {
+        const TypeOperations* operations = operationsOf(m_type);
+        return operations ? operations->m_compare(m_value, value) : SymbolEvent::EventFireType::eft_None;
+    }
+
+    SymbolEvent::EventFireType Symbol::detectChange(const std::any& value)
+    {
+        const SymbolEvent::EventFireType change = compare(value);
+        if (change == SymbolEvent::EventFireType::eft_None || !m_deadband.isEnabled())
+            return change;
+
+        uint64_t bits;
+        if (!toRaw(m_type, value, bits))
+            return change;
+
+        //a NaN has no distance, the change into or out of it is always reported and the next
+        //finite value becomes the reference again
+        const double newVal = rawToDouble(m_type, bits);
+        if (std::isnan(newVal) || std::isnan(m_reference))
+        {
+            m_reference = newVal;
+            m_lastDirection = SymbolEvent::EventFireType::eft_None;
+            return SymbolEvent::EventFireType::eft_AnyChange;
+        }
+
+        const double diff = newVal - m_reference;
+        const auto direction = diff > 0 ? SymbolEvent::EventFireType::eft_Increase :
+            SymbolEvent::EventFireType::eft_Decrease;
+
+        double band = std::max(m_deadband.m_absolute, std::abs(m_reference) * m_deadband.m_percent / 100.0);
+        if (m_lastDirection != SymbolEvent::EventFireType::eft_None && direction != m_lastDirection)
+            band += m_deadband.m_hysteresis;
+
+        if (std::abs(diff) <= band)
+            return SymbolEvent::EventFireType::eft_Filtered;
+
+        m_reference = newVal;
+        m_lastDirection = direction;
+        return direction;
+    }
+
+    void Symbol::setDeadband(const SymbolDeadband& deadband) noexcept
+    {
+        m_deadband = deadband;
+        m_lastDirection = SymbolEvent::EventFireType::eft_None;
+
+        uint64_t bits;
+        m_reference = getRaw(bits) ? rawToDouble(m_type, bits) : 0.0;
+    }
+
+    size_t Symbol::fireEvents(SymbolEvent::EventFireType change, const std::any& oldVal)
+    {
+        size_t fired = 0;
+        m_events.ForEach([&](auto& item)
+        {
+            auto& symbolEvent = item.second;
+
+            // 1: SATISFY Symbols::SymbolEvent::EventFireType
+            if (symbolEvent.getEventFireType() != SymbolEvent::EventFireType::eft_AnyChange &&
+                symbolEvent.getEventFireType() != change)
+                return;
+            if (symbolEvent.getCondition() && !symbolEvent.getCondition()->test())
+                return;
+
+            // 2: construct arguments for specified event type and fire event
+            switch (symbolEvent.getEventType())
+            {
+            case SymbolEvent::EventType::et_OpcServer:
+            {
+                SymbolEvent::OpcServerArgs arg(m_name, m_type, oldVal, m_value);
+                symbolEvent.m_event(&arg);
+            }
+            break;
+
+            case SymbolEvent::EventType::et_OpcClient:
+            {
+                SymbolEvent::OpcClientArgs arg(m_name, m_type, oldVal, m_value);
+                symbolEvent.m_event(&arg);
+            }
+            break;
+
+            case SymbolEvent::EventType::et_Database:
+            {
+                SymbolEvent::DatabaseArgs arg(m_name, m_type, oldVal, m_value, 1);
+                symbolEvent.m_event(&arg);
+            }
+            break;
+
+            case SymbolEvent::EventType::et_Transaction:
+            {
+                SymbolEvent::TransactionArgs arg(m_name, m_type, oldVal, m_value, 1);
+                symbolEvent.m_event(&arg);
+            }
+            break;
+
+            default:
+            {
+                SymbolEvent::BaseArgs arg;
+                arg.m_symbolName = m_name;
+                arg.m_type = m_type;
+                arg.m_oldVal = &oldVal;
+                arg.m_newVal = &m_value;
+                symbolEvent.m_event(&arg);
+            }
+            break;
+            }
+            fired++;
+        });
+        return fired;
+    }
+
+    Symbol SymbolTable::GetValue(uint32_t id) const
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_GetValue);
+        Symbol bRet;
+        auto it = find(id);
+        if (it != cend())
+        {
+            if (scope.active())
+                it->second.getCounters().add(SymbolMetric::sm_Reads);
+            bRet = it->second;
+        }
+        else
+            scope.failed();
+        return bRet;
+    }
+
+    Symbol SymbolTable::GetValue(std::string name) const
+    {
+        Symbol bRet;
+        int index = getSymbolIdByName(name);
+        if (index > 0)
+        {
+            bRet = GetValue(index);
+        }
+        return bRet;
+    }
+
+    bool SymbolTable::AddEvent(uint32_t id, Symbols::SymbolEvent symbolEvent)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_AddEvent);
+        bool bRet = false;
+        auto it = find(id);
+        if (it != end())
+        {
+            bRet = true;
+            it->second.addEvent(symbolEvent.getEventId(), std::move(symbolEvent));
+        }
+        else
+            scope.failed();
+        return bRet;
+    }
+
+    bool SymbolTable::SetDeadband(uint32_t id, const SymbolDeadband& deadband)
+    {
+        auto it = find(id);
+        if (it == end() || !Symbol::isScalar(it->second.getType()))
+            return false;
+
+        it->second.setDeadband(deadband);
+        return true;
+    }
+
+    bool SymbolTable::RemoveEvent(uint32_t id, int eventId)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_RemoveEvent);
+        bool bRet = false;
+        auto it = find(id);
+        if (it != end())
+        {
+            bRet = true;
+            it->second.removeEvent(eventId);
+        }
+        else
+            scope.failed();
+        return bRet;
+    }
+
+    bool SymbolTable::AddEvent(std::string name, Symbols::SymbolEvent symbolEvent)
+    {
+        int index = getSymbolIdByName(name);
+        if (index > 0)
+        {
+            return AddEvent(index, std::move(symbolEvent));
+        }
+        return false;
+    }
+
+    bool SymbolTable::SetValue(uint32_t id, std::any value)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_SetValue);
+        bool bRet = false;
+        auto it = find(id);
+        if (it != end())
+        {
+            applyValue(it->second, std::move(value));
+            bRet = true;
+        }
+        else
+            scope.failed();
+        return bRet;
+    }
+
+    bool SymbolTable::SetValue(const SymbolHandle& handle, std::any value)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_SetValue);
+        Symbol* symbol = handle.m_table == this ? handle.symbol() : nullptr;
+        if (!symbol)
+        {
+            scope.failed();
+            return false;
+        }
+        applyValue(*symbol, std::move(value));
+        return true;
+    }
+
+    SymbolHandle SymbolTable::Resolve(uint32_t id)
+    {
+        //a DeleteValue() holds the mutex until the symbol is erased, so the symbol found stays until it has a slot
+        std::lock_guard<std::mutex> lock(m_handleMutex);
+        auto it = find(id);
+        if (it == end())
+            return {};
+
+        Symbol& symbol = it->second;
+        if (symbol.getHandleSlot() == decltype(m_handles)::NO_SLOT)
+        {
+            const uint32_t slot = m_handles.acquire(&symbol);
+            if (slot == decltype(m_handles)::NO_SLOT)
+                return {};
+            symbol.setHandleSlot(slot);
+        }
+        return { this, id, symbol.getHandleSlot(), m_handles.generation(symbol.getHandleSlot()) };
+    }
+
+    SymbolHandle SymbolTable::Resolve(const std::string& name)
+    {
+        const int id = getSymbolIdByName(name);
+        return id > 0 ? Resolve(static_cast<uint32_t>(id)) : SymbolHandle{};
+    }
+
+    template<typename T>
+    size_t SymbolTable::SetValues(uint32_t firstId, const T* values, size_t count)
+    {
+        //reused between calls, a block read should not allocate.
+        //not a std::vector<T>, the kernels need contiguous storage for bool as well
+        struct Scratch {
+            std::unique_ptr<T[]> m_current;
+            size_t m_capacity{};
+            std::vector<Symbol*> m_symbols;
+            ChangeMasks m_masks;
+        };
+        thread_local Scratch reused;
+        thread_local unsigned depth = 0;
+
+        //an event fired below may call SetValues() again, the nested call must not overwrite the
+        //buffers the outer one still walks, it works on its own
+        struct DepthGuard {
+            unsigned& m_depth;
+            explicit DepthGuard(unsigned& d) noexcept : m_depth(d) { m_depth++; }
+            ~DepthGuard() { m_depth--; }
+        };
+        std::optional<Scratch> nested;
+        Scratch& scratch = depth == 0 ? reused : nested.emplace();
+        const DepthGuard guard(depth);
+        auto& current = scratch.m_current;
+        auto& capacity = scratch.m_capacity;
+        std::vector<Symbol*>& symbols = scratch.m_symbols;
+        auto& masks = scratch.m_masks;
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_SetValues);
+        //the computed symbols are recomputed once for the run
+        std::optional<SymbolBatch> batch;
+        if (m_hasComputed.load(std::memory_order_relaxed))
+            batch.emplace(*this);
+
+        if (capacity < count)
+        {
+            current = std::make_unique<T[]>(count);
+            capacity = count;
+        }
+        std::fill_n(current.get(), count, T{});
+        symbols.assign(count, nullptr);
+        if (count == 0)
+            return 0;
+
+        // 1: gather the symbols of the run in one walk, gaps stay nullptr
+        const uint64_t lastId = std::min<uint64_t>(uint64_t{ firstId } + count - 1, UINT32_MAX);
+        ForEachInRange(firstId, static_cast<uint32_t>(lastId), [&](auto& item)
+        {
+            symbols[item.first - firstId] = &item.second;
+        });
+
+        // 2: the current values, another type falls back to the single value path.
+        //    applyValue fires events, it runs after the walk released the lock
+        size_t changes = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!symbols[i])
+                continue;
+            if (const T* value = symbols[i]->get<T>())
+                current[i] = *value;
+            else
+            {
+                if (applyValue(*symbols[i], std::any(values[i])))
+                    changes++;
+                symbols[i] = nullptr;
+            }
+        }
+
+        // 3: one kernel call for the whole run
+        DetectChanges(current.get(), values, count, masks);
+
+        // 4: only the changed symbols take the event path, the others just record a sample and,
+        //    as in applyValue(), complete a delayed alarm level whose delay has passed
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!symbols[i])
+                continue;
+            if (!masks.isChanged(i))
+            {
+                recordSample(*symbols[i]);
+                if (scope.active())
+                    symbols[i]->getCounters().add(SymbolMetric::sm_Writes);
+                if (const auto alarm = symbols[i]->getAlarm())
+                    updateAlarm(*symbols[i], *alarm);
+            }
+            else if (applyValue(*symbols[i], std::any(values[i])))
+                changes++;
+        }
+        return changes;
+    }
+
+    template size_t SymbolTable::SetValues<bool>(uint32_t, const bool*, size_t);
+    template size_t SymbolTable::SetValues<signed char>(uint32_t, const signed char*, size_t);
+    template size_t SymbolTable::SetValues<unsigned char>(uint32_t, const unsigned char*, size_t);
+    template size_t SymbolTable::SetValues<short>(uint32_t, const short*, size_t);
+    template size_t SymbolTable::SetValues<unsigned short>(uint32_t, const unsigned short*, size_t);
+    template size_t SymbolTable::SetValues<int>(uint32_t, const int*, size_t);
+    template size_t SymbolTable::SetValues<unsigned int>(uint32_t, const unsigned int*, size_t);
+    template size_t SymbolTable::SetValues<long long>(uint32_t, const long long*, size_t);
+    template size_t SymbolTable::SetValues<unsigned long long>(uint32_t, const unsigned long long*, size_t);
+    template size_t SymbolTable::SetValues<float>(uint32_t, const float*, size_t);
+    template size_t SymbolTable::SetValues<double>(uint32_t, const double*, size_t);
+
+    template<typename T>
+    bool SymbolTable::SetSlice(uint32_t id, size_t offset, const T* values, size_t count, ChangeMasks* changes)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_SetValues);
+        auto it = find(id);
+        const bool bRet = it != end() && applySlice(it->second, offset, values, count, changes);
+        if (!bRet)
+            scope.failed();
+        return bRet;
+    }
+
+    template<typename T>
+    bool SymbolTable::SetSlice(const SymbolHandle& handle, size_t offset, const T* values, size_t count, ChangeMasks* changes)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_SetValues);
+        Symbol* symbol = handle.m_table == this ? handle.symbol() : nullptr;
+        const bool bRet = symbol && applySlice(*symbol, offset, values, count, changes);
+        if (!bRet)
+            scope.failed();
+        return bRet;
+    }
+
+    template<typename T>
+    bool SymbolTable::GetSlice(uint32_t id, size_t offset, T* values, size_t count) const
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_GetValue);
+        auto it = find(id);
+        const auto* array = it != end() ? it->second.get<std::vector<T>>() : nullptr;
+        if (!array || offset > array->size() || count > array->size() - offset)
+        {
+            scope.failed();
+            return false;
+        }
+        std::copy_n(array->data() + offset, count, values);
+        if (scope.active())
+            it->second.getCounters().add(SymbolMetric::sm_Reads);
+        return true;
+    }
+
+    template<typename T>
+    bool SymbolTable::applySlice(Symbol& symbol, size_t offset, const T* values, size_t count, ChangeMasks* changes)
+    {
+        thread_local ChangeMasks local;
+        std::vector<T>* array = symbol.getArray<T>();
+        if (!array || offset > array->size() || count > array->size() - offset)
+            return false;
+
+        // 1: one kernel call for the slice, the masks tell the caller which elements changed
+        ChangeMasks& masks = changes ? *changes : local;
+        DetectChanges(array->data() + offset, values, count, masks);
+        const bool counted = activeStats() != nullptr;
+        if (counted)
+            symbol.getCounters().add(SymbolMetric::sm_Writes);
+        if (masks.changedCount() == 0)
+            return true;
+
+        // 2: write the elements in place, the events get the old array, it is only copied for them
+        std::any oldVal;
+        if (symbol.hasEvents())
+            oldVal = symbol.get();
+        std::copy_n(values, count, array->data() + offset);
+
+        // 3: an array has no deadband and no direction
+        const size_t fired = symbol.fireEvents(SymbolEvent::EventFireType::eft_AnyChange, oldVal);
+        if (counted)
+        {
+            symbol.getCounters().add(SymbolMetric::sm_Changes);
+            if (fired > 0)
+                symbol.getCounters().add(SymbolMetric::sm_Events, fired);
+        }
+        fireTableEvents(SymbolCodec::ChangeType::ct_Set, symbol, SymbolEvent::EventFireType::eft_AnyChange);
+        propagate(symbol.getId());
+        return true;
+    }
+
+#define SYMBOLS_INSTANTIATE_SLICE(T) \
+    template bool SymbolTable::SetSlice<T>(uint32_t, size_t, const T*, size_t, ChangeMasks*); \
+    template bool SymbolTable::SetSlice<T>(const SymbolHandle&, size_t, const T*, size_t, ChangeMasks*); \
+    template bool SymbolTable::GetSlice<T>(uint32_t, size_t, T*, size_t) const;
+
+    SYMBOLS_INSTANTIATE_SLICE(signed char)
+    SYMBOLS_INSTANTIATE_SLICE(unsigned char)
+    SYMBOLS_INSTANTIATE_SLICE(short)
+    SYMBOLS_INSTANTIATE_SLICE(unsigned short)
+    SYMBOLS_INSTANTIATE_SLICE(int)
+    SYMBOLS_INSTANTIATE_SLICE(unsigned int)
+    SYMBOLS_INSTANTIATE_SLICE(long long)
+    SYMBOLS_INSTANTIATE_SLICE(unsigned long long)
+    SYMBOLS_INSTANTIATE_SLICE(float)
+    SYMBOLS_INSTANTIATE_SLICE(double)
+#undef SYMBOLS_INSTANTIATE_SLICE
+
+    bool SymbolTable::SetStruct(uint32_t id, const void* data, size_t size, uint64_t* changedFields)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_SetValue);
+        auto it = find(id);
+        const StructValue* current = it != end() ? it->second.get<StructValue>() : nullptr;
+        const bool bRet = current && size == current->size() && applyStruct(it->second, 0, data, size, changedFields);
+        if (!bRet)
+            scope.failed();
+        return bRet;
+    }
+
+    bool SymbolTable::SetStruct(const SymbolHandle& handle, const void* data, size_t size, uint64_t* changedFields)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_SetValue);
+        Symbol* symbol = handle.m_table == this ? handle.symbol() : nullptr;
+        const StructValue* current = symbol ? symbol->get<StructValue>() : nullptr;
+        const bool bRet = current && size == current->size() && applyStruct(*symbol, 0, data, size, changedFields);
+        if (!bRet)
+            scope.failed();
+        return bRet;
+    }
+
+    bool SymbolTable::applyStruct(Symbol& symbol, size_t offset, const void* data, size_t size, uint64_t* changedFields)
+    {
+        StructValue* value = symbol.getStruct();
+        if (!value || offset > value->size() || size > value->size() - offset)
+            return false;
+
+        // 1: the fields inside the range which differ, at their precomputed offsets
+        const uint64_t changed = value->changedFields(offset, data, size);
+        if (changedFields)
+            *changedFields = changed;
+        const bool counted = activeStats() != nullptr;
+        if (counted)
+            symbol.getCounters().add(SymbolMetric::sm_Writes);
+
+        // 2: write in place, padding bytes are copied as well, the old value is only copied for the events
+        if (changed == 0)
+        {
+            value->write(offset, data, size);
+            return true;
+        }
+        std::any oldVal;
+        if (symbol.hasEvents())
+            oldVal = symbol.get();
+        value->write(offset, data, size);
+
+        // 3: like an array, a struct has no deadband and no direction
+        const size_t fired = symbol.fireEvents(SymbolEvent::EventFireType::eft_AnyChange, oldVal);
+        if (counted)
+        {
+            symbol.getCounters().add(SymbolMetric::sm_Changes);
+            if (fired > 0)
+                symbol.getCounters().add(SymbolMetric::sm_Events, fired);
+        }
+        fireTableEvents(SymbolCodec::ChangeType::ct_Set, symbol, SymbolEvent::EventFireType::eft_AnyChange);
+        propagate(symbol.getId());
+        return true;
+    }
+
+    bool SymbolTable::applyValue(Symbol& symbol, std::any&& value)
+    {
+        // 1: determine how the value changed, the deadband of the symbol is applied here
+        const Symbols::SymbolEvent::EventFireType theChange = symbol.detectChange(value);
+
+        // 2: update with new value and keep the current one for the events
+        const std::any oldVal = symbol.exchange(std::move(value));
+
+        // 3: record the new sample if the symbol keeps history, publish it to other processes
+        recordSample(symbol);
+        shareValue(symbol);
+        const bool counted = activeStats() != nullptr;
+        if (counted)
+            symbol.getCounters().add(SymbolMetric::sm_Writes);
+
+        // 4: an unchanged value still completes a delayed alarm level whose delay has passed
+        if (const auto alarm = symbol.getAlarm())
+            updateAlarm(symbol, *alarm);
+
+        // 5: fire the events, changes inside the deadband only reach the table events
+        if (theChange == Symbols::SymbolEvent::EventFireType::eft_None)
+            return false;
+
+        const bool reported = theChange != Symbols::SymbolEvent::EventFireType::eft_Filtered;
+        const size_t fired = reported ? symbol.fireEvents(theChange, oldVal) : 0;
+        if (counted)
+        {
+            symbol.getCounters().add(SymbolMetric::sm_Changes);
+            if (fired > 0)
+                symbol.getCounters().add(SymbolMetric::sm_Events, fired);
+        }
+        fireTableEvents(SymbolCodec::ChangeType::ct_Set, symbol, theChange);
+        propagate(symbol.getId());
+        return reported;
+    }
+
+    void SymbolTable::recordSample(const Symbol& symbol)
+    {
+        //copies, another thread may disable them while the sample is recorded
+        const auto history = symbol.getHistory();
+        const auto archive = symbol.getArchive();
+        const auto rollup = symbol.getRollup();
+        uint64_t bits;
+        if ((history || archive || rollup) && symbol.getRaw(bits))
+        {
+            const int64_t now = nowNanoseconds();
+            if (history)
+                history->append(now, bits);
+            if (archive)
+                archive->append(now, bits);
+            if (rollup)
+                rollup->add(now, Symbol::rawToDouble(symbol.getType(), bits));
+        }
+    }
+
+    bool SymbolTable::SetValue(std::string name, std::any value)
+    {
+        bool bRet = false;
+        int index = getSymbolIdByName(name);
+        if (index > 0)
+        {
+            bRet = SetValue(index, std::move(value));
+        }
+        return bRet;
+    }
+
+    bool SymbolTable::InsertFromStringValue(uint32_t id, std::string name, std::string desc,
+        SymbolType type, std::string value)
+    {
+        //arrays keep an empty string empty, a ByteString is hex digits, a struct is the name of a registered type
+        if (type == SymbolType::st_Struct)
+        {
+            auto layout = StructLayout::find(value);
+            return layout && InsertValue(id, std::move(name), std::move(desc), type, StructValue(std::move(layout)));
+        }
+        if (type == SymbolType::st_ByteString)
+            return InsertValue(id, std::move(name), std::move(desc), type, parseHex(value));
+        if (Symbol::isArray(type))
+        {
+            std::any array = visitSymbolType(type, [&value](auto symbolType) -> std::any {
+                using E = typename SymbolTypeTraits<decltype(symbolType)::value>::element_type;
+                if constexpr (std::is_void_v<E>)
+                    return {};
+                else
+                    return parseArray<E>(value);
+            });
+            return InsertValue(id, std::move(name), std::move(desc), type, std::move(array));
+        }
+
+        int is;
+        std::string val;
+        std::any anyVal;
+
+        if (value.length() == 0) val = "0";
+        else val = std::move(value);
+
+        switch (type)
+        {
+        case SymbolType::st_Boolean:
+            anyVal = true;
+            if (val.substr(0, 1) == "0") anyVal = false;
+            break;
+        case SymbolType::st_SByte:
+            is = static_cast<int>(std::strtol(val.c_str(), nullptr, 0));
+            anyVal = static_cast<signed char>(std::clamp(is, SCHAR_MIN, SCHAR_MAX));
+            break;
+        case SymbolType::st_Byte:
+            is = static_cast<int>(std::strtol(val.c_str(), nullptr, 0));
+            anyVal = static_cast<unsigned char>(std::clamp(is, 0, UCHAR_MAX));
+            break;
+        case SymbolType::st_Int16:
+            is = static_cast<int>(std::strtol(val.c_str(), nullptr, 0));
+            if (is > SHRT_MAX)
+                anyVal = static_cast<short>(SHRT_MAX);
+            else if (is < SHRT_MIN)
+                anyVal = static_cast<short>(SHRT_MIN);
+            else
+                anyVal = static_cast<short>(is);
+            break;
+        case SymbolType::st_UInt16:
+            is = static_cast<int>(std::strtol(val.c_str(), nullptr, 0));
+            if (is > USHRT_MAX)
+                anyVal = static_cast<unsigned short>(USHRT_MAX);
+            else if (is < 0)
+                anyVal = static_cast<unsigned short>(0);
+            else
+                anyVal = static_cast<unsigned short>(is);
+            break;
+        case SymbolType::st_Integer:
+        case SymbolType::st_Int32:
+            anyVal = static_cast<int>(std::strtol(val.c_str(), nullptr, 0));
+            break;
+        case SymbolType::st_UInteger:
+        case SymbolType::st_UInt32:
+            anyVal = static_cast<unsigned int>(std::strtoul(val.c_str(), nullptr, 0));
+            break;
+        case SymbolType::st_Int64:
+            anyVal = static_cast<long long>(std::strtoll(val.c_str(), nullptr, 0));
+            break;
+        case SymbolType::st_UInt64:
+            anyVal = static_cast<unsigned long long>(std::strtoull(val.c_str(), nullptr, 0));
+            break;
+        case SymbolType::st_Number:
+        case SymbolType::st_Float:
+            anyVal = static_cast<float>(std::strtof(val.c_str(), nullptr));
+            break;
+        case SymbolType::st_Double:
+            anyVal = std::strtod(val.c_str(), nullptr);
+            break;
+        case SymbolType::st_String:
+            anyVal = std::move(val);
+            break;
+        case SymbolType::st_DateTime:
+            anyVal = static_cast<unsigned long long>(std::strtoull(val.c_str(), nullptr, 0));
+            break;
+        case SymbolType::st_Guid:
+        {
+            Guid guid{};
+            SYMBOLS_SSCANF(val.c_str(),
+                "{%8x-%4hx-%4hx-%2hhx%2hhx-%2hhx%2hhx%2hhx%2hhx%2hhx%2hhx}",
+                &guid.Data1, &guid.Data2, &guid.Data3,
+                &guid.Data4[0], &guid.Data4[1], &guid.Data4[2], &guid.Data4[3],
+                &guid.Data4[4], &guid.Data4[5], &guid.Data4[6], &guid.Data4[7]);
+            anyVal = guid;
+        }
+        break;
+        case SymbolType::st_WideString:
+            anyVal = std::move(val);
+            break;
+        case SymbolType::st_Null:
+        default:
+            anyVal = std::move(val);
+            break;
+        }
+
+        return InsertValue(id, std::move(name), std::move(desc), type, std::move(anyVal));
+    }
+
+    bool SymbolTable::InsertValue(uint32_t id, std::string name, std::string desc, SymbolType type, std::any value)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_InsertValue);
+        const uint64_t hash = hashName(name);
+        //the symbol is constructed in the map node, an existing id constructs nothing
+        auto result = try_emplace(id, id, std::move(name), std::move(desc), type, std::move(value));
+        if (result.second)
+        {
+            {
+                //EnableSharedMemory() publishes under the same lock, the symbol is published exactly once
+                std::lock_guard<std::mutex> nameLock(m_nameMutex);
+                indexName(hash, id);
+                shareSymbol(result.first->second);
+            }
+            fireTableEvents(SymbolCodec::ChangeType::ct_Insert, result.first->second,
+                SymbolEvent::EventFireType::eft_AnyChange);
+        }
+        else
+            scope.failed();
+        return result.second;
+    }
+
+    bool SymbolTable::DeleteValue(std::string name)
+    {
+        int index = getSymbolIdByName(name);
+        if (index > 0)
+        {
+            return DeleteValue(index);
+        }
+        return false;
+    }
+
+    bool SymbolTable::DeleteValue(uint32_t id)
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_DeleteValue);
+        std::unique_lock<std::mutex> handleLock(m_handleMutex);
+        auto it = find(id);
+        if (it != end())
+        {
+            //only the thread which takes the buffer out gives its budget back, a concurrent
+            //DisableHistory() or DisableRollup() finds none left
+            if (const auto history = it->second.setHistory(nullptr))
+                m_historyUsed -= SymbolHistory::memoryUsage(history->capacity());
+            if (it->second.setRollup(nullptr))
+                m_historyUsed -= SymbolRollup::memoryUsage();
+            if (const auto shared = std::atomic_load(&m_shared))
+                shared->remove(it->second.getSharedSlot());
+
+            //handles of the symbol turn invalid before its node is freed
+            m_handles.release(it->second.getHandleSlot());
+
+            //the event runs after the erase, a snapshot taken meanwhile does not see the symbol anymore
+            const Symbol deleted = std::move(it->second);
+            erase(it);
+            handleLock.unlock();
+            {
+                std::lock_guard<std::mutex> nameLock(m_nameMutex);
+                unindexName(hashName(deleted.getName()), id);
+            }
+            fireTableEvents(SymbolCodec::ChangeType::ct_Delete, deleted, SymbolEvent::EventFireType::eft_AnyChange);
+
+            //the symbols computed from it see nullptr for it from now on
+            if (m_hasComputed.load(std::memory_order_relaxed))
+            {
+                RemoveComputed(id);
+                propagateChange(id);
+            }
+            return true;
+        }
+        scope.failed();
+        return false;
+    }
+
+    bool SymbolTable::EnableHistory(uint32_t id, size_t capacity)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        //only scalar values have a raw representation
+        if (!Symbol::isScalar(it->second.getType()))
+            return false;
+
+        //reserve the budget before allocating
+        if (!reserveHistoryBudget(SymbolHistory::memoryUsage(capacity)))
+            return false;
+
+        if (const auto previous = it->second.setHistory(std::make_shared<SymbolHistory>(capacity)))
+            m_historyUsed -= SymbolHistory::memoryUsage(previous->capacity());
+        return true;
+    }
+
+    bool SymbolTable::DisableHistory(uint32_t id)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        //only the thread which takes the buffer out gives its budget back
+        const auto history = it->second.setHistory(nullptr);
+        if (!history)
+            return false;
+
+        m_historyUsed -= SymbolHistory::memoryUsage(history->capacity());
+        return true;
+    }
+
+    void SymbolTable::SetHistoryBudget(size_t bytes) noexcept
+    {
+        m_historyBudget = bytes;
+    }
+
+    std::vector<HistorySample> SymbolTable::History(uint32_t id,
+        std::chrono::system_clock::time_point from,
+        std::chrono::system_clock::time_point to) const
+    {
+        auto it = find(id);
+        if (it == cend())
+            return {};
+
+        //keep the buffer alive even if history gets disabled meanwhile
+        const std::shared_ptr<SymbolHistory> history = it->second.getHistory();
+        if (!history)
+            return {};
+
+        std::vector<SymbolHistory::RawSample> raw;
+        raw.reserve(history->size());
+        history->query(toNanoseconds(from), toNanoseconds(to), raw);
+        return toHistorySamples(it->second.getType(), raw);
+    }
+
+    bool SymbolTable::EnableArchive(uint32_t id, size_t maxBytes)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        SymbolArchive::Encoding encoding;
+        if (!archiveEncoding(it->second.getType(), encoding))
+            return false;
+
+        it->second.setArchive(std::make_shared<SymbolArchive>(encoding,
+            SymbolArchive::DEFAULT_RESOLUTION, SymbolArchive::DEFAULT_BLOCK_SAMPLES, maxBytes));
+        return true;
+    }
+
+    bool SymbolTable::DisableArchive(uint32_t id)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        return it->second.setArchive(nullptr) != nullptr;
+    }
+
+    std::vector<HistorySample> SymbolTable::Archive(uint32_t id,
+        std::chrono::system_clock::time_point from,
+        std::chrono::system_clock::time_point to) const
+    {
+        auto it = find(id);
+        if (it == cend())
+            return {};
+
+        //keep the archive alive even if it gets disabled meanwhile
+        const std::shared_ptr<SymbolArchive> archive = it->second.getArchive();
+        if (!archive)
+            return {};
+
+        std::vector<SymbolHistory::RawSample> raw;
+        archive->query(toNanoseconds(from), toNanoseconds(to), raw);
+        return toHistorySamples(it->second.getType(), raw);
+    }
+
+    bool SymbolTable::EnableRollup(uint32_t id)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        //only scalar values have a numeric representation
+        if (!Symbol::isScalar(it->second.getType()))
+            return false;
+
+        if (it->second.getRollup())
+            return true;
+
+        if (!reserveHistoryBudget(SymbolRollup::memoryUsage()))
+            return false;
+
+        //a concurrent EnableRollup() may have set rollups meanwhile, its budget is given back
+        if (it->second.setRollup(std::make_shared<SymbolRollup>()))
+            m_historyUsed -= SymbolRollup::memoryUsage();
+        return true;
+    }
+
+    bool SymbolTable::DisableRollup(uint32_t id)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        //only the thread which takes the rollups out gives their budget back
+        if (!it->second.setRollup(nullptr))
+            return false;
+
+        m_historyUsed -= SymbolRollup::memoryUsage();
+        return true;
+    }
+
+    std::vector<RollupAggregate> SymbolTable::Rollup(uint32_t id,
+        std::chrono::system_clock::time_point from,
+        std::chrono::system_clock::time_point to,
+        std::chrono::nanoseconds step) const
+    {
+        std::vector<RollupAggregate> aggregates;
+        auto it = find(id);
+        if (it == cend())
+            return aggregates;
+
+        //keep the rollups alive even if they get disabled meanwhile
+        const std::shared_ptr<SymbolRollup> rollup = it->second.getRollup();
+        if (rollup)
+            rollup->query(toNanoseconds(from), toNanoseconds(to), step.count(), aggregates);
+        return aggregates;
+    }
+
+    bool SymbolTable::EnableSharedMemory(const std::string& name, uint32_t capacity)
+    {
+        if (capacity < size())
+            return false;
+
+        auto shared = std::make_shared<SharedSymbolSegment>();
+        if (!shared->create(name, capacity))
+            return false;
+
+        {
+            //an InsertValue() which ran before publishes nothing or is in the walk below, one which runs
+            //after sees the segment and publishes its symbol itself
+            std::lock_guard<std::mutex> nameLock(m_nameMutex);
+            std::atomic_store(&m_shared, std::shared_ptr<SharedSymbolSegment>{});
+            ForEach([&shared](auto& item)
+            {
+                Symbol& symbol = item.second;
+                symbol.setSharedSlot(shared->publish(symbol.getId(), symbol.getName(), symbol.getType()));
+            });
+            std::atomic_store(&m_shared, shared);
+        }
+
+        ForEach([this](const auto& item) { shareValue(item.second); });
+        return true;
+    }
+
+    void SymbolTable::DisableSharedMemory()
+    {
+        std::lock_guard<std::mutex> nameLock(m_nameMutex);
+        std::atomic_store(&m_shared, std::shared_ptr<SharedSymbolSegment>{});
+        ForEach([](auto& item) { item.second.setSharedSlot(SharedSymbolSegment::NO_SLOT); });
+    }
+
+    void SymbolTable::shareSymbol(Symbol& symbol)
+    {
+        //a symbol inserted while EnableSharedMemory() waited for the lock was published by its walk
+        if (symbol.getSharedSlot() != SharedSymbolSegment::NO_SLOT)
+            return;
+        if (const auto shared = std::atomic_load(&m_shared))
+        {
+            symbol.setSharedSlot(shared->publish(symbol.getId(), symbol.getName(), symbol.getType()));
+            shareValue(symbol);
+        }
+    }
+
+    void SymbolTable::shareValue(const Symbol& symbol) const
+    {
+        const uint32_t slot = symbol.getSharedSlot();
+        if (slot == SharedSymbolSegment::NO_SLOT)
+            return;
+
+        const auto shared = std::atomic_load(&m_shared);
+        if (!shared)
+            return;
+
+        uint64_t bits;
+        if (symbol.getRaw(bits))
+            shared->write(slot, nowNanoseconds(), bits);
+        else if (const auto* text = symbol.get<std::string>())
+            shared->writeText(slot, nowNanoseconds(), *text);
+        else if (symbol.getType() == SymbolType::st_String || symbol.getType() == SymbolType::st_WideString)
+            shared->clearText(slot, nowNanoseconds());  //e.g. a std::wstring, readers fail instead of reading ""
+    }
+
+    int SymbolTable::AddTableEvent(table_event_t tableEvent)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_tableEventMutex);
+        const int eventId = m_nextTableEvent++;
+        m_tableEvents.emplace(eventId, std::move(tableEvent));
+        m_hasTableEvents = true;
+        return eventId;
+    }
+
+    bool SymbolTable::RemoveTableEvent(int eventId)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_tableEventMutex);
+        const bool bRet = m_tableEvents.erase(eventId) != 0;
+        m_hasTableEvents = !m_tableEvents.empty();
+        return bRet;
+    }
+
+    void SymbolTable::fireTableEvents(SymbolCodec::ChangeType change, const Symbol& symbol,
+        SymbolEvent::EventFireType fireType)
+    {
+        //the waiters see the changes the symbol events see
+        if (m_hasWaiters.load(std::memory_order_relaxed) && fireType != SymbolEvent::EventFireType::eft_Filtered)
+            notifyWaiters(change, symbol);
+
+        //checked first, most tables have no table events and SetValue is the hot path
+        if (!m_hasTableEvents.load(std::memory_order_relaxed))
+            return;
+
+        const TableChange tableChange{ change, &symbol, fireType };
+        std::shared_lock<std::shared_mutex> lock(m_tableEventMutex);
+        for (const auto& item : m_tableEvents)
+            item.second(tableChange);
+    }
+
+    bool SymbolTable::EnableAlarm(uint32_t id, const AlarmLimits& limits)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        //only scalar values have a numeric representation
+        if (!Symbol::isScalar(it->second.getType()))
+            return false;
+
+        auto alarm = std::make_shared<SymbolAlarm>(limits);
+        it->second.setAlarm(alarm);
+        updateAlarm(it->second, *alarm);
+        return true;
+    }
+
+    bool SymbolTable::DisableAlarm(uint32_t id)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        return it->second.setAlarm(nullptr) != nullptr;
+    }
+
+    bool SymbolTable::AcknowledgeAlarm(uint32_t id)
+    {
+        auto it = find(id);
+        if (it == end())
+            return false;
+
+        //keep the alarm alive even if it gets disabled meanwhile
+        const std::shared_ptr<SymbolAlarm> alarm = it->second.getAlarm();
+        AlarmTransition transition;
+        if (!alarm || !alarm->acknowledge(transition))
+            return false;
+
+        transition.m_id = id;
+        fireAlarmEvents(transition);
+        return true;
+    }
+
+    std::vector<AlarmStatus> SymbolTable::ActiveAlarms() const
+    {
+        std::vector<AlarmStatus> active;
+        ForEach([&](const auto& item)
+        {
+            const auto alarm = item.second.getAlarm();
+            if (!alarm)
+                return;
+            const AlarmLevel level = alarm->level();
+            const bool acknowledged = alarm->acknowledged();
+            if (level != AlarmLevel::al_Normal || !acknowledged)
+                active.push_back({ item.first, level, acknowledged });
+        });
+        return active;
+    }
+
+    size_t SymbolTable::ProcessAlarmDelays()
+    {
+        std::vector<uint32_t> delayed;
+        {
+            std::lock_guard<std::mutex> lock(m_delayedAlarmMutex);
+            delayed.swap(m_delayedAlarms);
+        }
+        std::sort(delayed.begin(), delayed.end());
+        delayed.erase(std::unique(delayed.begin(), delayed.end()), delayed.end());
+
+        size_t transitions = 0;
+        std::vector<uint32_t> waiting;
+        const int64_t now = nowNanoseconds();
+        for (uint32_t id : delayed)
+        {
+            auto it = find(id);
+            if (it == end())
+                continue;
+            const std::shared_ptr<SymbolAlarm> alarm = it->second.getAlarm();
+            if (!alarm)
+                continue;
+            AlarmTransition transition;
+            if (alarm->expire(now, transition))
+            {
+                transition.m_id = id;
+                fireAlarmEvents(transition);
+                transitions++;
+            }
+            else if (alarm->pending())
+                waiting.push_back(id);
+        }
+
+        if (!waiting.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_delayedAlarmMutex);
+            m_delayedAlarms.insert(m_delayedAlarms.end(), waiting.begin(), waiting.end());
+        }
+        return transitions;
+    }
+
+    int SymbolTable::AddAlarmEvent(alarm_event_t alarmEvent)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_alarmEventMutex);
+        const int eventId = m_nextAlarmEvent++;
+        m_alarmEvents.emplace(eventId, std::move(alarmEvent));
+        return eventId;
+    }
+
+    bool SymbolTable::RemoveAlarmEvent(int eventId)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_alarmEventMutex);
+        return m_alarmEvents.erase(eventId) != 0;
+    }
+
+    void SymbolTable::SetExecutor(std::shared_ptr<SymbolExecutor> executor)
+    {
+        std::lock_guard<std::mutex> lock(m_waiterMutex);
+        m_executor = std::move(executor);
+    }
+
+    bool SymbolTable::addWaiter(ChangeWaiter& waiter, bool notifyNow)
+    {
+        //checked under the lock, a DeleteValue() erases before it notifies
+        std::lock_guard<std::mutex> lock(m_waiterMutex);
+        ChangeWaiter** head = &m_prefixWaiters;
+        if (!waiter.m_byPrefix)
+        {
+            auto it = find(waiter.m_id);
+            if (it == end())
+                return false;
+            //the current value may satisfy the waiter already, a change of it later would not be notified
+            if (notifyNow && waiter.m_notify(waiter, SymbolCodec::ChangeType::ct_Set, it->second))
+                return false;
+            head = &m_waiters[waiter.m_id];
+        }
+        waiter.m_prev = nullptr;
+        waiter.m_next = *head;
+        if (*head)
+            (*head)->m_prev = &waiter;
+        *head = &waiter;
+        m_waiterCount++;
+        m_hasWaiters = true;
+        return true;
+    }
+
+    bool SymbolTable::removeWaiter(ChangeWaiter& waiter)
+    {
+        std::lock_guard<std::mutex> lock(m_waiterMutex);
+        return unlinkWaiter(waiter);
+    }
+
+    bool SymbolTable::unlinkWaiter(ChangeWaiter& waiter)
+    {
+        ChangeWaiter** head = &m_prefixWaiters;
+        if (!waiter.m_byPrefix)
+        {
+            auto it = m_waiters.find(waiter.m_id);
+            if (it == m_waiters.end())
+                return false;
+            head = &it->second;
+        }
+
+        if (waiter.m_prev)
+            waiter.m_prev->m_next = waiter.m_next;
+        else if (*head == &waiter)
+            *head = waiter.m_next;
+        else
+            return false;   //not linked anymore
+        if (waiter.m_next)
+            waiter.m_next->m_prev = waiter.m_prev;
+        waiter.m_prev = waiter.m_next = nullptr;
+        m_hasWaiters = --m_waiterCount != 0;
+        return true;
+    }
+
+    void SymbolTable::notifyWaiters(SymbolCodec::ChangeType change, const Symbol& symbol)
+    {
+        ChangeWaiter* ready = nullptr;
+        std::shared_ptr<SymbolExecutor> executor;
+        {
+            std::lock_guard<std::mutex> lock(m_waiterMutex);
+            const auto notify = [&](ChangeWaiter& waiter) {
+                if (!waiter.m_notify(waiter, change, symbol))
+                    return;
+                if (!waiter.m_persistent)
+                    unlinkWaiter(waiter);
+                waiter.m_ready = ready;
+                ready = &waiter;
+            };
+
+            //the head of an id stays when its last waiter goes, a coroutine waits again right after a change
+            auto it = m_waiters.find(symbol.getId());
+            if (it != m_waiters.end())
+            {
+                for (ChangeWaiter* waiter = it->second; waiter; )
+                {
+                    ChangeWaiter* next = waiter->m_next;
+                    notify(*waiter);
+                    waiter = next;
+                }
+                if (change == SymbolCodec::ChangeType::ct_Delete && !it->second)
+                    m_waiters.erase(it);
+            }
+            for (ChangeWaiter* waiter = m_prefixWaiters; waiter; )
+            {
+                ChangeWaiter* next = waiter->m_next;
+                if (symbol.getName().compare(0, waiter->m_prefix.size(), waiter->m_prefix) == 0)
+                    notify(*waiter);
+                waiter = next;
+            }
+            if (ready)
+                executor = m_executor;
+        }
+
+        //resumed after the lock, a resumed coroutine may wait again right away
+        while (ready)
+        {
+            ChangeWaiter* next = ready->m_ready;
+            if (executor)
+                executor->post(ready->m_resume, ready->m_context);
+            else
+                ready->m_resume(ready->m_context);
+            ready = next;
+        }
+    }
+
+    void SymbolTable::updateAlarm(const Symbol& symbol, SymbolAlarm& alarm)
+    {
+        uint64_t bits;
+        if (!symbol.getRaw(bits))
+            return;
+
+        AlarmTransition transition;
+        bool delayed;
+        if (alarm.update(Symbol::rawToDouble(symbol.getType(), bits), transition, delayed))
+        {
+            transition.m_id = symbol.getId();
+            fireAlarmEvents(transition);
+        }
+        else if (delayed)
+        {
+            std::lock_guard<std::mutex> lock(m_delayedAlarmMutex);
+            m_delayedAlarms.push_back(symbol.getId());
+        }
+    }
+
+    void SymbolTable::fireAlarmEvents(const AlarmTransition& transition)
+    {
+        //only transitions get here, they are rare compared to the writes
+        std::shared_lock<std::shared_mutex> lock(m_alarmEventMutex);
+        for (const auto& item : m_alarmEvents)
+            item.second(transition);
+    }
+
+    /*
+    *   a computed symbol, the inputs and the output are resolved once.
+    *   m_rank is higher than the rank of every computed input, so recomputing by rank visits
+    *   a symbol after everything it reads.
+    */
+    struct ComputedSymbol {
+        uint32_t m_id{};
+        SymbolHandle m_output;
+        std::vector<SymbolHandle> m_inputs;
+        compute_t m_compute;
+        uint32_t m_rank{};  //guarded by m_computeMutex
+        std::atomic<bool> m_removed{ false };   //a pending recompute is skipped after RemoveComputed()
+    };
+
+    /*
+    *   the computed symbols a thread has to recompute for a table, a heap ordered by rank.
+    *   m_depth counts the open batches and the running recompute, a change inside either
+    *   only adds to the heap.
+    */
+    struct PendingCompute {
+        struct Entry {
+            uint32_t m_rank;
+            std::shared_ptr<ComputedSymbol> m_computed;
+
+            bool operator<(const Entry& other) const noexcept {
+                return m_rank > other.m_rank;   //std::push_heap keeps the lowest rank on top
+            }
+        };
+
+        const SymbolTable* m_table{};
+        int m_depth{};
+        std::vector<Entry> m_heap;
+        std::unordered_set<const ComputedSymbol*> m_queued;
+    };
+
+    namespace {
+        //one entry per table this thread is recomputing or batching at once, usually one. idle entries are reused
+        PendingCompute& pendingFor(const SymbolTable* table)
+        {
+            thread_local std::vector<std::unique_ptr<PendingCompute>> pending;
+            PendingCompute* idle = nullptr;
+            for (const auto& entry : pending)
+            {
+                if (entry->m_table == table)
+                    return *entry;
+                if (!idle && entry->m_depth == 0 && entry->m_heap.empty())
+                    idle = entry.get();
+            }
+            if (!idle)
+            {
+                pending.push_back(std::make_unique<PendingCompute>());
+                idle = pending.back().get();
+            }
+            idle->m_table = table;
+            return *idle;
+        }
+    }
+
+    bool SymbolTable::AddComputed(uint32_t id, const std::vector<uint32_t>& inputs, compute_t compute)
+    {
+        if (!compute)
+            return false;
+        auto computed = std::make_shared<ComputedSymbol>();
+        computed->m_id = id;
+        computed->m_output = Resolve(id);
+        computed->m_compute = std::move(compute);
+        if (!computed->m_output.valid())
+            return false;
+        for (const uint32_t input : inputs)
+        {
+            computed->m_inputs.push_back(Resolve(input));
+            if (input == id || !computed->m_inputs.back().valid())
+                return false;
+        }
+
+        {
+            std::unique_lock<std::shared_mutex> lock(m_computeMutex);
+            if (m_computed.count(id) != 0)
+                return false;
+
+            // 1: an input downstream of id would close a cycle
+            std::vector<uint32_t> stack{ id };
+            std::unordered_set<uint32_t> visited;
+            while (!stack.empty())
+            {
+                auto it = m_dependents.find(stack.back());
+                stack.pop_back();
+                if (it == m_dependents.end())
+                    continue;
+                for (const auto& dependent : it->second)
+                {
+                    if (std::find(inputs.begin(), inputs.end(), dependent->m_id) != inputs.end())
+                        return false;
+                    if (visited.insert(dependent->m_id).second)
+                        stack.push_back(dependent->m_id);
+                }
+            }
+
+            // 2: rank after the computed inputs, the symbols already computed from id move behind it
+            for (const uint32_t input : inputs)
+            {
+                auto it = m_computed.find(input);
+                if (it != m_computed.end())
+                    computed->m_rank = std::max(computed->m_rank, it->second->m_rank + 1);
+                m_dependents[input].push_back(computed);
+            }
+            std::vector<const ComputedSymbol*> raised{ computed.get() };
+            while (!raised.empty())
+            {
+                const ComputedSymbol* node = raised.back();
+                raised.pop_back();
+                auto it = m_dependents.find(node->m_id);
+                if (it == m_dependents.end())
+                    continue;
+                for (const auto& dependent : it->second)
+                {
+                    if (dependent->m_rank <= node->m_rank)
+                    {
+                        dependent->m_rank = node->m_rank + 1;
+                        raised.push_back(dependent.get());
+                    }
+                }
+            }
+            m_computed.emplace(id, computed);
+            m_hasComputed = true;
+        }
+
+        // 3: the first value, inside a batch it waits for the batch
+        PendingCompute& pending = pendingFor(this);
+        {
+            std::shared_lock<std::shared_mutex> lock(m_computeMutex);
+            schedule(pending, computed);
+        }
+        if (pending.m_depth == 0)
+            runPending(pending);
+        return true;
+    }
+
+    bool SymbolTable::AddComputed(uint32_t id, const std::string& expression, std::string* error)
+    {
+        const auto compiled = SymbolExpression::compile(*this, expression, error);
+        if (!compiled)
+            return false;
+        const SymbolHandle output = Resolve(id);
+        const SymbolType type = output ? output.get()->getType() : SymbolType::st_Null;
+        if (!SymbolExpression::toAny(SymbolExpression::Value{}, type).has_value())
+        {
+            if (error)
+                *error = "computed symbol does not exist or is not boolean or numeric";
+            return false;
+        }
+        return AddComputed(id, compiled->getInputs(), [compiled, type](const std::vector<const Symbol*>& inputs) {
+            SymbolExpression::Value result;
+            return compiled->evaluate(inputs, result) ? SymbolExpression::toAny(result, type) : std::any();
+        });
+    }
+
+    bool SymbolTable::RemoveComputed(uint32_t id)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_computeMutex);
+        auto it = m_computed.find(id);
+        if (it == m_computed.end())
+            return false;
+
+        //ranks of the symbols computed from id stay, they are still in order without it
+        const std::shared_ptr<ComputedSymbol> computed = std::move(it->second);
+        m_computed.erase(it);
+        computed->m_removed = true;
+        for (const auto& input : computed->m_inputs)
+        {
+            auto dependents = m_dependents.find(input.getId());
+            if (dependents == m_dependents.end())
+                continue;
+            auto& list = dependents->second;
+            list.erase(std::remove(list.begin(), list.end(), computed), list.end());
+            if (list.empty())
+                m_dependents.erase(dependents);
+        }
+        m_hasComputed = !m_computed.empty();
+        return true;
+    }
+
+    void SymbolTable::propagateChange(uint32_t id)
+    {
+        PendingCompute& pending = pendingFor(this);
+        {
+            std::shared_lock<std::shared_mutex> lock(m_computeMutex);
+            auto it = m_dependents.find(id);
+            if (it == m_dependents.end())
+                return;
+            for (const auto& computed : it->second)
+                schedule(pending, computed);
+        }
+        if (pending.m_depth == 0)
+            runPending(pending);
+    }
+
+    void SymbolTable::schedule(PendingCompute& pending, const std::shared_ptr<ComputedSymbol>& computed)
+    {
+        //the rank is read under m_computeMutex, held by the caller
+        if (!pending.m_queued.insert(computed.get()).second)
+            return;
+        pending.m_heap.push_back({ computed->m_rank, computed });
+        std::push_heap(pending.m_heap.begin(), pending.m_heap.end());
+    }
+
+    void SymbolTable::runPending(PendingCompute& pending)
+    {
+        //a symbol set by compute() only schedules the symbols computed from it, they have a higher rank
+        pending.m_depth++;
+        while (!pending.m_heap.empty())
+        {
+            std::pop_heap(pending.m_heap.begin(), pending.m_heap.end());
+            const std::shared_ptr<ComputedSymbol> computed = std::move(pending.m_heap.back().m_computed);
+            pending.m_heap.pop_back();
+            pending.m_queued.erase(computed.get());
+            compute(*computed);
+        }
+        pending.m_depth--;
+    }
+
+    void SymbolTable::compute(ComputedSymbol& computed)
+    {
+        //one argument vector per nesting level, compute may write to another table which recomputes as well
+        thread_local std::vector<std::vector<const Symbol*>> arguments;
+        thread_local size_t level = 0;
+        Symbol* output = computed.m_output.symbol();
+        if (!output || computed.m_removed.load(std::memory_order_relaxed))
+            return;
+
+        if (arguments.size() <= level)
+            arguments.resize(level + 1);
+        std::vector<const Symbol*>& inputs = arguments[level];
+        inputs.clear();
+        for (const auto& input : computed.m_inputs)
+            inputs.push_back(input.get());
+        level++;
+        std::any value = computed.m_compute(inputs);
+        level--;
+
+        if (value.has_value())
+            applyValue(*output, std::move(value));
+    }
+
+    void SymbolTable::beginBatch()
+    {
+        pendingFor(this).m_depth++;
+    }
+
+    void SymbolTable::endBatch()
+    {
+        PendingCompute& pending = pendingFor(this);
+        if (--pending.m_depth == 0)
+            runPending(pending);
+    }
+
+    bool SymbolTable::EnableStats()
+    {
+#if SYMBOLS_STATS
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if (!m_stats)
+        {
+            m_stats = std::make_unique<SymbolStats>();
+            m_countersSince = std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+        m_activeStats.store(m_stats.get(), std::memory_order_release);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void SymbolTable::DisableStats()
+    {
+        m_activeStats.store(nullptr, std::memory_order_release);
+        StopStatsDump();
+    }
+
+    SymbolStatsSnapshot SymbolTable::Stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if (m_stats)
+            return m_stats->snapshot();
+
+        SymbolStatsSnapshot bRet;
+        bRet.m_taken = std::chrono::system_clock::now();
+        return bRet;
+    }
+
+    void SymbolTable::ResetStats()
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if (m_stats)
+            m_stats->reset();
+        ForEach([](const auto& item) { item.second.getCounters().clear(); });
+        m_countersSince = std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    std::vector<SymbolActivity> SymbolTable::TopN(SymbolMetric metric, size_t n) const
+    {
+        std::vector<SymbolActivity> bRet;
+        if (n == 0 || metric >= SymbolMetric::sm_Count)
+            return bRet;
+
+        // 1: keep the n highest counts in a min heap, one pass over the table
+        using ranked_t = std::pair<uint64_t, uint32_t>;     //count, id
+        const auto higher = [](const ranked_t& a, const ranked_t& b) { return a.first > b.first; };
+        std::vector<ranked_t> heap;
+        heap.reserve(std::min(n, size()));  //n may well be larger than the table
+        ForEach([&](const auto& item)
+        {
+            const uint64_t count = item.second.getCounters().get(metric);
+            if (count == 0 || (heap.size() == n && count <= heap.front().first))
+                return;
+
+            if (heap.size() == n)
+            {
+                std::pop_heap(heap.begin(), heap.end(), higher);
+                heap.pop_back();
+            }
+            heap.emplace_back(count, item.first);
+            std::push_heap(heap.begin(), heap.end(), higher);
+        });
+        std::sort_heap(heap.begin(), heap.end(), higher);   //highest count first
+
+        // 2: names and rates of the winners only
+        const auto since = std::chrono::steady_clock::duration(m_countersSince.load());
+        const double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch() - since).count();
+        bRet.reserve(heap.size());
+        for (const auto& ranked : heap)
+        {
+            auto it = find(ranked.second);
+            if (it == cend())
+                continue;   //deleted meanwhile
+            bRet.push_back({ ranked.second, it->second.getName(), ranked.first,
+                seconds > 0 ? static_cast<double>(ranked.first) / seconds : 0.0 });
+        }
+        return bRet;
+    }
+
+    bool SymbolTable::StartStatsDump(std::chrono::milliseconds interval,
+        std::function<void(const SymbolStatsSnapshot&)> sink, bool resetAfter)
+    {
+        //m_stats lives as long as the table once created, the dump is not started under m_statsMutex
+        //so a sink calling Stats() cannot deadlock with the join
+        SymbolStats* stats = activeStats();
+        if (!stats || !sink || interval.count() <= 0)
+            return false;
+
+        stats->startDump(interval, std::move(sink), resetAfter);
+        return true;
+    }
+
+    void SymbolTable::StopStatsDump()
+    {
+        SymbolStats* stats = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            stats = m_stats.get();
+        }
+        if (stats)
+            stats->stopDump();
+    }
+
+    bool SymbolTable::reserveHistoryBudget(size_t bytes) noexcept
+    {
+        size_t used = m_historyUsed.load();
+        do
+        {
+            if (used + bytes > m_historyBudget.load())
+                return false;
+        } while (!m_historyUsed.compare_exchange_weak(used, used + bytes));
+        return true;
+    }
+
+    int SymbolTable::getSymbolIdByName(const std::string& name) const noexcept
+    {
+        //the index holds every symbol, a name missing from it does not exist
+        const uint64_t hash = hashName(name);
+        uint32_t id = 0;
+        if (!m_nameIndex.find(hash, id))
+            return 0;
+
+        //the lowest id of the hash, if it has this name it is the lowest one of the name as well
+        auto it = find(id);
+        if (it != end() && it->second.getName() == name)
+            return it->first;
+
+        //another name with the same hash, or the symbol was deleted meanwhile
+        int bRet = 0;
+        std::lock_guard<std::mutex> nameLock(m_nameMutex);
+        const auto twins = m_nameTwins.find(hash);
+        if (twins == m_nameTwins.end())
+        {
+            if (m_nameIndex.find(hash, id) && (it = find(id)) != end() && it->second.getName() == name)
+                bRet = it->first;
+            return bRet;
+        }
+        for (const uint32_t twin : twins->second)
+        {
+            if ((bRet == 0 || twin < static_cast<uint32_t>(bRet)) && (it = find(twin)) != end() &&
+                it->second.getName() == name)
+                bRet = it->first;
+        }
+        return bRet;
+    }
+
+    void SymbolTable::indexName(uint64_t hash, uint32_t id)
+    {
+        //a hash held by one symbol needs the index only, a second one starts the list of twins
+        uint32_t indexed = 0;
+        if (!m_nameIndex.find(hash, indexed))
+        {
+            m_nameIndex.insert(hash, id);
+            return;
+        }
+        auto& twins = m_nameTwins[hash];
+        if (twins.empty())
+            twins.push_back(indexed);
+        twins.push_back(id);
+        if (id < indexed)
+            m_nameIndex.insert_or_assign(hash, id);
+    }
+
+    void SymbolTable::unindexName(uint64_t hash, uint32_t id)
+    {
+        const auto twins = m_nameTwins.find(hash);
+        if (twins == m_nameTwins.end())
+        {
+            uint32_t indexed = 0;
+            if (m_nameIndex.find(hash, indexed) && indexed == id)
+                m_nameIndex.erase(hash);
+            return;
+        }
+
+        //the lowest of the ids left is indexed, a single one left does not need the list anymore
+        auto& ids = twins->second;
+        const auto it = std::find(ids.begin(), ids.end(), id);
+        if (it != ids.end())
+            ids.erase(it);
+        m_nameIndex.insert_or_assign(hash, *std::min_element(ids.begin(), ids.end()));
+        if (ids.size() == 1)
+            m_nameTwins.erase(twins);
+    }
+
+    std::vector<unsigned char> SymbolTable::SerializeXML() const
+    {
+        tinyxml2::XMLElement* root = nullptr, * pElm = nullptr;
+
+        std::vector<unsigned char> charVec;
+
+        //only what the document needs, the lock is held while copying it
+        struct Row {
+            std::string m_name;
+            uint32_t m_id;
+            std::string m_desc;
+            SymbolType m_type;
+            size_t m_length;    //elements of an array
+            std::string m_struct;   //type name of a struct
+        };
+        std::vector<Row> rows = Snapshot([](const auto& item) {
+            const StructValue* value = item.second.template get<StructValue>();
+            return Row{ item.second.getName(), item.first, item.second.getDescription(), item.second.getType(),
+                item.second.getArrayLength(), value && value->getLayout() ? value->getLayout()->getName() : std::string() };
+        });
+
+        //ordered by name, a duplicate name keeps the lowest id
+        std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.m_name < b.m_name; });
+        rows.erase(std::unique(rows.begin(), rows.end(),
+            [](const Row& a, const Row& b) { return a.m_name == b.m_name; }), rows.end());
+
+        auto pDoc = std::make_unique<tinyxml2::XMLDocument>();
+        tinyxml2::XMLNode* pRoot = pDoc->NewElement(XML_ELEMENT_SYMBOLTABLE);
+        tinyxml2::XMLNode* pTemp, *pSearch;
+        pDoc->InsertFirstChild(pRoot);
+
+        for (auto itn = rows.cbegin(); itn != rows.cend(); itn++)
+        {
+            bool lastSubs = false;
+            std::istringstream f(itn->m_name);
+            std::string s;
+
+            if (itn->m_name.length() == 0)
+                continue;
+
+            pTemp = pRoot;
+
+            // split name into substrings and search
+            while (getline(f, s, '.'))
+            {
+                // is substring same as string or is substring last substring
+                if (itn->m_name == s || itn->m_name.rfind('.' + s) == itn->m_name.length() - s.length() - 1)
+                    lastSubs = true;
+
+                //the children are folder and symbol elements, only a substring spelled like them can match.
+                //skipping the search keeps a flat table from scanning every child for every symbol
+                pSearch = s == XML_ELEMENT_FOLDER || s == XML_ELEMENT_SYMBOL ?
+                    pTemp->FirstChildElement(s.c_str()) : nullptr;
+
+                // substring not found? create
+                if (!pSearch)
+                {
+                    // if base variable type add variable
+                    if (lastSubs)
+                    {
+                        pElm = pDoc->NewElement(XML_ELEMENT_SYMBOL);
+                        pElm->SetAttribute(XML_ELEMENT_ID, itn->m_id);
+                        pElm->SetAttribute(XML_ELEMENT_NAME, s.c_str());
+                        pElm->SetAttribute(XML_ELEMENT_DESC, itn->m_desc.c_str());
+                        pElm->SetAttribute(XML_ELEMENT_TYPE, static_cast<int>(itn->m_type));
+                        if (Symbol::isArray(itn->m_type))
+                            pElm->SetAttribute(XML_ELEMENT_LENGTH, static_cast<unsigned>(itn->m_length));
+                        if (!itn->m_struct.empty())
+                            pElm->SetAttribute(XML_ELEMENT_STRUCT, itn->m_struct.c_str());
+                        pTemp->LinkEndChild(pElm);
+                    }
+                    else // if folder type add folder
+                    {
+                        pElm = pDoc->NewElement(XML_ELEMENT_FOLDER);
+                        pElm->SetAttribute(XML_ELEMENT_NAME, s.c_str());
+                        pTemp->LinkEndChild(pElm);
+                        pTemp = pElm;
+                    }
+                }
+                else // substring found
+                {
+                    if (!lastSubs)
+                    {
+                        pTemp = pSearch;
+                    }
+                }
+            }
+        }
+
+        //print
+        tinyxml2::XMLPrinter printer;
+        pDoc->Accept(&printer);
+
+        const char* chIn = printer.CStr();
+
+        const char* end = chIn + strlen(chIn);
+
+        charVec.insert(charVec.end(), chIn, end);
+
+        return charVec;
+    }
 }
\ No newline at end of file
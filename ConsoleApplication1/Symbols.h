@@ -1,501 +1,1731 @@
-// Symbols.h : header file
-// 
-// Symbols Interface for PLCiManagementConsole App
-// Version: 1.3
-// Date: February 2021
-// Authors: Kadir ALTINDAG, Suat ARICANLI
-// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
-// Copyright (c) 2021. All Rights Reserved.
-
-// Changelog:
-//  Version 1.0:
-//  *Initial Release.
-//  Version 1.1:
-//  *Fix accesing private members of std::map
-//  Version 1.2:
-//  *Avoid copying data if possible
-//  Version 1.3:
-//  *Removed type parameter from method SetValue. Set value does not create anymore.
-//  *Added methods InsertValue and DeleteValue. SetValue no longer inserts a symbol.
-//  *GetValue now returns root folder if parameter is empty string
-//  *Added SymbolEvent class, and Symbol events map. Each Symbol may be assigned one or more events.
-//   Event parameter defined as void*, may be one of ????BaseArgs classes
-//   BaseArgs classes will evolve as we go
-//  *Added Symbol.compare()
-//  *Added Symbol.get()
-//  Version 1.4:
-//  *Added thread safe implementation for std::map
-//  *Events work properly now
-//  *Removed move semantic for SymbolTable methods which do not make any sense.
-//  *Added some tests for transaction and thread safety.
-//  *Improved event args by inheritance
-//  *Symbol::compare moved into cpp source file.
-//  *Some other improvements.
-//  Version 1.5:
-//  *Added SymbolTable::SerializeXML() returns vector of unsigned char.
-
-
-#pragma once
-#include <any>
-#include <functional>
-#include "ThreadSafeMap.h"
-#include <tinyxml2/tinyxml2.h>
-
-namespace Symbols {
-    enum class SymbolType {
-        st_Null = 0,
-        st_Boolean = 1,
-        st_SByte = 2,
-        st_Byte = 3,
-        st_Int16 = 4,
-        st_UInt16 = 5,
-        st_Int32 = 6,
-        st_UInt32 = 7,
-        st_Int64 = 8,
-        st_UInt64 = 9,
-        st_Float = 10,
-        st_Double = 11,
-        st_String = 12,
-        st_DateTime = 13,
-        st_Guid = 14,
-        //ByteString = 15,
-        //XmlElement = 16,
-        //NodeId = 17,
-        //ExpandedNodeId = 18,
-        //StatusCode = 19,
-        //QualifiedName = 20,
-        //LocalizedText = 21,
-        //ExtensionObject = 22,
-        //DataValue = 23,
-        //Variant = 24,
-        //DiagnosticInfo = 25,
-        st_WideString = 25,
-        st_Number = 26,
-        st_Integer = 27,
-        st_UInteger = 28,
-        //st_FolderType = 61
-    };
-
-    class Symbol;   //incomplete type declaration
-
-    //our map to hold whole datas
-    using treeMap = aricanli::container::ThreadSafeMap<uint32_t, Symbol>;    //sortable map class
-
-    class SymbolEvent
-    {
-    public:
-        enum class EventType {
-            et_None = 0,
-            // An OPC Server subscribed to a change in the symbol data
-            // This happens because an external OPC system asked to be notified.
-            et_OpcServer,
-            // An OPC Client subscribed to a change in the symbol data
-            // This happens because we are configured to notify an external OPC system
-            et_OpcClient,
-            // A Database subscribed to a change in the symbol data
-            // This happens because we are configured to save changes to a database
-            et_Database,
-            // An External Client subscribed to a change in the symbol data
-            // 1. This may happen because a PLCi client such as a form subscibed to show up to date values
-            //   forms subscribe when they are on a page that needs the updates, but unsubscribe when leaving the page or the form app terminates
-            // 2. This may happen because we are configured to update another PLCi device with up to date values
-            et_Transaction,
-            et_Coded
-        };
-
-        // this enum is used 1) to mark an event, 2) so save symbol update status
-        enum class EventFireType {
-            // no change in value
-            eft_None = 0,
-            // execute event when any change in value occurs
-            eft_AnyChange,
-            // execute event when any value increases
-            eft_Increase,
-            // execute event when any value decreases
-            eft_Decrease
-        };
-
-        //the base class for sending args between events
-        class BaseArgs {
-        public:
-            BaseArgs() = default;
-            virtual ~BaseArgs() {};    //This makes BaseArgs a polymorphic type
-
-            std::string m_symbolName;
-            SymbolType m_type{ SymbolType::st_Null };
-            const std::any* m_oldVal = nullptr;
-            const std::any* m_newVal = nullptr;
-        };
-
-        class OpcServerArgs : public BaseArgs
-        {
-        public:
-            OpcServerArgs() = default;   //default constructor
-            ~OpcServerArgs() override = default;  //destructor
-            OpcServerArgs(std::string symbolName, SymbolType type, 
-                const std::any& oldVal, const std::any& newVal)
-            {
-                m_symbolName = symbolName;
-                m_type = type;
-                m_oldVal = &oldVal;
-                m_newVal = &newVal;
-            }
-        };
-
-        class OpcClientArgs : public BaseArgs
-        {
-        public:
-            OpcClientArgs() = default;   //default constructor
-            ~OpcClientArgs() override = default;  //destructor
-            OpcClientArgs(std::string symbolName, SymbolType type, 
-                const std::any& oldVal, const std::any& newVal)
-            {
-                m_symbolName = symbolName;
-                m_type = type;
-                m_oldVal = &oldVal;
-                m_newVal = &newVal;
-            }
-        };
-
-        class DatabaseArgs : public BaseArgs
-        {
-        public:
-            DatabaseArgs() = default;   //default constructor
-            ~DatabaseArgs() override = default;  //destructor
-            DatabaseArgs(std::string symbolName, SymbolType type, 
-                const std::any& oldVal, const std::any& newVal, int transactionId) :
-                m_transactionId(transactionId)
-            {
-                m_symbolName = symbolName;
-                m_type = type;
-                m_oldVal = &oldVal;
-                m_newVal = &newVal;
-            }
-
-            int m_transactionId{};
-        };
-
-        class TransactionArgs : public BaseArgs
-        {
-        public:
-            TransactionArgs() = default;   //default constructor
-            ~TransactionArgs() override = default;  //destructor
-            TransactionArgs(std::string symbolName, SymbolType type, 
-                const std::any& oldVal, const std::any& newVal, int deviceTransactionId) :
-                m_deviceTransactionId(deviceTransactionId)
-            {
-                m_symbolName = symbolName;
-                m_type = type;
-                m_oldVal = &oldVal;
-                m_newVal = &newVal;
-            }
-
-            int m_deviceTransactionId{};
-        };
-
-        using symbol_event_t = std::function<void(BaseArgs*)>;
-
-    public:
-        SymbolEvent() = default;   //default constructor
-        virtual ~SymbolEvent() = default;  //destructor
-        SymbolEvent(int eventId, EventType type, EventFireType fireType, const symbol_event_t& callback) :
-            m_eventId(eventId),
-            m_type(type),
-            m_fireType(fireType),
-            m_event(std::bind(callback, std::placeholders::_1))
-        {
-
-        }
-
-        int getEventId() const noexcept {
-            return m_eventId;
-        }
-
-        EventType getEventType() const noexcept {
-            return m_type;
-        }
-
-        EventFireType getEventFireType() const noexcept {
-            return m_fireType;
-        }
-
-        symbol_event_t m_event;
-
-    private:
-        int m_eventId{};
-        EventType m_type{ EventType::et_None };
-        EventFireType m_fireType{ EventFireType::eft_AnyChange };
-    };
-
-
-    /*
-    *   the class we created should work any type of variables.
-    *   Designed with modern c++.
-    *   TODO: improve this class with a return type which is uncertain.
-    */
-
-    class Symbol {
-    public:
-        Symbol() = default;   //default constructor
-        virtual ~Symbol() = default;  //destructor
-
-        /*
-        *   if you want to noncopyable, just uncomment
-        *   but it probably should not work.
-        */
-        /*Symbol(const Symbol& r) = delete;
-        Symbol& operator=(const Symbol& r) = delete;*/
-
-        Symbol(uint32_t id, std::string name, std::string desc,
-            SymbolType type, const std::any& val) :
-            m_id{ id },
-            m_name{ name },
-            m_desc{ desc },
-            m_type{ type },
-            m_value{ val }
-        {
-
-        }
-
-        Symbol(uint32_t id, std::string name, std::string desc, 
-            SymbolType type, std::any&& val) :
-            m_id{ id },
-            m_name{ name },
-            m_desc{ desc },
-            m_type{ type },
-            m_value{ std::move(val) }
-        {
-
-        }
-
-        /*
-        *   sets the value of the object we stored in any via move semantic.
-        *   returns nothing.
-        */
-        void set(std::any&& value) noexcept {
-            m_value = std::move(value);
-        }
-
-        /*
-        *   sets the value of the object we stored in any via copy semantic.
-        *   returns nothing.
-        */
-        void set(const std::any& value) noexcept {
-            m_value = value;
-        }
-
-        /*
-        *   get the name of the symbol.
-        *   returns the name of an object we created earlier.
-        */
-        std::string getName() const noexcept {
-            return m_name;
-        }
-
-        /*
-        *   get the description of the symbol.
-        *   returns the name of an object we created earlier.
-        */
-        std::string getDescription() const noexcept {
-            return m_desc;
-        }
-
-        /*
-        *   sets the object type of the object we stored in any.
-        *   returns nothing.
-        */
-        void setType(SymbolType type) noexcept {
-            m_type = type;
-        }
-
-        /*
-        *   get the typed object we stored in std::any via metaprogramming.
-        *   returns the address of the object we created early, otherwise nullptr.
-        */
-        template<typename returnType>
-        const returnType* get() const noexcept {
-            return std::any_cast<returnType>(&m_value);
-        }
-
-        /*
-        *   get the std::any value we had stored.
-        *   returns the object itself for reading.
-        */
-        const std::any& get() const noexcept {
-            return m_value;
-        }
-
-        /*
-        *   compare a value with this one.
-        *   returns if there was a change and then if it increased or decreased.
-        */
-        SymbolEvent::EventFireType compare(const std::any& value) const;
-
-        /*
-        *   get the type of the object we stored in any.
-        *   returns the type of the object we created earlier.
-        */
-        SymbolType getType() const noexcept {
-            return m_type;
-        }
-
-        /*
-        *   get the id of the object we stored in any.
-        *   returns the type of the object we created earlier.
-        */
-        uint32_t getId() const noexcept {
-            return m_id;
-        }
-
-        bool addEvent(int eventId, SymbolEvent symbolEvent)
-        {
-            auto result = m_events.emplace(eventId, symbolEvent);
-            return result.second;
-        }
-
-        void removeEvent(int eventId)
-        {
-            m_events.erase(eventId);
-        }
-
-    protected:
-        SymbolType m_type{ SymbolType::st_Null };
-        uint32_t m_id{};
-        std::string m_name, m_desc;
-        std::any m_value;   //can be any value of object
-        aricanli::container::ThreadSafeMap<int, SymbolEvent> m_events;
-    };
-
-    /*
-    *   Symbol table class to hold symbol data which is set of unknown variables.
-    *   You can set value of an object any time you want but it erases the old one if contains any.
-    *   One more thing, there should be something wrong with storing pointers, this class does not guaranteed
-    *   to clean up pointer addresses. So be careful with dynamic memory allocations.
-    */
-    class SymbolTable : public treeMap
-    {
-        static inline constexpr auto XML_ELEMENT_SYMBOLTABLE = "symboltable";
-        static inline constexpr auto XML_ELEMENT_FOLDER = "folder";
-        static inline constexpr auto XML_ELEMENT_SYMBOL = "symbol";
-        static inline constexpr auto XML_ELEMENT_NAME = "name";
-        static inline constexpr auto XML_ELEMENT_DESC = "desc";
-        static inline constexpr auto XML_ELEMENT_TYPE = "type";
-        static inline constexpr auto XML_ELEMENT_ID = "id";
-
-    public:
-        SymbolTable() = default;    //default constructor
-        virtual ~SymbolTable() = default;   //destructor
-
-        //noncopyable SymbolTable interface
-        /*SymbolTable(const SymbolTable& r) = delete;
-        SymbolTable& operator=(const SymbolTable& r) = delete;*/
-
-    public:
-        /*
-        *   Get value of a symbol instance by name.
-        *   Params:
-        *   name: Symbol name.
-        *   Returns: returns value of map entry, otherwise empty class.
-        */
-        Symbol GetValue(std::string name) const;
-
-        /*
-        *   Get value of a symbol instance by Id.
-        *   Params:
-        *   id: Symbol Id which is the key of the map.
-        *   Returns: returns value of map entry, otherwise empty class.
-        */
-        Symbol GetValue(uint32_t id) const;
-
-        /*
-        *   Set value of a symbol instance by name.
-        *   Params:
-        *   name: Symbol name.
-        *   value: any type of variable to hold into map.
-        *   Returns: returns true if successful, otherwise false.
-        */
-        bool SetValue(std::string name, std::any value);
-
-        /*
-        *   Set value of a symbol instance by Id.
-        *   Params:
-        *   id: Symbol Id which is the key of the map.
-        *   value: any type of variable to hold into map.
-        *   Returns: returns true if successful, otherwise false.
-        */
-        bool SetValue(uint32_t id, std::any value);
-
-        /*
-        *   Add an event to a symbol instance by name.
-        *   Params:
-        *   name: Symbol name.
-        *   symbolEvent: a Symbols::SymbolEvent instance.
-        *   Returns: returns true if successful, otherwise false.
-        */
-        bool AddEvent(std::string name, Symbols::SymbolEvent symbolEvent);
-
-        /*
-        *   Add an event to a symbol instance by Id.
-        *   Params:
-        *   id: Symbol Id which is the key of the map.
-        *   symbolEvent: a Symbols::SymbolEvent instance.
-        *   Returns: returns true if successful, otherwise false.
-        */
-        bool AddEvent(uint32_t id, Symbols::SymbolEvent symbolEvent);
-
-        /*
-        *   Insert a symbol.
-        *   Params:
-        *   id: Symbol id.
-        *   name: Symbol name.
-        *   desc: Symbol description.
-        *   type: type of variable we send.
-        *   value: any type of variable to hold into map.
-        *   Returns: returns true if successful, otherwise false.
-        */
-        bool InsertValue(uint32_t id, std::string name, std::string desc,
-            SymbolType type, std::any value);
-
-        /*
-        *   Insert a symbol by name. Converts string parameter to any<type>.
-        *   Params:
-        *   name: Symbol name.
-        *   desc: Symbol description.
-        *   type: type of variable we send.
-        *   value: any type of variable to hold into map.
-        *   Returns: returns true if successful, otherwise false.
-        */
-        bool InsertFromStringValue(uint32_t id, std::string name, std::string desc,
-            SymbolType type, std::string value);
-
-        /*
-        *   Delete a symbol by name.
-        *   Params:
-        *   name: Symbol name.
-        *   Returns: returns true if successful, otherwise false.
-        */
-        bool DeleteValue(std::string name);
-
-        /*
-        *   Delete a symbol by Id.
-        *   Params:
-        *   id: Symbol Id which is the key of the map.
-        *   Returns: returns true if successful, otherwise false.
-        */
-        bool DeleteValue(uint32_t id);
-
-        /*
-        *   Serialize the symbol table to XML.
-        *   Params: None
-        *   Returns: std::vector<unsigned char> containing the XML.
-        */
-        std::vector<unsigned char> SerializeXML() const;
-
-    private:
-        //void recurseFolders(const treeMap* folder, const std::unique_ptr<tinyxml2::XMLDocument>& doc,
-        //    tinyxml2::XMLNode* pNode) const;
-
-        int getSymbolIdByName(std::string name) const noexcept;
-
-    };
+// Symbols.h : header file
+// 
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.3
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release.
+//  Version 1.1:
+//  *Fix accesing private members of std::map
+//  Version 1.2:
+//  *Avoid copying data if possible
+//  Version 1.3:
+//  *Removed type parameter from method SetValue. Set value does not create anymore.
+//  *Added methods InsertValue and DeleteValue. SetValue no longer inserts a symbol.
+//  *GetValue now returns root folder if parameter is empty string
+//  *Added SymbolEvent class, and Symbol events map. Each Symbol may be assigned one or more events.
+//   Event parameter defined as void*, may be one of ????BaseArgs classes
+//   BaseArgs classes will evolve as we go
+//  *Added Symbol.compare()
+//  *Added Symbol.get()
+//  Version 1.4:
+//  *Added thread safe implementation for std::map
+//  *Events work properly now
+//  *Removed move semantic for SymbolTable methods which do not make any sense.
+//  *Added some tests for transaction and thread safety.
+//  *Improved event args by inheritance
+//  *Symbol::compare moved into cpp source file.
+//  *Some other improvements.
+//  Version 1.5:
+//  *Added SymbolTable::SerializeXML() returns vector of unsigned char.
+//  Version 1.6:
+//  *Added optional per symbol history ring buffer filled by SetValue.
+//  *Added SymbolTable::History(), EnableHistory(), DisableHistory() and SetHistoryBudget().
+//  Version 1.7:
+//  *Added optional compressed per symbol archive filled by SetValue.
+//  *Added SymbolTable::Archive(), EnableArchive() and DisableArchive().
+//  Version 1.8:
+//  *Added optional per symbol min/max/avg/count/last rollups at 1 s, 1 min and 1 h filled by SetValue.
+//  *Added SymbolTable::Rollup(), EnableRollup() and DisableRollup().
+//  Version 1.9:
+//  *Added SymbolDeadband, per symbol absolute and percent deadbands with hysteresis.
+//  *Added EventFireType::eft_Filtered for changes which stay inside the deadband.
+//  *SetValue fires the symbol events again, changes inside the deadband do not fire any.
+//  Version 1.10:
+//  *SymbolType moved into SymbolTraits.h, added SymbolTypeTraits mapping each type to its C++ type.
+//  *Symbol::compare() handles every SymbolType through a table of comparators generated from the traits.
+//   Values are compared in place, a value of another type than the symbol reports eft_AnyChange.
+//  *st_SByte and st_Byte hold signed char and unsigned char, InsertFromStringValue() parses them as numbers.
+//   They held the first character of the string as char before, get<char>() of such a symbol returns nullptr now.
+//  Version 1.11:
+//  *Added SymbolTable::SetValues() to update a run of same typed symbols from one block read.
+//   Changes are detected by SIMD kernels (BatchCompare.h), only changed symbols go through the event path.
+//  Version 1.12:
+//  *Added SymbolTable::EnableSharedMemory() and DisableSharedMemory(). Symbol values are mirrored into a
+//   shared memory segment (SharedSymbols.h) which other local processes read through SharedSymbolReader.
+//  Version 1.13:
+//  *Added table events (SymbolTable::AddTableEvent()) which are fired for every insert, delete and
+//   reported value change of the table, used by SubscriptionServer to fan out changes.
+//  Version 1.14:
+//  *Table events fire for changes inside the deadband as well, TableChange::m_fireType tells them apart.
+//   A deleted symbol is reported after it was erased.
+//  *Added replication of a table to other processes (SymbolReplication.h).
+//  Version 1.15:
+//  *tinyxml2.h is included from the project directory and sscanf_s is only used with MSVC,
+//   the table builds with the portable CMake build as well.
+//  Version 1.16:
+//  *Added SymbolTable::RemoveEvent(). ThreadSafeMap counts the time threads wait for its lock.
+//  Version 1.17:
+//  *Added optional operation counters, latency histograms and lock wait times (SymbolStats.h),
+//   SymbolTable::EnableStats(), DisableStats(), Stats(), ResetStats(), StartStatsDump() and StopStatsDump().
+//  Version 1.18:
+//  *Symbols count their reads, writes, value changes and fired events while the stats are enabled.
+//  *Added SymbolTable::TopN() to find the busiest symbols. Symbol::fireEvents() returns the events fired.
+//  Version 1.19:
+//  *GetValue, SetValue, AddEvent and DeleteValue by name resolve the name through a lock free hash
+//   index (ConcurrentHashMap.h) instead of walking the table. A name held by several symbols resolves
+//   to the lowest of their ids.
+//  Version 1.20:
+//  *The table and the event lists are traversed with ThreadSafeMap::ForEach(), ForEachInRange() and
+//   Snapshot() which hold the lock, begin() is not accessible anymore. SerializeXML() copies out the
+//   names only and no longer scans every child element per symbol.
+//  *SetValues() updates a run whose first id has no symbol as well.
+//  Version 1.21:
+//  *ThreadSafeMap::operator[] takes the exclusive lock to insert. Added ThreadSafeMap::try_emplace(),
+//   insert_or_assign() and upsert(), InsertValue() constructs the symbol in place.
+//  Version 1.22:
+//  *Symbol and SymbolEvent are movable, the write path moves names, values and events instead of
+//   copying them. SymbolEvent stores the callback without wrapping it in std::bind.
+//  *Symbol::getName() and getDescription() return a reference instead of a copy.
+//  Version 1.23:
+//  *Added TypedSymbol and SymbolTable::Typed(), a symbol resolved once with typed get() and set().
+//  *InsertFromStringValue() stores a double for st_Double, it stored a float.
+//  Version 1.24:
+//  *Added SymbolHandle and SymbolTable::Resolve(), a symbol resolved once whose reads and writes take no
+//   lookup and no lock of the map. A handle of a deleted symbol is invalid, see HandleTable.h.
+//  *TypedSymbol is built on SymbolHandle and no longer dangles after DeleteValue().
+//  Version 1.25:
+//  *Added st_ByteString and array symbol types stored contiguously (SymbolTraits.h). Arrays are compared by
+//   the SIMD kernels of DetectChanges(), SymbolTable::SetSlice() and GetSlice() update and read a range of
+//   elements and report the changed ones. SerializeXML() writes the length of an array, SymbolCodec the elements.
+//  Version 1.26:
+//  *Added st_Struct symbols of user defined types (SymbolStruct.h). SymbolTable::SetStruct() writes a whole
+//   struct in place and reports the changed fields as a bit mask, SetField() and GetField() access one field.
+//  Version 1.27:
+//  *Added computed symbols, SymbolTable::AddComputed() keeps a dependency graph and recomputes only the symbols
+//   downstream of a change, in dependency order. SetValues() and SymbolBatch recompute once per batch.
+//  Version 1.28:
+//  *Added SymbolExpression (SymbolExpression.h), expressions over symbols compiled once. A computed symbol can be
+//   defined by an expression, SymbolEvent::setCondition() fires an event only while an expression holds.
+//  Version 1.29:
+//  *Added alarm points (SymbolAlarm.h). SymbolTable::EnableAlarm() checks HI/HIHI/LO/LOLO limits with deadband and
+//   delays in SetValue(), alarm events (AddAlarmEvent()) receive the transitions and acknowledgements only.
+//  Version 1.30:
+//  *Added change waiters and SymbolTable::SetExecutor(), with C++20 coroutines (SymbolAwait.h) a coroutine can
+//   co_await NextChange(), WaitUntil() and the changes of a prefix without a thread or a SymbolEvent each.
+
+
+#pragma once
+#include <any>
+#include <functional>
+#include <unordered_map>
+#include "ThreadSafeMap.h"
+#include "ConcurrentHashMap.h"
+#include "HandleTable.h"
+#include "SymbolTraits.h"
+#include "SymbolStruct.h"
+#include "SymbolHistory.h"
+#include "SymbolArchive.h"
+#include "SymbolRollup.h"
+#include "SymbolAlarm.h"
+#include "SymbolStats.h"
+#include "BatchCompare.h"
+#include "SharedSymbols.h"
+#include "SymbolCodec.h"
+#include "tinyxml2.h"
+
+namespace Symbols {
+    class Symbol;   //incomplete type declaration
+    class SymbolExpression;
+
+    //our map to hold whole datas
+    using treeMap = aricanli::container::ThreadSafeMap<uint32_t, Symbol>;    //sortable map class
+
+    class SymbolEvent
+    {
+    public:
+        enum class EventType {
+            et_None = 0,
+            // An OPC Server subscribed to a change in the symbol data
+            // This happens because an external OPC system asked to be notified.
+            et_OpcServer,
+            // An OPC Client subscribed to a change in the symbol data
+            // This happens because we are configured to notify an external OPC system
+            et_OpcClient,
+            // A Database subscribed to a change in the symbol data
+            // This happens because we are configured to save changes to a database
+            et_Database,
+            // An External Client subscribed to a change in the symbol data
+            // 1. This may happen because a PLCi client such as a form subscibed to show up to date values
+            //   forms subscribe when they are on a page that needs the updates, but unsubscribe when leaving the page or the form app terminates
+            // 2. This may happen because we are configured to update another PLCi device with up to date values
+            et_Transaction,
+            et_Coded
+        };
+
+        // this enum is used 1) to mark an event, 2) so save symbol update status
+        enum class EventFireType {
+            // no change in value
+            eft_None = 0,
+            // execute event when any change in value occurs
+            eft_AnyChange,
+            // execute event when any value increases
+            eft_Increase,
+            // execute event when any value decreases
+            eft_Decrease,
+            // the value changed but stayed inside the deadband or hysteresis band of the symbol
+            // the new value is stored but no event is executed, never used to mark an event
+            eft_Filtered
+        };
+
+        //the base class for sending args between events
+        class BaseArgs {
+        public:
+            BaseArgs() = default;
+            virtual ~BaseArgs() {};    //This makes BaseArgs a polymorphic type
+
+            std::string m_symbolName;
+            SymbolType m_type{ SymbolType::st_Null };
+            const std::any* m_oldVal = nullptr;
+            const std::any* m_newVal = nullptr;
+        };
+
+        class OpcServerArgs : public BaseArgs
+        {
+        public:
+            OpcServerArgs() = default;   //default constructor
+            ~OpcServerArgs() override = default;  //destructor
+            OpcServerArgs(std::string symbolName, SymbolType type, 
+                const std::any& oldVal, const std::any& newVal)
+            {
+                m_symbolName = std::move(symbolName);
+                m_type = type;
+                m_oldVal = &oldVal;
+                m_newVal = &newVal;
+            }
+        };
+
+        class OpcClientArgs : public BaseArgs
+        {
+        public:
+            OpcClientArgs() = default;   //default constructor
+            ~OpcClientArgs() override = default;  //destructor
+            OpcClientArgs(std::string symbolName, SymbolType type, 
+                const std::any& oldVal, const std::any& newVal)
+            {
+                m_symbolName = std::move(symbolName);
+                m_type = type;
+                m_oldVal = &oldVal;
+                m_newVal = &newVal;
+            }
+        };
+
+        class DatabaseArgs : public BaseArgs
+        {
+        public:
+            DatabaseArgs() = default;   //default constructor
+            ~DatabaseArgs() override = default;  //destructor
+            DatabaseArgs(std::string symbolName, SymbolType type, 
+                const std::any& oldVal, const std::any& newVal, int transactionId) :
+                m_transactionId(transactionId)
+            {
+                m_symbolName = std::move(symbolName);
+                m_type = type;
+                m_oldVal = &oldVal;
+                m_newVal = &newVal;
+            }
+
+            int m_transactionId{};
+        };
+
+        class TransactionArgs : public BaseArgs
+        {
+        public:
+            TransactionArgs() = default;   //default constructor
+            ~TransactionArgs() override = default;  //destructor
+            TransactionArgs(std::string symbolName, SymbolType type, 
+                const std::any& oldVal, const std::any& newVal, int deviceTransactionId) :
+                m_deviceTransactionId(deviceTransactionId)
+            {
+                m_symbolName = std::move(symbolName);
+                m_type = type;
+                m_oldVal = &oldVal;
+                m_newVal = &newVal;
+            }
+
+            int m_deviceTransactionId{};
+        };
+
+        using symbol_event_t = std::function<void(BaseArgs*)>;
+
+    public:
+        SymbolEvent() = default;   //default constructor
+        virtual ~SymbolEvent() = default;  //destructor
+        SymbolEvent(const SymbolEvent& r) = default;
+        SymbolEvent(SymbolEvent&& r) noexcept = default;    //the virtual destructor suppresses the implicit one
+        SymbolEvent& operator=(const SymbolEvent& r) = default;
+        SymbolEvent& operator=(SymbolEvent&& r) noexcept = default;
+        SymbolEvent(int eventId, EventType type, EventFireType fireType, symbol_event_t callback) :
+            m_event(std::move(callback)),
+            m_eventId(eventId),
+            m_type(type),
+            m_fireType(fireType)
+        {
+
+        }
+
+        int getEventId() const noexcept {
+            return m_eventId;
+        }
+
+        EventType getEventType() const noexcept {
+            return m_type;
+        }
+
+        EventFireType getEventFireType() const noexcept {
+            return m_fireType;
+        }
+
+        /*
+        *   fire the event only when a condition holds after the change, e.g. "tank1.level > tank1.high",
+        *   tested once the fire type matched, see SymbolExpression::compile(). nullptr removes the condition.
+        *   returns nothing.
+        */
+        void setCondition(std::shared_ptr<const SymbolExpression> condition) noexcept {
+            m_condition = std::move(condition);
+        }
+
+        const std::shared_ptr<const SymbolExpression>& getCondition() const noexcept {
+            return m_condition;
+        }
+
+        symbol_event_t m_event;
+
+    private:
+        int m_eventId{};
+        EventType m_type{ EventType::et_None };
+        EventFireType m_fireType{ EventFireType::eft_AnyChange };
+        std::shared_ptr<const SymbolExpression> m_condition;    //optional
+    };
+
+
+    /*
+    *   an optional part of a symbol (history, archive, rollups, alarm) which other threads enable and
+    *   disable while the symbol is written. The shared_ptr is accessed through std::atomic_load and
+    *   std::atomic_exchange, a reader gets a copy which keeps the part alive. Those take a lock of the
+    *   library, so a flag tells the write path cheaply that nothing is attached. Writers are serialized,
+    *   the flag always matches the pointer after a write.
+    */
+    template<typename T>
+    class SymbolAttachment
+    {
+    public:
+        SymbolAttachment() = default;
+        //copies of symbols without attachments take no lock
+        SymbolAttachment(const SymbolAttachment& r) noexcept {
+            if (auto value = r.load())
+                exchange(std::move(value));
+        }
+
+        SymbolAttachment& operator=(const SymbolAttachment& r) noexcept {
+            auto value = r.load();
+            if (value || m_attached.load(std::memory_order_acquire))
+                exchange(std::move(value));
+            return *this;
+        }
+
+        //returns nullptr if nothing is attached
+        std::shared_ptr<T> load() const noexcept {
+            if (!m_attached.load(std::memory_order_acquire))
+                return {};
+            return std::atomic_load(&m_value);
+        }
+
+        //returns the previous value
+        std::shared_ptr<T> exchange(std::shared_ptr<T> value) noexcept {
+            static std::mutex writeMutex;
+            std::lock_guard<std::mutex> lock(writeMutex);
+            const bool attached = value != nullptr;
+            auto previous = std::atomic_exchange(&m_value, std::move(value));
+            m_attached.store(attached, std::memory_order_release);
+            return previous;
+        }
+
+    private:
+        std::shared_ptr<T> m_value;
+        std::atomic<bool> m_attached{};
+    };
+
+    /*
+    *   Deadband settings of a numeric symbol, all zero means every change is reported.
+    *   A change is only reported when it differs from the last reported value by more than
+    *   max(m_absolute, m_percent * |last reported value| / 100). When the direction reverses
+    *   (e.g. a decrease after an increase) m_hysteresis is added to the band, so a noisy signal
+    *   oscillating around a value does not fire events back and forth. A change into or out of NaN
+    *   is always reported as eft_AnyChange.
+    */
+    struct SymbolDeadband {
+        double m_absolute{};
+        double m_percent{};
+        double m_hysteresis{};
+
+        bool isEnabled() const noexcept {
+            return m_absolute > 0.0 || m_percent > 0.0 || m_hysteresis > 0.0;
+        }
+    };
+
+    /*
+    *   the class we created should work any type of variables.
+    *   Designed with modern c++.
+    *   TODO: improve this class with a return type which is uncertain.
+    */
+
+    class Symbol {
+    public:
+        Symbol() = default;   //default constructor
+        virtual ~Symbol() = default;  //destructor
+
+        /*
+        *   if you want to noncopyable, just uncomment
+        *   but it probably should not work.
+        */
+        /*Symbol(const Symbol& r) = delete;
+        Symbol& operator=(const Symbol& r) = delete;*/
+        Symbol(const Symbol& r) = default;
+        Symbol& operator=(const Symbol& r) = default;
+        Symbol(Symbol&& r) = default;   //the virtual destructor suppresses the implicit one
+        Symbol& operator=(Symbol&& r) = default;
+
+        Symbol(uint32_t id, std::string name, std::string desc,
+            SymbolType type, const std::any& val) :
+            m_id{ id },
+            m_name{ std::move(name) },
+            m_desc{ std::move(desc) },
+            m_type{ type },
+            m_value{ val }
+        {
+
+        }
+
+        Symbol(uint32_t id, std::string name, std::string desc, 
+            SymbolType type, std::any&& val) :
+            m_id{ id },
+            m_name{ std::move(name) },
+            m_desc{ std::move(desc) },
+            m_type{ type },
+            m_value{ std::move(val) }
+        {
+
+        }
+
+        /*
+        *   sets the value of the object we stored in any via move semantic.
+        *   returns nothing.
+        */
+        void set(std::any&& value) noexcept {
+            m_value = std::move(value);
+        }
+
+        /*
+        *   sets the value of the object we stored in any via copy semantic.
+        *   returns nothing.
+        */
+        void set(const std::any& value) noexcept {
+            m_value = value;
+        }
+
+        /*
+        *   sets the value of the object we stored in any via move semantic.
+        *   returns the previous value.
+        */
+        std::any exchange(std::any&& value) noexcept {
+            std::any oldVal = std::move(m_value);
+            m_value = std::move(value);
+            return oldVal;
+        }
+
+        /*
+        *   get the name of the symbol.
+        *   returns the name of an object we created earlier.
+        */
+        const std::string& getName() const noexcept {
+            return m_name;
+        }
+
+        /*
+        *   get the description of the symbol.
+        *   returns the name of an object we created earlier.
+        */
+        const std::string& getDescription() const noexcept {
+            return m_desc;
+        }
+
+        /*
+        *   sets the object type of the object we stored in any.
+        *   returns nothing.
+        */
+        void setType(SymbolType type) noexcept {
+            m_type = type;
+        }
+
+        /*
+        *   get the typed object we stored in std::any via metaprogramming.
+        *   returns the address of the object we created early, otherwise nullptr.
+        */
+        template<typename returnType>
+        const returnType* get() const noexcept {
+            return std::any_cast<returnType>(&m_value);
+        }
+
+        /*
+        *   get the std::any value we had stored.
+        *   returns the object itself for reading.
+        */
+        const std::any& get() const noexcept {
+            return m_value;
+        }
+
+        /*
+        *   compare a value with this one.
+        *   returns if there was a change and then if it increased or decreased.
+        */
+        SymbolEvent::EventFireType compare(const std::any& value) const;
+
+        /*
+        *   compare a value with this one and apply the deadband of the symbol.
+        *   returns eft_Filtered if the value changed inside the deadband, otherwise like compare().
+        *   a reported change becomes the new reference of the deadband.
+        */
+        SymbolEvent::EventFireType detectChange(const std::any& value);
+
+        /*
+        *   sets the deadband of a numeric symbol, the current value becomes its reference.
+        *   returns nothing.
+        */
+        void setDeadband(const SymbolDeadband& deadband) noexcept;
+
+        /*
+        *   get the deadband of the symbol.
+        *   returns the deadband settings, all zero if not set.
+        */
+        const SymbolDeadband& getDeadband() const noexcept {
+            return m_deadband;
+        }
+
+        /*
+        *   execute the events whose fire type matches the change. The events run while the event list
+        *   is locked for reading, an event must not add or remove events of its own symbol.
+        *   returns the number of events fired.
+        */
+        size_t fireEvents(SymbolEvent::EventFireType change, const std::any& oldVal);
+
+        /*
+        *   get the type of the object we stored in any.
+        *   returns the type of the object we created earlier.
+        */
+        SymbolType getType() const noexcept {
+            return m_type;
+        }
+
+        /*
+        *   get the id of the object we stored in any.
+        *   returns the type of the object we created earlier.
+        */
+        uint32_t getId() const noexcept {
+            return m_id;
+        }
+
+        bool addEvent(int eventId, SymbolEvent symbolEvent)
+        {
+            return m_events.try_emplace(eventId, std::move(symbolEvent)).second;
+        }
+
+        void removeEvent(int eventId)
+        {
+            m_events.erase(eventId);
+        }
+
+        bool hasEvents() const noexcept
+        {
+            return !m_events.empty();
+        }
+
+        /*
+        *   get the raw 64 bit representation of a scalar value.
+        *   returns false if the symbol type is not a scalar type.
+        */
+        bool getRaw(uint64_t& bits) const noexcept;
+
+        /*
+        *   get the raw 64 bit representation of a scalar value of the given type.
+        *   returns false if the type is not a scalar type or the value does not hold it.
+        */
+        static bool toRaw(SymbolType type, const std::any& value, uint64_t& bits) noexcept;
+
+        /*
+        *   build a std::any of the given type from its raw 64 bit representation.
+        *   returns an empty std::any if the type is not a scalar type.
+        */
+        static std::any fromRaw(SymbolType type, uint64_t bits);
+
+        /*
+        *   convert a raw 64 bit representation of the given type to double.
+        *   returns 0 if the type is not a scalar type.
+        */
+        static double rawToDouble(SymbolType type, uint64_t bits) noexcept;
+
+        /*
+        *   check if values of the given type have a raw 64 bit representation.
+        *   returns true for booleans, integers, floating point and date time types.
+        */
+        static bool isScalar(SymbolType type) noexcept;
+
+        /*
+        *   check if values of the given type are a std::vector of elements, see SymbolTypeTraits::is_array.
+        *   returns true for st_ByteString and the array types.
+        */
+        static bool isArray(SymbolType type) noexcept;
+
+        /*
+        *   get the size of one element of an array type.
+        *   returns 0 if the type is not an array type.
+        */
+        static size_t elementSize(SymbolType type) noexcept;
+
+        /*
+        *   get the contiguous elements of an array value of the given type.
+        *   returns false if the type is not an array type or the value does not hold it.
+        */
+        static bool arrayData(SymbolType type, const std::any& value, const void*& data, size_t& count) noexcept;
+
+        /*
+        *   build an array value of the given type from count elements of elementSize() bytes.
+        *   returns an empty std::any if the type is not an array type.
+        */
+        static std::any arrayFromBytes(SymbolType type, const void* data, size_t count);
+
+        /*
+        *   get the number of elements of an array value.
+        *   returns 0 if the symbol does not hold an array.
+        */
+        size_t getArrayLength() const noexcept;
+
+        /*
+        *   get the elements of an array value to update them in place, see SymbolTable::SetSlice().
+        *   returns nullptr if the symbol does not hold a std::vector<T>.
+        */
+        template<typename T>
+        std::vector<T>* getArray() noexcept {
+            return std::any_cast<std::vector<T>>(&m_value);
+        }
+
+        /*
+        *   get the value of a st_Struct symbol to update it in place, see SymbolTable::SetStruct().
+        *   returns nullptr if the symbol does not hold a StructValue.
+        */
+        StructValue* getStruct() noexcept {
+            return std::any_cast<StructValue>(&m_value);
+        }
+
+        /*
+        *   get the history buffer assigned to the symbol. The copy keeps the buffer alive while
+        *   history gets disabled by another thread.
+        *   returns nullptr if history is not enabled.
+        */
+        std::shared_ptr<SymbolHistory> getHistory() const noexcept {
+            return m_history.load();
+        }
+
+        /*
+        *   assigns a history buffer to the symbol, nullptr disables history.
+        *   returns the previous buffer.
+        */
+        std::shared_ptr<SymbolHistory> setHistory(std::shared_ptr<SymbolHistory> history) noexcept {
+            return m_history.exchange(std::move(history));
+        }
+
+        /*
+        *   get the compressed archive assigned to the symbol, a copy like getHistory().
+        *   returns nullptr if the archive is not enabled.
+        */
+        std::shared_ptr<SymbolArchive> getArchive() const noexcept {
+            return m_archive.load();
+        }
+
+        /*
+        *   assigns a compressed archive to the symbol, nullptr disables it.
+        *   returns the previous archive.
+        */
+        std::shared_ptr<SymbolArchive> setArchive(std::shared_ptr<SymbolArchive> archive) noexcept {
+            return m_archive.exchange(std::move(archive));
+        }
+
+        /*
+        *   get the rollups assigned to the symbol, a copy like getHistory().
+        *   returns nullptr if rollups are not enabled.
+        */
+        std::shared_ptr<SymbolRollup> getRollup() const noexcept {
+            return m_rollup.load();
+        }
+
+        /*
+        *   assigns rollups to the symbol, nullptr disables them.
+        *   returns the previous rollups.
+        */
+        std::shared_ptr<SymbolRollup> setRollup(std::shared_ptr<SymbolRollup> rollup) noexcept {
+            return m_rollup.exchange(std::move(rollup));
+        }
+
+        /*
+        *   get the alarm point of the symbol, a copy like getHistory().
+        *   returns nullptr if no alarm is enabled.
+        */
+        std::shared_ptr<SymbolAlarm> getAlarm() const noexcept {
+            return m_alarm.load();
+        }
+
+        /*
+        *   assigns an alarm point to the symbol, nullptr disables it.
+        *   returns the previous alarm point.
+        */
+        std::shared_ptr<SymbolAlarm> setAlarm(std::shared_ptr<SymbolAlarm> alarm) noexcept {
+            return m_alarm.exchange(std::move(alarm));
+        }
+
+        /*
+        *   get the slot of the symbol in the shared memory segment of its table.
+        *   returns SharedSymbolSegment::NO_SLOT if the symbol is not shared.
+        */
+        uint32_t getSharedSlot() const noexcept {
+            return m_sharedSlot;
+        }
+
+        void setSharedSlot(uint32_t slot) noexcept {
+            m_sharedSlot = slot;
+        }
+
+        /*
+        *   get the slot of the symbol in the handle table of its table, see SymbolTable::Resolve().
+        *   returns NO_SLOT if the symbol was never resolved.
+        */
+        uint32_t getHandleSlot() const noexcept {
+            return m_handleSlot;
+        }
+
+        void setHandleSlot(uint32_t slot) noexcept {
+            m_handleSlot = slot;
+        }
+
+        /*
+        *   get the activity counters of the symbol, see SymbolTable::EnableStats().
+        */
+        const SymbolCounters& getCounters() const noexcept {
+            return m_counters;
+        }
+
+    protected:
+        SymbolType m_type{ SymbolType::st_Null };
+        uint32_t m_id{};
+        std::string m_name, m_desc;
+        std::any m_value;   //can be any value of object
+        aricanli::container::ThreadSafeMap<int, SymbolEvent> m_events;
+        SymbolAttachment<SymbolHistory> m_history;  //optional, shared by copies of the symbol
+        SymbolAttachment<SymbolArchive> m_archive;  //optional, shared by copies of the symbol
+        SymbolAttachment<SymbolRollup> m_rollup;    //optional, shared by copies of the symbol
+        SymbolAttachment<SymbolAlarm> m_alarm;      //optional, shared by copies of the symbol
+        SymbolDeadband m_deadband;
+        double m_reference{};   //last reported value when a deadband is set
+        SymbolEvent::EventFireType m_lastDirection{ SymbolEvent::EventFireType::eft_None };
+        uint32_t m_sharedSlot{ SharedSymbolSegment::NO_SLOT };
+        uint32_t m_handleSlot{ aricanli::container::HandleTable<Symbol>::NO_SLOT };
+        SymbolCounters m_counters;
+    };
+
+    /*
+    *   a change of the table passed to the table events, see SymbolTable::AddTableEvent().
+    *   m_symbol holds the new value for ct_Set, for ct_Delete it is the symbol which was erased.
+    *   m_fireType is how the value changed, eft_Filtered for changes inside the deadband which
+    *   do not fire the symbol events. Inserts and deletes report eft_AnyChange.
+    */
+    struct TableChange {
+        SymbolCodec::ChangeType m_change;
+        const Symbol* m_symbol;
+        SymbolEvent::EventFireType m_fireType;
+    };
+
+    using table_event_t = std::function<void(const TableChange&)>;
+
+    using alarm_event_t = std::function<void(const AlarmTransition&)>;
+
+    /*
+    *   a registration for the reported changes of one symbol or of every symbol under a name prefix, the
+    *   building block of the coroutine watches in SymbolAwait.h. The node belongs to the waiter and the table
+    *   links it without allocating. For each change the table calls m_notify under its waiter lock, so it has
+    *   to be short and must not call the table. When m_notify returns true the table unlinks a waiter which is
+    *   not m_persistent and calls m_resume(m_context) after the lock, through the executor if one is set.
+    */
+    struct ChangeWaiter {
+        using notify_t = bool (*)(ChangeWaiter& waiter, SymbolCodec::ChangeType change, const Symbol& symbol);
+
+        uint32_t m_id{};            //the symbol, unless m_byPrefix
+        std::string m_prefix;       //symbols whose name starts with it, inserts included, when m_byPrefix
+        bool m_byPrefix{};
+        bool m_persistent{};        //stays linked after m_notify returned true
+        notify_t m_notify{};
+        void (*m_resume)(void* context){};
+        void* m_context{};
+        ChangeWaiter* m_prev{};     //links of the table
+        ChangeWaiter* m_next{};
+        ChangeWaiter* m_ready{};    //the waiters one change resumes
+    };
+
+    /*
+    *   runs the resumptions of change waiters, e.g. on a thread pool or the event loop of a GUI, see
+    *   SymbolTable::SetExecutor(). Without an executor they run on the thread which changed the table.
+    */
+    class SymbolExecutor
+    {
+    public:
+        virtual ~SymbolExecutor() = default;
+
+        //call work(context) once, on any thread, right away or later
+        virtual void post(void (*work)(void* context), void* context) = 0;
+    };
+
+    class ChangeAwaiter;    //SymbolAwait.h, needs C++20 coroutines
+    class ConditionAwaiter;
+    class ChangeStream;
+
+    /*
+    *   computes the value of a computed symbol from its inputs, see SymbolTable::AddComputed().
+    *   returns the new value, an empty std::any keeps the current one.
+    */
+    using compute_t = std::function<std::any(const std::vector<const Symbol*>& inputs)>;
+
+    struct ComputedSymbol;  //a node of the dependency graph, defined in Symbols.cpp
+    struct PendingCompute;  //the computed symbols a thread has to recompute, defined in Symbols.cpp
+
+    class SymbolHandle;
+    class SymbolBatch;
+
+    template<SymbolType symbolType>
+    class TypedSymbol;
+
+    /*
+    *   Symbol table class to hold symbol data which is set of unknown variables.
+    *   You can set value of an object any time you want but it erases the old one if contains any.
+    *   One more thing, there should be something wrong with storing pointers, this class does not guaranteed
+    *   to clean up pointer addresses. So be careful with dynamic memory allocations.
+    */
+    class SymbolTable : public treeMap
+    {
+        static inline constexpr auto XML_ELEMENT_SYMBOLTABLE = "symboltable";
+        static inline constexpr auto XML_ELEMENT_FOLDER = "folder";
+        static inline constexpr auto XML_ELEMENT_SYMBOL = "symbol";
+        static inline constexpr auto XML_ELEMENT_NAME = "name";
+        static inline constexpr auto XML_ELEMENT_DESC = "desc";
+        static inline constexpr auto XML_ELEMENT_TYPE = "type";
+        static inline constexpr auto XML_ELEMENT_ID = "id";
+        static inline constexpr auto XML_ELEMENT_LENGTH = "length";
+        static inline constexpr auto XML_ELEMENT_STRUCT = "struct";
+
+        static inline constexpr size_t DEFAULT_HISTORY_BUDGET = 64 * 1024 * 1024;   //bytes
+
+    public:
+        SymbolTable() = default;    //default constructor
+        virtual ~SymbolTable() = default;   //destructor
+
+        //noncopyable SymbolTable interface
+        /*SymbolTable(const SymbolTable& r) = delete;
+        SymbolTable& operator=(const SymbolTable& r) = delete;*/
+
+    public:
+        /*
+        *   Get value of a symbol instance by name.
+        *   Params:
+        *   name: Symbol name.
+        *   Returns: returns value of map entry, otherwise empty class.
+        */
+        Symbol GetValue(std::string name) const;
+
+        /*
+        *   Get value of a symbol instance by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: returns value of map entry, otherwise empty class.
+        */
+        Symbol GetValue(uint32_t id) const;
+
+        /*
+        *   Set value of a symbol instance by name.
+        *   Params:
+        *   name: Symbol name.
+        *   value: any type of variable to hold into map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool SetValue(std::string name, std::any value);
+
+        /*
+        *   Set value of a symbol instance by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   value: any type of variable to hold into map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool SetValue(uint32_t id, std::any value);
+
+        /*
+        *   Set value of a symbol instance through a handle, without looking it up.
+        *   Params:
+        *   handle: handle returned by Resolve().
+        *   value: any type of variable to hold into map.
+        *   Returns: returns true if successful, otherwise false (invalid handle or the symbol was deleted).
+        */
+        bool SetValue(const SymbolHandle& handle, std::any value);
+
+        /*
+        *   Set the values of a run of symbols with consecutive Ids, e.g. from a PLC block read.
+        *   Params:
+        *   firstId: Id of the symbol which receives values[0].
+        *   values: new values of symbols firstId .. firstId + count - 1.
+        *   count: number of values.
+        *   Returns: returns the number of symbols whose value changed.
+        *   The values are compared in one batch (see DetectChanges()), only changed symbols go through
+        *   deadband and event dispatch. Missing Ids are skipped, symbols holding another type than T
+        *   are set one by one like SetValue() does.
+        */
+        template<typename T>
+        size_t SetValues(uint32_t firstId, const T* values, size_t count);
+
+        /*
+        *   Set a range of elements of an array symbol, e.g. a waveform from a block read.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   offset: index of the first element set.
+        *   values: new values of elements offset .. offset + count - 1.
+        *   count: number of values.
+        *   changes: receives a bit per element of the range which changed, may be nullptr.
+        *   Returns: returns true if successful, otherwise false (unknown id, the symbol holds no
+        *   std::vector<T> or the range does not fit into it).
+        *   The range is compared by the kernels of DetectChanges() and written in place, the symbol
+        *   events fire once with eft_AnyChange if any element changed.
+        */
+        template<typename T>
+        bool SetSlice(uint32_t id, size_t offset, const T* values, size_t count, ChangeMasks* changes = nullptr);
+
+        /*
+        *   Set a range of elements of an array symbol through a handle, see SetSlice(uint32_t, ...).
+        */
+        template<typename T>
+        bool SetSlice(const SymbolHandle& handle, size_t offset, const T* values, size_t count,
+            ChangeMasks* changes = nullptr);
+
+        /*
+        *   Get a range of elements of an array symbol.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   offset: index of the first element read.
+        *   values: receives elements offset .. offset + count - 1.
+        *   count: number of values.
+        *   Returns: returns true if successful, otherwise false (unknown id, the symbol holds no
+        *   std::vector<T> or the range does not fit into it).
+        */
+        template<typename T>
+        bool GetSlice(uint32_t id, size_t offset, T* values, size_t count) const;
+
+        /*
+        *   Set all fields of a st_Struct symbol from one block, e.g. a UDT from one PLC read.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   data: the block in the layout of the type, StructLayout::size() bytes.
+        *   size: bytes of data, has to match the layout.
+        *   changedFields: receives a bit per field of the layout which changed, may be nullptr.
+        *   Returns: returns true if successful, otherwise false (unknown id, the symbol holds no
+        *   StructValue or size does not match).
+        *   The block is written in place, the symbol events fire once with eft_AnyChange if any field
+        *   changed, StructValue::diff() of the new and old value in the event args tells which.
+        */
+        bool SetStruct(uint32_t id, const void* data, size_t size, uint64_t* changedFields = nullptr);
+
+        /*
+        *   Set all fields of a st_Struct symbol through a handle, see SetStruct(uint32_t, ...).
+        */
+        bool SetStruct(const SymbolHandle& handle, const void* data, size_t size, uint64_t* changedFields = nullptr);
+
+        /*
+        *   Set one field of a st_Struct symbol.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   field: index of the field, see StructLayout::fieldIndex().
+        *   value: new value, T has to be the C++ type of the field type.
+        *   Returns: returns true if successful, otherwise false (unknown id or field, another type).
+        */
+        template<typename T>
+        bool SetField(uint32_t id, size_t field, const T& value);
+
+        /*
+        *   Get one field of a st_Struct symbol.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   field: index of the field, see StructLayout::fieldIndex().
+        *   value: receives the value, T has to be the C++ type of the field type.
+        *   Returns: returns true if successful, otherwise false (unknown id or field, another type).
+        */
+        template<typename T>
+        bool GetField(uint32_t id, size_t field, T& value) const;
+
+        /*
+        *   Add an event to a symbol instance by name.
+        *   Params:
+        *   name: Symbol name.
+        *   symbolEvent: a Symbols::SymbolEvent instance.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool AddEvent(std::string name, Symbols::SymbolEvent symbolEvent);
+
+        /*
+        *   Add an event to a symbol instance by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   symbolEvent: a Symbols::SymbolEvent instance.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool AddEvent(uint32_t id, Symbols::SymbolEvent symbolEvent);
+
+        /*
+        *   Remove an event from a symbol instance by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   eventId: Id of the Symbols::SymbolEvent given to AddEvent().
+        *   Returns: returns true if the symbol exists, otherwise false.
+        */
+        bool RemoveEvent(uint32_t id, int eventId);
+
+        /*
+        *   Set the deadband of a numeric symbol by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   deadband: absolute, percent and hysteresis settings, all zero disables the deadband.
+        *   Returns: returns true if successful, otherwise false (unknown id or non scalar type).
+        */
+        bool SetDeadband(uint32_t id, const SymbolDeadband& deadband);
+
+        /*
+        *   Insert a symbol.
+        *   Params:
+        *   id: Symbol id.
+        *   name: Symbol name.
+        *   desc: Symbol description.
+        *   type: type of variable we send.
+        *   value: any type of variable to hold into map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool InsertValue(uint32_t id, std::string name, std::string desc,
+            SymbolType type, std::any value);
+
+        /*
+        *   Insert a symbol by name. Converts string parameter to any<type>.
+        *   Params:
+        *   name: Symbol name.
+        *   desc: Symbol description.
+        *   type: type of variable we send.
+        *   value: any type of variable to hold into map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool InsertFromStringValue(uint32_t id, std::string name, std::string desc,
+            SymbolType type, std::string value);
+
+        /*
+        *   Delete a symbol by name.
+        *   Params:
+        *   name: Symbol name.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool DeleteValue(std::string name);
+
+        /*
+        *   Delete a symbol by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool DeleteValue(uint32_t id);
+
+        /*
+        *   Serialize the symbol table to XML.
+        *   Params: None
+        *   Returns: std::vector<unsigned char> containing the XML.
+        */
+        std::vector<unsigned char> SerializeXML() const;
+
+        /*
+        *   Enable the in-memory history of a symbol by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   capacity: number of samples kept, the oldest sample is overwritten when full.
+        *   Returns: returns true if successful, otherwise false (unknown id, non scalar type
+        *   or the history budget of the table would be exceeded).
+        */
+        bool EnableHistory(uint32_t id, size_t capacity);
+
+        /*
+        *   Disable the in-memory history of a symbol by Id and release its budget.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool DisableHistory(uint32_t id);
+
+        /*
+        *   Set the memory budget shared by all history buffers of the table.
+        *   Params:
+        *   bytes: budget in bytes. Buffers already enabled are kept.
+        *   Returns: nothing.
+        */
+        void SetHistoryBudget(size_t bytes) noexcept;
+
+        /*
+        *   Get the recorded history of a symbol by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   from: first timestamp of the range (inclusive).
+        *   to: last timestamp of the range (inclusive).
+        *   Returns: samples in the range, oldest first. Empty if history is not enabled.
+        */
+        std::vector<HistorySample> History(uint32_t id,
+            std::chrono::system_clock::time_point from,
+            std::chrono::system_clock::time_point to) const;
+
+        /*
+        *   Enable the compressed archive of a symbol by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   maxBytes: memory limit of the archive, the oldest blocks are dropped beyond it.
+        *   0 means unlimited.
+        *   Returns: returns true if successful, otherwise false (unknown id or non scalar type).
+        */
+        bool EnableArchive(uint32_t id, size_t maxBytes = 0);
+
+        /*
+        *   Disable the compressed archive of a symbol by Id.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool DisableArchive(uint32_t id);
+
+        /*
+        *   Get the archived history of a symbol by Id. Only the blocks touching the range are decoded.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   from: first timestamp of the range (inclusive).
+        *   to: last timestamp of the range (inclusive).
+        *   Returns: samples in the range, oldest first. Empty if the archive is not enabled.
+        */
+        std::vector<HistorySample> Archive(uint32_t id,
+            std::chrono::system_clock::time_point from,
+            std::chrono::system_clock::time_point to) const;
+
+        /*
+        *   Enable the min/max/avg/count/last rollups of a numeric symbol by Id.
+        *   The rollups are charged to the same budget as the history buffers.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: returns true if successful, otherwise false (unknown id, non scalar type
+        *   or the history budget of the table would be exceeded).
+        */
+        bool EnableRollup(uint32_t id);
+
+        /*
+        *   Disable the rollups of a symbol by Id and release its budget.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool DisableRollup(uint32_t id);
+
+        /*
+        *   Get aggregates of a symbol by Id. The coarsest resolution finer than step is used,
+        *   so long ranges are served from a few precomputed buckets. If that resolution does not retain
+        *   from any more (1 s for two minutes, 1 min for a day, 1 h for a week), a coarser one is used
+        *   and the windows are as wide as its buckets.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   from: start of the range.
+        *   to: end of the range.
+        *   step: width of the returned windows.
+        *   Returns: one aggregate per non empty window, oldest first. Empty if rollups are not enabled.
+        */
+        std::vector<RollupAggregate> Rollup(uint32_t id,
+            std::chrono::system_clock::time_point from,
+            std::chrono::system_clock::time_point to,
+            std::chrono::nanoseconds step) const;
+
+        /*
+        *   Mirror the values of all symbols into a shared memory segment, so other local processes
+        *   can read them through SharedSymbolReader without asking this process.
+        *   Symbols inserted later are added, deleted symbols are removed from the segment.
+        *   Params:
+        *   name: segment name, e.g. "/plc_symbols". A segment with the same name is replaced.
+        *   capacity: maximum number of symbols ever published, slots of deleted symbols are not reused.
+        *   Returns: returns true if successful, otherwise false (the segment could not be created
+        *   or holds less slots than the table has symbols).
+        */
+        bool EnableSharedMemory(const std::string& name, uint32_t capacity);
+
+        /*
+        *   Stop mirroring the values and remove the shared memory segment.
+        *   Params: None
+        *   Returns: nothing.
+        */
+        void DisableSharedMemory();
+
+        /*
+        *   Add an event which is fired for every change of the table: inserted and deleted symbols
+        *   and value changes, including the ones inside the deadband (see TableChange::m_fireType).
+        *   The event runs on the thread which changed the table, so it should be short,
+        *   and must not add or remove table events itself.
+        *   Params:
+        *   tableEvent: callback receiving the change.
+        *   Returns: returns the event Id to pass to RemoveTableEvent().
+        */
+        int AddTableEvent(table_event_t tableEvent);
+
+        /*
+        *   Remove a table event, once it returns the event is not running anymore.
+        *   Params:
+        *   eventId: Id returned by AddTableEvent().
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool RemoveTableEvent(int eventId);
+
+        /*
+        *   Start counting the operations of the table with their latency and lock wait times.
+        *   The counters of an earlier EnableStats() are kept, see ResetStats().
+        *   Params: None
+        *   Returns: returns true if successful, false if the build has SYMBOLS_STATS=0.
+        */
+        bool EnableStats();
+
+        /*
+        *   Stop counting and stop a running dump, the counters are kept for Stats().
+        *   Params: None
+        *   Returns: nothing.
+        */
+        void DisableStats();
+
+        /*
+        *   Get the counters merged over all threads.
+        *   Params: None
+        *   Returns: the counters since the stats were enabled or reset, empty if they never were.
+        */
+        SymbolStatsSnapshot Stats() const;
+
+        /*
+        *   Clear the counters, the activity counters of the symbols as well.
+        *   Params: None
+        *   Returns: nothing.
+        */
+        void ResetStats();
+
+        /*
+        *   Pass a snapshot of the counters to sink every interval, e.g. to log them.
+        *   The sink runs on a thread of its own, it may call Stats() but not StopStatsDump() or DisableStats().
+        *   Params:
+        *   interval: time between two snapshots.
+        *   sink: receives the snapshot.
+        *   resetAfter: clear the counters after each snapshot, so every snapshot covers one interval.
+        *   Returns: returns true if successful, otherwise false (stats are not enabled).
+        */
+        bool StartStatsDump(std::chrono::milliseconds interval,
+            std::function<void(const SymbolStatsSnapshot&)> sink, bool resetAfter = false);
+
+        /*
+        *   Stop the periodic dump, once it returns the sink is not running anymore.
+        *   Params: None
+        *   Returns: nothing.
+        */
+        void StopStatsDump();
+
+        /*
+        *   Get the busiest symbols by one of their activity counters, counted while the stats are enabled.
+        *   Params:
+        *   metric: the counter to rank by, e.g. SymbolMetric::sm_Changes for chatty tags.
+        *   n: number of symbols returned at most.
+        *   Returns: the symbols with the highest counts, highest first. Symbols with a count of 0 are left out.
+        */
+        std::vector<SymbolActivity> TopN(SymbolMetric metric, size_t n) const;
+
+        /*
+        *   Resolve a symbol once into a handle which points to its storage, e.g. for the tags a driver
+        *   updates every cycle. Reading and writing through the handle needs no lookup and no lock of the map.
+        *   Params:
+        *   id: Symbol id.
+        *   Returns: a valid handle if the symbol exists, otherwise an invalid one.
+        *   The handle becomes invalid when the symbol is deleted, see SymbolHandle.
+        */
+        SymbolHandle Resolve(uint32_t id);
+
+        /*
+        *   Resolve a symbol by name once into a handle, see Resolve(uint32_t).
+        */
+        SymbolHandle Resolve(const std::string& name);
+
+        /*
+        *   Resolve a symbol once into a typed handle whose get() and set() need no lookup and no
+        *   switch over the SymbolType, e.g. for the inner loop of a controller.
+        *   Params:
+        *   id: Symbol id.
+        *   Returns: a valid handle if the symbol exists and its type stores symbol_type_t<symbolType>,
+        *   otherwise an invalid one.
+        */
+        template<SymbolType symbolType>
+        TypedSymbol<symbolType> Typed(uint32_t id);
+
+        /*
+        *   Resolve a symbol by name once into a typed handle, see Typed(uint32_t).
+        */
+        template<SymbolType symbolType>
+        TypedSymbol<symbolType> Typed(const std::string& name);
+
+        /*
+        *   Compute a symbol from other symbols, e.g. a sum of flows, a scaled value or an alarm boolean,
+        *   instead of polling the inputs from outside. When an input changes, the table recomputes the
+        *   computed symbols downstream of it, each once and after all of its inputs, and sets the results
+        *   like SetValue(). The writes of a SetValues() or a SymbolBatch recompute once at the end.
+        *   Two threads changing inputs of the same computed symbol may recompute it concurrently,
+        *   like two threads calling SetValue() for it.
+        *   Params:
+        *   id: Symbol id of the computed symbol, it has to exist and is computed once right away.
+        *   inputs: Symbol ids compute reads, they have to exist and may be computed symbols themselves.
+        *   compute: receives the input symbols in the order of inputs, nullptr for an input deleted since.
+        *   It runs on the thread which changed an input.
+        *   Returns: returns true if successful, otherwise false (a symbol does not exist, id is computed
+        *   already or one of the inputs depends on id, which would be a cycle).
+        */
+        bool AddComputed(uint32_t id, const std::vector<uint32_t>& inputs, compute_t compute);
+
+        /*
+        *   Compute a symbol from an expression over other symbols, e.g. "flow1 + flow2" or "level > 90",
+        *   see SymbolExpression. The result is converted to the type of the symbol, a result which does
+        *   not fit keeps the current value.
+        *   Params:
+        *   id: Symbol id of the computed symbol, a boolean or numeric symbol.
+        *   expression: the expression, its symbols are the inputs.
+        *   error: optional, receives what is wrong with the expression.
+        *   Returns: returns true if successful, otherwise false (see SymbolExpression::compile() and the
+        *   AddComputed() above).
+        */
+        bool AddComputed(uint32_t id, const std::string& expression, std::string* error = nullptr);
+
+        /*
+        *   Stop computing a symbol, it keeps its last value. DeleteValue() of the symbol removes it as well.
+        *   Params:
+        *   id: Symbol id passed to AddComputed().
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool RemoveComputed(uint32_t id);
+
+        /*
+        *   Watch a numeric symbol for HI/HIHI/LO/LOLO limits. SetValue() evaluates the alarm with thresholds
+        *   computed once, the alarm events receive only the changes of its level and acknowledgements.
+        *   The current value is evaluated right away. Enabling it again replaces the limits and resets the state.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   limits: the limits, deadband and delays, see AlarmLimits.
+        *   Returns: returns true if successful, otherwise false (unknown id or non scalar type).
+        */
+        bool EnableAlarm(uint32_t id, const AlarmLimits& limits);
+
+        /*
+        *   Stop watching a symbol for limits, no transition is reported.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool DisableAlarm(uint32_t id);
+
+        /*
+        *   Acknowledge the alarm of a symbol, the alarm events receive the acknowledgement.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: returns true if it was not acknowledged, otherwise false (already acknowledged or no alarm).
+        */
+        bool AcknowledgeAlarm(uint32_t id);
+
+        /*
+        *   Get the alarms which are not normal or not acknowledged.
+        *   Params: None
+        *   Returns: their states ordered by id.
+        */
+        std::vector<AlarmStatus> ActiveAlarms() const;
+
+        /*
+        *   Complete the delayed transitions whose delay has passed, e.g. from a timer every 100 ms.
+        *   A delayed transition is completed by the next SetValue() of the symbol as well, even one
+        *   which writes the same value, this is for values which are not written anymore.
+        *   Params: None
+        *   Returns: the number of transitions reported.
+        */
+        size_t ProcessAlarmDelays();
+
+        /*
+        *   Add an event which receives the transitions of all alarms of the table. It runs on the thread
+        *   which changed the value, acknowledged the alarm or called ProcessAlarmDelays(), so it should be
+        *   short, and must not add or remove alarm events itself.
+        *   Params:
+        *   alarmEvent: callback receiving the transition.
+        *   Returns: returns the event Id to pass to RemoveAlarmEvent().
+        */
+        int AddAlarmEvent(alarm_event_t alarmEvent);
+
+        /*
+        *   Remove an alarm event, once it returns the event is not running anymore.
+        *   Params:
+        *   eventId: Id returned by AddAlarmEvent().
+        *   Returns: returns true if successful, otherwise false.
+        */
+        bool RemoveAlarmEvent(int eventId);
+
+        /*
+        *   Set the executor which resumes the change waiters, e.g. the coroutines waiting in NextChange().
+        *   Params:
+        *   executor: the executor, nullptr resumes them on the thread which changed the table.
+        *   Returns: nothing.
+        */
+        void SetExecutor(std::shared_ptr<SymbolExecutor> executor);
+
+        /*
+        *   co_await the next reported change of a symbol, defined in SymbolAwait.h for C++20 coroutines.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   Returns: an awaitable whose result is the new value, an empty std::any if the symbol does not exist
+        *   or was deleted.
+        */
+        ChangeAwaiter NextChange(uint32_t id);
+
+        /*
+        *   co_await until the value of a symbol satisfies a predicate, defined in SymbolAwait.h for C++20 coroutines.
+        *   Params:
+        *   id: Symbol Id which is the key of the map.
+        *   predicate: tested with the current value, then with every reported change under the waiter lock
+        *   of the table, it has to be short and must not call the table.
+        *   Returns: an awaitable whose result is the value which satisfied the predicate, an empty std::any
+        *   if the symbol does not exist or was deleted.
+        */
+        ConditionAwaiter WaitUntil(uint32_t id, std::function<bool(const Symbol&)> predicate);
+
+        /*
+        *   Get the changes of the symbols under a name prefix as a stream whose next() a coroutine co_awaits,
+        *   defined in SymbolAwait.h for C++20 coroutines. The changes are queued from the call on.
+        *   Params:
+        *   prefix: the start of the names, e.g. "plant.line1.", empty for all symbols.
+        *   Returns: the stream, it stops receiving changes when destroyed.
+        */
+        ChangeStream Changes(std::string prefix);
+
+    private:
+        friend class SymbolHandle;
+        friend class SymbolBatch;
+        friend class ChangeAwaiter;
+        friend class ConditionAwaiter;
+        friend class ChangeStream;
+
+        //void recurseFolders(const treeMap* folder, const std::unique_ptr<tinyxml2::XMLDocument>& doc,
+        //    tinyxml2::XMLNode* pNode) const;
+
+        int getSymbolIdByName(const std::string& name) const noexcept;
+        void indexName(uint64_t hash, uint32_t id);
+        void unindexName(uint64_t hash, uint32_t id);
+
+        bool applyValue(Symbol& symbol, std::any&& value);
+        template<typename T>
+        bool applySlice(Symbol& symbol, size_t offset, const T* values, size_t count, ChangeMasks* changes);
+        bool applyStruct(Symbol& symbol, size_t offset, const void* data, size_t size, uint64_t* changedFields);
+        void recordSample(const Symbol& symbol);
+        void shareValue(const Symbol& symbol) const;
+        void shareSymbol(Symbol& symbol);
+        void fireTableEvents(SymbolCodec::ChangeType change, const Symbol& symbol,
+            SymbolEvent::EventFireType fireType);
+
+        bool reserveHistoryBudget(size_t bytes) noexcept;
+        void updateAlarm(const Symbol& symbol, SymbolAlarm& alarm);
+        void fireAlarmEvents(const AlarmTransition& transition);
+        bool addWaiter(ChangeWaiter& waiter, bool notifyNow = false);
+        bool removeWaiter(ChangeWaiter& waiter);
+        bool unlinkWaiter(ChangeWaiter& waiter);
+        void notifyWaiters(SymbolCodec::ChangeType change, const Symbol& symbol);
+
+        //checked first, most tables have no computed symbols and SetValue is the hot path
+        void propagate(uint32_t id) {
+            if (m_hasComputed.load(std::memory_order_relaxed))
+                propagateChange(id);
+        }
+        void propagateChange(uint32_t id);
+        void schedule(PendingCompute& pending, const std::shared_ptr<ComputedSymbol>& computed);
+        void runPending(PendingCompute& pending);
+        void compute(ComputedSymbol& computed);
+        void beginBatch();
+        void endBatch();
+
+        SymbolStats* activeStats() const noexcept {
+            return m_activeStats.load(std::memory_order_acquire);
+        }
+
+        std::atomic<size_t> m_historyBudget{ DEFAULT_HISTORY_BUDGET };
+        std::atomic<size_t> m_historyUsed{ 0 };
+        std::shared_ptr<SharedSymbolSegment> m_shared;  //accessed through std::atomic_load/store
+        std::map<int, table_event_t> m_tableEvents;
+        mutable std::shared_mutex m_tableEventMutex;    //held while the table events run
+        int m_nextTableEvent{ 1 };
+        std::atomic<bool> m_hasTableEvents{ false };
+        std::unique_ptr<SymbolStats> m_stats;   //created by the first EnableStats(), kept until the table goes
+        std::atomic<SymbolStats*> m_activeStats{ nullptr };    //m_stats while enabled, checked by every operation
+        std::atomic<std::chrono::steady_clock::rep> m_countersSince{ 0 };  //symbol counters enabled or reset
+        mutable std::mutex m_statsMutex;
+        aricanli::container::ConcurrentHashMap<uint64_t, uint32_t> m_nameIndex;   //name hash to the lowest id, see getSymbolIdByName()
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_nameTwins;    //every id of a hash held by more than one symbol
+        mutable std::mutex m_nameMutex;     //held by the writers of the name index, by lookups of m_nameTwins and while symbols are published to m_shared
+        aricanli::container::HandleTable<Symbol> m_handles;    //slots of resolved symbols, see Resolve()
+        std::mutex m_handleMutex;   //held by Resolve() and by DeleteValue() until the symbol is erased
+        std::map<uint32_t, std::shared_ptr<ComputedSymbol>> m_computed;    //by id of the computed symbol
+        std::unordered_map<uint32_t, std::vector<std::shared_ptr<ComputedSymbol>>> m_dependents;   //input id to the symbols computed from it
+        mutable std::shared_mutex m_computeMutex;   //guards the graph, not held while computing
+        std::atomic<bool> m_hasComputed{ false };
+        std::map<int, alarm_event_t> m_alarmEvents;
+        mutable std::shared_mutex m_alarmEventMutex;    //held while the alarm events run
+        int m_nextAlarmEvent{ 1 };
+        std::vector<uint32_t> m_delayedAlarms;  //ids of alarms which started a delay, see ProcessAlarmDelays()
+        std::mutex m_delayedAlarmMutex;
+        std::unordered_map<uint32_t, ChangeWaiter*> m_waiters;  //id to the first waiter for it
+        ChangeWaiter* m_prefixWaiters{ nullptr };
+        size_t m_waiterCount{};
+        std::shared_ptr<SymbolExecutor> m_executor;
+        std::mutex m_waiterMutex;   //held while the waiters are notified
+        std::atomic<bool> m_hasWaiters{ false };
+    };
+
+    /*
+    *   SymbolBatch defers the recomputation of computed symbols on the calling thread until it ends, e.g. around
+    *   the writes of one PLC read cycle. A computed symbol is recomputed once, however many of its inputs the
+    *   batch changed. Batches nest, the outermost one recomputes. Writes of other threads are not deferred.
+    */
+    class SymbolBatch {
+    public:
+        explicit SymbolBatch(SymbolTable& table) :
+            m_table{ &table }
+        {
+            table.beginBatch();
+        }
+
+        ~SymbolBatch() {
+            commit();
+        }
+
+        SymbolBatch(const SymbolBatch& r) = delete;
+        SymbolBatch& operator=(const SymbolBatch& r) = delete;
+
+        /*
+        *   end the batch before the destructor, the computed symbols are recomputed now.
+        *   returns nothing.
+        */
+        void commit() {
+            if (SymbolTable* table = std::exchange(m_table, nullptr))
+                table->endBatch();
+        }
+
+    private:
+        SymbolTable* m_table;
+    };
+
+    /*
+    *   SymbolHandle is a symbol resolved once by SymbolTable::Resolve(). It points to a slot which points
+    *   to the symbol in its map node, get() and SymbolTable::SetValue(handle) read the slot and its
+    *   generation and take no lock of the map. DeleteValue() bumps the generation of the slot, a handle of
+    *   a deleted symbol is invalid from then on, also when the slot was reused for another symbol.
+    *   A symbol deleted while another thread uses it through a handle is not guarded, like a symbol deleted
+    *   during SetValue() by id. The handle must not outlive its table.
+    */
+    class SymbolHandle {
+    public:
+        SymbolHandle() = default;
+
+        /*
+        *   check if the symbol still exists.
+        */
+        bool valid() const noexcept {
+            return get() != nullptr;
+        }
+
+        explicit operator bool() const noexcept {
+            return valid();
+        }
+
+        /*
+        *   get the id of the symbol resolved, also after it was deleted.
+        *   returns 0 for a handle which was never resolved.
+        */
+        uint32_t getId() const noexcept {
+            return m_id;
+        }
+
+        /*
+        *   get the symbol.
+        *   returns the symbol, nullptr if the handle is invalid or the symbol was deleted.
+        */
+        const Symbol* get() const noexcept {
+            return symbol();
+        }
+
+        /*
+        *   get the typed value of the symbol.
+        *   returns the address of the value, nullptr if the symbol was deleted or holds another type.
+        */
+        template<typename returnType>
+        const returnType* get() const noexcept {
+            const Symbol* symbol = get();
+            return symbol ? symbol->get<returnType>() : nullptr;
+        }
+
+        /*
+        *   set the value, see SymbolTable::SetValue(const SymbolHandle&, std::any).
+        *   returns false if the handle is invalid or the symbol was deleted.
+        */
+        bool set(std::any value) {
+            return m_table && m_table->SetValue(*this, std::move(value));
+        }
+
+    private:
+        friend class SymbolTable;
+
+        SymbolHandle(SymbolTable* table, uint32_t id, uint32_t slot, uint32_t generation) noexcept :
+            m_table{ table },
+            m_id{ id },
+            m_slot{ slot },
+            m_generation{ generation }
+        {
+
+        }
+
+        Symbol* symbol() const noexcept {
+            return m_table ? m_table->m_handles.get(m_slot, m_generation) : nullptr;
+        }
+
+        SymbolTable* m_table{};
+        uint32_t m_id{};
+        uint32_t m_slot{ aricanli::container::HandleTable<Symbol>::NO_SLOT };
+        uint32_t m_generation{};
+    };
+
+    /*
+    *   TypedSymbol is a handle to a symbol of a SymbolType known at compile time, see SymbolTable::Typed().
+    *   The symbol is resolved once into a SymbolHandle, get() and set() use the C++ type of the SymbolType
+    *   directly, so a wrong type does not compile instead of returning nullptr at runtime.
+    *   After DeleteValue() the handle is invalid, get() returns a value initialised value and set() fails.
+    */
+    template<SymbolType symbolType>
+    class TypedSymbol {
+    public:
+        using value_type = symbol_type_t<symbolType>;
+        static_assert(!std::is_void_v<value_type>, "the SymbolType holds no value");
+
+        TypedSymbol() = default;
+
+        bool valid() const noexcept {
+            return m_handle.valid();
+        }
+
+        explicit operator bool() const noexcept {
+            return valid();
+        }
+
+        uint32_t getId() const noexcept {
+            return m_handle.getId();
+        }
+
+        /*
+        *   get the value.
+        *   returns the value, or a value initialised one if the symbol was deleted or holds another type.
+        */
+        const value_type& get() const noexcept {
+            //a generation check and a single pointer comparison in any_cast, no lookup and no switch
+            const value_type* value = m_handle.template get<value_type>();
+            return value ? *value : EMPTY;
+        }
+
+        /*
+        *   set the value the way SymbolTable::SetValue() does, with history, deadband and events.
+        *   returns false if the handle is not valid.
+        */
+        bool set(value_type value) {
+            return m_handle.set(std::any(std::move(value)));
+        }
+
+    private:
+        friend class SymbolTable;
+
+        explicit TypedSymbol(SymbolHandle handle) noexcept :
+            m_handle{ handle }
+        {
+
+        }
+
+        static inline const value_type EMPTY{};
+        SymbolHandle m_handle;
+    };
+
+    template<SymbolType symbolType>
+    TypedSymbol<symbolType> SymbolTable::Typed(uint32_t id)
+    {
+        SymbolHandle handle = Resolve(id);
+        const Symbol* symbol = handle.get();
+        if (!symbol || !symbolTypeStores<symbol_type_t<symbolType>>(symbol->getType()))
+            return {};
+        return TypedSymbol<symbolType>(handle);
+    }
+
+    template<SymbolType symbolType>
+    TypedSymbol<symbolType> SymbolTable::Typed(const std::string& name)
+    {
+        const int id = getSymbolIdByName(name);
+        return id > 0 ? Typed<symbolType>(static_cast<uint32_t>(id)) : TypedSymbol<symbolType>{};
+    }
+
+    template<typename T>
+    bool SymbolTable::SetField(uint32_t id, size_t field, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "fields hold plain values");
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_SetValue);
+        auto it = find(id);
+        const StructValue* current = it != end() ? it->second.get<StructValue>() : nullptr;
+        const StructLayout* layout = current ? current->getLayout().get() : nullptr;
+        if (!layout || field >= layout->fieldCount() || !symbolTypeStores<T>(layout->field(field).m_type) ||
+            !applyStruct(it->second, layout->field(field).m_offset, &value, sizeof(T), nullptr))
+        {
+            scope.failed();
+            return false;
+        }
+        return true;
+    }
+
+    template<typename T>
+    bool SymbolTable::GetField(uint32_t id, size_t field, T& value) const
+    {
+        SymbolStats::Scope scope(activeStats(), StatsOperation::op_GetValue);
+        auto it = find(id);
+        const StructValue* current = it != end() ? it->second.get<StructValue>() : nullptr;
+        if (!current || !current->get(field, value))
+        {
+            scope.failed();
+            return false;
+        }
+        if (scope.active())
+            it->second.getCounters().add(SymbolMetric::sm_Reads);
+        return true;
+    }
 }
\ No newline at end of file
@@ -1,12 +1,47 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include <map>
+#include <mutex>
 #include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace aricanli::container {
 
+    /*
+    *   time the calling thread spent waiting for the lock of a ThreadSafeMap.
+    *   Only an acquisition which does not get the lock at the first try is timed,
+    *   so an uncontended lock costs nothing extra.
+    */
+    struct LockWaitCounters {
+        uint64_t m_sharedWaits{};       //shared acquisitions which had to wait
+        uint64_t m_sharedWaitNs{};
+        uint64_t m_exclusiveWaits{};    //exclusive acquisitions which had to wait
+        uint64_t m_exclusiveWaitNs{};
+
+        uint64_t waitNs() const noexcept {
+            return m_sharedWaitNs + m_exclusiveWaitNs;
+        }
+    };
+
+    /*
+    *   get the lock wait counters of the calling thread, summed over every ThreadSafeMap.
+    */
+    inline LockWaitCounters& lockWaitCounters() noexcept
+    {
+        thread_local LockWaitCounters counters;
+        return counters;
+    }
+
     /*  
     *   ThreadSafeMap is a thread safe implementation of std::map.
     *   It works with multiple threads at the same time reading or writing into map.
+    *   The map is traversed with ForEach(), ForEachInRange() or Snapshot() only, begin() is not
+    *   accessible because an iterator walked without the lock breaks when another thread inserts.
+    *   The lock guards the tree, not the mapped values: threads changing the same value, e.g. through
+    *   at() or upsert(), synchronise themselves.
     */
     template<typename Key,
         typename T,
@@ -35,8 +70,8 @@ namespace aricanli::container {
             const key_compare& comp = key_compare(),
             const allocator_type& alloc = allocator_type()) : _Mybase(first, last, comp, alloc) {}
         ThreadSafeMap(const map& x) : _Mybase(x) {}
-        ThreadSafeMap(const ThreadSafeMap& x) : _Mybase(x) {}
-        ThreadSafeMap(const ThreadSafeMap& x, const allocator_type& alloc) : _Mybase(x, alloc) {}
+        ThreadSafeMap(const ThreadSafeMap& x) : _Mybase(x.lockedCopy()) {}
+        ThreadSafeMap(const ThreadSafeMap& x, const allocator_type& alloc) : _Mybase(x.lockedCopy(), alloc) {}
         ThreadSafeMap(map&& x) : _Mybase(std::move(x)) {}
         ThreadSafeMap(ThreadSafeMap&& x) : _Mybase(std::move(x)) {}
         ThreadSafeMap(map&& x, const allocator_type& alloc) : _Mybase(std::move(x), alloc) {}
@@ -47,35 +82,35 @@ namespace aricanli::container {
         std::pair<iterator, bool> insert(const value_type& val)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             return _Mybase::insert(val);
         }
         //-----------------------------------------------------------------------------
         iterator insert(iterator position, const value_type& val)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             return _Mybase::insert(position, val);
         }
         //-----------------------------------------------------------------------------
         template <class InputIterator> void insert(InputIterator first, InputIterator last)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             return _Mybase::insert(first, last);
         }
 
         iterator find(const key_type& k)
         {
             // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto lock = sharedLock();
             return _Mybase::find(k);
         }
         //-----------------------------------------------------------------------------
         const_iterator find(const key_type& k) const
         {
             // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto lock = sharedLock();
             return _Mybase::find(k);
         }
 
@@ -83,51 +118,53 @@ namespace aricanli::container {
         void clear() noexcept
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             _Mybase::clear();
         }
 
         iterator erase(const_iterator position)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             return _Mybase::erase(position);
         }
         //-----------------------------------------------------------------------------
         size_type erase(const key_type& k)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             return _Mybase::erase(k);
         }
         //-----------------------------------------------------------------------------
         iterator erase(const_iterator first, const_iterator last)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             return _Mybase::erase(first, last);
         }
 
         ThreadSafeMap<Key, T, Compare, Alloc>& operator= (const map& x)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             _Mybase::operator=(x);
             return *this;
         }
         //-----------------------------------------------------------------------------  
         ThreadSafeMap<Key, T, Compare, Alloc>& operator= (const ThreadSafeMap<Key, T, Compare, Alloc>& x)
         {
+            //copy first, the two locks are never held together
+            _Mybase copy = x.lockedCopy();
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
-            _Mybase::operator=(x);
+            auto lock = exclusiveLock();
+            _Mybase::operator=(std::move(copy));
             return *this;
         }
         //-----------------------------------------------------------------------------  
         ThreadSafeMap<Key, T, Compare, Alloc>& operator= (map&& x)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             _Mybase::operator=(std::move(x));
             return *this;
         }
@@ -135,7 +172,7 @@ namespace aricanli::container {
         ThreadSafeMap<Key, T, Compare, Alloc>& operator= (ThreadSafeMap<Key, T, Compare, Alloc>&& x)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             _Mybase::operator=(std::move(x));
             return *this;
         }
@@ -143,7 +180,7 @@ namespace aricanli::container {
         ThreadSafeMap<Key, T, Compare, Alloc>& operator= (std::initializer_list<value_type> il)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             _Mybase::operator=(il);
             return *this;
         }
@@ -151,60 +188,231 @@ namespace aricanli::container {
         bool empty() const noexcept
         {
             // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto lock = sharedLock();
             return _Mybase::empty();
         }
         //-----------------------------------------------------------------------------  
         size_type size() const noexcept
         {
             // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto lock = sharedLock();
             return _Mybase::size();
         }
         //-----------------------------------------------------------------------------  
         mapped_type& operator[] (const key_type& k)
         {
-            // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
-            return _Mybase::operator[](k);
+            //inserts a default value for a missing key, see try_emplace()
+            return try_emplace(k).first->second;
         }
         //-----------------------------------------------------------------------------
         mapped_type& operator[] (key_type&& k)
         {
-            // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
-            return _Mybase::operator[](std::move(k));
+            return try_emplace(std::move(k)).first->second;
         }
         //-----------------------------------------------------------------------------
         mapped_type& at(const key_type& k)
         {
             // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto lock = sharedLock();
             return _Mybase::at(k);
         }
         //-----------------------------------------------------------------------------
         const mapped_type& at(const key_type& k) const
         {
             // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto lock = sharedLock();
             return _Mybase::at(k);
         }
 
         size_type count(const key_type& k) const
         {
             // A shared mutex is used to enable mutiple concurrent reads
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto lock = sharedLock();
             return _Mybase::count(k);
         }
 
         template <typename... Args> std::pair<iterator, bool> emplace(Args&&... args)
         {
             //Exclusive lock to enable single write in the map
-            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto lock = exclusiveLock();
             return _Mybase::emplace(std::forward<Args>(args)...);
         }
 
+        /*
+        *   construct the value in place from args if the key does not exist, otherwise nothing is
+        *   constructed. An existing key is found under the shared lock, only an insert takes the
+        *   exclusive lock.
+        *   Returns: the element and true if it was inserted.
+        */
+        template <typename... Args> std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args)
+        {
+            if (auto it = find(k); it != _Mybase::end())
+                return { it, false };
+            //another thread may have inserted meanwhile, std::map::try_emplace checks again
+            auto lock = exclusiveLock();
+            return _Mybase::try_emplace(k, std::forward<Args>(args)...);
+        }
+        //-----------------------------------------------------------------------------
+        template <typename... Args> std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args)
+        {
+            if (auto it = find(k); it != _Mybase::end())
+                return { it, false };
+            auto lock = exclusiveLock();
+            return _Mybase::try_emplace(std::move(k), std::forward<Args>(args)...);
+        }
+
+        /*
+        *   assign obj to an existing key or insert it, both under the exclusive lock, so the assignment
+        *   does not race readers of the value or an erase of the key.
+        *   Returns: the element and true if it was inserted, false if assigned.
+        */
+        template <typename M> std::pair<iterator, bool> insert_or_assign(const key_type& k, M&& obj)
+        {
+            auto lock = exclusiveLock();
+            return _Mybase::insert_or_assign(k, std::forward<M>(obj));
+        }
+
+        /*
+        *   update the value of a key in place, a missing key is inserted with a default value first.
+        *   Params:
+        *   k: the key.
+        *   fn: called as fn(mapped_type&) under the exclusive lock, so no other thread reads the value
+        *   while fn changes it and the key cannot be erased meanwhile. Do not call back into the map from fn.
+        *   Returns: true if the key was inserted.
+        */
+        template <typename Fn> bool upsert(const key_type& k, Fn&& fn)
+        {
+            auto lock = exclusiveLock();
+            auto result = _Mybase::try_emplace(k);
+            fn(result.first->second);
+            return result.second;
+        }
+
+        /*
+        *   call fn for every element in key order while holding the shared lock.
+        *   Writers wait until fn returned for the last element, keep fn short and do not call
+        *   back into the map from it. fn may return false to stop early.
+        *   Params:
+        *   fn: called as fn(const value_type&), or fn(value_type&) on a non const map which may
+        *   change the mapped values but not insert or erase.
+        */
+        template <typename Fn> void ForEach(Fn&& fn) const
+        {
+            auto lock = sharedLock();
+            for (auto it = _Mybase::cbegin(); it != _Mybase::cend() && visit(fn, *it); ++it) {}
+        }
+        //-----------------------------------------------------------------------------
+        template <typename Fn> void ForEach(Fn&& fn)
+        {
+            auto lock = sharedLock();
+            for (auto it = _Mybase::begin(); it != _Mybase::end() && visit(fn, *it); ++it) {}
+        }
+
+        /*
+        *   call fn for every element whose key lies in [first, last], in key order, while holding
+        *   the shared lock. The same rules as for ForEach() apply.
+        */
+        template <typename Fn> void ForEachInRange(const key_type& first, const key_type& last, Fn&& fn) const
+        {
+            auto lock = sharedLock();
+            for (auto it = _Mybase::lower_bound(first);
+                it != _Mybase::cend() && !_Mybase::key_comp()(last, it->first) && visit(fn, *it); ++it) {}
+        }
+        //-----------------------------------------------------------------------------
+        template <typename Fn> void ForEachInRange(const key_type& first, const key_type& last, Fn&& fn)
+        {
+            auto lock = sharedLock();
+            for (auto it = _Mybase::lower_bound(first);
+                it != _Mybase::end() && !_Mybase::key_comp()(last, it->first) && visit(fn, *it); ++it) {}
+        }
+
+        /*
+        *   copy the elements out in key order. The shared lock is held while copying only,
+        *   a long scan of the copy does not block writers.
+        *   Returns: the elements at the time of the call.
+        */
+        std::vector<std::pair<Key, T>> Snapshot() const
+        {
+            auto lock = sharedLock();
+            return std::vector<std::pair<Key, T>>(_Mybase::cbegin(), _Mybase::cend());
+        }
+
+        /*
+        *   copy out only what a scan needs, e.g. the name and id of every element.
+        *   Params:
+        *   project: called as project(const value_type&) under the shared lock, returns the row kept.
+        *   Returns: one row per element in key order.
+        */
+        template <typename Fn> auto Snapshot(Fn&& project) const
+        {
+            std::vector<std::decay_t<std::invoke_result_t<Fn&, const value_type&>>> rows;
+            auto lock = sharedLock();
+            rows.reserve(_Mybase::size());
+            for (const auto& item : static_cast<const _Mybase&>(*this))
+                rows.push_back(project(item));
+            return rows;
+        }
+
     private:
+        //unguarded traversal, see ForEach()
+        using _Mybase::begin;
+        using _Mybase::cbegin;
+        using _Mybase::rbegin;
+        using _Mybase::crbegin;
+        using _Mybase::rend;
+        using _Mybase::crend;
+        using _Mybase::lower_bound;
+        using _Mybase::upper_bound;
+        using _Mybase::equal_range;
+
+        _Mybase lockedCopy() const
+        {
+            auto lock = sharedLock();
+            return _Mybase(*this);
+        }
+
+        //call fn, an fn returning void never stops the walk
+        template <typename Fn, typename Entry> static bool visit(Fn& fn, Entry& entry)
+        {
+            if constexpr (std::is_same_v<std::invoke_result_t<Fn&, Entry&>, bool>)
+                return fn(entry);
+            else
+            {
+                fn(entry);
+                return true;
+            }
+        }
+
+        std::shared_lock<std::shared_mutex> sharedLock() const
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                const auto start = std::chrono::steady_clock::now();
+                lock.lock();
+                auto& counters = lockWaitCounters();
+                counters.m_sharedWaits++;
+                counters.m_sharedWaitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+            return lock;
+        }
+
+        std::unique_lock<std::shared_mutex> exclusiveLock() const
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                const auto start = std::chrono::steady_clock::now();
+                lock.lock();
+                auto& counters = lockWaitCounters();
+                counters.m_exclusiveWaits++;
+                counters.m_exclusiveWaitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+            return lock;
+        }
+
         mutable std::shared_mutex mutex_; //The mutex for this map
     };
 }
\ No newline at end of file
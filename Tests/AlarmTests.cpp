@@ -0,0 +1,82 @@
+// AlarmTests.cpp : unit tests of the alarm points of SymbolTable
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include <chrono>
+#include <thread>
+#include "Symbols.h"
+#include "TestCheck.h"
+
+namespace {
+    using Symbols::AlarmLevel;
+    using Symbols::SymbolType;
+
+    constexpr auto DELAY = std::chrono::milliseconds(20);
+
+    //a table with an Int32 symbol of id 1 whose HI level is entered after DELAY, the levels reported are kept
+    struct DelayedAlarm {
+        Symbols::SymbolTable m_table;
+        std::vector<AlarmLevel> m_levels;
+
+        DelayedAlarm()
+        {
+            m_table.InsertValue(1, "tank.level", "", SymbolType::st_Int32, std::any(0));
+            Symbols::AlarmLimits limits;
+            limits.m_hi = 100;
+            limits.m_onDelay = DELAY;
+            m_table.EnableAlarm(1, limits);
+            m_table.AddAlarmEvent([this](const Symbols::AlarmTransition& transition) {
+                m_levels.push_back(transition.m_to);
+            });
+        }
+    };
+
+    void testSetValueDelay()
+    {
+        DelayedAlarm alarm;
+        alarm.m_table.SetValue(1, std::any(150));
+        CHECK(alarm.m_levels.empty());
+
+        //the same value written after the delay completes the level
+        std::this_thread::sleep_for(DELAY * 2);
+        alarm.m_table.SetValue(1, std::any(150));
+        CHECK(alarm.m_levels.size() == 1 && alarm.m_levels.front() == AlarmLevel::al_Hi);
+    }
+
+    void testSetValuesDelay()
+    {
+        DelayedAlarm alarm;
+        const int values[] = { 150 };
+        CHECK(alarm.m_table.SetValues(1, values, 1) == 1);
+        CHECK(alarm.m_levels.empty());
+
+        //an unchanged value of a run completes it as well
+        std::this_thread::sleep_for(DELAY * 2);
+        CHECK(alarm.m_table.SetValues(1, values, 1) == 0);
+        CHECK(alarm.m_levels.size() == 1 && alarm.m_levels.front() == AlarmLevel::al_Hi);
+    }
+
+    void testProcessAlarmDelays()
+    {
+        DelayedAlarm alarm;
+        alarm.m_table.SetValue(1, std::any(150));
+        CHECK(alarm.m_table.ProcessAlarmDelays() == 0);
+
+        std::this_thread::sleep_for(DELAY * 2);
+        CHECK(alarm.m_table.ProcessAlarmDelays() == 1);
+        CHECK(alarm.m_levels.size() == 1 && alarm.m_levels.front() == AlarmLevel::al_Hi);
+    }
+}
+
+int main()
+{
+    testSetValueDelay();
+    testSetValuesDelay();
+    testProcessAlarmDelays();
+    return Tests::result("AlarmTests");
+}
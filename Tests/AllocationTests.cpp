@@ -0,0 +1,138 @@
+// AllocationTests.cpp : unit tests of the heap allocations of the SymbolTable write path
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include <cstdlib>
+#include <new>
+#include "Symbols.h"
+#include "TestCheck.h"
+
+namespace {
+    //allocations of the calling thread, counted by the operator new below
+    thread_local size_t t_allocations = 0;
+
+    void* allocate(std::size_t size)
+    {
+        t_allocations++;
+        if (void* p = std::malloc(size ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    //the allocations fn makes
+    template<typename Fn>
+    size_t allocationsOf(Fn&& fn)
+    {
+        const size_t before = t_allocations;
+        fn();
+        return t_allocations - before;
+    }
+
+    using Symbols::SymbolEvent;
+    using Symbols::SymbolType;
+
+    //longer than the small string buffer, a copy of any of them allocates
+    const std::string NAME = "plant.area1.line.temperature.sensor";
+    const std::string DESC = "temperature of the line in degrees celsius";
+    const std::string TEXT = "a string value longer than the small string buffer";
+
+    /*
+    *   the names, descriptions, values and events are moved into the table, so the only allocations
+    *   left are the node of the symbol and the node of an event. A copy of a string argument or of a
+    *   std::any holding one adds an allocation and fails the test.
+    */
+    void testInsertValue()
+    {
+        Symbols::SymbolTable table;
+        std::string name = NAME, desc = DESC;
+        std::any value(TEXT);
+        CHECK(allocationsOf([&] {
+            table.InsertValue(1, std::move(name), std::move(desc), SymbolType::st_String, std::move(value));
+        }) <= 1);
+
+        std::string textName = NAME + ".text", textDesc = DESC, text = TEXT;
+        CHECK(allocationsOf([&] {
+            table.InsertFromStringValue(2, std::move(textName), std::move(textDesc), SymbolType::st_String, std::move(text));
+        }) <= 2);
+    }
+
+    void testSetValue()
+    {
+        Symbols::SymbolTable table;
+        table.InsertValue(1, NAME, DESC, SymbolType::st_Int32, std::any(1));
+        table.InsertValue(2, NAME + ".text", DESC, SymbolType::st_String, std::any(TEXT));
+
+        std::any number(2);
+        CHECK(allocationsOf([&] { table.SetValue(1, std::move(number)); }) == 0);
+
+        std::any text(TEXT + " changed");
+        CHECK(allocationsOf([&] { table.SetValue(2, std::move(text)); }) == 0);
+
+        std::string name = NAME;
+        std::any byName(3);
+        CHECK(allocationsOf([&] { table.SetValue(std::move(name), std::move(byName)); }) == 0);
+
+        //an unchanged value allocates nothing either
+        std::any same(3);
+        CHECK(allocationsOf([&] { table.SetValue(1, std::move(same)); }) == 0);
+    }
+
+    void testEvents()
+    {
+        Symbols::SymbolTable table;
+        table.InsertValue(1, NAME, DESC, SymbolType::st_Int32, std::any(1));
+
+        SymbolEvent symbolEvent(1, SymbolEvent::EventType::et_OpcServer, SymbolEvent::EventFireType::eft_AnyChange,
+            [](SymbolEvent::BaseArgs*) {});
+        CHECK(allocationsOf([&] { table.AddEvent(1, std::move(symbolEvent)); }) <= 1);
+
+        //the event arguments carry a copy of the name
+        std::any value(4);
+        CHECK(allocationsOf([&] { table.SetValue(1, std::move(value)); }) <= 1);
+
+        CHECK(allocationsOf([&] { table.DeleteValue(1); }) == 0);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    testInsertValue();
+    testSetValue();
+    testEvents();
+    return Tests::result("AllocationTests");
+}
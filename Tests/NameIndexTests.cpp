@@ -0,0 +1,82 @@
+// NameIndexTests.cpp : unit tests of the name lookups of SymbolTable
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "Symbols.h"
+#include "TestCheck.h"
+
+namespace {
+    using Symbols::SymbolType;
+
+    //id of the symbol found by name, 0 if none
+    uint32_t idOf(const Symbols::SymbolTable& table, const std::string& name)
+    {
+        return table.GetValue(name).getId();
+    }
+
+    void testMissingName()
+    {
+        Symbols::SymbolTable table;
+        CHECK(idOf(table, "plc.db1.speed") == 0);
+
+        table.InsertValue(1, "plc.db1.speed", "", SymbolType::st_Int32, std::any(1));
+        CHECK(idOf(table, "plc.db1.speed") == 1);
+        CHECK(idOf(table, "plc.db1.level") == 0);
+        CHECK(!table.DeleteValue(std::string("plc.db1.level")));
+
+        CHECK(table.DeleteValue(1));
+        CHECK(idOf(table, "plc.db1.speed") == 0);
+    }
+
+    void testDuplicateNames()
+    {
+        //the lowest id wins, whatever the order of the inserts
+        Symbols::SymbolTable table;
+        table.InsertValue(5, "plc.db1.speed", "", SymbolType::st_Int32, std::any(5));
+        table.InsertValue(3, "plc.db1.speed", "", SymbolType::st_Int32, std::any(3));
+        table.InsertValue(9, "plc.db1.speed", "", SymbolType::st_Int32, std::any(9));
+        table.InsertValue(4, "plc.db1.level", "", SymbolType::st_Int32, std::any(4));
+        CHECK(idOf(table, "plc.db1.speed") == 3);
+        CHECK(idOf(table, "plc.db1.level") == 4);
+    }
+
+    void testDeleteDuplicate()
+    {
+        Symbols::SymbolTable table;
+        table.InsertValue(7, "plc.db1.speed", "", SymbolType::st_Int32, std::any(7));
+        table.InsertValue(2, "plc.db1.speed", "", SymbolType::st_Int32, std::any(2));
+        table.InsertValue(4, "plc.db1.speed", "", SymbolType::st_Int32, std::any(4));
+
+        //the next lowest one is found once the indexed one is gone
+        CHECK(table.DeleteValue(2));
+        CHECK(idOf(table, "plc.db1.speed") == 4);
+
+        //deleting one which is not the lowest keeps the lowest
+        table.InsertValue(9, "plc.db1.speed", "", SymbolType::st_Int32, std::any(9));
+        CHECK(table.DeleteValue(7));
+        CHECK(idOf(table, "plc.db1.speed") == 4);
+
+        //by name deletes the lowest
+        CHECK(table.DeleteValue(std::string("plc.db1.speed")));
+        CHECK(idOf(table, "plc.db1.speed") == 9);
+        CHECK(table.DeleteValue(std::string("plc.db1.speed")));
+        CHECK(idOf(table, "plc.db1.speed") == 0);
+
+        //an id inserted again is found again
+        table.InsertValue(2, "plc.db1.speed", "", SymbolType::st_Int32, std::any(2));
+        CHECK(idOf(table, "plc.db1.speed") == 2);
+    }
+}
+
+int main()
+{
+    testMissingName();
+    testDuplicateNames();
+    testDeleteDuplicate();
+    return Tests::result("NameIndexTests");
+}
@@ -0,0 +1,76 @@
+// SetValuesTests.cpp : unit tests of SymbolTable::SetValues()
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include "Symbols.h"
+#include "TestCheck.h"
+
+namespace {
+    using Symbols::SymbolEvent;
+    using Symbols::SymbolType;
+
+    constexpr uint32_t COUNT = 8;
+
+    void insertRun(Symbols::SymbolTable& table, const char* prefix)
+    {
+        for (uint32_t id = 1; id <= COUNT; id++)
+            table.InsertValue(id, prefix + std::to_string(id), "", SymbolType::st_Int32, std::any(0));
+    }
+
+    int valueOf(const Symbols::SymbolTable& table, uint32_t id)
+    {
+        const Symbols::Symbol symbol = table.GetValue(id);
+        const int* value = symbol.get<int>();
+        return value ? *value : -1;
+    }
+
+    void testRun()
+    {
+        Symbols::SymbolTable table;
+        insertRun(table, "plc.db1.");
+        const int values[COUNT] = { 1, 0, 3, 0, 5, 0, 7, 0 };
+        CHECK(table.SetValues(1, values, COUNT) == 4);
+        for (uint32_t id = 1; id <= COUNT; id++)
+            CHECK(valueOf(table, id) == values[id - 1]);
+    }
+
+    void testNestedCall()
+    {
+        //the event of the first symbol writes a run of another table while the outer run is dispatched
+        Symbols::SymbolTable outer, inner;
+        insertRun(outer, "plc.db1.");
+        insertRun(inner, "plc.db2.");
+
+        const int innerValues[COUNT] = { 9, 9, 9, 9, 9, 9, 9, 9 };
+        size_t innerChanges = 0;
+        outer.AddEvent(1, SymbolEvent(1, SymbolEvent::EventType::et_OpcServer, SymbolEvent::EventFireType::eft_AnyChange,
+            [&](SymbolEvent::BaseArgs*) { innerChanges += inner.SetValues(1, innerValues, COUNT); }));
+
+        const int values[COUNT] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+        CHECK(outer.SetValues(1, values, COUNT) == COUNT);
+        CHECK(innerChanges == COUNT);
+        for (uint32_t id = 1; id <= COUNT; id++)
+        {
+            CHECK(valueOf(outer, id) == values[id - 1]);
+            CHECK(valueOf(inner, id) == 9);
+        }
+
+        //the outer call keeps reusing its buffers afterwards
+        const int again[COUNT] = { 8, 7, 6, 5, 4, 3, 2, 1 };
+        CHECK(outer.SetValues(1, again, COUNT) == COUNT);
+        for (uint32_t id = 1; id <= COUNT; id++)
+            CHECK(valueOf(outer, id) == again[id - 1]);
+    }
+}
+
+int main()
+{
+    testRun();
+    testNestedCall();
+    return Tests::result("SetValuesTests");
+}
@@ -0,0 +1,165 @@
+// SymbolCompareTests.cpp : unit tests of Symbol::compare()
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+#include <cmath>
+#include <limits>
+#include "Symbols.h"
+#include "TestCheck.h"
+
+namespace {
+    using Symbols::Symbol;
+    using Symbols::SymbolType;
+    using FireType = Symbols::SymbolEvent::EventFireType;
+
+    //a value of the type and a greater one, the elements of arrays differ in the last one
+    template<typename T>
+    bool samples(T& low, T& high)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            low = false;
+            high = true;
+        }
+        else if constexpr (std::is_arithmetic_v<T>)
+        {
+            low = static_cast<T>(1);
+            high = static_cast<T>(2);
+        }
+        else if constexpr (std::is_same_v<T, std::string>)
+        {
+            low = "pump1";
+            high = "pump2";
+        }
+        else if constexpr (std::is_same_v<T, Symbols::Guid>)
+        {
+            low = Symbols::Guid{ 1, 2, 3, { 4, 5, 6, 7, 8, 9, 10, 11 } };
+            high = Symbols::Guid{ 1, 2, 3, { 4, 5, 6, 7, 8, 9, 10, 12 } };
+        }
+        else if constexpr (std::is_same_v<T, Symbols::StructValue>)
+        {
+            const auto layout = Symbols::StructLayout::registerType("CompareTestMotor", {
+                { "speed", SymbolType::st_Float }, { "running", SymbolType::st_Boolean } });
+            low = Symbols::StructValue(layout);
+            high = Symbols::StructValue(layout);
+            low.set(0, 10.0f);
+            high.set(0, 20.0f);
+        }
+        else if constexpr (Symbols::SymbolArrayOf<T>::value)
+        {
+            using E = typename Symbols::SymbolArrayOf<T>::element_type;
+            low = T(100, static_cast<E>(1));
+            high = low;
+            high.back() = static_cast<E>(2);
+        }
+        else
+            return false;
+        return true;
+    }
+
+    //compare() of one SymbolType against values of its own type and of another type
+    template<SymbolType symbolType>
+    void checkType()
+    {
+        using T = Symbols::symbol_type_t<symbolType>;
+        if constexpr (std::is_void_v<T>)
+        {
+            //nothing stored, nothing changes
+            const Symbol symbol(1, "unused", "", symbolType, std::any());
+            CHECK(symbol.compare(std::any()) == FireType::eft_None);
+        }
+        else
+        {
+            T low{}, high{};
+            if (!CHECK(samples(low, high)))
+                return;
+
+            const Symbol symbol(1, "symbol", "", symbolType, std::any(low));
+            CHECK(symbol.compare(std::any(low)) == FireType::eft_None);
+
+            //scalars, strings and Guids have a direction, arrays and structs only change
+            constexpr bool directed = !Symbols::SymbolTypeTraits<symbolType>::is_array &&
+                !std::is_same_v<T, Symbols::StructValue>;
+            CHECK(symbol.compare(std::any(high)) == (directed ? FireType::eft_Increase : FireType::eft_AnyChange));
+            const Symbol higher(2, "higher", "", symbolType, std::any(high));
+            CHECK(higher.compare(std::any(low)) == (directed ? FireType::eft_Decrease : FireType::eft_AnyChange));
+
+            //a value of another type than the symbol holds cannot be ordered
+            if constexpr (std::is_same_v<T, std::string>)
+                CHECK(symbol.compare(std::any(1)) == FireType::eft_AnyChange);
+            else
+                CHECK(symbol.compare(std::any(std::string("1"))) == FireType::eft_AnyChange);
+            CHECK(symbol.compare(std::any()) == FireType::eft_AnyChange);
+        }
+    }
+
+    void testEveryType()
+    {
+        for (size_t index = 0; index < Symbols::SYMBOL_TYPE_COUNT; index++)
+        {
+            Symbols::visitSymbolType(static_cast<SymbolType>(index), [](auto symbolType) {
+                checkType<decltype(symbolType)::value>();
+            });
+        }
+    }
+
+    void testArraySize()
+    {
+        //a longer array is a change even if the common elements are equal
+        const Symbol symbol(1, "wave", "", SymbolType::st_FloatArray, std::any(std::vector<float>{ 1, 2, 3 }));
+        CHECK(symbol.compare(std::any(std::vector<float>{ 1, 2, 3, 4 })) == FireType::eft_AnyChange);
+        CHECK(symbol.compare(std::any(std::vector<float>{ 1, 2, 3 })) == FireType::eft_None);
+    }
+
+    void testNaN()
+    {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const Symbol number(1, "level", "", SymbolType::st_Double, std::any(1.0));
+        CHECK(number.compare(std::any(nan)) == FireType::eft_AnyChange);
+
+        const Symbol missing(2, "missing", "", SymbolType::st_Double, std::any(nan));
+        CHECK(missing.compare(std::any(nan)) == FireType::eft_None);
+        CHECK(missing.compare(std::any(1.0)) == FireType::eft_AnyChange);
+    }
+
+    void testByteStorage()
+    {
+        //st_SByte and st_Byte hold signed char and unsigned char, not the first character as char
+        Symbols::SymbolTable table;
+        CHECK(table.InsertFromStringValue(1, "sbyte", "", SymbolType::st_SByte, "-5"));
+        CHECK(table.InsertFromStringValue(2, "byte", "", SymbolType::st_Byte, "200"));
+        CHECK(table.InsertFromStringValue(3, "sbyteClamped", "", SymbolType::st_SByte, "-300"));
+        CHECK(table.InsertFromStringValue(4, "byteClamped", "", SymbolType::st_Byte, "0x1FF"));
+
+        const Symbol sbyte = table.GetValue(1);
+        CHECK(sbyte.get<signed char>() && *sbyte.get<signed char>() == -5);
+        CHECK(sbyte.get<char>() == nullptr);
+
+        const Symbol byte = table.GetValue(2);
+        CHECK(byte.get<unsigned char>() && *byte.get<unsigned char>() == 200);
+        CHECK(byte.get<char>() == nullptr);
+
+        const Symbol sbyteClamped = table.GetValue(3);
+        CHECK(sbyteClamped.get<signed char>() && *sbyteClamped.get<signed char>() == SCHAR_MIN);
+        const Symbol byteClamped = table.GetValue(4);
+        CHECK(byteClamped.get<unsigned char>() && *byteClamped.get<unsigned char>() == UCHAR_MAX);
+
+        //ordered as numbers, 200 is greater than 100 although it is negative as char
+        CHECK(byte.compare(std::any(static_cast<unsigned char>(100))) == FireType::eft_Decrease);
+        CHECK(sbyte.compare(std::any(static_cast<signed char>(-6))) == FireType::eft_Decrease);
+    }
+}
+
+int main()
+{
+    testEveryType();
+    testArraySize();
+    testNaN();
+    testByteStorage();
+    return Tests::result("SymbolCompareTests");
+}
@@ -0,0 +1,43 @@
+// TestCheck.h : header file
+//
+// Symbols Interface for PLCiManagementConsole App
+// Version: 1.0
+// Date: February 2021
+// Authors: Kadir ALTINDAG, Suat ARICANLI
+// Email: kadir.altindag@aricanli.com.tr, suat@aricanli.com.tr
+// Copyright (c) 2021. All Rights Reserved.
+
+// Changelog:
+//  Version 1.0:
+//  *Initial Release. Checks of the unit tests run by ctest.
+
+#pragma once
+#include <iostream>
+
+namespace Tests {
+    //number of failed checks of the test executable
+    inline int g_failures = 0;
+
+    //a failed check prints where it failed and the test goes on, main() returns the failures
+    inline bool check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (!condition)
+        {
+            std::cerr << file << "(" << line << "): check failed: " << expression << "\n";
+            g_failures++;
+        }
+        return condition;
+    }
+
+    //the exit code of the test executable, ctest reports any other than 0 as failed
+    inline int result(const char* name)
+    {
+        if (g_failures == 0)
+            std::cout << name << ": all checks passed\n";
+        else
+            std::cerr << name << ": " << g_failures << " checks failed\n";
+        return g_failures == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(condition) Tests::check((condition), #condition, __FILE__, __LINE__)